@@ -0,0 +1,520 @@
+// 规范JSON解析基准：单次遍历解析器（RegulationJson）与旧的子串查找解析器对比（无需ArchiCAD）
+//
+//   g++ -std=c++17 -O2 -ISrc Bench/RegulationJsonBench.cpp Src/RegulationJson.cpp -o regulation_json_bench
+//
+//   ./regulation_json_bench                      依次测试 1 / 100 / 1000 / 10000 个规范
+//   ./regulation_json_bench --regulations 5000   只测试指定数量
+//   ./regulation_json_bench --load               文件加载：1 / 5 / 10 / 25 / 50 MB 规范库
+//   ./regulation_json_bench --load-mb 20         文件加载：只测试指定大小
+//
+// 旧解析器按 RegulationConfig::ParseRule 的逻辑移植：先把UTF-8转换为宽字符串，
+// 对每个规则名在全文中 FindFirst，再在规则块中逐字段 FindFirst 并用 sscanf 解析数值。
+// 它只能读取文件中的第一个规范，因此多规范文件按规范切片后逐个调用。
+//
+// 文件加载对比 RegulationConfig::LoadFromJSON 的两种读法：旧的4 KB分块读取（每块转换为宽字符串后追加，
+// 解析前再整体转回UTF-8），以及按文件长度一次分配、直接解析原始字节。
+
+#include "RegulationJson.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// 旧解析器
+// ---------------------------------------------------------------------------
+
+std::u16string Utf8ToUtf16 (const char* data, std::size_t size)
+{
+	std::u16string result;
+	result.reserve (size);
+	for (std::size_t i = 0; i < size;) {
+		const unsigned char c = static_cast<unsigned char> (data[i]);
+		std::uint32_t codePoint = c;
+		std::size_t length = 1;
+		if (c >= 0xF0 && i + 3 < size) {
+			codePoint = ((c & 0x07u) << 18) | ((data[i + 1] & 0x3Fu) << 12) | ((data[i + 2] & 0x3Fu) << 6) | (data[i + 3] & 0x3Fu);
+			length = 4;
+		} else if (c >= 0xE0 && i + 2 < size) {
+			codePoint = ((c & 0x0Fu) << 12) | ((data[i + 1] & 0x3Fu) << 6) | (data[i + 2] & 0x3Fu);
+			length = 3;
+		} else if (c >= 0xC0 && i + 1 < size) {
+			codePoint = ((c & 0x1Fu) << 6) | (data[i + 1] & 0x3Fu);
+			length = 2;
+		}
+		if (codePoint >= 0x10000) {
+			codePoint -= 0x10000;
+			result.push_back (static_cast<char16_t> (0xD800 + (codePoint >> 10)));
+			result.push_back (static_cast<char16_t> (0xDC00 + (codePoint & 0x3FF)));
+		} else {
+			result.push_back (static_cast<char16_t> (codePoint));
+		}
+		i += length;
+	}
+	return result;
+}
+
+std::string Utf16ToUtf8 (const std::u16string& text)
+{
+	std::string result;
+	result.reserve (text.size ());
+	for (std::size_t i = 0; i < text.size (); ++i) {
+		std::uint32_t codePoint = text[i];
+		if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 1 < text.size ())
+			codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (text[++i] - 0xDC00u);
+		if (codePoint < 0x80) {
+			result.push_back (static_cast<char> (codePoint));
+		} else if (codePoint < 0x800) {
+			result.push_back (static_cast<char> (0xC0 | (codePoint >> 6)));
+			result.push_back (static_cast<char> (0x80 | (codePoint & 0x3F)));
+		} else if (codePoint < 0x10000) {
+			result.push_back (static_cast<char> (0xE0 | (codePoint >> 12)));
+			result.push_back (static_cast<char> (0x80 | ((codePoint >> 6) & 0x3F)));
+			result.push_back (static_cast<char> (0x80 | (codePoint & 0x3F)));
+		} else {
+			result.push_back (static_cast<char> (0xF0 | (codePoint >> 18)));
+			result.push_back (static_cast<char> (0x80 | ((codePoint >> 12) & 0x3F)));
+			result.push_back (static_cast<char> (0x80 | ((codePoint >> 6) & 0x3F)));
+			result.push_back (static_cast<char> (0x80 | (codePoint & 0x3F)));
+		}
+	}
+	return result;
+}
+
+// GS::UniString::FindFirst 的语义：未找到返回 -1
+long FindFirst (const std::u16string& text, const char16_t* pattern, long from = 0)
+{
+	if (from < 0)
+		from = 0;
+	const std::size_t pos = text.find (pattern, static_cast<std::size_t> (from));
+	return pos == std::u16string::npos ? -1 : static_cast<long> (pos);
+}
+
+std::u16string GetSubstring (const std::u16string& text, long from, long length)
+{
+	if (from < 0 || length < 0 || static_cast<std::size_t> (from) > text.size ())
+		return std::u16string ();
+	return text.substr (static_cast<std::size_t> (from), static_cast<std::size_t> (length));
+}
+
+void Trim (std::u16string& text)
+{
+	const std::size_t first = text.find_first_not_of (u" \t\r\n");
+	if (first == std::u16string::npos) {
+		text.clear ();
+		return;
+	}
+	text = text.substr (first, text.find_last_not_of (u" \t\r\n") - first + 1);
+}
+
+void LegacyParseLimit (const std::u16string& ruleBlock, const char16_t* key, std::optional<double>& limit)
+{
+	const long pos = FindFirst (ruleBlock, key);
+	if (pos < 0)
+		return;
+	const long colonPos = FindFirst (ruleBlock, u":", pos);
+	const long commaPos = FindFirst (ruleBlock, u",", colonPos);
+	if (colonPos < 0)
+		return;
+
+	std::u16string valueStr = GetSubstring (ruleBlock, colonPos + 1, commaPos - colonPos - 1);
+	Trim (valueStr);
+	if (valueStr.find (u"null") != std::u16string::npos)
+		return;
+
+	double value = 0.0;
+	if (std::sscanf (Utf16ToUtf8 (valueStr).c_str (), "%lf", &value) == 1)
+		limit = value;
+}
+
+void LegacyParseText (const std::u16string& ruleBlock, const char16_t* key, std::string& text)
+{
+	const long pos = FindFirst (ruleBlock, key);
+	if (pos < 0)
+		return;
+	const long colonPos = FindFirst (ruleBlock, u":", pos);
+	const long quoteStart = FindFirst (ruleBlock, u"\"", colonPos + 1) + 1;
+	const long quoteEnd = FindFirst (ruleBlock, u"\"", quoteStart);
+	if (quoteStart > 0 && quoteEnd > quoteStart)
+		text = Utf16ToUtf8 (GetSubstring (ruleBlock, quoteStart, quoteEnd - quoteStart));
+}
+
+RegulationJson::RuleRecord LegacyParseRule (const std::u16string& jsonContent, const char16_t* searchKey)
+{
+	RegulationJson::RuleRecord rule;
+
+	const long ruleStart = FindFirst (jsonContent, searchKey);
+	if (ruleStart < 0)
+		return rule;
+
+	const long blockStart = FindFirst (jsonContent, u"{", ruleStart);
+	const long blockEnd = FindFirst (jsonContent, u"}", blockStart);
+	if (blockStart < 0 || blockEnd < 0)
+		return rule;
+
+	const std::u16string ruleBlock = GetSubstring (jsonContent, blockStart, blockEnd - blockStart);
+	LegacyParseLimit (ruleBlock, u"\"min_value\"", rule.minValue);
+	LegacyParseLimit (ruleBlock, u"\"max_value\"", rule.maxValue);
+	LegacyParseText (ruleBlock, u"\"unit\"", rule.unit);
+	LegacyParseText (ruleBlock, u"\"source\"", rule.source);
+	LegacyParseText (ruleBlock, u"\"full_text\"", rule.fullText);
+	return rule;
+}
+
+RegulationJson::RegulationRecord LegacyParse (const char* data, std::size_t size)
+{
+	const std::u16string jsonContent = Utf8ToUtf16 (data, size);
+
+	RegulationJson::RegulationRecord record;
+	LegacyParseText (jsonContent, u"\"regulation_name\"", record.name);
+	LegacyParseText (jsonContent, u"\"regulation_code\"", record.code);
+	record.rules[StairCore::RiserHeightRule] = LegacyParseRule (jsonContent, u"\"riser_height\"");
+	record.rules[StairCore::TreadDepthRule] = LegacyParseRule (jsonContent, u"\"tread_depth\"");
+	record.rules[StairCore::TwoRPlusGoingRule] = LegacyParseRule (jsonContent, u"\"two_r_plus_g\"");
+	record.rules[StairCore::LandingLengthRule] = LegacyParseRule (jsonContent, u"\"landing_length\"");
+	return record;
+}
+
+// ---------------------------------------------------------------------------
+// 合成规范库
+// ---------------------------------------------------------------------------
+
+struct Slice {
+	std::size_t	begin;
+	std::size_t	end;
+};
+
+void AppendRule (std::string& json, const char* key, const char* minValue, const char* maxValue, const char* fullText, bool last)
+{
+	json += "      \"";
+	json += key;
+	json += "\": {\n        \"min_value\": ";
+	json += minValue;
+	json += ",\n        \"max_value\": ";
+	json += maxValue;
+	json += ",\n        \"unit\": \"m\",\n        \"source\": \"GB 50016-2014 第6.4.5条\",\n        \"full_text\": \"";
+	json += fullText;
+	json += "\"\n      }";
+	json += last ? "\n" : ",\n";
+}
+
+// 每个规范包含四条规则和一个嵌套的 meta 对象，每十个规范中有一个的条文含转义引号
+std::string GenerateLibrary (std::size_t regulationCount, std::vector<Slice>& slices)
+{
+	std::string json = "{\n  \"regulations\": [\n";
+	char number[64];
+
+	for (std::size_t i = 0; i < regulationCount; ++i) {
+		const std::size_t begin = json.size () + 4;
+		json += "    {\n      \"regulation_name\": \"建筑设计防火规范 ";
+		std::snprintf (number, sizeof (number), "%zu", i + 1);
+		json += number;
+		json += "\",\n      \"regulation_code\": \"GB 50016-2014\",\n";
+		json += "      \"meta\": { \"jurisdiction\": \"CN\", \"building_types\": [\"residential\", \"public\"], \"revision\": { \"year\": 2018 } },\n";
+
+		std::snprintf (number, sizeof (number), "%.3f", 0.150 + static_cast<double> (i % 40) * 0.001);
+		AppendRule (json, "riser_height", "null", number, (i % 10 == 0) ? "楼梯踏步高度不宜大于\\\"0.175m\\\"。" : "楼梯踏步高度不宜大于0.175m。", false);
+		AppendRule (json, "tread_depth", "0.26", "null", "楼梯踏步宽度不应小于0.26m。", false);
+		AppendRule (json, "two_r_plus_g", "0.54", "0.62", "踏步应满足 2R+G 在 0.54m~0.62m 之间。", false);
+		AppendRule (json, "landing_length", "1.2", "null", "楼梯平台宽度不应小于梯段宽度，并不得小于1.20m。", true);
+
+		json += "    }";
+		slices.push_back ({ begin, json.size () });
+		json += (i + 1 < regulationCount) ? ",\n" : "\n";
+	}
+
+	json += "  ]\n}\n";
+	return json;
+}
+
+bool SameLimit (const std::optional<double>& a, const std::optional<double>& b)
+{
+	return a.has_value () == b.has_value () && (!a.has_value () || *a == *b);
+}
+
+bool SameRecord (const RegulationJson::RegulationRecord& a, const RegulationJson::RegulationRecord& b)
+{
+	if (a.name != b.name || a.code != b.code)
+		return false;
+	for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+		const RegulationJson::RuleRecord& ra = a.rules[kind];
+		const RegulationJson::RuleRecord& rb = b.rules[kind];
+		if (!SameLimit (ra.minValue, rb.minValue) || !SameLimit (ra.maxValue, rb.maxValue) || ra.fullText != rb.fullText || ra.source != rb.source)
+			return false;
+	}
+	return true;
+}
+
+void PrintRecord (const char* label, const RegulationJson::RegulationRecord& record)
+{
+	std::printf ("  %-6s name=\"%s\"\n", label, record.name.c_str ());
+	for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+		const RegulationJson::RuleRecord& rule = record.rules[kind];
+		std::printf ("         %-15s min=%-8s max=%-8s full_text=\"%s\"\n",
+			RegulationJson::GetRuleKey (static_cast<StairCore::RuleKind> (kind)),
+			rule.minValue.has_value () ? std::to_string (*rule.minValue).substr (0, 6).c_str () : "null",
+			rule.maxValue.has_value () ? std::to_string (*rule.maxValue).substr (0, 6).c_str () : "null",
+			rule.fullText.c_str ());
+	}
+}
+
+// 旧解析器在以下输入上出错：键名出现在条文中、转义引号、规则对象内嵌套对象
+void RunCorrectnessCases ()
+{
+	const char* tricky =
+		"{\n"
+		"  \"regulation_name\": \"住宅设计规范 \\\"2011版\\\"\",\n"
+		"  \"regulation_code\": \"GB 50096-2011\",\n"
+		"  \"notes\": \"本规范中 \\\"riser_height\\\" 指踏步高度\",\n"
+		"  \"riser_height\": { \"limits\": { \"note\": \"nested\" }, \"min_value\": null, \"max_value\": 0.175, \"full_text\": \"踏步高度不应大于0.175m\" },\n"
+		"  \"tread_depth\": { \"full_text\": \"宽度不应小于\\\"0.26m\\\"\", \"min_value\": 0.26, \"max_value\": null }\n"
+		"}\n";
+
+	const RegulationJson::RegulationRecord legacy = LegacyParse (tricky, std::strlen (tricky));
+
+	RegulationJson::Document document;
+	std::vector<RegulationJson::RegulationRecord> regulations;
+	const bool parsed = document.Parse (tricky, std::strlen (tricky)) && RegulationJson::ReadRegulations (document, regulations);
+
+	std::printf ("correctness: key inside text, escaped quotes, nested object\n");
+	PrintRecord ("legacy", legacy);
+	if (parsed)
+		PrintRecord ("new", regulations[0]);
+
+	const char* broken = "{\n  \"riser_height\": { \"max_value\": 0.175, }\n}\n";
+	if (!document.Parse (broken, std::strlen (broken))) {
+		const RegulationJson::ParseError& error = document.GetError ();
+		std::printf ("  error  line %zu, column %zu (offset %zu): %s\n\n", error.line, error.column, error.offset, error.message);
+	}
+}
+
+double ElapsedMs (std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+}
+
+void RunBenchmark (std::size_t regulationCount)
+{
+	std::vector<Slice> slices;
+	const std::string json = GenerateLibrary (regulationCount, slices);
+
+	// 新解析器：整个文件一次遍历
+	const auto newStart = std::chrono::steady_clock::now ();
+	RegulationJson::Document document;
+	std::vector<RegulationJson::RegulationRecord> regulations;
+	if (!document.Parse (json.data (), json.size ()) || !RegulationJson::ReadRegulations (document, regulations)) {
+		std::printf ("parse failed: %s\n", document.GetError ().message);
+		return;
+	}
+	const double newMs = ElapsedMs (newStart);
+
+	// 旧解析器：按规范切片后逐个解析（对旧解析器最有利的情况）
+	const auto legacyStart = std::chrono::steady_clock::now ();
+	std::vector<RegulationJson::RegulationRecord> legacy;
+	legacy.reserve (slices.size ());
+	for (const Slice& slice : slices)
+		legacy.push_back (LegacyParse (json.data () + slice.begin, slice.end - slice.begin));
+	const double legacyMs = ElapsedMs (legacyStart);
+
+	// 旧解析器直接读取整个文件：只能得到第一个规范
+	const auto wholeStart = std::chrono::steady_clock::now ();
+	const RegulationJson::RegulationRecord whole = LegacyParse (json.data (), json.size ());
+	const double wholeMs = ElapsedMs (wholeStart);
+
+	std::size_t mismatches = 0;
+	for (std::size_t i = 0; i < regulations.size () && i < legacy.size (); ++i) {
+		if (!SameRecord (regulations[i], legacy[i]))
+			++mismatches;
+	}
+
+	const double megabytes = static_cast<double> (json.size ()) / (1024.0 * 1024.0);
+	std::printf ("%6zu regulations, %8.2f MB | new %9.2f ms (%7.1f MB/s, %8zu nodes) | legacy per-regulation %9.2f ms (%7.1f MB/s) | legacy whole file %9.2f ms, 1 regulation (%s) | %zu/%zu records differ from legacy\n",
+		regulationCount, megabytes,
+		newMs, newMs > 0.0 ? megabytes * 1000.0 / newMs : 0.0, document.GetValueCount (),
+		legacyMs, legacyMs > 0.0 ? megabytes * 1000.0 / legacyMs : 0.0,
+		wholeMs, SameRecord (whole, regulations[0]) ? "= first" : "!= first", mismatches, regulations.size ());
+}
+
+// ---------------------------------------------------------------------------
+// 文件加载
+// ---------------------------------------------------------------------------
+
+const char* const kLoadBenchPath = "regulation_json_bench.tmp.json";
+
+// 旧读法：ReadBin(buffer, 4095) 循环，每块构造 UniString(buffer, CC_UTF8) 后 Append，
+// 再 ToCStr(CC_UTF8) 得到解析用的缓冲区。跨块的多字节字符会被拆开解码。
+bool LoadChunked (const char* path, std::string& utf8, std::size_t& chunkCount)
+{
+	std::FILE* file = std::fopen (path, "rb");
+	if (file == nullptr)
+		return false;
+
+	std::u16string content;
+	char buffer[4096];
+	std::size_t bytesRead = 0;
+	chunkCount = 0;
+	while ((bytesRead = std::fread (buffer, 1, sizeof (buffer) - 1, file)) > 0) {
+		buffer[bytesRead] = '\0';
+		content.append (Utf8ToUtf16 (buffer, std::strlen (buffer)));
+		++chunkCount;
+	}
+	std::fclose (file);
+
+	utf8 = Utf16ToUtf8 (content);
+	return true;
+}
+
+// 新读法：先取文件长度，一次分配、一次读取
+bool LoadSized (const char* path, std::vector<char>& bytes)
+{
+	std::FILE* file = std::fopen (path, "rb");
+	if (file == nullptr)
+		return false;
+
+	std::fseek (file, 0, SEEK_END);
+	const long length = std::ftell (file);
+	std::fseek (file, 0, SEEK_SET);
+	if (length < 0) {
+		std::fclose (file);
+		return false;
+	}
+
+	bytes.resize (static_cast<std::size_t> (length));
+	bytes.resize (std::fread (bytes.data (), 1, bytes.size (), file));
+	std::fclose (file);
+	return true;
+}
+
+std::size_t CountDifferentRecords (const std::vector<RegulationJson::RegulationRecord>& a, const std::vector<RegulationJson::RegulationRecord>& b)
+{
+	std::size_t count = a.size () > b.size () ? a.size () - b.size () : b.size () - a.size ();
+	for (std::size_t i = 0; i < a.size () && i < b.size (); ++i) {
+		if (!SameRecord (a[i], b[i]))
+			++count;
+	}
+	return count;
+}
+
+void RunLoadBenchmark (std::size_t targetMegabytes)
+{
+	// 先用少量规范估算单个规范的大小
+	std::vector<Slice> slices;
+	const std::size_t sampleCount = 100;
+	const std::size_t bytesPerRegulation = GenerateLibrary (sampleCount, slices).size () / sampleCount;
+	const std::size_t regulationCount = std::max<std::size_t> (1, targetMegabytes * 1024 * 1024 / bytesPerRegulation);
+
+	slices.clear ();
+	const std::string json = GenerateLibrary (regulationCount, slices);
+	std::FILE* out = std::fopen (kLoadBenchPath, "wb");
+	if (out == nullptr || std::fwrite (json.data (), 1, json.size (), out) != json.size ()) {
+		std::printf ("cannot write %s\n", kLoadBenchPath);
+		if (out != nullptr)
+			std::fclose (out);
+		return;
+	}
+	std::fclose (out);
+
+	const int repeatCount = 3;
+	double chunkedLoadMs = 0.0, chunkedTotalMs = 0.0, sizedLoadMs = 0.0, sizedTotalMs = 0.0;
+	std::size_t chunkCount = 0;
+	bool chunkedParsed = false, chunkedIdentical = false;
+	std::vector<RegulationJson::RegulationRecord> chunkedRegulations;
+	std::vector<RegulationJson::RegulationRecord> sizedRegulations;
+
+	for (int repeat = 0; repeat < repeatCount; ++repeat) {
+		// 旧读法
+		{
+			const auto start = std::chrono::steady_clock::now ();
+			std::string utf8;
+			LoadChunked (kLoadBenchPath, utf8, chunkCount);
+			const double loadMs = ElapsedMs (start);
+
+			RegulationJson::Document document;
+			chunkedRegulations.clear ();
+			chunkedParsed = document.Parse (utf8.c_str (), std::strlen (utf8.c_str ())) && RegulationJson::ReadRegulations (document, chunkedRegulations);
+			const double totalMs = ElapsedMs (start);
+
+			chunkedIdentical = (utf8 == json);
+			if (repeat == 0 || totalMs < chunkedTotalMs) {
+				chunkedLoadMs = loadMs;
+				chunkedTotalMs = totalMs;
+			}
+		}
+
+		// 新读法
+		{
+			const auto start = std::chrono::steady_clock::now ();
+			std::vector<char> bytes;
+			LoadSized (kLoadBenchPath, bytes);
+			const double loadMs = ElapsedMs (start);
+
+			RegulationJson::Document document;
+			sizedRegulations.clear ();
+			if (!document.Parse (bytes.data (), bytes.size ()) || !RegulationJson::ReadRegulations (document, sizedRegulations)) {
+				std::printf ("parse failed: %s\n", document.GetError ().message);
+				std::remove (kLoadBenchPath);
+				return;
+			}
+			const double totalMs = ElapsedMs (start);
+
+			if (repeat == 0 || totalMs < sizedTotalMs) {
+				sizedLoadMs = loadMs;
+				sizedTotalMs = totalMs;
+			}
+		}
+	}
+
+	std::remove (kLoadBenchPath);
+
+	const double megabytes = static_cast<double> (json.size ()) / (1024.0 * 1024.0);
+	std::printf ("%7.2f MB, %6zu regulations | chunked (%6zu reads) load %8.2f ms, load+parse %8.2f ms | sized load %7.2f ms, load+parse %8.2f ms (%5.2fx) | chunked text %s, ",
+		megabytes, regulationCount, chunkCount,
+		chunkedLoadMs, chunkedTotalMs, sizedLoadMs, sizedTotalMs,
+		sizedTotalMs > 0.0 ? chunkedTotalMs / sizedTotalMs : 0.0,
+		chunkedIdentical ? "intact" : "corrupted at chunk boundaries");
+	if (chunkedParsed)
+		std::printf ("%zu/%zu records differ\n", CountDifferentRecords (chunkedRegulations, sizedRegulations), sizedRegulations.size ());
+	else
+		std::printf ("chunked parse failed\n");
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+	std::vector<std::size_t> counts;
+	std::vector<std::size_t> loadSizes;
+	bool load = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp (argv[i], "--regulations") == 0 && i + 1 < argc)
+			counts.push_back (static_cast<std::size_t> (std::strtoull (argv[++i], nullptr, 10)));
+		else if (std::strcmp (argv[i], "--load-mb") == 0 && i + 1 < argc)
+			loadSizes.push_back (static_cast<std::size_t> (std::strtoull (argv[++i], nullptr, 10)));
+		else if (std::strcmp (argv[i], "--load") == 0)
+			load = true;
+	}
+
+	if (load || !loadSizes.empty ()) {
+		if (loadSizes.empty ())
+			loadSizes = { 1, 5, 10, 25, 50 };
+		for (std::size_t megabytes : loadSizes)
+			RunLoadBenchmark (megabytes);
+		return 0;
+	}
+
+	if (counts.empty ())
+		counts = { 1, 100, 1000, 10000 };
+
+	RunCorrectnessCases ();
+
+	for (std::size_t count : counts)
+		RunBenchmark (count);
+
+	return 0;
+}
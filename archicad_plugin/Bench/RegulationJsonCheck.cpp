@@ -0,0 +1,272 @@
+// 规范JSON解析器的检查：出错位置（字节偏移、行、列）、字符串转义解码和数字的边界情况（无需ArchiCAD）
+//
+//   g++ -std=c++17 -O2 -Wall -Wextra -ISrc Bench/RegulationJsonCheck.cpp Src/RegulationJson.cpp -o regulation_json_check
+//
+//   ./regulation_json_check      逐项输出失败的检查，全部通过时返回0
+//
+// 每个输入都复制到恰好等长的缓冲区后解析（末尾没有'\0'），
+// 以便越界读取能被 -fsanitize=address 发现。
+
+#include "RegulationJson.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::size_t g_checkCount = 0;
+std::size_t g_failureCount = 0;
+
+void Check (bool condition, const std::string& input, const char* what)
+{
+	++g_checkCount;
+	if (!condition) {
+		++g_failureCount;
+		std::printf ("FAIL %-40s | input: %s\n", what, input.c_str ());
+	}
+}
+
+// 输入复制到等长缓冲区后解析；Document引用缓冲区中的字符串，两者须一起保持有效
+struct ParsedInput {
+	std::vector<char>			buffer;
+	RegulationJson::Document	document;
+	bool						parsed = false;
+
+	explicit ParsedInput (const std::string& input) :
+		buffer (input.begin (), input.end ())
+	{
+		parsed = document.Parse (buffer.data (), buffer.size ());
+	}
+};
+
+// ---------------------------------------------------------------------------
+// 出错位置
+// ---------------------------------------------------------------------------
+
+void CheckError (const std::string& input, std::size_t offset, std::size_t line, std::size_t column, const char* message)
+{
+	const ParsedInput parsed (input);
+	const RegulationJson::ParseError& error = parsed.document.GetError ();
+	Check (!parsed.parsed, input, "rejected");
+	Check (parsed.document.GetRoot () == nullptr, input, "no root after failure");
+	Check (error.offset == offset, input, "error offset");
+	Check (error.line == line, input, "error line");
+	Check (error.column == column, input, "error column");
+	Check (error.message != nullptr && std::strcmp (error.message, message) == 0, input, "error message");
+	if (error.offset != offset || error.line != line || error.column != column)
+		std::printf ("     got offset %zu line %zu column %zu (%s)\n", error.offset, error.line, error.column, error.message != nullptr ? error.message : "");
+}
+
+void CheckMalformed ()
+{
+	CheckError ("", 0, 1, 1, "文档为空");
+	CheckError (" \n\t", 3, 2, 2, "文档为空");
+	CheckError ("{} x", 3, 1, 4, "文档末尾有多余内容");
+	CheckError ("[1,\n  2,\n  ]", 11, 3, 3, "无效的值");
+	CheckError ("{\"a\": 1,\n  \"b\" 2}", 15, 2, 7, "对象键后应为 ':'");
+	CheckError ("{\"a\": 1\n\"b\": 2}", 8, 2, 1, "对象成员后应为 ',' 或 '}'");
+	CheckError ("{1: 2}", 1, 1, 2, "应为对象键（字符串）");
+	CheckError ("[1 2]", 3, 1, 4, "数组元素后应为 ',' 或 ']'");
+	CheckError ("[tru]", 1, 1, 2, "无效的字面量");
+	CheckError ("{\"a\":", 5, 1, 6, "缺少值");
+
+	// 字符串：未结束时指向开头的引号，控制字符和转义错误指向出错处
+	CheckError ("[\"abc", 1, 1, 2, "字符串缺少结束引号");
+	CheckError ("[\"a\\n", 1, 1, 2, "字符串缺少结束引号");
+	CheckError ("[\"a\\", 1, 1, 2, "字符串缺少结束引号");
+	CheckError ("[1,\n2,\n\"x\ty\"]", 9, 3, 3, "字符串中不能包含控制字符");
+	CheckError ("\"a\\n\x01\"", 4, 1, 5, "字符串中不能包含控制字符");
+	CheckError ("\"a\\qb\"", 2, 1, 3, "无效的转义字符");
+	CheckError ("\"\\u12G4\"", 5, 1, 6, "\\u 后应为4位十六进制数");
+	CheckError ("\"\\u12", 3, 1, 4, "\\u 后应为4位十六进制数");
+	CheckError ("\"\\uDC00\"", 1, 1, 2, "无效的Unicode代理对");
+	CheckError ("\"\\uD83Dx\"", 1, 1, 2, "无效的Unicode代理对");
+	CheckError ("\"\\uD83D\\u0041\"", 1, 1, 2, "无效的Unicode代理对");
+
+	// 行号按'\n'计算，列按字节计算（多字节的UTF-8字符占多列，'\r'也占一列）
+	CheckError ("{\r\n\"名\": x}", 10, 2, 8, "无效的值");
+
+	// 嵌套层数
+	CheckError (std::string (200, '['), 129, 1, 130, "嵌套层数过深");
+	{
+		const std::string nested = std::string (128, '[') + std::string (128, ']');
+		const ParsedInput parsed (nested);
+		Check (parsed.parsed, "128 x [", "128 levels accepted");
+	}
+
+	// UTF-8 BOM被跳过，但仍计入偏移和列
+	{
+		const ParsedInput parsed ("\xEF\xBB\xBF{}");
+		Check (parsed.parsed && parsed.document.GetRoot ()->IsObject (), "BOM {}", "BOM skipped");
+	}
+	CheckError ("\xEF\xBB\xBF", 3, 1, 4, "文档为空");
+
+	// 同一Document重复使用时清除上次的错误
+	{
+		ParsedInput parsed ("[");
+		const std::string valid = "[1]";
+		parsed.buffer.assign (valid.begin (), valid.end ());
+		const bool reparsed = parsed.document.Parse (parsed.buffer.data (), parsed.buffer.size ());
+		Check (reparsed && parsed.document.GetError ().message == nullptr, valid, "error cleared on reuse");
+	}
+}
+
+// ---------------------------------------------------------------------------
+// 转义解码
+// ---------------------------------------------------------------------------
+
+void CheckString (const std::string& input, const std::string& expected)
+{
+	const ParsedInput parsed (input);
+	const RegulationJson::Value* root = parsed.document.GetRoot ();
+	Check (parsed.parsed && root != nullptr && root->IsString (), input, "parsed as string");
+	if (root != nullptr && root->IsString ())
+		Check (root->string == expected, input, "decoded text");
+}
+
+void CheckEscapes ()
+{
+	CheckString ("\"plain\"", "plain");
+	CheckString ("\"\"", "");
+	CheckString ("\"a\\\"b\\\\c\\/d\"", "a\"b\\c/d");
+	CheckString ("\"\\b\\f\\n\\r\\t\"", "\b\f\n\r\t");
+	CheckString ("\"\\u0041\\u00e9\\u00E9\"", "A\xC3\xA9\xC3\xA9");
+	CheckString ("\"\\u4e2d\\u6587\"", "中文");
+	CheckString ("\"\\uD83D\\uDE00\"", "\xF0\x9F\x98\x80");
+	CheckString ("\"\\uDBFF\\uDFFF\"", "\xF4\x8F\xBF\xBF");
+	CheckString ("\"\\u0000\"", std::string (1, '\0'));
+	CheckString ("\"\\u07FF\\u0800\\uFFFF\"", "\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF");
+	CheckString ("\"踏步高度\\n6.3.2\"", "踏步高度\n6.3.2");
+
+	// 不含转义的字符串直接引用源缓冲区
+	{
+		const ParsedInput parsed ("\"GB 50096\"");
+		const RegulationJson::Value* root = parsed.document.GetRoot ();
+		const char* first = parsed.buffer.data ();
+		Check (root != nullptr && root->string.data () == first + 1, "\"GB 50096\"", "unescaped string points into source");
+	}
+
+	// 含转义的字符串解码到Document中；后面的字符串不会使前面已解码的字符串失效
+	{
+		std::string input = "{";
+		for (int i = 0; i < 1000; ++i) {
+			if (i > 0)
+				input += ",";
+			input += "\"k\\u00e9" + std::to_string (i) + "\": \"v\\t" + std::to_string (i) + "\"";
+		}
+		input += "}";
+
+		const ParsedInput parsed (input);
+		const RegulationJson::Value* root = parsed.document.GetRoot ();
+		Check (parsed.parsed && root != nullptr && root->childCount == 1000, "1000 escaped members", "parsed");
+		if (root != nullptr && root->childCount == 1000) {
+			int index = 0;
+			bool allMatch = true;
+			for (const RegulationJson::Value* member = parsed.document.GetFirstChild (*root); member != nullptr; member = parsed.document.GetNextSibling (*member), ++index) {
+				allMatch = allMatch && member->key == "k\xC3\xA9" + std::to_string (index);
+				allMatch = allMatch && member->string == "v\t" + std::to_string (index);
+			}
+			Check (allMatch && index == 1000, "1000 escaped members", "decoded keys and values stay valid");
+
+			const RegulationJson::Value* found = parsed.document.FindMember (*root, "k\xC3\xA9" "999");
+			Check (found != nullptr && found->string == "v\t999", "1000 escaped members", "FindMember with decoded key");
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+// 数字
+// ---------------------------------------------------------------------------
+
+bool ParseNumber (const std::string& input, double& number)
+{
+	const ParsedInput parsed (input);
+	const RegulationJson::Value* root = parsed.document.GetRoot ();
+	if (!parsed.parsed || root == nullptr || !root->IsNumber ())
+		return false;
+	number = root->number;
+	return true;
+}
+
+void CheckNumber (const std::string& input, double expected)
+{
+	double number = 0.0;
+	const bool parsed = ParseNumber (input, number);
+	Check (parsed, input, "parsed as number");
+	if (parsed && number != expected)
+		std::printf ("     got %.17g, expected %.17g\n", number, expected);
+	Check (parsed && number == expected, input, "exact value");
+}
+
+void CheckNumbers ()
+{
+	CheckNumber ("0", 0.0);
+	CheckNumber ("7", 7.0);
+	CheckNumber ("-12", -12.0);
+	CheckNumber ("0.175", 0.175);
+	CheckNumber ("1.5E+2", 150.0);
+	CheckNumber ("25e-2", 0.25);
+	CheckNumber ("1e0", 1.0);
+	CheckNumber ("0.1", 0.1);
+	CheckNumber ("0.30000000000000004", 0.30000000000000004);
+	CheckNumber ("12345678901234567890", 12345678901234567890.0);
+	CheckNumber ("9007199254740993", 9007199254740992.0);		// 2^53 + 1 就近舍入为偶数
+	CheckNumber ("1.7976931348623157e308", std::numeric_limits<double>::max ());
+	CheckNumber ("2.2250738585072014e-308", std::numeric_limits<double>::min ());
+	CheckNumber ("4.9406564584124654e-324", std::numeric_limits<double>::denorm_min ());
+	CheckNumber ("   42   ", 42.0);
+
+	// -0 保留符号
+	{
+		double number = 1.0;
+		const bool parsed = ParseNumber ("-0", number);
+		Check (parsed && number == 0.0 && std::signbit (number), "-0", "negative zero");
+	}
+
+	// 数组中的数字在 ',' 和 ']' 处结束，不把后面的字符交给from_chars
+	{
+		const ParsedInput parsed ("[1,-2.5,3e2]");
+		const RegulationJson::Value* root = parsed.document.GetRoot ();
+		bool matches = parsed.parsed && root != nullptr && root->childCount == 3;
+		const double expected[] = { 1.0, -2.5, 300.0 };
+		int index = 0;
+		for (const RegulationJson::Value* item = matches ? parsed.document.GetFirstChild (*root) : nullptr; item != nullptr; item = parsed.document.GetNextSibling (*item), ++index)
+			matches = matches && item->IsNumber () && item->number == expected[index];
+		Check (matches, "[1,-2.5,3e2]", "numbers in array");
+	}
+
+	// JSON语法不允许的写法
+	CheckError ("-", 1, 1, 2, "无效的数字");
+	CheckError ("-a", 1, 1, 2, "无效的数字");
+	CheckError ("+1", 0, 1, 1, "无效的值");
+	CheckError (".5", 0, 1, 1, "无效的值");
+	CheckError ("01", 1, 1, 2, "文档末尾有多余内容");
+	CheckError ("1.", 2, 1, 3, "小数点后缺少数字");
+	CheckError ("1.e5", 2, 1, 3, "小数点后缺少数字");
+	CheckError ("1e", 2, 1, 3, "指数缺少数字");
+	CheckError ("1e+", 3, 1, 4, "指数缺少数字");
+	CheckError ("[0x10]", 2, 1, 3, "数组元素后应为 ',' 或 ']'");
+	CheckError ("NaN", 0, 1, 1, "无效的值");
+	CheckError ("[Infinity]", 1, 1, 2, "无效的值");
+
+	// 超出double范围时报告数字的起始位置
+	CheckError ("{\"max\": 1e309}", 8, 1, 9, "数值超出范围");
+	CheckError ("[-1e400]", 1, 1, 2, "数值超出范围");
+}
+
+} // namespace
+
+int main ()
+{
+	CheckMalformed ();
+	CheckEscapes ();
+	CheckNumbers ();
+
+	std::printf ("%zu checks, %zu failures\n", g_checkCount, g_failureCount);
+	return g_failureCount == 0 ? 0 : 1;
+}
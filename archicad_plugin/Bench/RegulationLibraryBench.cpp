@@ -0,0 +1,396 @@
+// 多规范规则库基准：合并耗时、内存占用、每个楼梯的规则查找、启动时JSON与二进制缓存的加载耗时（无需ArchiCAD）
+//
+//   g++ -std=c++17 -O2 -ISrc Bench/RegulationLibraryBench.cpp Src/RegulationLibrary.cpp Src/RegulationCache.cpp Src/RegulationJson.cpp Src/StairEvaluationCore.cpp Src/StairRuleProgram.cpp Src/StairWorkPool.cpp Src/StairTrace.cpp Src/StairTreadGeometry.cpp Src/StairWalkingLine.cpp -pthread -o regulation_library_bench
+//
+//   ./regulation_library_bench                     依次测试 10 / 100 / 1000 / 5000 个规范
+//   ./regulation_library_bench --regulations 2000  只测试指定数量
+//
+// 合成规范分布在 全国 / 31个省 / 每省10个市 三级地区和16种建筑类型上，每个规范4条规则。
+// 查找对比：规则库预先合并的 Resolve 与逐个楼梯遍历所有规范筛选适用规则的做法。
+// 启动对比：解析JSON并合并 与 校验并读取二进制缓存（均从内存中的文件内容开始计时）。
+// 缓存丢失：每个规范一个文件写入临时规范目录，按目录顺序重新合并，须与按上传顺序合并的规范库相同。
+
+#include "RegulationCache.hpp"
+#include "RegulationLibrary.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kProvinceCount = 31;
+const int kCitiesPerProvince = 10;
+const int kBuildingTypeCount = 16;
+
+std::string JurisdictionName (int province, int city)
+{
+	std::string name = "CN";
+	if (province >= 0) {
+		name += "-P" + std::to_string (province);
+		if (city >= 0)
+			name += "-C" + std::to_string (city);
+	}
+	return name;
+}
+
+std::vector<RegulationJson::RegulationRecord> GenerateRecords (std::size_t regulationCount, std::mt19937& random)
+{
+	std::vector<RegulationJson::RegulationRecord> records (regulationCount);
+	for (std::size_t i = 0; i < regulationCount; ++i) {
+		RegulationJson::RegulationRecord& record = records[i];
+		record.name = "规范 " + std::to_string (i + 1);
+		record.code = "GB " + std::to_string (50000 + i);
+
+		// 约1/10为全国规范，3/10为省级，其余为市级
+		const unsigned int level = static_cast<unsigned int> (random () % 10);
+		const int province = static_cast<int> (random () % kProvinceCount);
+		const int city = static_cast<int> (random () % kCitiesPerProvince);
+		record.jurisdiction = JurisdictionName (level == 0 ? -1 : province, level < 4 ? -1 : city);
+
+		// 一半规范限定1～3种建筑类型
+		if (random () % 2 == 0) {
+			const unsigned int typeCount = static_cast<unsigned int> (1 + random () % 3);
+			for (unsigned int t = 0; t < typeCount; ++t)
+				record.buildingTypes.push_back ("type" + std::to_string (random () % kBuildingTypeCount));
+		}
+
+		const double jitter = static_cast<double> (random () % 20) * 0.001;
+		record.rules[StairCore::RiserHeightRule].maxValue = 0.165 + jitter;
+		record.rules[StairCore::TreadDepthRule].minValue = 0.25 + jitter;
+		record.rules[StairCore::LandingLengthRule].minValue = 1.1 + jitter;
+		record.rules[StairCore::TwoRPlusGoingRule].minValue = 0.54;
+		record.rules[StairCore::TwoRPlusGoingRule].maxValue = 0.62 + jitter;
+		for (RegulationJson::RuleRecord& rule : record.rules) {
+			rule.source = record.code + " 第6.4.5条";
+			rule.fullText = "楼梯踏步应满足 " + record.code + " 的要求。";
+		}
+	}
+	return records;
+}
+
+void AppendJsonString (std::string& json, const std::string& text)
+{
+	json += '"';
+	for (char c : text) {
+		if (c == '"' || c == '\\')
+			json += '\\';
+		json += c;
+	}
+	json += '"';
+}
+
+// 生成与提取工具输出格式相同的多规范JSON
+std::string ToJson (const std::vector<RegulationJson::RegulationRecord>& records)
+{
+	std::string json = "{\"regulations\": [\n";
+	char number[64];
+	for (std::size_t i = 0; i < records.size (); ++i) {
+		const RegulationJson::RegulationRecord& record = records[i];
+		json += "{\"regulation_name\": ";
+		AppendJsonString (json, record.name);
+		json += ", \"regulation_code\": ";
+		AppendJsonString (json, record.code);
+		json += ", \"jurisdiction\": ";
+		AppendJsonString (json, record.jurisdiction);
+		json += ", \"building_types\": [";
+		for (std::size_t t = 0; t < record.buildingTypes.size (); ++t) {
+			if (t > 0)
+				json += ", ";
+			AppendJsonString (json, record.buildingTypes[t]);
+		}
+		json += "], \"rules\": {";
+		for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+			const RegulationJson::RuleRecord& rule = record.rules[kind];
+			if (kind > 0)
+				json += ", ";
+			json += '"';
+			json += RegulationJson::GetRuleKey (static_cast<StairCore::RuleKind> (kind));
+			json += "\": {";
+			if (rule.minValue.has_value ()) {
+				std::snprintf (number, sizeof (number), "\"min_value\": %.17g, ", *rule.minValue);
+				json += number;
+			}
+			if (rule.maxValue.has_value ()) {
+				std::snprintf (number, sizeof (number), "\"max_value\": %.17g, ", *rule.maxValue);
+				json += number;
+			}
+			json += "\"unit\": \"m\", \"source\": ";
+			AppendJsonString (json, rule.source);
+			json += ", \"full_text\": ";
+			AppendJsonString (json, rule.fullText);
+			json += '}';
+		}
+		json += i + 1 < records.size () ? "}},\n" : "}}\n";
+	}
+	json += "]}\n";
+	return json;
+}
+
+struct ContextName {
+	std::string	jurisdiction;
+	std::string	buildingType;
+};
+
+// 逐个楼梯遍历所有规范：地区为本级或上级、建筑类型匹配时收紧限值
+StairCore::RuleSet ResolveByScan (const std::vector<RegulationJson::RegulationRecord>& records, const ContextName& context)
+{
+	StairCore::RuleSet ruleSet;
+	for (const RegulationJson::RegulationRecord& record : records) {
+		const std::string& jurisdiction = record.jurisdiction;
+		const bool jurisdictionMatches = jurisdiction.empty () || context.jurisdiction == jurisdiction ||
+			(context.jurisdiction.compare (0, jurisdiction.size (), jurisdiction) == 0 && context.jurisdiction.size () > jurisdiction.size () && context.jurisdiction[jurisdiction.size ()] == '-');
+		if (!jurisdictionMatches)
+			continue;
+
+		bool typeMatches = record.buildingTypes.empty ();
+		for (const std::string& type : record.buildingTypes)
+			typeMatches = typeMatches || type == context.buildingType;
+		if (!typeMatches)
+			continue;
+
+		for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+			const RegulationJson::RuleRecord& rule = record.rules[kind];
+			StairCore::RuleLimits& target = ruleSet.rules[kind];
+			if (rule.minValue.has_value () && (!target.minValue.has_value () || *rule.minValue > *target.minValue))
+				target.minValue = rule.minValue;
+			if (rule.maxValue.has_value () && (!target.maxValue.has_value () || *rule.maxValue < *target.maxValue))
+				target.maxValue = rule.maxValue;
+		}
+	}
+	return ruleSet;
+}
+
+bool SameLimits (const StairCore::RuleSet& a, const StairCore::RuleSet& b)
+{
+	for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+		if (a.rules[kind].minValue != b.rules[kind].minValue || a.rules[kind].maxValue != b.rules[kind].maxValue)
+			return false;
+	}
+	return true;
+}
+
+double ElapsedMs (std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+}
+
+void RunBenchmark (std::size_t regulationCount)
+{
+	std::mt19937 random (static_cast<unsigned int> (regulationCount));
+	const std::vector<RegulationJson::RegulationRecord> records = GenerateRecords (regulationCount, random);
+
+	const auto mergeStart = std::chrono::steady_clock::now ();
+	StairCore::RegulationLibrary library;
+	library.Merge (records);
+	const double mergeMs = ElapsedMs (mergeStart);
+
+	// 楼梯随机分布在各市和建筑类型上
+	const std::size_t stairCount = 100000;
+	std::vector<ContextName> names (stairCount);
+	std::vector<StairCore::RuleContext> contexts (stairCount);
+	for (std::size_t i = 0; i < stairCount; ++i) {
+		names[i].jurisdiction = JurisdictionName (static_cast<int> (random () % kProvinceCount), static_cast<int> (random () % kCitiesPerProvince));
+		names[i].buildingType = "type" + std::to_string (random () % kBuildingTypeCount);
+		contexts[i] = library.MakeContext (names[i].jurisdiction, names[i].buildingType);
+	}
+
+	const auto resolveStart = std::chrono::steady_clock::now ();
+	double checksum = 0.0;
+	for (const StairCore::RuleContext& context : contexts)
+		checksum += library.Resolve (context).ruleSet.rules[StairCore::TreadDepthRule].minValue.value_or (0.0);
+	const double resolveMs = ElapsedMs (resolveStart);
+
+	// 逐个遍历的做法太慢，只抽取前1000个楼梯计时并按比例折算
+	const std::size_t scanCount = 1000;
+	std::size_t mismatches = 0;
+	const auto scanStart = std::chrono::steady_clock::now ();
+	for (std::size_t i = 0; i < scanCount; ++i) {
+		const StairCore::RuleSet scanned = ResolveByScan (records, names[i]);
+		if (!SameLimits (scanned, library.Resolve (contexts[i]).ruleSet))
+			++mismatches;
+	}
+	const double scanMs = ElapsedMs (scanStart) * static_cast<double> (stairCount) / static_cast<double> (scanCount);
+
+	std::printf ("%5zu regulations, %5zu rules | merge %8.2f ms | %4zu jurisdictions x %2zu types -> %5zu distinct rule sets | %8.1f KB (%5.1f B/rule) | "
+		"resolve %6.2f ms / %zu stairs (%5.1f ns) | scan ~%9.2f ms (%8.1f ns) | %zu/%zu mismatches (checksum %.1f)\n",
+		library.GetRegulationCount (), library.GetRuleCount (), mergeMs,
+		library.GetJurisdictionCount (), library.GetBuildingTypeCount (), library.GetResolvedCount (),
+		static_cast<double> (library.GetMemoryUsage ()) / 1024.0,
+		library.GetRuleCount () > 0 ? static_cast<double> (library.GetMemoryUsage ()) / static_cast<double> (library.GetRuleCount ()) : 0.0,
+		resolveMs, stairCount, resolveMs * 1e6 / static_cast<double> (stairCount),
+		scanMs, scanMs * 1e6 / static_cast<double> (stairCount),
+		mismatches, scanCount, checksum);
+
+	// 启动加载：JSON解析+合并 与 二进制缓存读取，缓存恢复的规范库须与原规范库一致
+	const std::string json = ToJson (records);
+	const int repeat = regulationCount <= 100 ? 200 : 5;
+
+	const auto jsonStart = std::chrono::steady_clock::now ();
+	for (int r = 0; r < repeat; ++r) {
+		RegulationJson::Document document;
+		std::vector<RegulationJson::RegulationRecord> parsed;
+		if (!document.Parse (json.data (), json.size ()) || !RegulationJson::ReadRegulations (document, parsed)) {
+			std::printf ("JSON parse failed: %s\n", document.GetError ().message);
+			return;
+		}
+		StairCore::RegulationLibrary fromJson;
+		fromJson.Merge (parsed);
+	}
+	const double jsonMs = ElapsedMs (jsonStart) / repeat;
+
+	StairCore::SourceStamp stamp;
+	stamp.size = json.size ();
+	stamp.contentHash = StairCore::HashContent (json.data (), json.size ());
+	const std::uint64_t folderStamp = 0x5eedf01d;
+	std::vector<char> cache;
+	StairCore::WriteRegulationCache (library, stamp, folderStamp, cache);
+
+	StairCore::RegulationLibrary fromCache;
+	StairCore::SourceStamp cachedStamp;
+	std::uint64_t cachedFolderStamp = 0;
+	StairCore::CacheStatus status = StairCore::CacheStatus::Loaded;
+	const auto cacheStart = std::chrono::steady_clock::now ();
+	for (int r = 0; r < repeat; ++r)
+		status = StairCore::ReadRegulationCache (cache.data (), cache.size (), fromCache, cachedStamp, cachedFolderStamp);
+	const double cacheMs = ElapsedMs (cacheStart) / repeat;
+
+	std::size_t cacheMismatches = 0;
+	if (status != StairCore::CacheStatus::Loaded || fromCache.GetFingerprint () != library.GetFingerprint () || cachedStamp.contentHash != stamp.contentHash ||
+		cachedFolderStamp != folderStamp) {
+		cacheMismatches = stairCount;
+	} else {
+		for (std::size_t i = 0; i < stairCount; ++i) {
+			const StairCore::RuleContext context = fromCache.MakeContext (names[i].jurisdiction, names[i].buildingType);
+			if (!SameLimits (fromCache.Resolve (context).ruleSet, library.Resolve (contexts[i]).ruleSet))
+				++cacheMismatches;
+		}
+	}
+
+	// 缓存被破坏时必须被拒绝
+	cache[cache.size () / 2] ^= 0x5A;
+	const bool corruptRejected = StairCore::ReadRegulationCache (cache.data (), cache.size (), fromCache, cachedStamp, cachedFolderStamp) != StairCore::CacheStatus::Loaded;
+
+	// 校验和正确但内容无效（截断）的数据被拒绝，且不改变原来启用的规则类别
+	std::vector<char> payload;
+	library.Serialize (payload);
+	const std::uint32_t otherMask = library.GetEnabledRules () ^ (1u << StairCore::RiserHeightRule);
+	StairCore::RegulationLibrary truncated;
+	truncated.SetEnabledRules (otherMask);
+	const bool invalidRejected = !truncated.Deserialize (payload.data (), payload.size () / 2) && truncated.GetEnabledRules () == otherMask &&
+		truncated.GetRegulationCount () == 0;
+
+	std::printf ("%5zu regulations | JSON %8.1f KB parse+merge %9.3f ms | cache %8.1f KB load %9.3f ms (%6.1fx, %s) | %zu/%zu mismatches | corrupt cache %s, invalid payload %s\n",
+		library.GetRegulationCount (),
+		static_cast<double> (json.size ()) / 1024.0, jsonMs,
+		static_cast<double> (cache.size ()) / 1024.0, cacheMs, cacheMs > 0.0 ? jsonMs / cacheMs : 0.0,
+		StairCore::GetCacheStatusText (status), cacheMismatches, stairCount,
+		corruptRejected ? "rejected" : "ACCEPTED", invalidRejected ? "rejected, rule mask kept" : "ACCEPTED OR RULE MASK CHANGED");
+}
+
+// 缓存丢失后的恢复：每个上传的规范写入临时规范目录的单独文件（其中一部规范先后上传了两个版本），
+// 按ListRegulationFolder的顺序重新合并的规范库须与按上传顺序合并的规范库相同；
+// 目录标记在文件未变化时不变，删除一个文件后改变
+void RunFolderRebuildCheck (std::size_t regulationCount)
+{
+	namespace fs = std::filesystem;
+
+	std::mt19937 random (42);
+	std::vector<RegulationJson::RegulationRecord> records = GenerateRecords (regulationCount, random);
+	RegulationJson::RegulationRecord revised = records[0];
+	revised.rules[StairCore::RiserHeightRule].maxValue = 0.15;
+	records.push_back (revised);
+
+	const fs::path folder = fs::temp_directory_path () / "regulation_folder_check";
+	std::error_code error;
+	fs::remove_all (folder, error);
+	fs::create_directories (folder);
+
+	// 统一的规范JSON含一部与上传规范相同的规范，插件中先于上传的规范合并，被上传的规范覆盖
+	RegulationJson::RegulationRecord legacy = records[1];
+	legacy.rules[StairCore::RiserHeightRule].maxValue = 0.20;
+	const std::vector<RegulationJson::RegulationRecord> legacyRecords (1, legacy);
+
+	// 上传顺序与文件名顺序相反，修改时间按上传顺序递增
+	StairCore::RegulationLibrary uploaded;
+	uploaded.Merge (legacyRecords);
+	const fs::file_time_type baseTime = fs::file_time_type::clock::now () - std::chrono::hours (1);
+	for (std::size_t i = 0; i < records.size (); ++i) {
+		const std::vector<RegulationJson::RegulationRecord> single (1, records[i]);
+		const fs::path path = folder / ("upload_" + std::to_string (records.size () - i) + ".json");
+		const std::string json = ToJson (single);
+		std::FILE* file = std::fopen (path.string ().c_str (), "wb");
+		if (file == nullptr) {
+			std::printf ("cannot write %s\n", path.string ().c_str ());
+			return;
+		}
+		std::fwrite (json.data (), 1, json.size (), file);
+		std::fclose (file);
+		fs::last_write_time (path, baseTime + std::chrono::seconds (i));
+		uploaded.Merge (single);
+	}
+
+	const auto rebuildStart = std::chrono::steady_clock::now ();
+	std::vector<StairCore::RegulationFolderEntry> entries;
+	StairCore::ListRegulationFolder (folder, entries);
+	std::vector<std::vector<RegulationJson::RegulationRecord>> batches (1, legacyRecords);
+	std::size_t unreadable = 0;
+	for (const StairCore::RegulationFolderEntry& entry : entries) {
+		std::vector<char> bytes (static_cast<std::size_t> (entry.size));
+		std::FILE* file = std::fopen (entry.path.string ().c_str (), "rb");
+		const bool read = file != nullptr && std::fread (bytes.data (), 1, bytes.size (), file) == bytes.size ();
+		if (file != nullptr)
+			std::fclose (file);
+
+		RegulationJson::Document document;
+		std::vector<RegulationJson::RegulationRecord> parsed;
+		if (!read || !document.Parse (bytes.data (), bytes.size ()) || !RegulationJson::ReadRegulations (document, parsed)) {
+			++unreadable;
+			continue;
+		}
+		batches.push_back (std::move (parsed));
+	}
+	StairCore::RegulationLibrary rebuilt;
+	rebuilt.Merge (batches);
+	const double rebuildMs = ElapsedMs (rebuildStart);
+
+	const std::uint64_t folderStamp = StairCore::HashRegulationFolder (entries);
+	StairCore::ListRegulationFolder (folder, entries);
+	const bool stableStamp = StairCore::HashRegulationFolder (entries) == folderStamp;
+	fs::remove (entries.front ().path);
+	StairCore::ListRegulationFolder (folder, entries);
+	const bool changedStamp = StairCore::HashRegulationFolder (entries) != folderStamp;
+	fs::remove_all (folder, error);
+
+	const bool identical = unreadable == 0 && rebuilt.GetFingerprint () == uploaded.GetFingerprint () &&
+		rebuilt.GetRegulationCount () == regulationCount;
+	std::printf ("%5zu regulation files | rebuild after cache loss %9.3f ms | %s | folder stamp %s, %s after delete\n",
+		records.size (), rebuildMs, identical ? "identical to incremental merge" : "MISMATCH",
+		stableStamp ? "stable" : "UNSTABLE", changedStamp ? "changed" : "UNCHANGED");
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+	std::vector<std::size_t> counts;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp (argv[i], "--regulations") == 0 && i + 1 < argc)
+			counts.push_back (static_cast<std::size_t> (std::strtoull (argv[++i], nullptr, 10)));
+	}
+	if (counts.empty ())
+		counts = { 10, 100, 1000, 5000 };
+
+	for (std::size_t count : counts)
+		RunBenchmark (count);
+
+	for (std::size_t count : counts)
+		RunFolderRebuildCheck (count);
+
+	return 0;
+}
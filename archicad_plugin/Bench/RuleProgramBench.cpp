@@ -0,0 +1,224 @@
+// 规则程序基准：数据驱动规则编译为RuleOp后的每楼梯检测耗时（无需ArchiCAD）
+//
+//   g++ -std=c++17 -O2 -ISrc Bench/RuleProgramBench.cpp Src/StairRuleProgram.cpp Src/StairEvaluationCore.cpp Src/StairTrace.cpp Src/StairTreadGeometry.cpp Src/StairWalkingLine.cpp Src/StairWorkPool.cpp -pthread -o rule_program_bench
+//
+//   ./rule_program_bench                依次测试 8 / 32 / 128 条规则
+//   ./rule_program_bench --rules 64     只测试指定数量
+//
+// 对比：逐条解释RuleDefinition（按比较方式和前提分支）与执行编译后的RuleOp数组。
+// 另外校验默认规则集编译后的结果与原先逐类手写的比较完全一致。
+
+#include "StairEvaluationCore.hpp"
+#include "StairRuleProgram.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+const std::size_t kStairCount = 100000;
+const int kRepeat = 20;
+
+double Uniform (std::mt19937& random, double low, double high)
+{
+	return low + (high - low) * static_cast<double> (random ()) / static_cast<double> (std::mt19937::max ());
+}
+
+// 实测值分布在规范限值附近，约1/10的楼梯无法获取踏步宽度，约一半没有平台段
+std::vector<StairCore::StairMetrics> GenerateMetrics (std::mt19937& random)
+{
+	std::vector<StairCore::StairMetrics> metrics (kStairCount);
+	for (StairCore::StairMetrics& m : metrics) {
+		m.riserHeight = Uniform (random, 0.14, 0.19);
+		m.treadDepth = random () % 10 == 0 ? 0.0 : Uniform (random, 0.22, 0.32);
+		m.twoRPlusGoing = StairCore::ComputeTwoRPlusGoing (m.riserHeight, m.treadDepth);
+		m.landingEvaluated = random () % 2 == 0;
+		m.minLandingLength = m.landingEvaluated ? Uniform (random, 0.9, 1.6) : 0.0;
+	}
+	return metrics;
+}
+
+// 原先逐类手写的比较，用于校验编译后的默认规则集
+std::uint32_t HandWrittenRules (const StairCore::StairMetrics& metrics, const StairCore::RuleSet& ruleSet)
+{
+	using namespace StairCore;
+	std::uint32_t mask = 0;
+
+	const RuleLimits& riser = ruleSet.rules[RiserHeightRule];
+	if (riser.enabled && riser.maxValue.has_value () && metrics.riserHeight - *riser.maxValue > kEpsilon)
+		mask |= 1u << RiserHeightRule;
+
+	const RuleLimits& tread = ruleSet.rules[TreadDepthRule];
+	if (tread.enabled && tread.minValue.has_value () && metrics.treadDepth > kEpsilon && *tread.minValue - metrics.treadDepth > kEpsilon)
+		mask |= 1u << TreadDepthRule;
+
+	const RuleLimits& landing = ruleSet.rules[LandingLengthRule];
+	if (landing.enabled && landing.minValue.has_value () && metrics.landingEvaluated && metrics.minLandingLength > 0.0 &&
+		*landing.minValue - metrics.minLandingLength > kEpsilon)
+		mask |= 1u << LandingLengthRule;
+
+	const RuleLimits& twoRPlusG = ruleSet.rules[TwoRPlusGoingRule];
+	if (twoRPlusG.enabled && twoRPlusG.minValue.has_value () && twoRPlusG.maxValue.has_value () &&
+		(*twoRPlusG.minValue - metrics.twoRPlusGoing > kEpsilon || metrics.twoRPlusGoing - *twoRPlusG.maxValue > kEpsilon))
+		mask |= 1u << TwoRPlusGoingRule;
+
+	return mask;
+}
+
+// 不编译、逐条解释规则定义
+std::uint32_t InterpretRules (const std::vector<StairCore::RuleDefinition>& definitions, const StairCore::StairMetrics& metrics)
+{
+	using namespace StairCore;
+	std::uint32_t mask = 0;
+	for (const RuleDefinition& definition : definitions) {
+		if (!definition.enabled)
+			continue;
+
+		const double value = GetMetricValue (metrics, definition.metric);
+		if ((definition.guards & RequirePositiveMetric) != 0 && value <= kEpsilon)
+			continue;
+		if ((definition.guards & RequireLanding) != 0 && !(metrics.landingEvaluated && metrics.minLandingLength > 0.0))
+			continue;
+
+		bool violated = false;
+		switch (definition.comparator) {
+			case Comparator::AtMost:
+				violated = value - definition.maxValue > definition.tolerance;
+				break;
+			case Comparator::AtLeast:
+				violated = definition.minValue - value > definition.tolerance;
+				break;
+			case Comparator::Between:
+				violated = definition.minValue - value > definition.tolerance || value - definition.maxValue > definition.tolerance;
+				break;
+		}
+		if (violated)
+			mask |= 1u << definition.metric;
+	}
+	return mask;
+}
+
+std::vector<StairCore::RuleDefinition> GenerateDefinitions (std::size_t ruleCount, std::mt19937& random)
+{
+	static const double kCenters[StairCore::RuleKindCount] = { 0.165, 0.26, 1.2, 0.6 };
+
+	std::vector<StairCore::RuleDefinition> definitions (ruleCount);
+	for (std::size_t i = 0; i < ruleCount; ++i) {
+		StairCore::RuleDefinition& definition = definitions[i];
+		definition.metric = static_cast<StairCore::RuleKind> (random () % StairCore::RuleKindCount);
+		definition.comparator = static_cast<StairCore::Comparator> (random () % 3);
+		const double center = kCenters[definition.metric];
+		definition.minValue = center * Uniform (random, 0.9, 1.0);
+		definition.maxValue = center * Uniform (random, 1.0, 1.1);
+		definition.guards = static_cast<std::uint8_t> (random () % 4);
+		definition.enabled = random () % 8 != 0;
+	}
+	return definitions;
+}
+
+double ElapsedNs (std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count ();
+}
+
+void CheckDefaultRuleSet (const std::vector<StairCore::StairMetrics>& metrics, std::mt19937& random)
+{
+	std::size_t mismatches = 0;
+	std::size_t violations = 0;
+	for (unsigned int enabledMask = 0; enabledMask < (1u << StairCore::RuleKindCount); ++enabledMask) {
+		StairCore::RuleSet ruleSet;
+		ruleSet.rules[StairCore::RiserHeightRule].maxValue = 0.175;
+		ruleSet.rules[StairCore::TreadDepthRule].minValue = 0.26;
+		ruleSet.rules[StairCore::LandingLengthRule].minValue = 1.2;
+		ruleSet.rules[StairCore::TwoRPlusGoingRule].minValue = 0.55;
+		ruleSet.rules[StairCore::TwoRPlusGoingRule].maxValue = 0.65;
+		// 随机去掉一个限值，覆盖限值不完整的情况
+		const unsigned int dropped = static_cast<unsigned int> (random () % (2 * StairCore::RuleKindCount + 1));
+		if (dropped < StairCore::RuleKindCount)
+			ruleSet.rules[dropped].minValue.reset ();
+		else if (dropped < 2 * StairCore::RuleKindCount)
+			ruleSet.rules[dropped - StairCore::RuleKindCount].maxValue.reset ();
+		for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind)
+			ruleSet.rules[kind].enabled = (enabledMask & (1u << kind)) != 0;
+
+		for (const StairCore::StairMetrics& m : metrics) {
+			const std::uint32_t expected = HandWrittenRules (m, ruleSet);
+			violations += expected != 0 ? 1 : 0;
+			if (StairCore::EvaluateRules (m, ruleSet) != expected)
+				++mismatches;
+		}
+	}
+	std::printf ("default rule set: %zu/%zu mismatches against hand-written checks (%zu violating)\n",
+		mismatches, metrics.size () * (1u << StairCore::RuleKindCount), violations);
+}
+
+void RunBenchmark (std::size_t ruleCount, const std::vector<StairCore::StairMetrics>& metrics)
+{
+	std::mt19937 random (static_cast<unsigned int> (ruleCount));
+	const std::vector<StairCore::RuleDefinition> definitions = GenerateDefinitions (ruleCount, random);
+
+	const auto compileStart = std::chrono::steady_clock::now ();
+	std::vector<StairCore::RuleOp> ops;
+	ops.reserve (definitions.size ());
+	for (const StairCore::RuleDefinition& definition : definitions) {
+		StairCore::RuleOp op;
+		if (StairCore::CompileRule (definition, op))
+			ops.push_back (op);
+	}
+	const double compileUs = ElapsedNs (compileStart) / 1000.0;
+
+	std::vector<std::uint32_t> interpreted (metrics.size ());
+	std::vector<std::uint32_t> compiled (metrics.size ());
+
+	const auto interpretStart = std::chrono::steady_clock::now ();
+	for (int r = 0; r < kRepeat; ++r) {
+		for (std::size_t i = 0; i < metrics.size (); ++i)
+			interpreted[i] = InterpretRules (definitions, metrics[i]);
+	}
+	const double interpretNs = ElapsedNs (interpretStart) / static_cast<double> (kRepeat * metrics.size ());
+
+	const auto runStart = std::chrono::steady_clock::now ();
+	for (int r = 0; r < kRepeat; ++r) {
+		for (std::size_t i = 0; i < metrics.size (); ++i)
+			compiled[i] = StairCore::RunRuleOps (ops.data (), ops.size (), metrics[i]);
+	}
+	const double runNs = ElapsedNs (runStart) / static_cast<double> (kRepeat * metrics.size ());
+
+	std::size_t mismatches = 0;
+	std::size_t violating = 0;
+	for (std::size_t i = 0; i < metrics.size (); ++i) {
+		if (compiled[i] != interpreted[i])
+			++mismatches;
+		violating += compiled[i] != 0 ? 1 : 0;
+	}
+
+	std::printf ("%4zu rules (%4zu ops) | compile %7.2f us | interpret %7.2f ns/stair | program %7.2f ns/stair (%4.1fx) | %zu violating, %zu/%zu mismatches\n",
+		ruleCount, ops.size (), compileUs, interpretNs, runNs, runNs > 0.0 ? interpretNs / runNs : 0.0,
+		violating, mismatches, metrics.size ());
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+	std::vector<std::size_t> counts;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp (argv[i], "--rules") == 0 && i + 1 < argc)
+			counts.push_back (static_cast<std::size_t> (std::strtoull (argv[++i], nullptr, 10)));
+	}
+	if (counts.empty ())
+		counts = { 8, 32, 128 };
+
+	std::mt19937 random (2024);
+	const std::vector<StairCore::StairMetrics> metrics = GenerateMetrics (random);
+
+	CheckDefaultRuleSet (metrics, random);
+	for (std::size_t count : counts)
+		RunBenchmark (count, metrics);
+
+	return 0;
+}
@@ -0,0 +1,1161 @@
+// 楼梯检测核心基准：生成合成楼梯模型，统计吞吐量和内存分配（无需ArchiCAD）
+//
+//   g++ -std=c++17 -O2 -ISrc -DSTAIR_TRACE_LEVEL=0 Bench/StairBench.cpp Src/StairEvaluationCore.cpp Src/StairMetricsTable.cpp Src/StairRailings.cpp Src/StairRuleProgram.cpp Src/StairSpatialIndex.cpp Src/StairTrace.cpp Src/StairTreadGeometry.cpp Src/StairWalkingLine.cpp Src/StairWorkPool.cpp -pthread -o stair_bench
+//
+//   ./stair_bench                 依次测试 10k / 100k / 1M 个楼梯（单线程）
+//   ./stair_bench --stairs 50000  只测试指定数量
+//   ./stair_bench --threads 4     使用4个线程检测
+//   ./stair_bench --scaling       线程数从1翻倍到硬件并发数，输出加速比
+//   ./stair_bench --table         比较逐个楼梯检测与按列（SIMD）检测，并校验结果一致
+//   ./stair_bench --walking-line  在弯曲的步行线上校验Locate，比较逐段扫描圆弧与WalkingLineGeometry::Build的平台长度计算
+//                                 （含大量平台段和乱序圆弧的最坏情况），并校验结果一致
+//   ./stair_bench --treads        用螺旋楼梯和U形楼梯的解析解校验逐个踏步的窄端宽度、踢面高度差、净宽和梯段间距
+//                                 （含梯段长度恰为踏步宽度整数倍、梯段接圆弧平台的情况）
+//   ./stair_bench --railings      比较逐个扫描栏杆与栏杆索引的扶手高度关联，并校验增量更新后与重建的索引一致
+//
+// 以不同的 STAIR_TRACE_LEVEL 编译可比较跟踪开启/关闭时的检测循环耗时，
+// 跟踪输出写入内存（模拟报告窗口）。
+
+#include "StairEvaluationCore.hpp"
+#include "StairMetricsTable.hpp"
+#include "StairRailings.hpp"
+#include "StairSpatialIndex.hpp"
+#include "StairTrace.hpp"
+#include "StairTreadGeometry.hpp"
+#include "StairWalkingLine.hpp"
+#include "StairWorkPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// 分配统计
+// ---------------------------------------------------------------------------
+
+namespace {
+
+std::atomic<std::size_t> g_allocatedBytes { 0 };
+std::atomic<std::size_t> g_allocationCount { 0 };
+
+struct AllocationSnapshot {
+	std::size_t	bytes;
+	std::size_t	count;
+
+	static AllocationSnapshot Take ()
+	{
+		return { g_allocatedBytes.load (std::memory_order_relaxed), g_allocationCount.load (std::memory_order_relaxed) };
+	}
+};
+
+} // namespace
+
+namespace {
+
+void* CountedAllocate (std::size_t size)
+{
+	g_allocatedBytes.fetch_add (size, std::memory_order_relaxed);
+	g_allocationCount.fetch_add (1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc (size == 0 ? 1 : size))
+		return ptr;
+	throw std::bad_alloc ();
+}
+
+} // namespace
+
+// 每种形式的 new 和 delete 各自直接调用 std::malloc / std::free，不互相转发，
+// 否则 GCC 内联后会把 new[] 的指针与 operator delete 配对而给出 -Wmismatched-new-delete
+void* operator new (std::size_t size)
+{
+	return CountedAllocate (size);
+}
+
+void* operator new[] (std::size_t size)
+{
+	return CountedAllocate (size);
+}
+
+void operator delete (void* ptr) noexcept
+{
+	std::free (ptr);
+}
+
+void operator delete[] (void* ptr) noexcept
+{
+	std::free (ptr);
+}
+
+void operator delete (void* ptr, std::size_t) noexcept
+{
+	std::free (ptr);
+}
+
+void operator delete[] (void* ptr, std::size_t) noexcept
+{
+	std::free (ptr);
+}
+
+// ---------------------------------------------------------------------------
+// 合成楼梯
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+struct Random {
+	std::uint64_t state;
+
+	double Next (double minValue, double maxValue)
+	{
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		const double unit = static_cast<double> (state >> 11) / static_cast<double> (1ull << 53);
+		return minValue + (maxValue - minValue) * unit;
+	}
+
+	std::uint32_t NextIndex (std::uint32_t count)
+	{
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		return static_cast<std::uint32_t> ((state >> 33) % count);
+	}
+};
+
+void AddVertex (StairCore::StairRecord& stair, double x, double y)
+{
+	stair.walkingLine.push_back ({ x, y });
+}
+
+void AddSegment (StairCore::StairRecord& stair, StairCore::SegmentType type, double x, double y)
+{
+	stair.segmentTypes.push_back (type);
+	AddVertex (stair, x, y);
+}
+
+constexpr double kHalfWidth = 0.6;
+
+// U形楼梯：两个梯段的步行线相距separation，梯井宽well，每个梯段净宽 separation - well，平台由三段组成
+void AddUStair (StairCore::StairRecord& stair, double flight, double separation, double well)
+{
+	using StairCore::SegmentType;
+
+	const double halfWidth = (separation - well) * 0.5;
+	const double turn = flight + separation * 0.5;
+	AddVertex (stair, 0.0, 0.0);
+	AddSegment (stair, SegmentType::Flight, flight, 0.0);
+	AddSegment (stair, SegmentType::Landing, turn, 0.0);
+	AddSegment (stair, SegmentType::DividedLanding, turn, separation);
+	AddSegment (stair, SegmentType::DividedLanding, flight, separation);
+	AddSegment (stair, SegmentType::Flight, 0.0, separation);
+
+	// 左侧为梯井一侧
+	stair.boundaries[0].points = { { 0.0, halfWidth }, { flight, halfWidth }, { flight, separation - halfWidth }, { 0.0, separation - halfWidth } };
+	stair.boundaries[1].points = { { 0.0, -halfWidth }, { turn + halfWidth, -halfWidth }, { turn + halfWidth, separation + halfWidth }, { 0.0, separation + halfWidth } };
+}
+
+// 以原点为圆心、半径radius的边界，与螺旋步行线的分段相同
+void AddSpiralBoundary (StairCore::BoundaryRecord& boundary, double radius, double step, std::uint32_t segmentCount)
+{
+	for (std::uint32_t i = 0; i <= segmentCount; ++i) {
+		boundary.points.push_back ({ radius * std::cos (step * i), radius * std::sin (step * i) });
+		if (i > 0)
+			boundary.arcs.push_back ({ static_cast<std::int32_t> (i - 1), static_cast<std::int32_t> (i), step });
+	}
+}
+
+// 直跑、L形、U形和螺旋楼梯，螺旋楼梯的步行线由大量圆弧段组成
+void GenerateStair (Random& random, StairCore::StairRecord& stair)
+{
+	using StairCore::SegmentType;
+
+	stair.Clear ();
+	stair.floorIndex = static_cast<short> (random.NextIndex (20));
+	stair.riserHeight = random.Next (0.14, 0.19);
+	stair.treadDepth = random.Next (0.24, 0.32);
+
+	const double flight = random.Next (2.0, 4.5);
+	const double landing = random.Next (0.9, 1.6);
+
+	switch (random.NextIndex (4)) {
+		case 0:		// 直跑
+			AddVertex (stair, 0.0, 0.0);
+			AddSegment (stair, SegmentType::Flight, flight, 0.0);
+			stair.boundaries[0].points = { { 0.0, kHalfWidth }, { flight, kHalfWidth } };
+			stair.boundaries[1].points = { { 0.0, -kHalfWidth }, { flight, -kHalfWidth } };
+			break;
+
+		case 1:		// L形
+			AddVertex (stair, 0.0, 0.0);
+			AddSegment (stair, SegmentType::Flight, flight, 0.0);
+			AddSegment (stair, SegmentType::Landing, flight + landing, 0.0);
+			AddSegment (stair, SegmentType::Flight, flight + landing, flight);
+			break;
+
+		case 2:		// U形
+			AddUStair (stair, flight, landing, random.Next (0.05, 0.3));
+			break;
+
+		default: {	// 螺旋
+			const std::uint32_t segmentCount = 24 + random.NextIndex (200);
+			const double radius = random.Next (1.0, 2.5);
+			const double step = 2.0 * kPi * random.Next (0.75, 2.0) / segmentCount;
+			AddVertex (stair, radius, 0.0);
+			for (std::uint32_t i = 1; i <= segmentCount; ++i) {
+				const double angle = step * i;
+				const SegmentType type = (i % 16 == 0) ? SegmentType::Landing : SegmentType::Flight;
+				AddSegment (stair, type, radius * std::cos (angle), radius * std::sin (angle));
+				stair.walkingLineArcs.push_back ({ static_cast<std::int32_t> (i - 1), static_cast<std::int32_t> (i), step });
+			}
+			AddSpiralBoundary (stair.boundaries[0], radius - kHalfWidth, step, segmentCount);
+			AddSpiralBoundary (stair.boundaries[1], radius + kHalfWidth, step, segmentCount);
+			break;
+		}
+	}
+
+	// 踏板顶面标高，偶尔有一块踏板偏高
+	const std::uint32_t levelCount = 8 + random.NextIndex (12);
+	for (std::uint32_t i = 1; i <= levelCount; ++i)
+		stair.treadLevels.push_back (stair.riserHeight * i);
+	if (random.NextIndex (8) == 0)
+		stair.treadLevels[random.NextIndex (levelCount)] += random.Next (0.0, 0.02);
+
+	stair.handrailHeight = random.Next (0.85, 1.1);
+}
+
+std::vector<StairCore::StairRecord> GenerateModel (std::size_t stairCount)
+{
+	Random random { 0x5eed1234abcdull };
+	std::vector<StairCore::StairRecord> stairs (stairCount);
+	for (StairCore::StairRecord& stair : stairs)
+		GenerateStair (random, stair);
+	return stairs;
+}
+
+StairCore::RuleSet BenchmarkRules ()
+{
+	StairCore::RuleSet ruleSet;
+	ruleSet.rules[StairCore::RiserHeightRule].maxValue = 0.175;
+	ruleSet.rules[StairCore::TreadDepthRule].minValue = 0.26;
+	ruleSet.rules[StairCore::LandingLengthRule].minValue = 1.2;
+	ruleSet.rules[StairCore::TwoRPlusGoingRule].minValue = 0.54;
+	ruleSet.rules[StairCore::TwoRPlusGoingRule].maxValue = 0.62;
+	ruleSet.rules[StairCore::NarrowTreadDepthRule].minValue = 0.22;
+	ruleSet.rules[StairCore::RiserVariationRule].maxValue = 0.01;
+	ruleSet.rules[StairCore::StairWidthRule].minValue = 1.1;
+	ruleSet.rules[StairCore::HandrailHeightRule].minValue = 0.9;
+	ruleSet.rules[StairCore::SlopeAngleRule].maxValue = 38.0;
+	ruleSet.rules[StairCore::FlightSpacingRule].minValue = 0.15;
+	return ruleSet;
+}
+
+// 模拟报告窗口
+std::string	g_reportWindow;
+std::size_t	g_reportLines = 0;
+
+void AppendToReportWindow (const char* text)
+{
+	g_reportWindow.append (text);
+	++g_reportLines;
+}
+
+double ElapsedMs (std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+}
+
+struct EvaluateResult {
+	double		milliseconds;
+	std::size_t	violationCount;
+	std::size_t	bytes;
+	std::size_t	allocations;
+};
+
+EvaluateResult EvaluateModel (const std::vector<StairCore::StairRecord>& stairs, const StairCore::RuleSet& ruleSet, unsigned int threadCount)
+{
+	// 线程池在计时之外创建，与插件中复用线程池的情形一致
+	std::optional<StairCore::WorkStealingPool> pool;
+	if (threadCount > 1)
+		pool.emplace (threadCount);
+
+	std::vector<StairCore::StairEvaluation> evaluations (stairs.size ());
+
+	g_reportWindow.clear ();
+	g_reportLines = 0;
+
+	const AllocationSnapshot before = AllocationSnapshot::Take ();
+	const auto start = std::chrono::steady_clock::now ();
+
+	StairCore::EvaluateStairs (stairs, ruleSet, evaluations, pool.has_value () ? &*pool : nullptr);
+
+	std::size_t violationCount = 0;
+	for (std::size_t i = 0; i < stairs.size (); ++i) {
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_STAIR
+		StairCore::TraceEvaluation (i, "1F 楼梯", evaluations[i], ruleSet);
+#endif
+		if (!evaluations[i].IsCompliant ())
+			++violationCount;
+	}
+
+	const double milliseconds = ElapsedMs (start);
+	const AllocationSnapshot after = AllocationSnapshot::Take ();
+	return { milliseconds, violationCount, after.bytes - before.bytes, after.count - before.count };
+}
+
+double StairsPerSecond (std::size_t stairCount, double milliseconds)
+{
+	return milliseconds > 0.0 ? static_cast<double> (stairCount) * 1000.0 / milliseconds : 0.0;
+}
+
+void RunBenchmark (std::size_t stairCount, unsigned int threadCount)
+{
+	const AllocationSnapshot beforeGenerate = AllocationSnapshot::Take ();
+	const auto generateStart = std::chrono::steady_clock::now ();
+	const std::vector<StairCore::StairRecord> stairs = GenerateModel (stairCount);
+	const double generateMs = ElapsedMs (generateStart);
+	const AllocationSnapshot afterGenerate = AllocationSnapshot::Take ();
+
+	const EvaluateResult evaluate = EvaluateModel (stairs, BenchmarkRules (), threadCount);
+
+	std::printf ("%8zu stairs | generate %9.2f ms, %10zu bytes in %8zu allocs | evaluate %9.2f ms, %12.0f stairs/s, %10zu bytes in %8zu allocs | %zu violations, %zu trace lines\n",
+		stairCount,
+		generateMs, afterGenerate.bytes - beforeGenerate.bytes, afterGenerate.count - beforeGenerate.count,
+		evaluate.milliseconds, StairsPerSecond (stairCount, evaluate.milliseconds),
+		evaluate.bytes, evaluate.allocations,
+		evaluate.violationCount, g_reportLines);
+}
+
+// 同一模型在1、2、4...个线程下检测，并确认结果与单线程一致
+void RunScaling (std::size_t stairCount, unsigned int maxThreads)
+{
+	const std::vector<StairCore::StairRecord> stairs = GenerateModel (stairCount);
+	const StairCore::RuleSet ruleSet = BenchmarkRules ();
+
+	std::vector<StairCore::StairEvaluation> reference;
+	StairCore::EvaluateStairs (stairs, ruleSet, reference, nullptr);
+
+	std::printf ("%8zu stairs\n", stairCount);
+
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int threads = 1; threads < maxThreads; threads *= 2)
+		threadCounts.push_back (threads);
+	threadCounts.push_back (maxThreads);
+
+	double singleThreadMs = 0.0;
+	for (unsigned int threads : threadCounts) {
+		// 取三次中最快的一次，减少调度抖动
+		EvaluateResult best = EvaluateModel (stairs, ruleSet, threads);
+		for (int repeat = 1; repeat < 3; ++repeat) {
+			const EvaluateResult current = EvaluateModel (stairs, ruleSet, threads);
+			if (current.milliseconds < best.milliseconds)
+				best = current;
+		}
+		if (threads == 1)
+			singleThreadMs = best.milliseconds;
+
+		StairCore::WorkStealingPool pool (threads);
+		std::vector<StairCore::StairEvaluation> evaluations;
+		StairCore::EvaluateStairs (stairs, ruleSet, evaluations, threads > 1 ? &pool : nullptr);
+		bool identical = evaluations.size () == reference.size ();
+		for (std::size_t i = 0; identical && i < reference.size (); ++i)
+			identical = evaluations[i].violationMask == reference[i].violationMask && evaluations[i].metrics.minLandingLength == reference[i].metrics.minLandingLength;
+
+		std::printf ("  %3u threads | evaluate %9.2f ms, %12.0f stairs/s, speedup %5.2fx | %s\n",
+			threads, best.milliseconds, StairsPerSecond (stairCount, best.milliseconds),
+			best.milliseconds > 0.0 ? singleThreadMs / best.milliseconds : 0.0,
+			identical ? "results identical" : "RESULTS DIFFER");
+	}
+}
+
+// 逐个楼梯检测（每个楼梯一个StairEvaluation，插件和命令行工具使用）与按列检测（StairMetricsTable）的对比。
+// 按列只加快规则比较；端到端耗时几乎全在计算实测值，另外还要填表并逐行取回结果
+void RunTableComparison (std::size_t stairCount, unsigned int threadCount)
+{
+	const std::vector<StairCore::StairRecord> stairs = GenerateModel (stairCount);
+	const StairCore::RuleSet ruleSet = BenchmarkRules ();
+
+	std::optional<StairCore::WorkStealingPool> pool;
+	if (threadCount > 1)
+		pool.emplace (threadCount);
+	StairCore::WorkStealingPool* poolPtr = pool.has_value () ? &*pool : nullptr;
+
+	std::vector<StairCore::StairEvaluation> evaluations;
+	StairCore::StairMetricsTable table;
+
+	// 先各执行一次分配好输出，计时只包含检测本身；交替执行三次取最短
+	StairCore::EvaluateStairs (stairs, ruleSet, evaluations, poolPtr);
+	StairCore::EvaluateStairTable (stairs, ruleSet, table, poolPtr);
+
+	double rowMs = 0.0;
+	double tableMs = 0.0;
+	for (int r = 0; r < 3; ++r) {
+		auto start = std::chrono::steady_clock::now ();
+		StairCore::EvaluateStairs (stairs, ruleSet, evaluations, poolPtr);
+		const double rowRunMs = ElapsedMs (start);
+		rowMs = r == 0 ? rowRunMs : std::min (rowMs, rowRunMs);
+
+		start = std::chrono::steady_clock::now ();
+		StairCore::EvaluateStairTable (stairs, ruleSet, table, poolPtr);
+		const double tableRunMs = ElapsedMs (start);
+		tableMs = r == 0 ? tableRunMs : std::min (tableMs, tableRunMs);
+	}
+
+	// 只比较规则检测部分：实测值已经算好
+	std::vector<StairCore::StairMetrics> metrics (stairs.size ());
+	for (std::size_t i = 0; i < stairs.size (); ++i)
+		metrics[i] = evaluations[i].metrics;
+	StairCore::RuleOp ops[StairCore::RuleKindCount];
+	const std::size_t opCount = StairCore::CompileRuleSet (ruleSet, ops);
+	std::vector<std::uint32_t> rowMasks (stairs.size ());
+
+	const int repeat = 20;
+	auto start = std::chrono::steady_clock::now ();
+	for (int r = 0; r < repeat; ++r) {
+		for (std::size_t i = 0; i < metrics.size (); ++i)
+			rowMasks[i] = StairCore::RunRuleOps (ops, opCount, metrics[i]);
+	}
+	const double rowCheckNs = ElapsedMs (start) * 1e6 / static_cast<double> (repeat * stairs.size ());
+
+	start = std::chrono::steady_clock::now ();
+	for (int r = 0; r < repeat; ++r) {
+		std::fill (table.violationMask.begin (), table.violationMask.end (), 0u);
+		StairCore::ApplyRuleOps (ops, opCount, table, 0, table.GetRowCount ());
+	}
+	const double columnCheckNs = ElapsedMs (start) * 1e6 / static_cast<double> (repeat * stairs.size ());
+
+	std::size_t mismatches = 0;
+	for (std::size_t i = 0; i < stairs.size (); ++i) {
+		if (table.violationMask[i] != evaluations[i].violationMask || rowMasks[i] != evaluations[i].violationMask)
+			++mismatches;
+	}
+
+	// 按列检测额外的开销：把实测值写入各列，以及生成结果时逐行取回StairEvaluation
+	StairCore::StairMetricsTable filled;
+	filled.Resize (stairs.size ());
+	start = std::chrono::steady_clock::now ();
+	for (int r = 0; r < repeat; ++r) {
+		for (std::size_t i = 0; i < metrics.size (); ++i)
+			filled.SetMetrics (i, metrics[i]);
+	}
+	const double fillNs = ElapsedMs (start) * 1e6 / static_cast<double> (repeat * stairs.size ());
+
+	std::size_t compliant = 0;
+	start = std::chrono::steady_clock::now ();
+	for (int r = 0; r < repeat; ++r) {
+		for (std::size_t i = 0; i < table.GetRowCount (); ++i)
+			compliant += table.GetEvaluation (i).IsCompliant () ? 1 : 0;
+	}
+	const double transposeNs = ElapsedMs (start) * 1e6 / static_cast<double> (repeat * stairs.size ());
+	if (compliant != repeat * (stairs.size () - table.CountViolations ()))
+		++mismatches;
+
+	std::printf ("%8zu stairs | end to end: per stair %9.2f ms, by column %9.2f ms (%4.2fx) | rule checks only: per stair %6.2f ns, by column %6.2f ns | "
+		"column overhead: fill %5.2f ns, read back %5.2f ns | %zu violations, %zu mismatches\n",
+		stairCount, rowMs, tableMs, tableMs > 0.0 ? rowMs / tableMs : 0.0, rowCheckNs, columnCheckNs, fillNs, transposeNs,
+		table.CountViolations (), mismatches);
+}
+
+// 原先的实现：每条线段扫描全部圆弧记录，作为几何索引的对照
+double ReferenceSegmentLength (const StairCore::StairRecord& stair, std::size_t edgeIndex)
+{
+	if (edgeIndex + 1 >= stair.walkingLine.size ())
+		return 0.0;
+
+	const StairCore::Point2D& start = stair.walkingLine[edgeIndex];
+	const StairCore::Point2D& end = stair.walkingLine[edgeIndex + 1];
+
+	const double dx = end.x - start.x;
+	const double dy = end.y - start.y;
+	const double chordLength = std::sqrt (dx * dx + dy * dy);
+
+	for (const StairCore::ArcRecord& arc : stair.walkingLineArcs) {
+		if (arc.begIndex == static_cast<std::int32_t> (edgeIndex) && arc.endIndex == static_cast<std::int32_t> (edgeIndex + 1)) {
+			const double angle = std::fabs (arc.arcAngle);
+			if (angle > StairCore::kEpsilon) {
+				const double halfChord = chordLength * 0.5;
+				const double radius = halfChord / std::sin (angle * 0.5);
+				return radius * angle;
+			}
+			break;
+		}
+	}
+
+	return chordLength;
+}
+
+double ReferenceMinimumLandingLength (const StairCore::StairRecord& stair, bool* landingEvaluated)
+{
+	*landingEvaluated = false;
+	if (stair.walkingLine.size () <= 1)
+		return 0.0;
+
+	const std::size_t segmentCount = std::min (stair.walkingLine.size () - 1, stair.segmentTypes.size ());
+	double minLanding = DBL_MAX;
+	double currentLanding = 0.0;
+	bool inLanding = false;
+
+	for (std::size_t edgeIdx = 0; edgeIdx < segmentCount; ++edgeIdx) {
+		const StairCore::SegmentType type = stair.segmentTypes[edgeIdx];
+		if (type == StairCore::SegmentType::Landing || type == StairCore::SegmentType::DividedLanding) {
+			*landingEvaluated = true;
+			if (!inLanding) {
+				inLanding = true;
+				currentLanding = 0.0;
+			}
+			currentLanding += ReferenceSegmentLength (stair, edgeIdx);
+		} else if (inLanding) {
+			minLanding = std::min (minLanding, currentLanding);
+			inLanding = false;
+		}
+	}
+
+	if (inLanding)
+		minLanding = std::min (minLanding, currentLanding);
+
+	return minLanding == DBL_MAX ? 0.0 : minLanding;
+}
+
+// 圆弧记录的顺序和重复记录不影响结果：打乱螺旋楼梯的圆弧顺序，并给部分线段追加重复记录
+void PerturbArcs (Random& random, StairCore::StairRecord& stair)
+{
+	std::reverse (stair.walkingLineArcs.begin (), stair.walkingLineArcs.end ());
+	const std::size_t arcCount = stair.walkingLineArcs.size ();
+	for (std::size_t i = 0; i < arcCount; i += 7) {
+		StairCore::ArcRecord duplicate = stair.walkingLineArcs[i];
+		duplicate.arcAngle = -random.Next (0.0, 1.0);
+		stair.walkingLineArcs.push_back (duplicate);
+	}
+	if (arcCount > 0)
+		stair.walkingLineArcs.push_back ({ -1, 0, 0.5 });
+}
+
+// 逐段扫描圆弧与几何索引的对照：逐段长度、累计距离、最短平台长度
+void RunWalkingLineComparison (std::size_t stairCount)
+{
+	std::vector<StairCore::StairRecord> stairs = GenerateModel (stairCount);
+	Random random { 0x0a1c5eedull };
+	std::size_t curvedCount = 0;
+	for (StairCore::StairRecord& stair : stairs) {
+		if (!stair.walkingLineArcs.empty ()) {
+			PerturbArcs (random, stair);
+			++curvedCount;
+		}
+	}
+
+	std::size_t mismatches = 0;
+	double maxDistanceError = 0.0;
+	StairCore::WalkingLineGeometry geometry;
+	for (const StairCore::StairRecord& stair : stairs) {
+		geometry.Build (stair);
+
+		double distance = 0.0;
+		bool identical = true;
+		for (std::size_t edge = 0; edge + 1 < stair.walkingLine.size (); ++edge) {
+			const double length = ReferenceSegmentLength (stair, edge);
+			identical = identical && geometry.GetSegmentLength (edge) == length;
+			distance += length;
+			maxDistanceError = std::max (maxDistanceError, std::fabs (geometry.GetDistance (edge + 1) - distance));
+		}
+
+		bool referenceEvaluated = false;
+		const double referenceLanding = ReferenceMinimumLandingLength (stair, &referenceEvaluated);
+		identical = identical && geometry.GetMinimumLandingLength () == referenceLanding && geometry.HasLanding () == referenceEvaluated;
+
+		if (!identical)
+			++mismatches;
+	}
+
+	double referenceSum = 0.0;
+	auto start = std::chrono::steady_clock::now ();
+	for (const StairCore::StairRecord& stair : stairs) {
+		bool landingEvaluated = false;
+		referenceSum += ReferenceMinimumLandingLength (stair, &landingEvaluated);
+	}
+	const double referenceMs = ElapsedMs (start);
+
+	// 与ComputeMetrics相同：复用缓冲区构建WalkingLineGeometry（段长、前缀和、梯段/平台划分）后取最短平台长度
+	double indexSum = 0.0;
+	start = std::chrono::steady_clock::now ();
+	for (const StairCore::StairRecord& stair : stairs) {
+		geometry.Build (stair);
+		indexSum += geometry.GetMinimumLandingLength ();
+	}
+	const double indexMs = ElapsedMs (start);
+
+	std::printf ("%8zu stairs (%zu curved) | arc scan %9.2f ms, WalkingLineGeometry::Build %9.2f ms (%4.1fx) | max distance error %.3g m, %zu mismatches%s\n",
+		stairCount, curvedCount, referenceMs, indexMs, indexMs > 0.0 ? referenceMs / indexMs : 0.0,
+		maxDistanceError, mismatches, indexSum == referenceSum ? "" : " (SUM DIFFERS)");
+}
+
+// 逐段扫描的最坏情况：一条步行线有edgeCount段，每段都是圆弧且记录顺序打乱，四段中有三段为平台，
+// 逐段扫描为 O(平台段数 × 圆弧数)，WalkingLineGeometry 为 O(段数)
+void RunWalkingLineWorstCase (std::size_t edgeCount)
+{
+	Random random { 0x5e9a11edull };
+	StairCore::StairRecord stair;
+	for (std::size_t k = 0; k <= edgeCount; ++k)
+		stair.walkingLine.push_back ({ 0.3 * static_cast<double> (k), 0.0 });
+	for (std::size_t k = 0; k < edgeCount; ++k) {
+		const std::int32_t begIndex = static_cast<std::int32_t> (k);
+		stair.walkingLineArcs.push_back ({ begIndex, begIndex + 1, (k % 2 == 0 ? 1.0 : -1.0) * random.Next (0.1, 1.2) });
+		stair.segmentTypes.push_back (k % 4 == 3 ? StairCore::SegmentType::Flight : StairCore::SegmentType::Landing);
+	}
+	for (std::size_t k = edgeCount; k > 1; --k)
+		std::swap (stair.walkingLineArcs[k - 1], stair.walkingLineArcs[random.NextIndex (static_cast<std::uint32_t> (k))]);
+
+	const std::size_t repeat = std::max<std::size_t> (1, 16000 / edgeCount);
+	bool referenceEvaluated = false;
+	double referenceLanding = 0.0;
+	auto start = std::chrono::steady_clock::now ();
+	for (std::size_t i = 0; i < repeat; ++i)
+		referenceLanding = ReferenceMinimumLandingLength (stair, &referenceEvaluated);
+	const double referenceMs = ElapsedMs (start) / static_cast<double> (repeat);
+
+	StairCore::WalkingLineGeometry geometry;
+	double landing = 0.0;
+	start = std::chrono::steady_clock::now ();
+	for (std::size_t i = 0; i < repeat; ++i) {
+		geometry.Build (stair);
+		landing = geometry.GetMinimumLandingLength ();
+	}
+	const double indexMs = ElapsedMs (start) / static_cast<double> (repeat);
+
+	std::printf ("%8zu arc edges (unsorted, %zu landing) | arc scan %9.3f ms, WalkingLineGeometry::Build %9.3f ms (%7.1fx) | %s\n",
+		edgeCount, edgeCount - edgeCount / 4, referenceMs, indexMs, indexMs > 0.0 ? referenceMs / indexMs : 0.0,
+		landing == referenceLanding && geometry.HasLanding () == referenceEvaluated ? "identical" : "MISMATCH");
+}
+
+// 步行线上距起点distance处的解析解
+struct ExpectedLocation {
+	StairCore::Point2D	point;
+	StairCore::Point2D	tangent;
+};
+
+// 逐点比较Locate与解析解，返回超出容差的点数
+std::size_t CheckLocate (const char* caseName, const StairCore::StairRecord& stair, const std::vector<double>& distances,
+						 ExpectedLocation (*expected) (double distance), double& maxError)
+{
+	const StairCore::WalkingLineGeometry geometry (stair);
+	std::size_t failures = 0;
+	for (double distance : distances) {
+		StairCore::Point2D point {};
+		StairCore::Point2D tangent {};
+		const ExpectedLocation location = expected (distance);
+		const bool located = geometry.Locate (stair, distance, point, tangent);
+		const double error = std::max ({ std::fabs (point.x - location.point.x), std::fabs (point.y - location.point.y),
+										 std::fabs (tangent.x - location.tangent.x), std::fabs (tangent.y - location.tangent.y) });
+		maxError = std::max (maxError, error);
+		if (!located || error > 1e-9) {
+			std::printf ("  %s: distance %.6f -> (%.9f, %.9f) tangent (%.6f, %.6f), expected (%.9f, %.9f) tangent (%.6f, %.6f)\n",
+				caseName, distance, point.x, point.y, tangent.x, tangent.y,
+				location.point.x, location.point.y, location.tangent.x, location.tangent.y);
+			++failures;
+		}
+	}
+	return failures;
+}
+
+// 整圆：圆心 (1, 2)，半径1.5，从角度0起逆时针分为6段圆弧
+constexpr double kCircleRadius = 1.5;
+
+ExpectedLocation LocateOnCircle (double distance)
+{
+	const double total = 2.0 * kPi * kCircleRadius;
+	const double angle = std::min (std::max (distance, 0.0), total) / kCircleRadius;
+	return { { 1.0 + kCircleRadius * std::cos (angle), 2.0 + kCircleRadius * std::sin (angle) }, { -std::sin (angle), std::cos (angle) } };
+}
+
+// 直线 (0,0)-(2,0)，顺时针半圆（圆心 (2,-1)，半径1，两段圆弧）到 (2,-2)，再沿直线回到 (0,-2)
+ExpectedLocation LocateOnHairpin (double distance)
+{
+	const double arcLength = kPi;
+	if (distance <= 2.0) {
+		const double x = std::max (distance, 0.0);
+		return { { x, 0.0 }, { 1.0, 0.0 } };
+	}
+	if (distance <= 2.0 + arcLength) {
+		const double angle = kPi * 0.5 - (distance - 2.0);		// 从正上方顺时针转动
+		return { { 2.0 + std::cos (angle), -1.0 + std::sin (angle) }, { std::sin (angle), -std::cos (angle) } };
+	}
+	const double x = 2.0 - std::min (distance - 2.0 - arcLength, 2.0);
+	return { { x, -2.0 }, { -1.0, 0.0 } };
+}
+
+// 在弯曲的步行线上直接校验Locate：端点、每段圆弧的中点、超出两端的距离
+void RunLocateChecks ()
+{
+	std::size_t failures = 0;
+	std::size_t pointCount = 0;
+	double maxError = 0.0;
+
+	StairCore::StairRecord circle;
+	constexpr int kCircleArcs = 6;
+	const double step = 2.0 * kPi / kCircleArcs;
+	for (int k = 0; k <= kCircleArcs; ++k)
+		circle.walkingLine.push_back ({ 1.0 + kCircleRadius * std::cos (step * k), 2.0 + kCircleRadius * std::sin (step * k) });
+	for (int k = kCircleArcs - 1; k >= 0; --k)
+		circle.walkingLineArcs.push_back ({ k, k + 1, step });
+	const double circleLength = 2.0 * kPi * kCircleRadius;
+	std::vector<double> distances = { 0.0, circleLength, -0.5, circleLength + 0.5, circleLength + 100.0 };
+	for (int k = 0; k < kCircleArcs; ++k)
+		distances.push_back ((k + 0.5) * step * kCircleRadius);
+	failures += CheckLocate ("circle", circle, distances, LocateOnCircle, maxError);
+	pointCount += distances.size ();
+
+	StairCore::StairRecord hairpin;
+	hairpin.walkingLine = { { 0.0, 0.0 }, { 2.0, 0.0 }, { 3.0, -1.0 }, { 2.0, -2.0 }, { 0.0, -2.0 } };
+	hairpin.walkingLineArcs = { { 2, 3, -kPi * 0.5 }, { 1, 2, -kPi * 0.5 } };
+	const double hairpinLength = 4.0 + kPi;
+	distances = { 0.0, hairpinLength, -1.0, hairpinLength + 0.25, hairpinLength + 10.0,
+				  2.0 + kPi * 0.25, 2.0 + kPi * 0.75,			// 两段圆弧的中点
+				  1.0, 2.0 + kPi * 0.5, 3.0 + kPi };			// 直线段中点、两段圆弧的分界
+	failures += CheckLocate ("hairpin", hairpin, distances, LocateOnHairpin, maxError);
+	pointCount += distances.size ();
+
+	std::printf ("Locate on curved walking lines | %zu points, max error %.3g | %zu failures\n", pointCount, maxError, failures);
+}
+
+// 螺旋楼梯的解析解：踏步对应的圆心角为 going / radius，窄端宽度为内侧测量圆上的弦长；
+// 标高偏移delta的踏板使相邻两个踢面分别变为 R+delta 和 R-delta
+void RunTreadComparison (std::size_t stairCount)
+{
+	Random random { 0x7ead5eedull };
+	std::vector<StairCore::StairRecord> stairs (stairCount);
+	std::vector<double> expectedNarrow (stairCount, 0.0);
+	std::vector<double> expectedVariation (stairCount, 0.0);
+	for (std::size_t index = 0; index < stairCount; ++index) {
+		StairCore::StairRecord& stair = stairs[index];
+		do {
+			GenerateStair (random, stair);
+		} while (stair.walkingLineArcs.empty ());
+
+		// 内侧边界半径
+		const StairCore::Point2D& inner = stair.boundaries[0].points[0];
+		const double innerRadius = std::sqrt (inner.x * inner.x + inner.y * inner.y);
+		const double radius = innerRadius + kHalfWidth;
+
+		double narrow = 0.0;
+		const StairCore::WalkingLineGeometry walkingLine (stair);
+		for (const StairCore::WalkingLineRun& run : walkingLine.GetRuns ()) {
+			if (run.landing)
+				continue;
+			const double treadCount = std::max (1.0, std::round (run.length / stair.treadDepth));
+			const double angle = run.length / treadCount / radius;
+			const double chord = 2.0 * (innerRadius + StairCore::kNarrowTreadOffset) * std::sin (angle * 0.5);
+			narrow = narrow > 0.0 ? std::min (narrow, chord) : chord;
+		}
+		expectedNarrow[index] = narrow;
+
+		// 重新生成标高：打乱顺序，并使中间一块踏板偏高
+		const double delta = random.Next (0.0, 0.02);
+		const std::size_t levelCount = stair.treadLevels.size ();
+		for (std::size_t i = 0; i < levelCount; ++i)
+			stair.treadLevels[i] = stair.riserHeight * static_cast<double> (i + 1) + (i == levelCount / 2 ? delta : 0.0);
+		std::reverse (stair.treadLevels.begin (), stair.treadLevels.end ());
+		expectedVariation[index] = 2.0 * delta;
+	}
+
+	std::size_t mismatches = 0;
+	std::size_t treadCount = 0;
+	double maxNarrowError = 0.0;
+	double maxVariationError = 0.0;
+	double maxWidthError = 0.0;
+	StairCore::WalkingLineGeometry geometry;
+	StairCore::TreadMetrics metrics;
+	const auto start = std::chrono::steady_clock::now ();
+	for (std::size_t index = 0; index < stairCount; ++index) {
+		geometry.Build (stairs[index]);
+		StairCore::ComputeTreadMetrics (stairs[index], geometry, metrics);
+		treadCount += metrics.treadCount;
+
+		// 边界圆弧离散为折线，交点略向圆心偏移
+		const double narrowError = std::fabs (metrics.minNarrowGoing - expectedNarrow[index]);
+		const double variationError = std::fabs (metrics.riserVariation - expectedVariation[index]);
+		maxNarrowError = std::max (maxNarrowError, narrowError);
+		maxVariationError = std::max (maxVariationError, variationError);
+		// 踢面线沿半径方向，净宽为内外边界的半径差；外侧边界离散为弦，交点最多内移弦高
+		const StairCore::BoundaryRecord& outer = stairs[index].boundaries[1];
+		const double outerRadius = std::sqrt (outer.points[0].x * outer.points[0].x + outer.points[0].y * outer.points[0].y);
+		const double chordAngle = std::fabs (outer.arcs[0].arcAngle) / std::ceil (std::fabs (outer.arcs[0].arcAngle) / StairCore::kBoundaryArcStep);
+		const double sagitta = outerRadius * (1.0 - std::cos (chordAngle * 0.5));
+		const double widthError = std::fabs (metrics.minClearWidth - 2.0 * kHalfWidth);
+		maxWidthError = std::max (maxWidthError, widthError);
+		if (narrowError > 0.002 || variationError > 1e-9 || widthError > sagitta + 1e-9)
+			++mismatches;
+	}
+	const double elapsedMs = ElapsedMs (start);
+
+	std::printf ("%8zu spiral stairs, %9zu treads | %9.2f ms (%6.1f ns/tread) | max narrow error %.3g m, max variation error %.3g m, max width error %.3g m, %zu mismatches\n",
+		stairCount, treadCount, elapsedMs, treadCount > 0 ? elapsedMs * 1e6 / static_cast<double> (treadCount) : 0.0,
+		maxNarrowError, maxVariationError, maxWidthError, mismatches);
+}
+
+// U形楼梯：净宽为 separation - well，两个梯段之间的距离为梯井宽度
+void RunFlightSpacingComparison (std::size_t stairCount)
+{
+	Random random { 0x0b57ac1eull };
+	std::size_t mismatches = 0;
+	double maxWidthError = 0.0;
+	double maxSpacingError = 0.0;
+	StairCore::StairRecord stair;
+	StairCore::WalkingLineGeometry geometry;
+	StairCore::TreadMetrics metrics;
+	const auto start = std::chrono::steady_clock::now ();
+	for (std::size_t index = 0; index < stairCount; ++index) {
+		stair.Clear ();
+		stair.riserHeight = random.Next (0.14, 0.19);
+		stair.treadDepth = random.Next (0.24, 0.32);
+		const double flight = random.Next (2.0, 4.5);
+		const double separation = random.Next (1.2, 3.0);
+		const double well = random.Next (0.05, 0.6);
+		AddUStair (stair, flight, separation, well);
+
+		geometry.Build (stair);
+		StairCore::ComputeTreadMetrics (stair, geometry, metrics);
+
+		const double widthError = std::fabs (metrics.minClearWidth - (separation - well));
+		const double spacingError = std::fabs (metrics.flightSpacing - well);
+		maxWidthError = std::max (maxWidthError, widthError);
+		maxSpacingError = std::max (maxSpacingError, spacingError);
+		if (widthError > 1e-9 || spacingError > 1e-9)
+			++mismatches;
+	}
+	const double elapsedMs = ElapsedMs (start);
+
+	std::printf ("%8zu U stairs | %9.2f ms (%6.1f ns/stair) | max width error %.3g m, max spacing error %.3g m, %zu mismatches\n",
+		stairCount, elapsedMs, stairCount > 0 ? elapsedMs * 1e6 / static_cast<double> (stairCount) : 0.0,
+		maxWidthError, maxSpacingError, mismatches);
+}
+
+// 梯段长度恰为踏步宽度整数倍时，最后一条踢面线位于梯段与平台的分界上：
+// 直跑梯段接切线不连续的圆弧平台，窄端宽度应等于踏步宽度；平台在梯段终点转向的U形楼梯，梯段间距应等于梯井宽度
+void RunFlightEndChecks ()
+{
+	using StairCore::SegmentType;
+
+	constexpr double kWell = 0.2;
+	constexpr double kSeparation = 1.4;
+	std::size_t caseCount = 0;
+	std::size_t failures = 0;
+	double maxNarrowError = 0.0;
+	double maxSpacingError = 0.0;
+	StairCore::StairRecord stair;
+	StairCore::WalkingLineGeometry geometry;
+	StairCore::TreadMetrics metrics;
+	for (int depthCm = 25; depthCm <= 32; ++depthCm) {
+		for (int treadCount = 6; treadCount <= 18; ++treadCount) {
+			// 与交换文件中十进制写出的长度相同（如2.8、0.28）
+			const double treadDepth = depthCm / 100.0;
+			const double flight = (depthCm * treadCount) / 100.0;
+
+			stair.Clear ();
+			stair.riserHeight = 0.15;
+			stair.treadDepth = treadDepth;
+			AddVertex (stair, 0.0, 0.0);
+			AddSegment (stair, SegmentType::Flight, flight, 0.0);
+			AddSegment (stair, SegmentType::Landing, flight + 1.2, 0.0);
+			stair.walkingLineArcs.push_back ({ 1, 2, kPi * 0.5 });
+			stair.boundaries[0].points = { { 0.0, kHalfWidth }, { flight, kHalfWidth } };
+			stair.boundaries[1].points = { { 0.0, -kHalfWidth }, { flight, -kHalfWidth } };
+			geometry.Build (stair);
+			StairCore::ComputeTreadMetrics (stair, geometry, metrics);
+			const double narrowError = std::fabs (metrics.minNarrowGoing - treadDepth);
+			maxNarrowError = std::max (maxNarrowError, narrowError);
+			if (narrowError > 1e-9) {
+				std::printf ("  arc landing: flight %.2f m, tread %.2f m -> narrow %.6f m\n", flight, treadDepth, metrics.minNarrowGoing);
+				++failures;
+			}
+
+			// 平台步行线在梯段终点直接转向的U形楼梯
+			const double halfWidth = (kSeparation - kWell) * 0.5;
+			stair.Clear ();
+			stair.riserHeight = 0.15;
+			stair.treadDepth = treadDepth;
+			AddVertex (stair, 0.0, 0.0);
+			AddSegment (stair, SegmentType::Flight, flight, 0.0);
+			AddSegment (stair, SegmentType::Landing, flight, kSeparation);
+			AddSegment (stair, SegmentType::Flight, 0.0, kSeparation);
+			stair.boundaries[0].points = { { 0.0, halfWidth }, { flight, halfWidth }, { flight, kSeparation - halfWidth }, { 0.0, kSeparation - halfWidth } };
+			stair.boundaries[1].points = { { 0.0, -halfWidth }, { flight + 1.0, -halfWidth }, { flight + 1.0, kSeparation + halfWidth }, { 0.0, kSeparation + halfWidth } };
+			geometry.Build (stair);
+			StairCore::ComputeTreadMetrics (stair, geometry, metrics);
+			const double spacingError = std::fabs (metrics.flightSpacing - kWell);
+			maxSpacingError = std::max (maxSpacingError, spacingError);
+			if (spacingError > 1e-9) {
+				std::printf ("  U stair: flight %.2f m, tread %.2f m -> spacing %.6f m\n", flight, treadDepth, metrics.flightSpacing);
+				++failures;
+			}
+			caseCount += 2;
+		}
+	}
+
+	std::printf ("flight length = treads x going | %zu cases (arc landing, U stair), max narrow error %.3g m, max spacing error %.3g m | %zu failures\n",
+		caseCount, maxNarrowError, maxSpacingError, failures);
+}
+
+// 每个楼梯一段梯段栏杆，另有跨越整个楼层的走廊栏杆（不应关联到任何楼梯）
+std::vector<StairCore::RailingRecord> GenerateRailings (Random& random, const std::vector<StairCore::StairRecord>& stairs, std::vector<double>& expected)
+{
+	std::vector<StairCore::RailingRecord> railings;
+	expected.assign (stairs.size (), 0.0);
+	for (std::size_t index = 0; index < stairs.size (); ++index) {
+		const StairCore::StairRecord& stair = stairs[index];
+		if (stair.walkingLine.size () < 2)
+			continue;
+
+		// 沿第一段步行线的栏杆，楼梯平移到各自的位置
+		const StairCore::Point2D& a = stair.walkingLine[0];
+		const StairCore::Point2D& b = stair.walkingLine[1];
+		StairCore::RailingRecord railing;
+		railing.bounds.floorIndex = stair.floorIndex;
+		railing.bounds.minX = std::min (a.x, b.x);
+		railing.bounds.minY = std::min (a.y, b.y);
+		railing.bounds.maxX = std::max (a.x, b.x);
+		railing.bounds.maxY = std::max (a.y, b.y);
+		railing.handrailHeight = random.Next (0.85, 1.1);
+		railings.push_back (railing);
+		expected[index] = railing.handrailHeight;
+
+		if (random.NextIndex (4) == 0) {
+			railing.handrailHeight = random.Next (0.85, 1.1);
+			railings.push_back (railing);
+			expected[index] = std::min (expected[index], railing.handrailHeight);
+		}
+	}
+	for (short floorIndex = 0; floorIndex < 20; ++floorIndex) {
+		StairCore::RailingRecord corridor;
+		corridor.bounds.floorIndex = floorIndex;
+		corridor.bounds.minX = -1e6;
+		corridor.bounds.maxX = 1e6;
+		corridor.bounds.maxY = 0.1;
+		corridor.handrailHeight = 0.5;
+		railings.push_back (corridor);
+	}
+	return railings;
+}
+
+void OffsetStair (StairCore::StairRecord& stair, double dx, double dy)
+{
+	for (StairCore::Point2D& point : stair.walkingLine)
+		point = { point.x + dx, point.y + dy };
+	for (StairCore::BoundaryRecord& boundary : stair.boundaries) {
+		for (StairCore::Point2D& point : boundary.points)
+			point = { point.x + dx, point.y + dy };
+	}
+}
+
+// 原先的做法：每个楼梯扫描全部栏杆
+double ReferenceHandrailHeight (const StairCore::StairRecord& stair, const std::vector<StairCore::RailingRecord>& railings)
+{
+	double minX = DBL_MAX, minY = DBL_MAX, maxX = -DBL_MAX, maxY = -DBL_MAX;
+	auto add = [&] (const StairCore::Point2D& point) {
+		minX = std::min (minX, point.x);
+		minY = std::min (minY, point.y);
+		maxX = std::max (maxX, point.x);
+		maxY = std::max (maxY, point.y);
+	};
+	for (const StairCore::Point2D& point : stair.walkingLine)
+		add (point);
+	for (const StairCore::BoundaryRecord& boundary : stair.boundaries) {
+		for (const StairCore::Point2D& point : boundary.points)
+			add (point);
+	}
+
+	double height = 0.0;
+	for (const StairCore::RailingRecord& railing : railings) {
+		const StairCore::ElementBounds& bounds = railing.bounds;
+		if (bounds.floorIndex != stair.floorIndex ||
+			bounds.minX < minX - StairCore::kRailingTolerance || bounds.maxX > maxX + StairCore::kRailingTolerance ||
+			bounds.minY < minY - StairCore::kRailingTolerance || bounds.maxY > maxY + StairCore::kRailingTolerance)
+			continue;
+		if (height <= 0.0 || railing.handrailHeight < height)
+			height = railing.handrailHeight;
+	}
+	return height;
+}
+
+// 与插件的增量更新相同：修改部分栏杆后，用楼梯索引找出新旧位置附近的楼梯，只重新查找这些楼梯，
+// 结果应与全部重建后的索引一致
+void RunIncrementalRailingUpdate (Random& random, std::vector<StairCore::StairRecord>& stairs, std::vector<StairCore::RailingRecord> railings, StairCore::RailingIndex& index)
+{
+	const auto stairIndexStart = std::chrono::steady_clock::now ();
+	StairCore::SpatialIndex stairIndex;
+	stairIndex.Reserve (stairs.size ());
+	for (const StairCore::StairRecord& stair : stairs) {
+		StairCore::ElementBounds bounds;
+		StairCore::ComputeStairBounds (stair, bounds);
+		stairIndex.Insert (bounds);
+	}
+	const double stairIndexMs = ElapsedMs (stairIndexStart);
+
+	// 每10个栏杆修改一个：移动并改变高度，或者删除
+	std::vector<bool> removed (railings.size (), false);
+	std::vector<std::uint32_t> affected;
+	std::size_t changedRailings = 0;
+	const auto updateStart = std::chrono::steady_clock::now ();
+	for (std::size_t railing = 0; railing < railings.size (); railing += 10) {
+		const std::uint32_t handle = static_cast<std::uint32_t> (railing);
+		const StairCore::ElementBounds oldBounds = railings[railing].bounds;
+		stairIndex.Query (oldBounds.Expanded (StairCore::kRailingTolerance), affected);
+		if (random.NextIndex (3) == 0) {
+			index.Remove (handle);
+			removed[railing] = true;
+		} else {
+			StairCore::RailingRecord& record = railings[railing];
+			const double dx = random.Next (-0.5, 0.5);
+			record.bounds.minX += dx;
+			record.bounds.maxX += dx;
+			record.handrailHeight = random.Next (0.85, 1.1);
+			index.Update (handle, record);
+			stairIndex.Query (record.bounds.Expanded (StairCore::kRailingTolerance), affected);
+		}
+		++changedRailings;
+	}
+	std::sort (affected.begin (), affected.end ());
+	affected.erase (std::unique (affected.begin (), affected.end ()), affected.end ());
+	for (const std::uint32_t stair : affected)
+		stairs[stair].handrailHeight = index.FindHandrailHeight (stairs[stair]);
+	const double updateMs = ElapsedMs (updateStart);
+
+	std::vector<StairCore::RailingRecord> remaining;
+	for (std::size_t railing = 0; railing < railings.size (); ++railing) {
+		if (!removed[railing])
+			remaining.push_back (railings[railing]);
+	}
+	StairCore::RailingIndex rebuilt;
+	rebuilt.Build (remaining);
+
+	std::size_t mismatches = 0;
+	for (const StairCore::StairRecord& stair : stairs) {
+		if (stair.handrailHeight != rebuilt.FindHandrailHeight (stair))
+			++mismatches;
+	}
+
+	std::printf ("%8zu railings changed | stair index %9.2f ms | update %9.2f ms (%zu stairs re-queried) | %zu mismatches\n",
+		changedRailings, stairIndexMs, updateMs, affected.size (), mismatches);
+}
+
+void RunRailingComparison (std::size_t stairCount)
+{
+	Random random { 0x2a11ed5eull };
+	std::vector<StairCore::StairRecord> stairs (stairCount);
+	for (std::size_t index = 0; index < stairCount; ++index) {
+		GenerateStair (random, stairs[index]);
+		// 同一楼层的楼梯排成一列，相互不重叠（螺旋楼梯的包围盒以原点为中心）
+		OffsetStair (stairs[index], static_cast<double> (index) * 10.0, 5.0);
+	}
+
+	std::vector<double> expected;
+	const std::vector<StairCore::RailingRecord> railings = GenerateRailings (random, stairs, expected);
+
+	// 对照只测前1000个楼梯，逐个扫描为O(楼梯数×栏杆数)
+	const std::size_t referenceCount = std::min<std::size_t> (stairCount, 1000);
+	std::size_t mismatches = 0;
+	const auto referenceStart = std::chrono::steady_clock::now ();
+	for (std::size_t index = 0; index < referenceCount; ++index) {
+		if (ReferenceHandrailHeight (stairs[index], railings) != expected[index])
+			++mismatches;
+	}
+	const double referenceMs = ElapsedMs (referenceStart);
+
+	const auto indexStart = std::chrono::steady_clock::now ();
+	StairCore::RailingIndex index;
+	index.Build (railings);
+	StairCore::AssignHandrailHeights (stairs, index);
+	const double indexMs = ElapsedMs (indexStart);
+
+	for (std::size_t i = 0; i < stairCount; ++i) {
+		if (stairs[i].handrailHeight != expected[i])
+			++mismatches;
+	}
+
+	std::printf ("%8zu stairs, %8zu railings | scan %9.2f ms (%zu stairs, %7.1f us/stair) | index %9.2f ms (%6.1f ns/stair) | %zu mismatches\n",
+		stairCount, railings.size (), referenceMs, referenceCount,
+		referenceCount > 0 ? referenceMs * 1e3 / static_cast<double> (referenceCount) : 0.0,
+		indexMs, stairCount > 0 ? indexMs * 1e6 / static_cast<double> (stairCount) : 0.0, mismatches);
+
+	RunIncrementalRailingUpdate (random, stairs, railings, index);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+	std::vector<std::size_t> sizes;
+	unsigned int threadCount = 1;
+	bool scaling = false;
+	bool table = false;
+	bool walkingLine = false;
+	bool treads = false;
+	bool railings = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp (argv[i], "--stairs") == 0 && i + 1 < argc)
+			sizes.push_back (static_cast<std::size_t> (std::strtoull (argv[++i], nullptr, 10)));
+		else if (std::strcmp (argv[i], "--threads") == 0 && i + 1 < argc)
+			threadCount = StairCore::WorkStealingPool::ResolveThreadCount (static_cast<unsigned int> (std::strtoul (argv[++i], nullptr, 10)));
+		else if (std::strcmp (argv[i], "--scaling") == 0)
+			scaling = true;
+		else if (std::strcmp (argv[i], "--table") == 0)
+			table = true;
+		else if (std::strcmp (argv[i], "--walking-line") == 0)
+			walkingLine = true;
+		else if (std::strcmp (argv[i], "--treads") == 0)
+			treads = true;
+		else if (std::strcmp (argv[i], "--railings") == 0)
+			railings = true;
+	}
+	if (sizes.empty ())
+		sizes = { 10000, 100000, 1000000 };
+
+	StairTrace::SetSink (AppendToReportWindow);
+
+	if (scaling) {
+		const unsigned int maxThreads = threadCount > 1 ? threadCount : StairCore::WorkStealingPool::ResolveThreadCount (0);
+		std::printf ("trace level %d, scaling 1..%u threads\n", STAIR_TRACE_LEVEL, maxThreads);
+		for (std::size_t size : sizes)
+			RunScaling (size, maxThreads);
+		return 0;
+	}
+
+	if (walkingLine) {
+		RunLocateChecks ();
+		for (std::size_t edgeCount : { 1000, 4000, 16000 })
+			RunWalkingLineWorstCase (edgeCount);
+		for (std::size_t size : sizes)
+			RunWalkingLineComparison (size);
+		return 0;
+	}
+
+	if (treads) {
+		RunFlightEndChecks ();
+		for (std::size_t size : sizes) {
+			RunTreadComparison (size);
+			RunFlightSpacingComparison (size);
+		}
+		return 0;
+	}
+
+	if (railings) {
+		for (std::size_t size : sizes)
+			RunRailingComparison (size);
+		return 0;
+	}
+
+	std::printf ("trace level %d, %u threads\n", STAIR_TRACE_LEVEL, threadCount);
+	for (std::size_t size : sizes) {
+		if (table)
+			RunTableComparison (size, threadCount);
+		else
+			RunBenchmark (size, threadCount);
+	}
+
+	return 0;
+}
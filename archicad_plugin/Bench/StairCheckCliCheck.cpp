@@ -0,0 +1,122 @@
+// 命令行检测工具stair_check的检查：读取失败的导出文件只报告错误，其中的楼梯不参与检测和统计（无需ArchiCAD）
+//
+//   g++ -std=c++17 -O2 -Wall -Wextra -ISrc Bench/StairCheckCliCheck.cpp Src/StairInterchange.cpp Src/RegulationJson.cpp Src/RegulationLibrary.cpp Src/StairEvaluationCore.cpp Src/StairRailings.cpp Src/StairRuleProgram.cpp Src/StairSpatialIndex.cpp Src/StairTrace.cpp Src/StairTreadGeometry.cpp Src/StairWalkingLine.cpp Src/StairWorkPool.cpp -pthread -o stair_check_cli_check
+//
+//   ./stair_check_cli_check ./stair_check      逐项输出失败的检查，全部通过时返回0
+//
+// 先直接调用 StairInterchange::ReadModel，再在临时目录中写入规范和导出文件，运行给出的stair_check并检查结果JSON的summary。
+
+#include "StairInterchange.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::size_t g_checkCount = 0;
+std::size_t g_failureCount = 0;
+
+void Check (bool condition, const std::string& input, const char* what)
+{
+	++g_checkCount;
+	if (!condition) {
+		++g_failureCount;
+		std::printf ("FAIL %-40s | %s\n", what, input.c_str ());
+	}
+}
+
+// 直线单跑楼梯；arcEnd不为空时给步行线加一段圆弧，终点序号为arcEnd（超出点数时文件无效）
+std::string MakeStair (const char* id, const char* arcEnd)
+{
+	std::string stair = std::string ("{\"id\": \"") + id + "\", \"floor\": 0, \"riser_height\": 0.19, \"tread_depth\": 0.24, "
+		"\"walking_line\": {\"points\": [[0, 0], [3, 0]], \"arcs\": [";
+	if (arcEnd != nullptr)
+		stair += std::string ("{\"begin\": 0, \"end\": ") + arcEnd + ", \"angle\": 0.5}";
+	stair += "], \"segments\": [\"flight\"]}}";
+	return stair;
+}
+
+std::string MakeModel (const char* name, const std::string& stairs)
+{
+	return std::string ("{\"format\": \"stair-interchange\", \"version\": 1, \"model\": \"") + name + "\", \"stairs\": [" + stairs + "]}";
+}
+
+void WriteText (const fs::path& path, const std::string& text)
+{
+	std::ofstream (path, std::ios::binary) << text;
+}
+
+std::string ReadText (const fs::path& path)
+{
+	std::ifstream file (path, std::ios::binary);
+	return std::string (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+}
+
+// 读取失败时模型被清空，不留下读了一半的楼梯
+void CheckReadModel ()
+{
+	const std::string input = MakeModel ("bad", MakeStair ("good", nullptr) + ", " + MakeStair ("bad", "7"));
+	StairInterchange::ModelRecord model;
+	std::string error;
+	const bool read = StairInterchange::ReadModel (input.data (), input.size (), model, error);
+	Check (!read, input, "arc end out of range rejected");
+	Check (!error.empty (), input, "error reported");
+	Check (model.stairs.empty () && model.stairIds.empty (), input, "no stairs after failure");
+	Check (model.name.empty (), input, "model cleared after failure");
+}
+
+// 运行stair_check，返回结果JSON（失败时为空）
+std::string RunStairCheck (const std::string& stairCheck, const fs::path& folder, const std::string& inputs)
+{
+	const fs::path output = folder / "results.json";
+	fs::remove (output);
+	const std::string command = "\"" + stairCheck + "\" --regulation \"" + (folder / "regulation.json").string () +
+		"\" --output \"" + output.string () + "\" " + inputs + " 2>/dev/null";
+	std::system (command.c_str ());
+	return ReadText (output);
+}
+
+void CheckSummary (const std::string& json, const char* expected, const char* what)
+{
+	Check (json.find (expected) != std::string::npos, json.substr (0, 400), what);
+}
+
+void CheckCommandLine (const std::string& stairCheck)
+{
+	const fs::path folder = fs::temp_directory_path () / "stair_check_cli_check";
+	std::error_code error;
+	fs::remove_all (folder, error);
+	fs::create_directories (folder);
+
+	WriteText (folder / "regulation.json", "{\"regulation_name\": \"t\", \"regulation_code\": \"T\", \"rules\": {\"riser_height\": {\"max_value\": 0.175}}}");
+	WriteText (folder / "bad.stairs.json", MakeModel ("bad", MakeStair ("good", nullptr) + ", " + MakeStair ("bad", "7")));
+	WriteText (folder / "good.stairs.json", MakeModel ("good", MakeStair ("a", nullptr) + ", " + MakeStair ("b", nullptr)));
+
+	// 只有一个无效文件：不统计任何楼梯
+	const std::string badOnly = RunStairCheck (stairCheck, folder, "\"" + (folder / "bad.stairs.json").string () + "\"");
+	CheckSummary (badOnly, "\"summary\": {\"models\": 0, \"stairs\": 0, \"non_compliant\": 0, \"errors\": 1}", "malformed file counts no stairs");
+	CheckSummary (badOnly, "\"models\": []", "malformed file lists no model");
+
+	// 与有效文件一起检测：只统计有效文件中的两个楼梯（踏步高度0.19超过上限，均不合规）
+	const std::string mixed = RunStairCheck (stairCheck, folder, "\"" + (folder / "bad.stairs.json").string () + "\" \"" + (folder / "good.stairs.json").string () + "\"");
+	CheckSummary (mixed, "\"summary\": {\"models\": 1, \"stairs\": 2, \"non_compliant\": 2, \"errors\": 1}", "only valid file's stairs counted");
+
+	fs::remove_all (folder, error);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+	CheckReadModel ();
+	CheckCommandLine (argc > 1 ? argv[1] : "./stair_check");
+
+	std::printf ("%zu checks, %zu failures\n", g_checkCount, g_failureCount);
+	return g_failureCount == 0 ? 0 : 1;
+}
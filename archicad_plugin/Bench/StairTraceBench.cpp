@@ -0,0 +1,145 @@
+// 跟踪开销基准：同一检测循环分别以 STAIR_TRACE_LEVEL 0（关闭）和 3（逐规则）编译，比较耗时
+//
+//   for level in 0 3; do
+//     g++ -std=c++17 -O2 -ISrc -DSTAIR_TRACE_LEVEL=$level Bench/StairTraceBench.cpp Src/StairEvaluationCore.cpp Src/StairRuleProgram.cpp Src/StairTrace.cpp Src/StairTreadGeometry.cpp Src/StairWalkingLine.cpp Src/StairWorkPool.cpp -pthread -o trace_bench_$level && ./trace_bench_$level
+//   done
+//
+//   ./trace_bench_3 [楼梯数量] [--ring 容量]
+//
+// 检测循环与插件全量检测的第二、三阶段相同：先检测全部楼梯，再按顺序为每个楼梯生成显示名称并输出跟踪，
+// 跟踪输出写入内存（模拟报告窗口）。每个级别输出一行，两次运行的结果一起即为跟踪开启/关闭的对比。
+
+#include "StairEvaluationCore.hpp"
+#include "StairTrace.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const kLevelNames[] = { "off", "summary", "per stair", "per rule" };
+
+// 模拟报告窗口：把消息追加到内存中
+std::string	g_reportWindow;
+std::size_t	g_reportLines = 0;
+
+void AppendToReportWindow (const char* text)
+{
+	g_reportWindow.append (text);
+	++g_reportLines;
+}
+
+// 直跑和带平台的双跑楼梯，尺寸在限值两侧随机分布
+std::vector<StairCore::StairRecord> GenerateStairs (std::size_t count)
+{
+	using StairCore::SegmentType;
+
+	std::vector<StairCore::StairRecord> stairs (count);
+	std::uint64_t seed = 12345u;
+	auto next = [&seed] (double minValue, double maxValue) {
+		seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+		return minValue + (maxValue - minValue) * static_cast<double> (seed >> 11) / static_cast<double> (1ull << 53);
+	};
+
+	for (StairCore::StairRecord& stair : stairs) {
+		stair.floorIndex = static_cast<short> (next (0.0, 20.0));
+		stair.riserHeight = next (0.15, 0.18);
+		stair.treadDepth = next (0.25, 0.30);
+
+		const double flight = next (2.0, 4.0);
+		stair.walkingLine = { { 0.0, 0.0 }, { flight, 0.0 } };
+		stair.segmentTypes = { SegmentType::Flight };
+		if (next (0.0, 1.0) < 0.5) {
+			const double landing = next (1.0, 1.5);
+			stair.walkingLine.push_back ({ flight + landing, 0.0 });
+			stair.walkingLine.push_back ({ flight + landing, flight });
+			stair.segmentTypes.push_back (SegmentType::Landing);
+			stair.segmentTypes.push_back (SegmentType::Flight);
+		}
+		stair.boundaries[0].points = { { 0.0, 0.6 }, { flight, 0.6 } };
+		stair.boundaries[1].points = { { 0.0, -0.6 }, { flight, -0.6 } };
+		for (int i = 1; i <= 12; ++i)
+			stair.treadLevels.push_back (stair.riserHeight * i);
+		stair.handrailHeight = next (0.85, 1.1);
+	}
+	return stairs;
+}
+
+StairCore::RuleSet BenchmarkRules ()
+{
+	StairCore::RuleSet ruleSet;
+	ruleSet.rules[StairCore::RiserHeightRule].maxValue = 0.175;
+	ruleSet.rules[StairCore::TreadDepthRule].minValue = 0.26;
+	ruleSet.rules[StairCore::LandingLengthRule].minValue = 1.2;
+	ruleSet.rules[StairCore::RiserVariationRule].maxValue = 0.01;
+	ruleSet.rules[StairCore::StairWidthRule].minValue = 1.1;
+	ruleSet.rules[StairCore::HandrailHeightRule].minValue = 0.9;
+	ruleSet.rules[StairCore::SlopeAngleRule].maxValue = 38.0;
+	return ruleSet;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+	std::size_t stairCount = 20000;
+	std::size_t ringCapacity = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp (argv[i], "--ring") == 0 && i + 1 < argc)
+			ringCapacity = static_cast<std::size_t> (std::strtoull (argv[++i], nullptr, 10));
+		else
+			stairCount = static_cast<std::size_t> (std::strtoull (argv[i], nullptr, 10));
+	}
+
+	StairTrace::SetSink (AppendToReportWindow);
+	if (ringCapacity > 0)
+		StairTrace::EnableRingBuffer (ringCapacity);
+
+	const std::vector<StairCore::StairRecord> stairs = GenerateStairs (stairCount);
+	const StairCore::RuleSet ruleSet = BenchmarkRules ();
+	std::vector<StairCore::StairEvaluation> evaluations;
+
+	constexpr int kRuns = 5;
+	double bestMs = 0.0;
+	std::size_t violations = 0;
+	for (int run = 0; run < kRuns; ++run) {
+		g_reportWindow.clear ();
+		g_reportLines = 0;
+
+		const auto start = std::chrono::steady_clock::now ();
+		StairCore::EvaluateStairs (stairs, ruleSet, evaluations, nullptr);
+		violations = 0;
+		for (std::size_t i = 0; i < stairs.size (); ++i) {
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_STAIR
+			// 插件中显示名称只在输出跟踪时生成
+			const std::string displayName = "楼层索引 " + std::to_string (stairs[i].floorIndex) + " 楼梯";
+			StairCore::TraceEvaluation (i, displayName.c_str (), evaluations[i], ruleSet);
+#endif
+			if (!evaluations[i].IsCompliant ())
+				++violations;
+		}
+		STAIR_TRACE_SUMMARY ("[Stair Compliance] 评估 %u 个楼梯（%u 个违规）\n",
+			static_cast<unsigned int> (stairs.size ()), static_cast<unsigned int> (violations));
+		const double ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+		if (run == 0 || ms < bestMs)
+			bestMs = ms;
+	}
+
+	if (ringCapacity > 0) {
+		const auto start = std::chrono::steady_clock::now ();
+		const std::size_t dumped = StairTrace::DumpRingBuffer ();
+		const double ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+		std::printf ("ring dump: %zu lines in %.3f ms\n", dumped, ms);
+	}
+
+	std::printf ("trace level %d (%s): %zu stairs, %zu violations, best of %d runs %.3f ms (%.1f ns/stair), %zu report lines, %zu bytes\n",
+		STAIR_TRACE_LEVEL, kLevelNames[STAIR_TRACE_LEVEL], stairCount, violations, kRuns, bestMs,
+		stairCount > 0 ? bestMs * 1e6 / static_cast<double> (stairCount) : 0.0,
+		g_reportLines, g_reportWindow.size ());
+	return 0;
+}
@@ -0,0 +1,454 @@
+// 无界面批量检测：读取插件导出的楼梯数据（*.stairs.json，格式见README）和规范JSON，
+// 在所有CPU核心上并行检测，输出JSON格式的结果（无需ArchiCAD，可在Linux构建服务器上运行）
+//
+//   g++ -std=c++17 -O2 -ISrc -DSTAIR_TRACE_LEVEL=0 Cli/StairCheck.cpp Src/RegulationJson.cpp Src/RegulationLibrary.cpp Src/StairEvaluationCore.cpp Src/StairInterchange.cpp Src/StairRailings.cpp Src/StairRuleProgram.cpp Src/StairSpatialIndex.cpp Src/StairTrace.cpp Src/StairTreadGeometry.cpp Src/StairWalkingLine.cpp Src/StairWorkPool.cpp -pthread -o stair_check
+//
+//   ./stair_check --regulation current_regulation.json exports/              检测目录（含子目录）中的全部*.stairs.json，结果写到标准输出
+//   ./stair_check --regulation gb.json --regulation bj.json --output results.json exports/ extra/model.stairs.json
+//   ./stair_check --jurisdiction CN-BJ --building-type residential ...      覆盖导出文件中的适用范围
+//   ./stair_check --threads 8 --all-rules --violations-only ...             线程数、检测全部规则类别、只输出违规的楼梯
+//
+// 多个规范文件按顺序合并到规范库（与插件相同）。默认检测的规则类别与插件默认相同。
+// 退出码：0 所有楼梯合规；1 存在违规；2 参数错误、规范无法读取或有楼梯数据文件无法读取
+// （无法读取的文件记录在结果的errors中，其余文件照常检测）。
+
+#include "RegulationJson.hpp"
+#include "RegulationLibrary.hpp"
+#include "StairEvaluationCore.hpp"
+#include "StairInterchange.hpp"
+#include "StairRailings.hpp"
+#include "StairWorkPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr const char*	kResultFormatName = "stair-check-results";
+constexpr int			kResultFormatVersion = 1;
+
+enum ExitCode {
+	ExitCompliant = 0,
+	ExitViolations = 1,
+	ExitError = 2
+};
+
+struct Options {
+	std::vector<std::string>	regulationFiles;
+	std::vector<std::string>	inputs;				// 目录或单个*.stairs.json
+	std::string					outputFile;			// 为空时写到标准输出
+	std::string					jurisdiction;		// 非空时覆盖导出文件中的适用范围
+	std::string					buildingType;
+	unsigned int				threadCount = 0;
+	bool						allRules = false;
+	bool						violationsOnly = false;
+};
+
+struct ModelInput {
+	std::string						path;
+	StairInterchange::ModelRecord	model;
+	std::string						error;			// 非空表示文件无法读取
+	std::size_t						firstRow = 0;	// 第一个楼梯在检测结果中的序号
+};
+
+void PrintUsage ()
+{
+	std::fprintf (stderr,
+		"用法: stair_check --regulation <规范.json> [--regulation ...] [选项] <目录或.stairs.json> ...\n"
+		"  --output <文件>          结果写入文件（默认标准输出）\n"
+		"  --jurisdiction <地区>    覆盖导出文件中的地区，如 CN-BJ\n"
+		"  --building-type <类型>   覆盖导出文件中的建筑类型\n"
+		"  --threads <n>            检测线程数（默认硬件并发数）\n"
+		"  --all-rules              检测全部规则类别（默认与插件相同）\n"
+		"  --violations-only        结果中只列出违规的楼梯\n"
+		"退出码: 0 全部合规, 1 存在违规, 2 参数或输入错误\n");
+}
+
+bool ParseOptions (int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; ++i) {
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp (argv[i], "--regulation") == 0 && hasValue)
+			options.regulationFiles.emplace_back (argv[++i]);
+		else if (std::strcmp (argv[i], "--output") == 0 && hasValue)
+			options.outputFile = argv[++i];
+		else if (std::strcmp (argv[i], "--jurisdiction") == 0 && hasValue)
+			options.jurisdiction = argv[++i];
+		else if (std::strcmp (argv[i], "--building-type") == 0 && hasValue)
+			options.buildingType = argv[++i];
+		else if (std::strcmp (argv[i], "--threads") == 0 && hasValue)
+			options.threadCount = static_cast<unsigned int> (std::strtoul (argv[++i], nullptr, 10));
+		else if (std::strcmp (argv[i], "--all-rules") == 0)
+			options.allRules = true;
+		else if (std::strcmp (argv[i], "--violations-only") == 0)
+			options.violationsOnly = true;
+		else if (argv[i][0] == '-' && argv[i][1] == '-')
+			return false;
+		else
+			options.inputs.emplace_back (argv[i]);
+	}
+	return !options.regulationFiles.empty () && !options.inputs.empty ();
+}
+
+bool ReadFileBytes (const std::string& path, std::vector<char>& bytes)
+{
+	std::ifstream file (path, std::ios::binary);
+	if (!file)
+		return false;
+	bytes.assign (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+	return !file.bad ();
+}
+
+// 规范文件按顺序合并，任一文件无法读取或没有规则时返回false
+bool LoadRegulations (const Options& options, StairCore::RegulationLibrary& library)
+{
+	library.SetEnabledRules (options.allRules ? (1u << StairCore::RuleKindCount) - 1 : StairCore::kDefaultCheckedRules);
+
+	for (const std::string& path : options.regulationFiles) {
+		std::vector<char> bytes;
+		if (!ReadFileBytes (path, bytes)) {
+			std::fprintf (stderr, "stair_check: 无法读取规范文件 %s\n", path.c_str ());
+			return false;
+		}
+
+		RegulationJson::Document document;
+		if (!document.Parse (bytes.data (), bytes.size ())) {
+			const RegulationJson::ParseError& error = document.GetError ();
+			std::fprintf (stderr, "stair_check: %s: JSON格式错误: %s（第%zu行，第%zu列）\n",
+				path.c_str (), error.message != nullptr ? error.message : "", error.line, error.column);
+			return false;
+		}
+
+		std::vector<RegulationJson::RegulationRecord> records;
+		if (!RegulationJson::ReadRegulations (document, records)) {
+			std::fprintf (stderr, "stair_check: %s: 没有可读取的规范\n", path.c_str ());
+			return false;
+		}
+		library.Merge (records);
+	}
+
+	if (library.GetRegulationCount () == 0) {
+		std::fprintf (stderr, "stair_check: 规范文件中没有任何规则\n");
+		return false;
+	}
+	return true;
+}
+
+// 目录中（含子目录）的*.stairs.json按路径排序，保证结果顺序与文件系统的遍历顺序无关
+bool CollectModelFiles (const std::vector<std::string>& inputs, std::vector<std::string>& files)
+{
+	namespace fs = std::filesystem;
+
+	const std::string suffix = StairInterchange::kFileSuffix;
+	for (const std::string& input : inputs) {
+		std::error_code error;
+		if (!fs::is_directory (input, error)) {
+			if (!fs::is_regular_file (input, error)) {
+				std::fprintf (stderr, "stair_check: 找不到 %s\n", input.c_str ());
+				return false;
+			}
+			files.push_back (input);
+			continue;
+		}
+
+		const std::size_t first = files.size ();
+		for (fs::recursive_directory_iterator it (input, error), end; !error && it != end; it.increment (error)) {
+			const std::string path = it->path ().string ();
+			if (it->is_regular_file (error) && path.size () > suffix.size () && path.compare (path.size () - suffix.size (), suffix.size (), suffix) == 0)
+				files.push_back (path);
+		}
+		if (error) {
+			std::fprintf (stderr, "stair_check: 无法遍历目录 %s: %s\n", input.c_str (), error.message ().c_str ());
+			return false;
+		}
+		std::sort (files.begin () + static_cast<std::ptrdiff_t> (first), files.end ());
+	}
+	return true;
+}
+
+// 读取、解析一个导出文件，按栏杆关联扶手高度，设置适用范围（各文件互不影响，可并行）
+void LoadModel (const Options& options, const StairCore::RegulationLibrary& library, ModelInput& input)
+{
+	std::vector<char> bytes;
+	if (!ReadFileBytes (input.path, bytes)) {
+		input.error = "无法读取文件";
+		return;
+	}
+	if (!StairInterchange::ReadModel (bytes.data (), bytes.size (), input.model, input.error))
+		return;
+
+	StairCore::RailingIndex railingIndex;
+	railingIndex.Build (input.model.railings);
+	StairCore::AssignHandrailHeights (input.model.stairs, railingIndex);
+
+	const std::string& jurisdiction = options.jurisdiction.empty () ? input.model.jurisdiction : options.jurisdiction;
+	const std::string& buildingType = options.buildingType.empty () ? input.model.buildingType : options.buildingType;
+	const StairCore::RuleContext context = library.MakeContext (jurisdiction, buildingType);
+	for (StairCore::StairRecord& stair : input.model.stairs)
+		stair.context = context;
+}
+
+void AppendMember (std::string& json, const char* key)
+{
+	json += '"';
+	json += key;
+	json += "\": ";
+}
+
+// 与插件的违规项一致：限值和条文取自给出该限值的规范，低于下限时违反下限，否则违反上限
+void AppendViolations (std::string& json, const StairCore::RegulationLibrary& library, const StairCore::StairRecord& stair, const StairCore::StairEvaluation& evaluation)
+{
+	const StairCore::ResolvedRules& rules = library.Resolve (stair.context);
+
+	json += '[';
+	bool first = true;
+	for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+		const StairCore::RuleKind ruleKind = static_cast<StairCore::RuleKind> (kind);
+		if (!evaluation.IsViolated (ruleKind))
+			continue;
+
+		const StairCore::RuleLimits& limits = rules.ruleSet.rules[kind];
+		const double measured = StairCore::GetMetricValue (evaluation.metrics, ruleKind);
+		const bool belowMin = limits.minValue.has_value () && measured < *limits.minValue;
+
+		json += first ? "" : ", ";
+		first = false;
+		json += "{\"rule\": ";
+		StairInterchange::AppendJsonString (json, RegulationJson::GetRuleKey (ruleKind));
+		json += ", \"measured\": ";
+		StairInterchange::AppendJsonNumber (json, measured);
+		json += ", \"limit\": ";
+		StairInterchange::AppendJsonNumber (json, belowMin ? *limits.minValue : limits.maxValue.value_or (0.0));
+		json += belowMin ? ", \"direction\": \"below_min\"" : ", \"direction\": \"above_max\"";
+
+		const std::uint32_t ruleId = library.GetGoverningRule (rules, ruleKind, evaluation.metrics);
+		if (ruleId != StairCore::kNoRule && ruleId < library.GetRuleCount ()) {
+			const StairCore::RegulationLibrary::Rule& rule = library.GetRule (ruleId);
+			json += ", \"regulation\": ";
+			StairInterchange::AppendJsonString (json, library.GetText (library.GetRegulation (rule.regulation).code));
+			json += ", \"clause\": ";
+			StairInterchange::AppendJsonString (json, library.GetText (rule.source));
+		}
+		json += '}';
+	}
+	json += ']';
+}
+
+void AppendStairResult (std::string& json, const StairCore::RegulationLibrary& library, const std::string& id,
+						const StairCore::StairRecord& stair, const StairCore::StairEvaluation& evaluation)
+{
+	json += "{\"id\": ";
+	StairInterchange::AppendJsonString (json, id);
+	json += ", \"floor\": ";
+	json += std::to_string (stair.floorIndex);
+	json += evaluation.IsCompliant () ? ", \"compliant\": true" : ", \"compliant\": false";
+
+	// 实测值的键名与规范JSON中的规则键名相同，坡度为度，其余为米
+	json += ", \"metrics\": {";
+	for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+		const StairCore::RuleKind ruleKind = static_cast<StairCore::RuleKind> (kind);
+		if (kind > 0)
+			json += ", ";
+		StairInterchange::AppendJsonString (json, RegulationJson::GetRuleKey (ruleKind));
+		json += ": ";
+		StairInterchange::AppendJsonNumber (json, StairCore::GetMetricValue (evaluation.metrics, ruleKind));
+	}
+	json += "}, \"violations\": ";
+	AppendViolations (json, library, stair, evaluation);
+	json += '}';
+}
+
+std::size_t CountNonCompliant (const std::vector<StairCore::StairEvaluation>& evaluations, std::size_t firstRow, std::size_t rowCount)
+{
+	std::size_t count = 0;
+	for (std::size_t row = firstRow; row < firstRow + rowCount; ++row) {
+		if (!evaluations[row].IsCompliant ())
+			++count;
+	}
+	return count;
+}
+
+void WriteResults (const Options& options, const StairCore::RegulationLibrary& library, const std::vector<ModelInput>& inputs,
+				   const std::vector<StairCore::StairRecord>& records, const std::vector<StairCore::StairEvaluation>& evaluations, std::string& json)
+{
+	std::size_t errorCount = 0;
+	std::size_t modelCount = 0;
+	for (const ModelInput& input : inputs) {
+		if (input.error.empty ())
+			++modelCount;
+		else
+			++errorCount;
+	}
+
+	json += "{\n  \"format\": ";
+	StairInterchange::AppendJsonString (json, kResultFormatName);
+	json += ",\n  \"version\": ";
+	json += std::to_string (kResultFormatVersion);
+
+	json += ",\n  \"regulations\": [";
+	for (std::size_t i = 0; i < library.GetRegulationCount (); ++i) {
+		const StairCore::RegulationLibrary::Regulation& regulation = library.GetRegulation (i);
+		json += i > 0 ? ", " : "";
+		json += "{\"name\": ";
+		StairInterchange::AppendJsonString (json, library.GetText (regulation.name));
+		json += ", \"code\": ";
+		StairInterchange::AppendJsonString (json, library.GetText (regulation.code));
+		json += '}';
+	}
+	json += ']';
+
+	json += ",\n  \"summary\": {";
+	AppendMember (json, "models");
+	json += std::to_string (modelCount);
+	json += ", ";
+	AppendMember (json, "stairs");
+	json += std::to_string (records.size ());
+	json += ", ";
+	AppendMember (json, "non_compliant");
+	json += std::to_string (CountNonCompliant (evaluations, 0, records.size ()));
+	json += ", ";
+	AppendMember (json, "errors");
+	json += std::to_string (errorCount);
+	json += '}';
+
+	json += ",\n  \"errors\": [";
+	bool first = true;
+	for (const ModelInput& input : inputs) {
+		if (input.error.empty ())
+			continue;
+		json += first ? "\n    " : ",\n    ";
+		first = false;
+		json += "{\"file\": ";
+		StairInterchange::AppendJsonString (json, input.path);
+		json += ", \"message\": ";
+		StairInterchange::AppendJsonString (json, input.error);
+		json += '}';
+	}
+	json += first ? "]" : "\n  ]";
+
+	json += ",\n  \"models\": [";
+	first = true;
+	for (const ModelInput& input : inputs) {
+		if (!input.error.empty ())
+			continue;
+		const std::size_t stairCount = input.model.stairIds.size ();
+		json += first ? "\n    " : ",\n    ";
+		first = false;
+		json += "{\"file\": ";
+		StairInterchange::AppendJsonString (json, input.path);
+		json += ", \"model\": ";
+		StairInterchange::AppendJsonString (json, input.model.name);
+		json += ", \"stairs\": ";
+		json += std::to_string (stairCount);
+		json += ", \"non_compliant\": ";
+		json += std::to_string (CountNonCompliant (evaluations, input.firstRow, stairCount));
+		json += ", \"results\": [";
+
+		bool firstStair = true;
+		for (std::size_t i = 0; i < stairCount; ++i) {
+			const std::size_t row = input.firstRow + i;
+			const StairCore::StairEvaluation& evaluation = evaluations[row];
+			if (options.violationsOnly && evaluation.IsCompliant ())
+				continue;
+			json += firstStair ? "\n      " : ",\n      ";
+			firstStair = false;
+			AppendStairResult (json, library, input.model.stairIds[i], records[row], evaluation);
+		}
+		json += firstStair ? "]}" : "\n    ]}";
+	}
+	json += first ? "]" : "\n  ]";
+	json += "\n}\n";
+}
+
+bool WriteOutput (const std::string& outputFile, const std::string& json)
+{
+	if (outputFile.empty ())
+		return std::fwrite (json.data (), 1, json.size (), stdout) == json.size ();
+
+	std::ofstream file (outputFile, std::ios::binary | std::ios::trunc);
+	file.write (json.data (), static_cast<std::streamsize> (json.size ()));
+	return static_cast<bool> (file);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions (argc, argv, options)) {
+		PrintUsage ();
+		return ExitError;
+	}
+
+	const auto start = std::chrono::steady_clock::now ();
+
+	StairCore::RegulationLibrary library;
+	if (!LoadRegulations (options, library))
+		return ExitError;
+
+	std::vector<std::string> files;
+	if (!CollectModelFiles (options.inputs, files))
+		return ExitError;
+
+	std::vector<ModelInput> inputs (files.size ());
+	for (std::size_t i = 0; i < files.size (); ++i)
+		inputs[i].path = files[i];
+
+	// 各文件并行读取和解析，然后所有楼梯放入同一个数组并行检测
+	StairCore::WorkStealingPool pool (options.threadCount);
+	auto loadModels = [&] (std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i)
+			LoadModel (options, library, inputs[i]);
+	};
+	pool.ParallelFor (inputs.size (), 1, loadModels);
+
+	// 读取失败的文件只报告错误，其中的楼梯不参与检测和统计
+	std::size_t stairCount = 0;
+	for (ModelInput& input : inputs) {
+		if (!input.error.empty ())
+			input.model.Clear ();
+		input.firstRow = stairCount;
+		stairCount += input.model.stairs.size ();
+	}
+	std::vector<StairCore::StairRecord> records;
+	records.reserve (stairCount);
+	for (ModelInput& input : inputs) {
+		std::move (input.model.stairs.begin (), input.model.stairs.end (), std::back_inserter (records));
+		input.model.stairs.clear ();
+		input.model.railings.clear ();
+	}
+
+	std::vector<StairCore::StairEvaluation> evaluations;
+	StairCore::EvaluateStairs (records, library, evaluations, &pool);
+
+	std::string json;
+	WriteResults (options, library, inputs, records, evaluations, json);
+	if (!WriteOutput (options.outputFile, json)) {
+		std::fprintf (stderr, "stair_check: 无法写入结果 %s\n", options.outputFile.c_str ());
+		return ExitError;
+	}
+
+	std::size_t errorCount = 0;
+	for (const ModelInput& input : inputs) {
+		if (!input.error.empty ()) {
+			std::fprintf (stderr, "stair_check: %s: %s\n", input.path.c_str (), input.error.c_str ());
+			++errorCount;
+		}
+	}
+	const std::size_t nonCompliant = CountNonCompliant (evaluations, 0, records.size ());
+	std::fprintf (stderr, "stair_check: %zu 个文件，%zu 个楼梯，%zu 个违规，%zu 个文件无法读取，用时 %.1f 毫秒（%u 个线程）\n",
+		inputs.size () - errorCount, records.size (), nonCompliant, errorCount,
+		std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count (), pool.GetThreadCount ());
+
+	if (errorCount > 0)
+		return ExitError;
+	return nonCompliant > 0 ? ExitViolations : ExitCompliant;
+}
@@ -6,6 +6,9 @@
 #include "StairCompliance.hpp"
 #include "StairCompliancePalette.hpp"
 #include "RegulationConfig.hpp"
+#include "StairTrace.hpp"
+
+#include <utility>
 
 // 声明全局规范配置（定义在StairCompliance.cpp）
 extern RegulationConfig g_regulationConfig;
@@ -27,6 +30,10 @@ static GS::UniString LoadString (short resId, short index)
 		return GS::UniString (L"楼梯规范校验");
 	if (resId == ID_MENU_PROMPT_STRINGS && index == 1)
 		return GS::UniString (L"按照用户上传的规范校验楼梯是否符合规范");
+	if (resId == ID_MENU_STRINGS && index == 2)
+		return GS::UniString (L"导出楼梯数据");
+	if (resId == ID_MENU_PROMPT_STRINGS && index == 2)
+		return GS::UniString (L"导出楼梯和栏杆数据，供命令行批量检测使用");
 	if (resId == ID_PALETTE_MENU_STRINGS && index == 1)
 		return GS::UniString (L"楼梯规范校验面板");
 	if (resId == ID_PALETTE_PROMPT_STRINGS && index == 1)
@@ -48,6 +55,11 @@ static void WriteReport (const GS::UniString& text, bool addToLog = false)
 	ACAPI_WriteReport (text.ToCStr ().Get (), addToLog);
 }
 
+static void WriteTraceToReport (const char* text)
+{
+	WriteReport (GS::UniString (text, CC_UTF8));
+}
+
 static GS::UniString FormatMillimeters (double meters)
 {
 	GS::UniString value;
@@ -97,6 +109,47 @@ static GS::UniString BuildRegulationText ()
 		hasAnyRule = true;
 	}
 
+	if (g_regulationConfig.narrowTreadDepthRule.HasMinValue ()) {
+		if (hasAnyRule) text += L"；";
+		text += L"踏步窄端宽度 ≥ ";
+		text += FormatMillimeters (g_regulationConfig.narrowTreadDepthRule.minValue.value ());
+		hasAnyRule = true;
+	}
+
+	if (g_regulationConfig.riserVariationRule.HasMaxValue ()) {
+		if (hasAnyRule) text += L"；";
+		text += L"踢面高度差 ≤ ";
+		text += FormatMillimeters (g_regulationConfig.riserVariationRule.maxValue.value ());
+		hasAnyRule = true;
+	}
+
+	if (g_regulationConfig.stairWidthRule.HasMinValue ()) {
+		if (hasAnyRule) text += L"；";
+		text += L"梯段净宽 ≥ ";
+		text += FormatMillimeters (g_regulationConfig.stairWidthRule.minValue.value ());
+		hasAnyRule = true;
+	}
+
+	if (g_regulationConfig.handrailHeightRule.HasMinValue ()) {
+		if (hasAnyRule) text += L"；";
+		text += L"扶手高度 ≥ ";
+		text += FormatMillimeters (g_regulationConfig.handrailHeightRule.minValue.value ());
+		hasAnyRule = true;
+	}
+
+	if (g_regulationConfig.slopeAngleRule.HasMaxValue ()) {
+		if (hasAnyRule) text += L"；";
+		text += GS::UniString::Printf (L"梯段坡度 ≤ %.1lf°", g_regulationConfig.slopeAngleRule.maxValue.value ());
+		hasAnyRule = true;
+	}
+
+	if (g_regulationConfig.betweenFlightsRule.HasMinValue ()) {
+		if (hasAnyRule) text += L"；";
+		text += L"梯段间距 ≥ ";
+		text += FormatMillimeters (g_regulationConfig.betweenFlightsRule.minValue.value ());
+		hasAnyRule = true;
+	}
+
 	if (g_regulationConfig.twoRPlusGRule.HasMinValue () && g_regulationConfig.twoRPlusGRule.HasMaxValue ()) {
 		if (hasAnyRule) text += L"；";
 		text += L"2R+G 范围为 ";
@@ -117,21 +170,20 @@ static GS::UniString BuildRegulationText ()
 static void LogDetailedResults (const GS::Array<StairComplianceResult>& results)
 {
 	for (const StairComplianceResult& result : results) {
-		GS::UniString prefix = result.displayName;
+		const GS::UniString displayName = result.GetDisplayName ();
+		GS::UniString prefix = displayName;
 		prefix.Append (L"：");
 
 		if (!result.violations.IsEmpty ()) {
-			for (const GS::UniString& issue : result.violations) {
+			for (const StairViolation& violation : result.violations) {
 				GS::UniString detail = prefix;
 				detail.Append (L"违规 — ");
-				detail += issue;
-				WriteReport (detail);
-			}
-		} else if (!result.notices.IsEmpty ()) {
-			for (const GS::UniString& notice : result.notices) {
-				GS::UniString detail = prefix;
-				detail.Append (L"提示 — ");
-				detail += notice;
+				detail += FormatViolation (result, violation);
+				const GS::UniString& fullText = violation.GetClause ().fullText;
+				if (!fullText.IsEmpty ()) {
+					detail.Append (L"：");
+					detail += fullText;
+				}
 				WriteReport (detail);
 			}
 		} else {
@@ -140,18 +192,16 @@ static void LogDetailedResults (const GS::Array<StairComplianceResult>& results)
 			WriteReport (okLine);
 		}
 
-		if (!result.metricsSummary.IsEmpty ()) {
-			GS::UniString metricsLine = result.displayName;
-			metricsLine.Append (L" — 实测参数：");
-			metricsLine += result.metricsSummary;
-			WriteReport (metricsLine);
-		}
+		GS::UniString metricsLine = displayName;
+		metricsLine.Append (L" — 实测参数：");
+		metricsLine += result.GetMetricsSummary ();
+		WriteReport (metricsLine);
 	}
 }
 
 static void RunStairComplianceCheck ()
 {
-	const GS::Array<StairComplianceResult> results = EvaluateStairCompliance ();
+	GS::Array<StairComplianceResult> results = EvaluateStairCompliance ();
 
 	StairCompliancePalette& palette = StairCompliancePalette::GetInstance ();
 	palette.EnsureShown ();
@@ -166,7 +216,7 @@ static void RunStairComplianceCheck ()
 	if (!hasValidRegulation) {
 		// 未加载规范，显示警告信息
 		const GS::UniString warningMessage (L"⚠ 未加载规范配置\n\n请按照以下步骤操作：\n1. 准备楼梯规范PDF文件\n2. 运行Python工具生成JSON配置文件\n3. 重新启动ArchiCAD或点击刷新按钮\n\n详细说明请查看ArchiCAD报告窗口。");
-		palette.UpdateResults (results, warningMessage, regulationText);
+		palette.UpdateResults (std::move (results), warningMessage, regulationText);
 		WriteReport (L"━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
 		WriteReport (warningMessage);
 		WriteReport (L"━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
@@ -175,27 +225,20 @@ static void RunStairComplianceCheck ()
 
 	if (results.IsEmpty ()) {
 		const GS::UniString message (L"未检测到楼梯元素，请确认模型中存在可校验的楼梯。");
-		palette.UpdateResults (results, message, regulationText);
+		palette.UpdateResults (std::move (results), message, regulationText);
 		WriteReport (message);
 		WriteReport (regulationText);
 		return;
 	}
 
-	GS::Array<const StairComplianceResult*> nonCompliant;
-	GS::Array<const StairComplianceResult*> needsReview;
-
+	unsigned int nonCompliantCount = 0;
 	for (const StairComplianceResult& result : results) {
-		if (!result.IsCompliant ()) {
-			nonCompliant.Push (&result);
-		} else if (!result.notices.IsEmpty ()) {
-			needsReview.Push (&result);
-		}
+		if (!result.IsCompliant ())
+			++nonCompliantCount;
 	}
 
 	const unsigned int totalCount = static_cast<unsigned int> (results.GetSize ());
-	const unsigned int nonCompliantCount = static_cast<unsigned int> (nonCompliant.GetSize ());
-	const unsigned int reviewCount = static_cast<unsigned int> (needsReview.GetSize ());
-	const unsigned int compliantCount = totalCount - nonCompliantCount - reviewCount;
+	const unsigned int compliantCount = totalCount - nonCompliantCount;
 
 	GS::UniString summary;
 	summary.Append (L"共检测 ");
@@ -203,8 +246,6 @@ static void RunStairComplianceCheck ()
 	summary.Append (L" 个楼梯，其中 ");
 	summary.Append (GS::UniString::Printf ("%u", nonCompliantCount));
 	summary.Append (L" 个存在违规，");
-	summary.Append (GS::UniString::Printf ("%u", reviewCount));
-	summary.Append (L" 个需人工复核，");
 	summary.Append (GS::UniString::Printf ("%u", compliantCount));
 	summary.Append (L" 个符合规范。");
 
@@ -212,7 +253,25 @@ static void RunStairComplianceCheck ()
 	WriteReport (regulationText);
 	LogDetailedResults (results);
 
-	palette.UpdateResults (results, summary, regulationText);
+	// 菜单检测输出完整报告，同时输出环形缓冲区中保存的跟踪记录
+	StairTrace::DumpRingBuffer ();
+
+	palette.UpdateResults (std::move (results), summary, regulationText);
+}
+
+// 导出楼梯交换格式文件，在构建服务器上用stair_check批量检测
+static void RunStairExport ()
+{
+	IO::Location exportedFile;
+	UInt32 stairCount = 0;
+	if (!ExportStairInterchange (IO::Location (GS::UniString (USER_STAIR_EXPORT_FOLDER)), exportedFile, stairCount)) {
+		WriteReport (L"[Stair Compliance] ⚠ 楼梯数据导出失败");
+		return;
+	}
+
+	GS::UniString message = GS::UniString::Printf (L"[Stair Compliance] 已导出 %u 个楼梯：", static_cast<unsigned int> (stairCount));
+	message += exportedFile.ToDisplayText ();
+	WriteReport (message);
 }
 
 } // namespace
@@ -227,6 +286,8 @@ static GSErrCode __ACENV_CALL MenuCommandHandler (const API_MenuParams* menuPara
 
 	if (menuResId == kMenuResId && itemIndex == 1) {
 		RunStairComplianceCheck ();
+	} else if (menuResId == kMenuResId && itemIndex == 2) {
+		RunStairExport ();
 	} else if (menuResId == kPaletteMenuResId && itemIndex == 1) {
 		StairCompliancePalette::GetInstance ().ToggleFromMenu ();
 	}
@@ -270,6 +331,14 @@ GSErrCode __ACENV_CALL Initialize (void)
 	GS::UniString menuText = ExtractMenuCaption (LoadString (kMenuResId, 1));
 	ACAPI_MenuItem_SetMenuItemText (&menuItemRef, nullptr, &menuText);
 
+	API_MenuItemRef exportMenuRef = {};
+	exportMenuRef.menuResID = kMenuResId;
+	exportMenuRef.itemIndex = 2;
+	GSFlags exportFlags = 0;
+	ACAPI_MenuItem_SetMenuItemFlags (&exportMenuRef, &exportFlags, nullptr);
+	GS::UniString exportText = ExtractMenuCaption (LoadString (kMenuResId, 2));
+	ACAPI_MenuItem_SetMenuItemText (&exportMenuRef, nullptr, &exportText);
+
 	API_MenuItemRef paletteMenuRef = {};
 	paletteMenuRef.menuResID = kPaletteMenuResId;
 	paletteMenuRef.itemIndex = 1;
@@ -278,16 +347,25 @@ GSErrCode __ACENV_CALL Initialize (void)
 	GS::UniString paletteText = ExtractMenuCaption (LoadString (kPaletteMenuResId, 1));
 	ACAPI_MenuItem_SetMenuItemText (&paletteMenuRef, nullptr, &paletteText);
 
+	StairTrace::SetSink (WriteTraceToReport);
+
 	err = StairCompliancePalette::RegisterPalette ();
 	if (err != NoError)
 		return err;
 
+	// 订阅楼梯变更通知失败时退回到每次全量检测
+	if (InstallStairChangeObserver (StairCompliancePalette::OnStairsChanged) != NoError)
+		WriteReport (L"[Stair Compliance] 无法订阅楼梯变更通知，增量检测已禁用");
+
 	ACAPI_KeepInMemory (true);
 	return NoError;
 }
 
 GSErrCode __ACENV_CALL FreeData (void)
 {
+	UninstallStairChangeObserver ();
 	StairCompliancePalette::UnregisterPalette ();
+	ShutdownStairEvaluation ();
+	StairTrace::SetSink (nullptr);
 	return NoError;
 }
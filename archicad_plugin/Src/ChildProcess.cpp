@@ -0,0 +1,456 @@
+#include "ChildProcess.hpp"
+
+#ifdef WINDOWS
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <cerrno>
+	#include <csignal>
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <pthread.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace StairCore {
+
+namespace {
+
+#ifdef WINDOWS
+
+// 按CommandLineToArgvW的规则给参数加引号
+std::wstring QuoteArgument (const std::wstring& argument)
+{
+	if (!argument.empty () && argument.find_first_of (L" \t\n\v\"") == std::wstring::npos)
+		return argument;
+
+	std::wstring quoted (1, L'"');
+	std::size_t backslashCount = 0;
+	for (const wchar_t c : argument) {
+		if (c == L'\\') {
+			++backslashCount;
+			continue;
+		}
+		// 引号前的反斜杠要加倍，引号本身再转义
+		quoted.append (c == L'"' ? backslashCount * 2 + 1 : backslashCount, L'\\');
+		quoted += c;
+		backslashCount = 0;
+	}
+	quoted.append (backslashCount * 2, L'\\');
+	quoted += L'"';
+	return quoted;
+}
+
+std::wstring BuildCommandLine (const std::vector<std::wstring>& arguments)
+{
+	std::wstring commandLine;
+	for (const std::wstring& argument : arguments) {
+		if (!commandLine.empty ())
+			commandLine += L' ';
+		commandLine += QuoteArgument (argument);
+	}
+	return commandLine;
+}
+
+void CloseHandleIfValid (void*& handle)
+{
+	if (handle != nullptr && handle != INVALID_HANDLE_VALUE)
+		CloseHandle (handle);
+	handle = nullptr;
+}
+
+#else
+
+void CloseDescriptor (int& descriptor)
+{
+	if (descriptor >= 0)
+		close (descriptor);
+	descriptor = -1;
+}
+
+#endif
+
+} // namespace
+
+std::string WideToUtf8 (const std::wstring& text)
+{
+	std::string result;
+	result.reserve (text.size ());
+	for (std::size_t i = 0; i < text.size (); ++i) {
+		std::uint32_t code = static_cast<std::uint32_t> (text[i]);
+		// UTF-16的代理对（wchar_t为16位时）
+		if (code >= 0xD800 && code < 0xDC00 && i + 1 < text.size ()) {
+			const std::uint32_t low = static_cast<std::uint32_t> (text[i + 1]);
+			if (low >= 0xDC00 && low < 0xE000) {
+				code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				++i;
+			}
+		}
+		if (code < 0x80) {
+			result += static_cast<char> (code);
+		} else if (code < 0x800) {
+			result += static_cast<char> (0xC0 | (code >> 6));
+			result += static_cast<char> (0x80 | (code & 0x3F));
+		} else if (code < 0x10000) {
+			result += static_cast<char> (0xE0 | (code >> 12));
+			result += static_cast<char> (0x80 | ((code >> 6) & 0x3F));
+			result += static_cast<char> (0x80 | (code & 0x3F));
+		} else {
+			result += static_cast<char> (0xF0 | (code >> 18));
+			result += static_cast<char> (0x80 | ((code >> 12) & 0x3F));
+			result += static_cast<char> (0x80 | ((code >> 6) & 0x3F));
+			result += static_cast<char> (0x80 | (code & 0x3F));
+		}
+	}
+	return result;
+}
+
+ChildProcess::~ChildProcess ()
+{
+	Terminate ();
+}
+
+#ifdef WINDOWS
+
+bool ChildProcess::Start (const std::vector<std::wstring>& arguments, const Options& options, std::string& error)
+{
+	if (arguments.empty () || IsStarted ()) {
+		error = "进程已启动或参数为空";
+		return false;
+	}
+
+	SECURITY_ATTRIBUTES inheritable = {};
+	inheritable.nLength = sizeof (inheritable);
+	inheritable.bInheritHandle = TRUE;
+
+	HANDLE outputRead = nullptr;
+	HANDLE outputWrite = nullptr;
+	if (!CreatePipe (&outputRead, &outputWrite, &inheritable, 0)) {
+		error = "无法创建输出管道";
+		return false;
+	}
+	SetHandleInformation (outputRead, HANDLE_FLAG_INHERIT, 0);
+
+	HANDLE inputRead = nullptr;
+	HANDLE inputWrite = nullptr;
+	if (options.pipeInput && CreatePipe (&inputRead, &inputWrite, &inheritable, 0)) {
+		SetHandleInformation (inputWrite, HANDLE_FLAG_INHERIT, 0);
+	} else {
+		inputRead = CreateFileW (L"NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, &inheritable, OPEN_EXISTING, 0, nullptr);
+	}
+
+	HANDLE errorFile = outputWrite;
+	if (!options.errorPath.empty ()) {
+		errorFile = CreateFileW (options.errorPath.c_str (), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE, &inheritable,
+								 OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (errorFile == INVALID_HANDLE_VALUE)
+			errorFile = outputWrite;
+	}
+
+	// 作业对象关闭时结束其中所有进程，ArchiCAD退出时也不会留下子进程
+	HANDLE job = CreateJobObjectW (nullptr, nullptr);
+	if (job != nullptr) {
+		JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+		limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+		SetInformationJobObject (job, JobObjectExtendedLimitInformation, &limits, sizeof (limits));
+	}
+
+	STARTUPINFOW startup = {};
+	startup.cb = sizeof (startup);
+	startup.dwFlags = STARTF_USESTDHANDLES;
+	startup.hStdInput = inputRead != INVALID_HANDLE_VALUE ? inputRead : nullptr;
+	startup.hStdOutput = outputWrite;
+	startup.hStdError = errorFile;
+
+	PROCESS_INFORMATION processInfo = {};
+	std::wstring commandLine = BuildCommandLine (arguments);
+	const BOOL created = CreateProcessW (nullptr, &commandLine[0], nullptr, nullptr, TRUE,
+										 CREATE_NO_WINDOW | CREATE_SUSPENDED, nullptr, nullptr, &startup, &processInfo);
+	const DWORD createError = GetLastError ();
+
+	// 子进程已继承这些句柄，父进程必须关闭自己的副本，否则读不到管道结束
+	if (errorFile != outputWrite)
+		CloseHandle (errorFile);
+	CloseHandle (outputWrite);
+	if (inputRead != nullptr && inputRead != INVALID_HANDLE_VALUE)
+		CloseHandle (inputRead);
+
+	if (!created) {
+		CloseHandle (outputRead);
+		if (inputWrite != nullptr)
+			CloseHandle (inputWrite);
+		if (job != nullptr)
+			CloseHandle (job);
+		char message[96];
+		std::snprintf (message, sizeof (message), "无法启动进程（错误码 %lu）", static_cast<unsigned long> (createError));
+		error = message;
+		return false;
+	}
+
+	if (job != nullptr && !AssignProcessToJobObject (job, processInfo.hProcess)) {
+		CloseHandle (job);
+		job = nullptr;
+	}
+	ResumeThread (processInfo.hThread);
+	CloseHandle (processInfo.hThread);
+
+	process = processInfo.hProcess;
+	jobObject = job;
+	outputPipe = outputRead;
+	inputPipe = inputWrite;
+	return true;
+}
+
+bool ChildProcess::IsStarted () const
+{
+	return process != nullptr;
+}
+
+long ChildProcess::Read (char* buffer, std::size_t size, int waitMilliseconds)
+{
+	if (outputPipe == nullptr)
+		return EndOfOutput;
+
+	const auto deadline = std::chrono::steady_clock::now () + std::chrono::milliseconds (waitMilliseconds);
+	for (;;) {
+		DWORD available = 0;
+		if (!PeekNamedPipe (outputPipe, nullptr, 0, nullptr, &available, nullptr))
+			return EndOfOutput;		// 所有写端都已关闭
+
+		if (available > 0) {
+			DWORD bytesRead = 0;
+			const DWORD toRead = static_cast<DWORD> (std::min<std::size_t> (available, size));
+			if (!ReadFile (outputPipe, buffer, toRead, &bytesRead, nullptr))
+				return EndOfOutput;
+			return static_cast<long> (bytesRead);
+		}
+
+		// 匿名管道不能等待，按短间隔轮询
+		const auto now = std::chrono::steady_clock::now ();
+		if (now >= deadline)
+			return 0;
+		const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds> (deadline - now).count ();
+		Sleep (static_cast<DWORD> (std::min<long long> (remaining, 10)));
+	}
+}
+
+bool ChildProcess::Write (const char* data, std::size_t size)
+{
+	while (inputPipe != nullptr && size > 0) {
+		DWORD written = 0;
+		if (!WriteFile (inputPipe, data, static_cast<DWORD> (std::min<std::size_t> (size, 0x10000)), &written, nullptr))
+			return false;
+		data += written;
+		size -= written;
+	}
+	return inputPipe != nullptr;
+}
+
+bool ChildProcess::HasExited (int& exitCode)
+{
+	if (process == nullptr || WaitForSingleObject (process, 0) != WAIT_OBJECT_0)
+		return false;
+
+	DWORD code = 0;
+	GetExitCodeProcess (process, &code);
+	exitCode = static_cast<int> (code);
+	return true;
+}
+
+void ChildProcess::Terminate ()
+{
+	if (process != nullptr && WaitForSingleObject (process, 0) != WAIT_OBJECT_0) {
+		if (jobObject != nullptr)
+			TerminateJobObject (jobObject, 1);
+		else
+			TerminateProcess (process, 1);
+		WaitForSingleObject (process, INFINITE);
+	}
+
+	CloseHandleIfValid (inputPipe);
+	CloseHandleIfValid (outputPipe);
+	CloseHandleIfValid (process);
+	CloseHandleIfValid (jobObject);		// 仍在作业中的进程（提取工具启动的子进程）随之结束
+}
+
+#else
+
+bool ChildProcess::Start (const std::vector<std::wstring>& arguments, const Options& options, std::string& error)
+{
+	if (arguments.empty () || IsStarted ()) {
+		error = "进程已启动或参数为空";
+		return false;
+	}
+
+	// fork之后只能调用异步信号安全的函数，参数提前转换好
+	std::vector<std::string> utf8Arguments;
+	utf8Arguments.reserve (arguments.size ());
+	for (const std::wstring& argument : arguments)
+		utf8Arguments.push_back (WideToUtf8 (argument));
+	std::vector<char*> argv;
+	for (std::string& argument : utf8Arguments)
+		argv.push_back (&argument[0]);
+	argv.push_back (nullptr);
+	const std::string errorPath = WideToUtf8 (options.errorPath);
+
+	int outputFds[2];
+	if (pipe (outputFds) != 0) {
+		error = "无法创建输出管道";
+		return false;
+	}
+	int inputFds[2] = { -1, -1 };
+	if (options.pipeInput && pipe (inputFds) != 0) {
+		close (outputFds[0]);
+		close (outputFds[1]);
+		error = "无法创建输入管道";
+		return false;
+	}
+	fcntl (outputFds[0], F_SETFD, FD_CLOEXEC);
+	if (inputFds[1] >= 0)
+		fcntl (inputFds[1], F_SETFD, FD_CLOEXEC);
+
+	const pid_t pid = fork ();
+	if (pid == 0) {
+		// 子进程单独成组，结束时连同其子进程一起结束
+		setpgid (0, 0);
+		const int input = inputFds[0] >= 0 ? inputFds[0] : open ("/dev/null", O_RDONLY);
+		if (input >= 0)
+			dup2 (input, STDIN_FILENO);
+		dup2 (outputFds[1], STDOUT_FILENO);
+		const int errorFile = errorPath.empty () ? -1 : open (errorPath.c_str (), O_WRONLY | O_CREAT | O_APPEND, 0644);
+		dup2 (errorFile >= 0 ? errorFile : outputFds[1], STDERR_FILENO);
+		execvp (argv[0], argv.data ());
+		_exit (127);
+	}
+
+	close (outputFds[1]);
+	if (inputFds[0] >= 0)
+		close (inputFds[0]);
+
+	if (pid < 0) {
+		close (outputFds[0]);
+		if (inputFds[1] >= 0)
+			close (inputFds[1]);
+		error = "无法启动进程";
+		return false;
+	}
+	setpgid (pid, pid);
+
+#ifdef F_SETNOSIGPIPE
+	if (inputFds[1] >= 0)
+		fcntl (inputFds[1], F_SETNOSIGPIPE, 1);
+#endif
+
+	processId = pid;
+	outputPipe = outputFds[0];
+	inputPipe = inputFds[1];
+	exitStatus = 0;
+	reaped = false;
+	return true;
+}
+
+bool ChildProcess::IsStarted () const
+{
+	return processId > 0;
+}
+
+long ChildProcess::Read (char* buffer, std::size_t size, int waitMilliseconds)
+{
+	if (outputPipe < 0)
+		return EndOfOutput;
+
+	pollfd readable = { outputPipe, POLLIN, 0 };
+	const int ready = poll (&readable, 1, waitMilliseconds);
+	if (ready <= 0)
+		return 0;
+
+	const ssize_t bytesRead = read (outputPipe, buffer, size);
+	if (bytesRead < 0 && errno == EINTR)
+		return 0;
+	if (bytesRead <= 0) {
+		CloseDescriptor (outputPipe);
+		return EndOfOutput;
+	}
+	return static_cast<long> (bytesRead);
+}
+
+bool ChildProcess::Write (const char* data, std::size_t size)
+{
+	if (inputPipe < 0)
+		return false;
+
+#ifndef F_SETNOSIGPIPE
+	// 子进程已退出时写入会产生SIGPIPE，写入期间在本线程屏蔽该信号
+	sigset_t pipeSignal;
+	sigset_t previousMask;
+	sigemptyset (&pipeSignal);
+	sigaddset (&pipeSignal, SIGPIPE);
+	pthread_sigmask (SIG_BLOCK, &pipeSignal, &previousMask);
+#endif
+
+	bool succeeded = true;
+	while (size > 0) {
+		const ssize_t written = write (inputPipe, data, size);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0) {
+			succeeded = false;
+			break;
+		}
+		data += written;
+		size -= static_cast<std::size_t> (written);
+	}
+
+#ifndef F_SETNOSIGPIPE
+	if (!succeeded) {
+		const timespec noWait = {};
+		sigtimedwait (&pipeSignal, nullptr, &noWait);
+	}
+	pthread_sigmask (SIG_SETMASK, &previousMask, nullptr);
+#endif
+	return succeeded;
+}
+
+bool ChildProcess::HasExited (int& exitCode)
+{
+	if (processId <= 0)
+		return false;
+
+	if (!reaped) {
+		if (waitpid (processId, &exitStatus, WNOHANG) != processId)
+			return false;
+		reaped = true;
+	}
+	exitCode = WIFEXITED (exitStatus) ? WEXITSTATUS (exitStatus) : -1;
+	return true;
+}
+
+void ChildProcess::Terminate ()
+{
+	// 进程已退出时也结束进程组，不留下它启动的进程
+	if (processId > 0) {
+		kill (-processId, SIGKILL);
+		if (!reaped)
+			waitpid (processId, &exitStatus, 0);
+	}
+
+	CloseDescriptor (inputPipe);
+	CloseDescriptor (outputPipe);
+	processId = -1;
+	reaped = false;
+}
+
+#endif
+
+} // namespace StairCore
@@ -0,0 +1,73 @@
+#ifndef CHILD_PROCESS_HPP
+#define CHILD_PROCESS_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace StairCore {
+
+/**
+ * 子进程（与ArchiCAD无关）
+ *
+ * 不经过shell直接启动程序，标准输出经管道读取。Windows下进程放入作业对象，
+ * 其他平台下进程单独成组，Terminate和析构时连同其启动的子进程一起结束。
+ * Read和HasExited只应由一个线程调用；Write可以在另一个线程中调用，但与Terminate之间需要调用方同步。
+ */
+class ChildProcess {
+public:
+	struct Options {
+		bool			pipeInput = false;		// 为true时可以通过Write写入标准输入，否则标准输入为空设备
+		std::wstring	errorPath;				// 非空时标准错误追加到该文件，否则与标准输出合并
+	};
+
+	// Read的返回值：管道已关闭且没有剩余数据
+	static constexpr long	EndOfOutput = -1;
+
+	ChildProcess () = default;
+	~ChildProcess ();
+
+	ChildProcess (const ChildProcess&) = delete;
+	ChildProcess& operator= (const ChildProcess&) = delete;
+
+	// arguments[0] 为程序名（按PATH查找），失败时error给出原因（UTF-8）
+	bool			Start (const std::vector<std::wstring>& arguments, const Options& options, std::string& error);
+	bool			IsStarted () const;
+
+	/**
+	 * 读取标准输出中已有的数据，没有数据时最多等待waitMilliseconds。
+	 * 返回读到的字节数（可能为0），管道已关闭时返回EndOfOutput。
+	 * 只读取已有的数据：子进程启动的进程可能仍持有管道，阻塞读取会等不到结束。
+	 */
+	long			Read (char* buffer, std::size_t size, int waitMilliseconds);
+
+	// 写入标准输入（需要Options::pipeInput），子进程已结束时返回false
+	bool			Write (const char* data, std::size_t size);
+
+	// 进程已结束时返回true并给出退出码（被结束的进程为-1或1）
+	bool			HasExited (int& exitCode);
+
+	// 结束进程及其启动的进程（已退出时只回收），等待其退出并释放所有句柄，之后可以再次Start
+	void			Terminate ();
+
+private:
+#ifdef WINDOWS
+	void*			process = nullptr;
+	void*			jobObject = nullptr;
+	void*			outputPipe = nullptr;
+	void*			inputPipe = nullptr;
+#else
+	int				processId = -1;
+	int				outputPipe = -1;
+	int				inputPipe = -1;
+	int				exitStatus = 0;
+	bool			reaped = false;
+#endif
+};
+
+// 宽字符串（Windows下为UTF-16，其他平台为UTF-32）转换为UTF-8
+std::string		WideToUtf8 (const std::wstring& text);
+
+} // namespace StairCore
+
+#endif
@@ -0,0 +1,158 @@
+#include "RegulationCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+namespace StairCore {
+
+namespace {
+
+constexpr char kMagic[4] = { 'B', 'C', 'C', 'R' };
+
+struct CacheHeader {
+	char			magic[4];
+	std::uint32_t	version;
+	std::uint32_t	headerSize;
+	std::uint32_t	reserved;
+	std::uint64_t	sourceModificationTime;
+	std::uint64_t	sourceSize;
+	std::uint64_t	sourceHash;
+	std::uint64_t	payloadSize;
+	std::uint64_t	payloadChecksum;
+	std::uint64_t	folderStamp;		// 版本3的缓存此处为0，与空的规范目录一致
+};
+
+static_assert (sizeof (CacheHeader) == 64, "缓存文件头必须是64字节");
+
+constexpr std::uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr std::uint64_t kFnvPrime = 1099511628211ull;
+
+} // namespace
+
+std::uint64_t HashContent (const char* data, std::size_t size)
+{
+	std::uint64_t hash = kFnvOffset ^ size;
+
+	std::size_t offset = 0;
+	for (; offset + sizeof (std::uint64_t) <= size; offset += sizeof (std::uint64_t)) {
+		std::uint64_t word = 0;
+		std::memcpy (&word, data + offset, sizeof (word));
+		hash = (hash ^ word) * kFnvPrime;
+	}
+	for (; offset < size; ++offset)
+		hash = (hash ^ static_cast<unsigned char> (data[offset])) * kFnvPrime;
+
+	return hash ^ (hash >> 32);
+}
+
+void WriteRegulationCache (const RegulationLibrary& library, const SourceStamp& stamp, std::uint64_t folderStamp, std::vector<char>& out)
+{
+	std::vector<char> payload;
+	library.Serialize (payload);
+
+	CacheHeader header {};
+	std::memcpy (header.magic, kMagic, sizeof (kMagic));
+	header.version = kRegulationCacheVersion;
+	header.headerSize = sizeof (CacheHeader);
+	header.sourceModificationTime = stamp.modificationTime;
+	header.sourceSize = stamp.size;
+	header.sourceHash = stamp.contentHash;
+	header.payloadSize = payload.size ();
+	header.payloadChecksum = HashContent (payload.data (), payload.size ());
+	header.folderStamp = folderStamp;
+
+	out.resize (sizeof (CacheHeader) + payload.size ());
+	std::memcpy (out.data (), &header, sizeof (CacheHeader));
+	if (!payload.empty ())
+		std::memcpy (out.data () + sizeof (CacheHeader), payload.data (), payload.size ());
+}
+
+CacheStatus ReadRegulationCache (const char* data, std::size_t size, RegulationLibrary& library, SourceStamp& stamp, std::uint64_t& folderStamp)
+{
+	library.Clear ();
+
+	if (size < sizeof (CacheHeader))
+		return CacheStatus::TooShort;
+
+	CacheHeader header;
+	std::memcpy (&header, data, sizeof (CacheHeader));
+	if (std::memcmp (header.magic, kMagic, sizeof (kMagic)) != 0)
+		return CacheStatus::BadMagic;
+	if (header.version != kRegulationCacheVersion || header.headerSize != sizeof (CacheHeader))
+		return CacheStatus::VersionMismatch;
+	if (header.payloadSize != size - sizeof (CacheHeader))
+		return CacheStatus::TooShort;
+
+	const char* payload = data + sizeof (CacheHeader);
+	const std::size_t payloadSize = size - sizeof (CacheHeader);
+	if (HashContent (payload, payloadSize) != header.payloadChecksum)
+		return CacheStatus::ChecksumMismatch;
+
+	if (!library.Deserialize (payload, payloadSize))
+		return CacheStatus::InvalidPayload;
+
+	stamp.modificationTime = header.sourceModificationTime;
+	stamp.size = header.sourceSize;
+	stamp.contentHash = header.sourceHash;
+	folderStamp = header.folderStamp;
+	return CacheStatus::Loaded;
+}
+
+void ListRegulationFolder (const std::filesystem::path& folder, std::vector<RegulationFolderEntry>& entries)
+{
+	entries.clear ();
+
+	std::error_code error;
+	for (std::filesystem::directory_iterator it (folder, error), end; !error && it != end; it.increment (error)) {
+		// 读取失败的文件（如正在被替换）跳过，目录标记随之不同，下次启动时重新合并
+		std::error_code entryError;
+		if (!it->is_regular_file (entryError) || it->path ().extension () != ".json")
+			continue;
+
+		RegulationFolderEntry entry;
+		entry.path = it->path ();
+		entry.modificationTime = static_cast<std::uint64_t> (it->last_write_time (entryError).time_since_epoch ().count ());
+		if (!entryError)
+			entry.size = static_cast<std::uint64_t> (it->file_size (entryError));
+		if (!entryError)
+			entries.push_back (std::move (entry));
+	}
+
+	std::sort (entries.begin (), entries.end (), [] (const RegulationFolderEntry& a, const RegulationFolderEntry& b) {
+		return a.modificationTime != b.modificationTime ? a.modificationTime < b.modificationTime : a.path.filename () < b.path.filename ();
+	});
+}
+
+std::uint64_t HashRegulationFolder (const std::vector<RegulationFolderEntry>& entries)
+{
+	if (entries.empty ())
+		return 0;
+
+	std::string key;
+	for (const RegulationFolderEntry& entry : entries) {
+		const std::filesystem::path::string_type name = entry.path.filename ().native ();
+		const std::uint64_t nameLength = name.size ();
+		key.append (reinterpret_cast<const char*> (&nameLength), sizeof (nameLength));
+		key.append (reinterpret_cast<const char*> (name.data ()), name.size () * sizeof (name[0]));
+		key.append (reinterpret_cast<const char*> (&entry.modificationTime), sizeof (entry.modificationTime));
+		key.append (reinterpret_cast<const char*> (&entry.size), sizeof (entry.size));
+	}
+	return HashContent (key.data (), key.size ());
+}
+
+const char* GetCacheStatusText (CacheStatus status)
+{
+	switch (status) {
+		case CacheStatus::Loaded:			return "已加载";
+		case CacheStatus::TooShort:			return "文件不完整";
+		case CacheStatus::BadMagic:			return "不是规范缓存文件";
+		case CacheStatus::VersionMismatch:	return "缓存版本不同";
+		case CacheStatus::ChecksumMismatch:	return "校验和不符";
+		case CacheStatus::InvalidPayload:	return "内容无效";
+	}
+	return "未知";
+}
+
+} // namespace StairCore
@@ -0,0 +1,72 @@
+#ifndef REGULATION_CACHE_HPP
+#define REGULATION_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "RegulationLibrary.hpp"
+
+/**
+ * 规范库二进制缓存（与ArchiCAD无关）
+ *
+ * 文件由定长文件头和 RegulationLibrary::Serialize 的内容组成：
+ *   magic "BCCR" | 版本 | 文件头长度 | 源JSON标记（修改时间、长度、内容哈希）| 内容长度 | 内容校验和 | 规范目录标记
+ * 启动时一次读入整个文件即可恢复规范库，源JSON未变化时不再解析JSON。
+ * 版本不同、校验和不符或内容无效时视为没有缓存。
+ *
+ * 缓存只是派生数据：规范库由规范目录中的JSON（每个上传的规范一个文件）按上传顺序合并而成，
+ * 缓存不可用或规范目录标记与目录当前内容不同时，按 ListRegulationFolder 的顺序重新合并即可恢复。
+ */
+namespace StairCore {
+
+// 缓存内容按RuleKindCount存放，规则类别变化时须增加版本号（2：踏步窄端宽度、踢面高度差；3：防火规范四项）
+constexpr std::uint32_t kRegulationCacheVersion = 3;
+
+// 源JSON文件的标记，用于判断JSON是否需要重新解析
+struct SourceStamp {
+	std::uint64_t	modificationTime = 0;
+	std::uint64_t	size = 0;
+	std::uint64_t	contentHash = 0;
+
+	// 修改时间和长度都相同时认为文件未变化，无需读取内容
+	bool			SameFile (const SourceStamp& other) const { return modificationTime == other.modificationTime && size == other.size; }
+};
+
+// 规范目录中的一个JSON文件
+struct RegulationFolderEntry {
+	std::filesystem::path	path;
+	std::uint64_t			modificationTime = 0;
+	std::uint64_t			size = 0;
+};
+
+enum class CacheStatus {
+	Loaded,
+	TooShort,
+	BadMagic,
+	VersionMismatch,
+	ChecksumMismatch,
+	InvalidPayload
+};
+
+// 文件内容的64位哈希（FNV-1a，按8字节分组）
+std::uint64_t	HashContent (const char* data, std::size_t size);
+
+// folderStamp 为合并时规范目录的标记（HashRegulationFolder）
+void			WriteRegulationCache (const RegulationLibrary& library, const SourceStamp& stamp, std::uint64_t folderStamp, std::vector<char>& out);
+
+// 读取失败时规范库被清空
+CacheStatus		ReadRegulationCache (const char* data, std::size_t size, RegulationLibrary& library, SourceStamp& stamp, std::uint64_t& folderStamp);
+
+// 列出目录中的*.json，按修改时间从早到晚（即上传顺序，相同时按文件名）排列；目录不存在时为空
+void			ListRegulationFolder (const std::filesystem::path& folder, std::vector<RegulationFolderEntry>& entries);
+
+// 文件名、修改时间和长度的组合标记，文件增加、删除或修改时变化；没有文件时为0
+std::uint64_t	HashRegulationFolder (const std::vector<RegulationFolderEntry>& entries);
+
+const char*		GetCacheStatusText (CacheStatus status);
+
+} // namespace StairCore
+
+#endif
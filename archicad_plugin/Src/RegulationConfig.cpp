@@ -1,299 +1,330 @@
 #include "RegulationConfig.hpp"
 #include "File.hpp"
+#include "FileSystem.hpp"
+#include "StairTrace.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * 读取整个文件的原始字节
+ * 先按文件长度分配一次缓冲区，再循环ReadBin直到读满（小文件第一次读取就可能返回EOF，
+ * 因此以读到的字节数判断是否继续）。不做编码转换，多字节字符不会被分块截断。
+ */
+static bool ReadFileBytes (IO::File& file, std::vector<char>& bytes) {
+    UInt64 length = 0;
+    if (file.GetDataLength (&length) != NoError)
+        return false;
+    if (length > static_cast<UInt64> (std::numeric_limits<USize>::max ()))
+        return false;
+
+    bytes.resize (static_cast<std::size_t> (length));
+
+    std::size_t offset = 0;
+    while (offset < bytes.size ()) {
+        USize bytesRead = 0;
+        const GSErrCode err = file.ReadBin (bytes.data () + offset, static_cast<USize> (bytes.size () - offset), &bytesRead);
+        offset += bytesRead;
+        if (bytesRead == 0 || (err != NoError && offset < bytes.size ()))
+            break;
+    }
+
+    // 文件在读取过程中变短时只保留实际读到的部分
+    bytes.resize (offset);
+    return true;
+}
 
 RegulationConfig RegulationConfig::LoadFromJSON(const IO::Location& jsonPath) {
-    RegulationConfig config;
+    std::vector<RegulationJson::RegulationRecord> regulations;
+    if (!LoadRecordsFromJSON (jsonPath, regulations))
+        return GetDefault();
+
+    RegulationConfig config = FromRecord (regulations[0]);
+
+    // 如果regulation_name解析失败，使用默认名称（但仍然使用成功解析的规则值）
+    if (config.regulationName.IsEmpty()) {
+        config.regulationName = L"已提取规范";
+        ACAPI_WriteReport(L"[RegulationConfig] ⚠ regulation_name解析失败，使用默认名称，但规则值已成功加载\n", false);
+    }
+    if (config.regulationCode.IsEmpty()) {
+        config.regulationCode = L"从PDF提取";
+    }
 
+    return config;
+}
+
+bool RegulationConfig::LoadRecordsFromJSON(const IO::Location& jsonPath, std::vector<RegulationJson::RegulationRecord>& regulations) {
+    regulations.clear ();
+
+    std::vector<char> jsonBytes;
+    if (!ReadJSONFile (jsonPath, jsonBytes))
+        return false;
+
+    return ParseRecords (jsonBytes, regulations);
+}
+
+bool RegulationConfig::ReadJSONFile(const IO::Location& jsonPath, std::vector<char>& jsonBytes) {
+    jsonBytes.clear ();
+
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_STAIR
     // 调试：输出正在读取的文件路径
     GS::UniString debugMsg = L"\n[LoadFromJSON] 尝试加载JSON文件:\n  路径: ";
     debugMsg += USER_REGULATION_JSON_PATH;
     debugMsg += L"\n";
     ACAPI_WriteReport(debugMsg.ToCStr().Get(), false);
+#endif
 
     try {
-        // 读取JSON文件
         IO::File jsonFile (jsonPath);
         GSErrCode err = jsonFile.Open (IO::File::ReadMode);
         if (err != NoError || !jsonFile.IsOpen ()) {
             GS::UniString errMsg;
             errMsg.Printf(L"[LoadFromJSON] ✗ 文件打开失败, GSErrCode=%d\n", (int)err);
             ACAPI_WriteReport(errMsg.ToCStr().Get(), false);
-            return GetDefault();
-        }
-
-        ACAPI_WriteReport(L"[LoadFromJSON] ✓ 文件打开成功\n", false);
-
-        // 读取文件内容（明确指定UTF-8编码）
-        GS::UniString jsonContent;
-        char buffer[4096];
-        USize bytesRead = 0;
-        USize totalBytesRead = 0;
-        int readCount = 0;
-
-        ACAPI_WriteReport(L"[LoadFromJSON] 准备开始读取文件内容...\n", false);
-
-        GSErrCode readErr = jsonFile.ReadBin (buffer, sizeof(buffer) - 1, &bytesRead);
-
-        GS::UniString firstReadDebug = L"[LoadFromJSON] 第一次ReadBin调用: err=" + GS::UniString::Printf(L"%d", (int)readErr) +
-                                       L", bytesRead=" + GS::UniString::Printf(L"%d", (int)bytesRead) + L"\n";
-        ACAPI_WriteReport(firstReadDebug.ToCStr().Get(), false);
-
-        // 关键修复：只要读取到数据就处理，不管是否EOF（小文件第一次读取就会返回EOF）
-        if (bytesRead > 0) {
-            buffer[bytesRead] = '\0';
-            GS::UniString chunk(buffer, CC_UTF8);  // 明确指定UTF-8编码
-            jsonContent.Append(chunk);
-            totalBytesRead += bytesRead;
-            readCount++;
-
-            ACAPI_WriteReport(L"[LoadFromJSON] ✓ 第一次读取的数据已处理\n", false);
-
-            // 继续读取剩余内容（如果有的话）
-            while (jsonFile.ReadBin (buffer, sizeof(buffer) - 1, &bytesRead) == NoError && bytesRead > 0) {
-                buffer[bytesRead] = '\0';
-                GS::UniString chunk2(buffer, CC_UTF8);
-                jsonContent.Append(chunk2);
-                totalBytesRead += bytesRead;
-                readCount++;
-            }
-        } else {
-            ACAPI_WriteReport(L"[LoadFromJSON] ✗ 第一次ReadBin没有读取到数据\n", false);
+            return false;
         }
 
+        // 按文件长度一次分配并读入原始UTF-8字节，不经过UniString
+        const bool readOk = ReadFileBytes (jsonFile, jsonBytes);
         jsonFile.Close ();
 
-        GS::UniString sizeDebug = L"[LoadFromJSON] 文件读取完成: 总共读取" + GS::UniString::Printf(L"%d", (int)totalBytesRead) +
-                                  L"字节, jsonContent长度=" + GS::UniString::Printf(L"%d", (int)jsonContent.GetLength()) + L"字符\n";
-        ACAPI_WriteReport(sizeDebug.ToCStr().Get(), false);
+        if (!readOk || jsonBytes.empty ()) {
+            ACAPI_WriteReport(L"[LoadFromJSON] ✗ 没有读取到文件内容\n", false);
+            return false;
+        }
 
-        // 调试：输出JSON内容预览（前500字符）
-        GS::UniString preview = jsonContent.GetSubstring(0, std::min(500, (int)jsonContent.GetLength()));
-        GS::UniString previewMsg = L"[LoadFromJSON] JSON内容预览（前500字符）:\n";
-        previewMsg += preview;
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_STAIR
+        // 调试：输出JSON内容预览（前500字节，截断在UTF-8字符边界上）
+        std::size_t previewLength = std::min<std::size_t> (jsonBytes.size (), 500);
+        while (previewLength > 0 && previewLength < jsonBytes.size () && (static_cast<unsigned char> (jsonBytes[previewLength]) & 0xC0) == 0x80)
+            --previewLength;
+        GS::UniString previewMsg = GS::UniString::Printf (L"[LoadFromJSON] 文件读取完成: 共%u字节，内容预览（前500字节）:\n", (unsigned int) jsonBytes.size ());
+        previewMsg += GS::UniString (std::string (jsonBytes.data (), previewLength).c_str (), CC_UTF8);
         previewMsg += L"\n...\n";
         ACAPI_WriteReport(previewMsg.ToCStr().Get(), false);
+#endif
+
+        return true;
+
+    } catch (...) {
+        jsonBytes.clear ();
+        return false;
+    }
+}
+
+bool RegulationConfig::ParseRecords(const std::vector<char>& jsonBytes, std::vector<RegulationJson::RegulationRecord>& regulations) {
+    regulations.clear ();
 
-        // 简单的JSON解析（手动解析关键字段）
-        // 提取regulation_name
-        Int32 nameStart = jsonContent.FindFirst (L"\"regulation_name\"");
-        if (nameStart >= 0) {
-            Int32 valueStart = jsonContent.FindFirst (L":", nameStart) + 1;
-            Int32 quoteStart = jsonContent.FindFirst (L"\"", valueStart) + 1;
-            Int32 quoteEnd = jsonContent.FindFirst (L"\"", quoteStart);
-            if (quoteStart > 0 && quoteEnd > quoteStart) {
-                config.regulationName = jsonContent.GetSubstring (quoteStart, quoteEnd - quoteStart);
-            }
+    try {
+        // 单次遍历解析JSON（RegulationJson），字符串直接引用jsonBytes
+        RegulationJson::Document document;
+        if (!document.Parse (jsonBytes.data (), jsonBytes.size ())) {
+            const RegulationJson::ParseError& parseError = document.GetError ();
+            GS::UniString errMsg = L"[RegulationConfig] JSON格式错误: ";
+            errMsg += GS::UniString (parseError.message, CC_UTF8);
+            errMsg += GS::UniString::Printf (L"（第%u行，第%u列，偏移%u字节）\n",
+                (unsigned int) parseError.line, (unsigned int) parseError.column, (unsigned int) parseError.offset);
+            ACAPI_WriteReport(errMsg.ToCStr().Get(), false);
+            return false;
         }
 
-        // 提取regulation_code
-        Int32 codeStart = jsonContent.FindFirst (L"\"regulation_code\"");
-        if (codeStart >= 0) {
-            Int32 valueStart = jsonContent.FindFirst (L":", codeStart) + 1;
-            Int32 quoteStart = jsonContent.FindFirst (L"\"", valueStart) + 1;
-            Int32 quoteEnd = jsonContent.FindFirst (L"\"", quoteStart);
-            if (quoteStart > 0 && quoteEnd > quoteStart) {
-                config.regulationCode = jsonContent.GetSubstring (quoteStart, quoteEnd - quoteStart);
-            }
+        bool hasAnyRule = false;
+        if (RegulationJson::ReadRegulations (document, regulations)) {
+            for (const RegulationJson::RegulationRecord& regulation : regulations)
+                hasAnyRule = hasAnyRule || regulation.HasAnyRule ();
+        }
+        if (!hasAnyRule) {
+            ACAPI_WriteReport(L"[RegulationConfig] JSON解析失败：没有规则被成功解析\n", false);
+            regulations.clear ();
+            return false;
         }
 
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_STAIR
         // 调试：输出解析的基本信息
         GS::UniString basicInfo = L"\n[LoadFromJSON] 解析基本信息:\n";
         basicInfo += L"  regulation_name: ";
-        basicInfo += config.regulationName.IsEmpty() ? L"(空)" : config.regulationName;
+        basicInfo += regulations[0].name.empty () ? GS::UniString (L"(空)") : GS::UniString (regulations[0].name.c_str (), CC_UTF8);
         basicInfo += L"\n  regulation_code: ";
-        basicInfo += config.regulationCode.IsEmpty() ? L"(空)" : config.regulationCode;
-        basicInfo += L"\n";
+        basicInfo += regulations[0].code.empty () ? GS::UniString (L"(空)") : GS::UniString (regulations[0].code.c_str (), CC_UTF8);
+        basicInfo += GS::UniString::Printf (L"\n  规范数: %u\n  JSON节点数: %u\n",
+            (unsigned int) regulations.size (), (unsigned int) document.GetValueCount ());
         ACAPI_WriteReport(basicInfo.ToCStr().Get(), false);
+#endif
 
-        // 解析规则
-        ACAPI_WriteReport(L"[LoadFromJSON] 准备调用ParseRule解析规则...\n", false);
-        config.riserHeightRule = ParseRule (jsonContent, L"riser_height");
-        ACAPI_WriteReport(L"[LoadFromJSON] riser_height解析完成\n", false);
-
-        config.treadDepthRule = ParseRule (jsonContent, L"tread_depth");
-        ACAPI_WriteReport(L"[LoadFromJSON] tread_depth解析完成\n", false);
+        return true;
 
-        config.twoRPlusGRule = ParseRule (jsonContent, L"two_r_plus_g");
-        ACAPI_WriteReport(L"[LoadFromJSON] two_r_plus_g解析完成\n", false);
-
-        config.landingLengthRule = ParseRule (jsonContent, L"landing_length");
-        ACAPI_WriteReport(L"[LoadFromJSON] landing_length解析完成\n", false);
-
-        // 验证至少有一个规则被成功解析（这是关键，不强制要求regulation_name）
-        bool hasAnyRule = config.riserHeightRule.HasMinValue() ||
-                          config.riserHeightRule.HasMaxValue() ||
-                          config.treadDepthRule.HasMinValue() ||
-                          config.treadDepthRule.HasMaxValue() ||
-                          config.twoRPlusGRule.HasMinValue() ||
-                          config.twoRPlusGRule.HasMaxValue();
-
-        if (!hasAnyRule) {
-            GS::UniString msg = L"[RegulationConfig] JSON解析失败：没有规则被成功解析\n";
-            msg += L"  riser_height maxValue: ";
-            msg += config.riserHeightRule.HasMaxValue() ? L"有" : L"无";
-            msg += L"\n  tread_depth minValue: ";
-            msg += config.treadDepthRule.HasMinValue() ? L"有" : L"无";
-            ACAPI_WriteReport(msg.ToCStr().Get(), false);
-            return GetDefault();
-        }
+    } catch (...) {
+        // 解析失败
+        regulations.clear ();
+        return false;
+    }
+}
 
-        // 如果regulation_name解析失败，使用默认名称（但仍然使用成功解析的规则值）
-        if (config.regulationName.IsEmpty()) {
-            config.regulationName = L"已提取规范";
-            ACAPI_WriteReport(L"[RegulationConfig] ⚠ regulation_name解析失败，使用默认名称，但规则值已成功加载\n", false);
-        }
-        if (config.regulationCode.IsEmpty()) {
-            config.regulationCode = L"从PDF提取";
-        }
+bool RegulationConfig::GetSourceStamp(const IO::Location& jsonPath, StairCore::SourceStamp& stamp) {
+    stamp = StairCore::SourceStamp ();
+
+    GSTime modificationTime = 0;
+    if (IO::fileSystem.GetItemModificationTime (jsonPath, &modificationTime) != NoError)
+        return false;
+
+    IO::File jsonFile (jsonPath);
+    if (jsonFile.Open (IO::File::ReadMode) != NoError)
+        return false;
+    UInt64 length = 0;
+    const GSErrCode err = jsonFile.GetDataLength (&length);
+    jsonFile.Close ();
+    if (err != NoError)
+        return false;
+
+    stamp.modificationTime = static_cast<std::uint64_t> (modificationTime);
+    stamp.size = length;
+    return true;
+}
 
-        return config;
+bool RegulationConfig::LoadLibraryCache(const IO::Location& cachePath, StairCore::RegulationLibrary& library, StairCore::SourceStamp& stamp, std::uint64_t& folderStamp) {
+    library.Clear ();
+
+    IO::File cacheFile (cachePath);
+    if (cacheFile.Open (IO::File::ReadMode) != NoError)
+        return false;
+
+    std::vector<char> cacheBytes;
+    const bool readOk = ReadFileBytes (cacheFile, cacheBytes);
+    cacheFile.Close ();
+    if (!readOk)
+        return false;
+
+    const StairCore::CacheStatus status = StairCore::ReadRegulationCache (cacheBytes.data (), cacheBytes.size (), library, stamp, folderStamp);
+    if (status != StairCore::CacheStatus::Loaded) {
+        GS::UniString msg = L"[RegulationConfig] 规范缓存不可用（";
+        msg += GS::UniString (StairCore::GetCacheStatusText (status), CC_UTF8);
+        msg += L"），将从规范目录和JSON重新合并\n";
+        ACAPI_WriteReport(msg.ToCStr().Get(), false);
+        return false;
+    }
+    return true;
+}
 
-    } catch (...) {
-        // 解析失败,返回默认配置
-        return GetDefault();
+bool RegulationConfig::SaveLibraryCache(const IO::Location& cachePath, const StairCore::RegulationLibrary& library, const StairCore::SourceStamp& stamp, std::uint64_t folderStamp) {
+    std::vector<char> cacheBytes;
+    StairCore::WriteRegulationCache (library, stamp, folderStamp, cacheBytes);
+    if (cacheBytes.size () > static_cast<std::size_t> (std::numeric_limits<USize>::max ()))
+        return false;
+
+    IO::File cacheFile (cachePath, IO::File::Create);
+    if (cacheFile.Open (IO::File::WriteEmptyMode) != NoError)
+        return false;
+
+    const GSErrCode err = cacheFile.WriteBin (cacheBytes.data (), static_cast<USize> (cacheBytes.size ()));
+    cacheFile.Close ();
+    if (err != NoError) {
+        ACAPI_WriteReport(L"[RegulationConfig] ⚠ 规范缓存写入失败\n", false);
+        return false;
     }
+    return true;
 }
 
-// 辅助函数：解析单个规则
-RegulationRule RegulationConfig::ParseRule(const GS::UniString& jsonContent, const GS::UniString& ruleName) {
+static RegulationRule ToRegulationRule (const RegulationJson::RuleRecord& record) {
     RegulationRule rule;
+    rule.minValue = record.minValue;
+    rule.maxValue = record.maxValue;
+    rule.unit = GS::UniString (record.unit.c_str (), CC_UTF8);
+    rule.source = GS::UniString (record.source.c_str (), CC_UTF8);
+    rule.fullText = GS::UniString (record.fullText.c_str (), CC_UTF8);
+    return rule;
+}
 
-    GS::UniString enterMsg = L"\n[ParseRule] 开始解析规则: " + ruleName + L"\n";
-    ACAPI_WriteReport(enterMsg.ToCStr().Get(), false);
+RegulationConfig RegulationConfig::FromRecord(const RegulationJson::RegulationRecord& record) {
+    RegulationConfig config;
+    config.regulationName = GS::UniString (record.name.c_str (), CC_UTF8);
+    config.regulationCode = GS::UniString (record.code.c_str (), CC_UTF8);
+
+    config.riserHeightRule = ToRegulationRule (record.rules[StairCore::RiserHeightRule]);
+    config.treadDepthRule = ToRegulationRule (record.rules[StairCore::TreadDepthRule]);
+    config.twoRPlusGRule = ToRegulationRule (record.rules[StairCore::TwoRPlusGoingRule]);
+    config.landingLengthRule = ToRegulationRule (record.rules[StairCore::LandingLengthRule]);
+    config.narrowTreadDepthRule = ToRegulationRule (record.rules[StairCore::NarrowTreadDepthRule]);
+    config.riserVariationRule = ToRegulationRule (record.rules[StairCore::RiserVariationRule]);
+    config.stairWidthRule = ToRegulationRule (record.rules[StairCore::StairWidthRule]);
+    config.handrailHeightRule = ToRegulationRule (record.rules[StairCore::HandrailHeightRule]);
+    config.slopeAngleRule = ToRegulationRule (record.rules[StairCore::SlopeAngleRule]);
+    config.betweenFlightsRule = ToRegulationRule (record.rules[StairCore::FlightSpacingRule]);
+    return config;
+}
 
-    // 查找规则块
-    GS::UniString searchKey = L"\"" + ruleName + L"\"";
-    Int32 ruleStart = jsonContent.FindFirst (searchKey);
-    if (ruleStart < 0) {
-        GS::UniString notFoundMsg = L"[ParseRule] " + ruleName + L": 在JSON中未找到此键\n";
-        ACAPI_WriteReport(notFoundMsg.ToCStr().Get(), false);
-        return rule;
-    }
+static void AppendRuleText (GS::UniString& target, std::string_view text) {
+    if (text.empty ())
+        return;
 
-    // 查找规则块的结束位置（下一个}）
-    Int32 blockStart = jsonContent.FindFirst (L"{", ruleStart);
-    Int32 blockEnd = jsonContent.FindFirst (L"}", blockStart);
-    if (blockStart < 0 || blockEnd < 0) return rule;
-
-    GS::UniString ruleBlock = jsonContent.GetSubstring (blockStart, blockEnd - blockStart);
-
-    // 解析min_value
-    Int32 minPos = ruleBlock.FindFirst (L"\"min_value\"");
-    if (minPos >= 0) {
-        Int32 colonPos = ruleBlock.FindFirst (L":", minPos);
-        Int32 commaPos = ruleBlock.FindFirst (L",", colonPos);
-        if (colonPos >= 0) {
-            GS::UniString valueStr = ruleBlock.GetSubstring (colonPos + 1, commaPos - colonPos - 1);
-            valueStr.Trim ();
-
-            // 调试：显示原始提取的字符串
-            GS::UniString parseDebug;
-            parseDebug.Printf(L"[ParseRule] %s min_value 原始字符串: '%s'\n",
-                ruleName.ToCStr().Get(), valueStr.ToCStr().Get());
-            ACAPI_WriteReport(parseDebug.ToCStr().Get(), false);
-
-            if (!valueStr.Contains (L"null")) {
-                double value = 0.0;
-                // 显式指定CC_UTF8编码，确保sscanf能正确解析窄字符串
-                int scanResult = sscanf (valueStr.ToCStr (CC_UTF8).Get (), "%lf", &value);
-
-                GS::UniString scanDebug;
-                scanDebug.Printf(L"[ParseRule] %s min_value sscanf结果: scanResult=%d, value=%.6f\n",
-                    ruleName.ToCStr().Get(), scanResult, value);
-                ACAPI_WriteReport(scanDebug.ToCStr().Get(), false);
-
-                if (scanResult == 1) {
-                    rule.minValue = value;
-                }
-            }
-        }
-    }
-
-    // 解析max_value
-    Int32 maxPos = ruleBlock.FindFirst (L"\"max_value\"");
-    if (maxPos >= 0) {
-        Int32 colonPos = ruleBlock.FindFirst (L":", maxPos);
-        Int32 commaPos = ruleBlock.FindFirst (L",", colonPos);
-        if (colonPos >= 0) {
-            GS::UniString valueStr = ruleBlock.GetSubstring (colonPos + 1, commaPos - colonPos - 1);
-            valueStr.Trim ();
-
-            // 调试：显示原始提取的字符串
-            GS::UniString parseDebug;
-            parseDebug.Printf(L"[ParseRule] %s max_value 原始字符串: '%s'\n",
-                ruleName.ToCStr().Get(), valueStr.ToCStr().Get());
-            ACAPI_WriteReport(parseDebug.ToCStr().Get(), false);
-
-            if (!valueStr.Contains (L"null")) {
-                double value = 0.0;
-                // 显式指定CC_UTF8编码，确保sscanf能正确解析窄字符串
-                int scanResult = sscanf (valueStr.ToCStr (CC_UTF8).Get (), "%lf", &value);
-
-                GS::UniString scanDebug;
-                scanDebug.Printf(L"[ParseRule] %s max_value sscanf结果: scanResult=%d, value=%.6f\n",
-                    ruleName.ToCStr().Get(), scanResult, value);
-                ACAPI_WriteReport(scanDebug.ToCStr().Get(), false);
-
-                if (scanResult == 1) {
-                    rule.maxValue = value;
-                }
-            }
-        }
-    }
+    const GS::UniString uniText (std::string (text).c_str (), CC_UTF8);
+    if (target == uniText)
+        return;
+    if (!target.IsEmpty ())
+        target += L"；";
+    target += uniText;
+}
 
-    // 解析unit
-    Int32 unitPos = ruleBlock.FindFirst (L"\"unit\"");
-    if (unitPos >= 0) {
-        Int32 colonPos = ruleBlock.FindFirst (L":", unitPos);
-        Int32 quoteStart = ruleBlock.FindFirst (L"\"", colonPos + 1) + 1;
-        Int32 quoteEnd = ruleBlock.FindFirst (L"\"", quoteStart);
-        if (quoteStart > 0 && quoteEnd > quoteStart) {
-            rule.unit = ruleBlock.GetSubstring (quoteStart, quoteEnd - quoteStart);
-        }
+// 生效规则：上下限分别来自给出该限值的规范，两者不同时条文和出处依次列出
+static RegulationRule ToRegulationRule (const StairCore::RegulationLibrary& library, const StairCore::ResolvedRules& rules, StairCore::RuleKind kind) {
+    RegulationRule rule;
+    rule.minValue = rules.ruleSet.rules[kind].minValue;
+    rule.maxValue = rules.ruleSet.rules[kind].maxValue;
+
+    const std::uint32_t governing[] = { rules.minRule[kind], rules.maxRule[kind] };
+    for (const std::uint32_t ruleIndex : governing) {
+        if (ruleIndex == StairCore::kNoRule)
+            continue;
+        const StairCore::RegulationLibrary::Rule& libraryRule = library.GetRule (ruleIndex);
+        rule.unit = GS::UniString (std::string (library.GetText (libraryRule.unit)).c_str (), CC_UTF8);
+        AppendRuleText (rule.source, library.GetText (libraryRule.source));
+        AppendRuleText (rule.fullText, library.GetText (libraryRule.fullText));
     }
+    return rule;
+}
 
-    // 解析source
-    Int32 sourcePos = ruleBlock.FindFirst (L"\"source\"");
-    if (sourcePos >= 0) {
-        Int32 colonPos = ruleBlock.FindFirst (L":", sourcePos);
-        Int32 quoteStart = ruleBlock.FindFirst (L"\"", colonPos + 1) + 1;
-        Int32 quoteEnd = ruleBlock.FindFirst (L"\"", quoteStart);
-        if (quoteStart > 0 && quoteEnd > quoteStart) {
-            rule.source = ruleBlock.GetSubstring (quoteStart, quoteEnd - quoteStart);
-        }
-    }
+RegulationConfig RegulationConfig::FromLibrary(const StairCore::RegulationLibrary& library, const StairCore::ResolvedRules& rules) {
+    if (rules.regulationCount == 0)
+        return GetDefault();
 
-    // 解析full_text
-    Int32 textPos = ruleBlock.FindFirst (L"\"full_text\"");
-    if (textPos >= 0) {
-        Int32 colonPos = ruleBlock.FindFirst (L":", textPos);
-        Int32 quoteStart = ruleBlock.FindFirst (L"\"", colonPos + 1) + 1;
-        Int32 quoteEnd = ruleBlock.FindFirst (L"\"", quoteStart);
-        if (quoteStart > 0 && quoteEnd > quoteStart) {
-            rule.fullText = ruleBlock.GetSubstring (quoteStart, quoteEnd - quoteStart);
+    // 名称和编号：取给出生效限值的规范（按规则类型顺序），编号依次列出
+    RegulationConfig config;
+    std::vector<std::uint32_t> listed;
+    for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+        for (const std::uint32_t ruleIndex : { rules.minRule[kind], rules.maxRule[kind] }) {
+            if (ruleIndex == StairCore::kNoRule)
+                continue;
+            const std::uint32_t regulationIndex = library.GetRule (ruleIndex).regulation;
+            if (std::find (listed.begin (), listed.end (), regulationIndex) != listed.end ())
+                continue;
+
+            const StairCore::RegulationLibrary::Regulation& regulation = library.GetRegulation (regulationIndex);
+            if (listed.empty ())
+                config.regulationName = GS::UniString (std::string (library.GetText (regulation.name)).c_str (), CC_UTF8);
+            AppendRuleText (config.regulationCode, library.GetText (regulation.code));
+            listed.push_back (regulationIndex);
         }
     }
 
-    // 添加调试日志
-    GS::UniString debugMsg = L"[ParseRule] ";
-    debugMsg += ruleName;
-    debugMsg += L": min=";
-    if (rule.HasMinValue()) {
-        debugMsg += GS::UniString::Printf(L"%.3f", rule.minValue.value());
-    } else {
-        debugMsg += L"null";
-    }
-    debugMsg += L", max=";
-    if (rule.HasMaxValue()) {
-        debugMsg += GS::UniString::Printf(L"%.3f", rule.maxValue.value());
-    } else {
-        debugMsg += L"null";
-    }
-    debugMsg += L", source=";
-    debugMsg += rule.source;
-    ACAPI_WriteReport(debugMsg.ToCStr().Get(), false);
-
-    return rule;
+    if (config.regulationName.IsEmpty ())
+        config.regulationName = L"已提取规范";
+    if (rules.regulationCount > 1)
+        config.regulationName += GS::UniString::Printf (L" 等%u部规范", (unsigned int) rules.regulationCount);
+    if (config.regulationCode.IsEmpty ())
+        config.regulationCode = L"从PDF提取";
+
+    config.riserHeightRule = ToRegulationRule (library, rules, StairCore::RiserHeightRule);
+    config.treadDepthRule = ToRegulationRule (library, rules, StairCore::TreadDepthRule);
+    config.twoRPlusGRule = ToRegulationRule (library, rules, StairCore::TwoRPlusGoingRule);
+    config.landingLengthRule = ToRegulationRule (library, rules, StairCore::LandingLengthRule);
+    config.narrowTreadDepthRule = ToRegulationRule (library, rules, StairCore::NarrowTreadDepthRule);
+    config.riserVariationRule = ToRegulationRule (library, rules, StairCore::RiserVariationRule);
+    config.stairWidthRule = ToRegulationRule (library, rules, StairCore::StairWidthRule);
+    config.handrailHeightRule = ToRegulationRule (library, rules, StairCore::HandrailHeightRule);
+    config.slopeAngleRule = ToRegulationRule (library, rules, StairCore::SlopeAngleRule);
+    config.betweenFlightsRule = ToRegulationRule (library, rules, StairCore::FlightSpacingRule);
+    return config;
 }
 
 RegulationConfig RegulationConfig::GetDefault() {
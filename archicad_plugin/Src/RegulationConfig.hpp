@@ -5,10 +5,21 @@
 #include "ACAPinc.h"
 #include "UniString.hpp"
 #include <optional>
+#include <vector>
+
+#include "RegulationCache.hpp"
+#include "RegulationJson.hpp"
+#include "RegulationLibrary.hpp"
 
 // 统一的JSON配置文件路径（上传和加载都使用此路径）
 #define USER_REGULATION_JSON_PATH L"E:\\ArchiCAD_Development_File\\BuildingCodeChecker_Stair\\shared\\current_regulation.json"
 
+// 已合并的规范JSON，每个上传的规范一个文件（按PDF文件名命名），上传新规范不会覆盖其他规范
+#define USER_REGULATION_FOLDER_PATH L"E:\\ArchiCAD_Development_File\\BuildingCodeChecker_Stair\\shared\\regulations"
+
+// 规范库二进制缓存（JSON未变化时启动直接读取，无需解析JSON）
+#define USER_REGULATION_CACHE_PATH L"E:\\ArchiCAD_Development_File\\BuildingCodeChecker_Stair\\shared\\current_regulation.cache"
+
 /**
  * 规范规则结构
  */
@@ -39,6 +50,8 @@ public:
     RegulationRule     treadDepthRule;         // 踏步宽度/深度
     RegulationRule     twoRPlusGRule;          // 2R+G 公式
     RegulationRule     landingLengthRule;      // 平台长度
+    RegulationRule     narrowTreadDepthRule;   // 扇形踏步窄端宽度
+    RegulationRule     riserVariationRule;     // 踢面高度差
 
     // 防火规范参数 (Fire Code Parameters)
     RegulationRule     stairWidthRule;         // 楼梯净宽度
@@ -47,10 +60,43 @@ public:
     RegulationRule     betweenFlightsRule;     // 两梯段间距
 
     /**
-     * 从JSON文件加载配置
+     * 从JSON文件加载配置（只取文件中的第一个规范）
      */
     static RegulationConfig LoadFromJSON(const IO::Location& jsonPath);
 
+    /**
+     * 从JSON文件读取所有规范记录，没有任何规则被成功解析时返回false
+     */
+    static bool LoadRecordsFromJSON(const IO::Location& jsonPath, std::vector<RegulationJson::RegulationRecord>& regulations);
+
+    /**
+     * 一次读入JSON文件的原始字节 / 解析已读入的字节（分开调用以便先比较内容哈希）
+     */
+    static bool ReadJSONFile(const IO::Location& jsonPath, std::vector<char>& jsonBytes);
+    static bool ParseRecords(const std::vector<char>& jsonBytes, std::vector<RegulationJson::RegulationRecord>& regulations);
+
+    /**
+     * 获取JSON文件的修改时间和长度（不读取内容，contentHash为0）
+     */
+    static bool GetSourceStamp(const IO::Location& jsonPath, StairCore::SourceStamp& stamp);
+
+    /**
+     * 读取/写入规范库二进制缓存，缓存不存在或无效时LoadLibraryCache返回false并清空规范库；
+     * folderStamp为合并时规范目录的标记（StairCore::HashRegulationFolder）
+     */
+    static bool LoadLibraryCache(const IO::Location& cachePath, StairCore::RegulationLibrary& library, StairCore::SourceStamp& stamp, std::uint64_t& folderStamp);
+    static bool SaveLibraryCache(const IO::Location& cachePath, const StairCore::RegulationLibrary& library, const StairCore::SourceStamp& stamp, std::uint64_t folderStamp);
+
+    /**
+     * 从解析后的规范记录生成配置（UTF-8字符串转换为UniString）
+     */
+    static RegulationConfig FromRecord(const RegulationJson::RegulationRecord& record);
+
+    /**
+     * 从规范库的生效规则生成配置（用于显示），没有适用规范时返回默认配置
+     */
+    static RegulationConfig FromLibrary(const StairCore::RegulationLibrary& library, const StairCore::ResolvedRules& rules);
+
     /**
      * 获取默认配置（硬编码的规范）
      */
@@ -60,9 +106,6 @@ public:
      * 保存为JSON文件
      */
     bool SaveToJSON(const IO::Location& jsonPath) const;
-
-private:
-    static RegulationRule ParseRule(const GS::UniString& jsonText, const GS::UniString& ruleName);
 };
 
 #endif // REGULATION_CONFIG_HPP
@@ -0,0 +1,441 @@
+#include "RegulationExtractionWorker.hpp"
+
+#include <cstdio>
+
+#include "RegulationJson.hpp"
+
+namespace StairCore {
+
+namespace {
+
+constexpr int					kPollMilliseconds = 50;
+constexpr std::size_t			kReadBufferSize = 4096;
+constexpr std::size_t			kMaxMessageLength = 1 << 20;	// 超长的输出行不是协议消息，丢弃
+constexpr std::chrono::seconds	kShutdownWait (3);
+
+void AppendJsonString (std::string& out, const std::string& text)
+{
+	out += '"';
+	for (const char c : text) {
+		switch (c) {
+			case '"':	out += "\\\"";	break;
+			case '\\':	out += "\\\\";	break;
+			case '\n':	out += "\\n";	break;
+			case '\r':	out += "\\r";	break;
+			case '\t':	out += "\\t";	break;
+			default:
+				if (static_cast<unsigned char> (c) < 0x20) {
+					char escaped[8];
+					std::snprintf (escaped, sizeof (escaped), "\\u%04x", static_cast<unsigned int> (c));
+					out += escaped;
+				} else {
+					out += c;
+				}
+				break;
+		}
+	}
+	out += '"';
+}
+
+std::string GetStringMember (const RegulationJson::Document& document, const RegulationJson::Value& object, std::string_view key)
+{
+	const RegulationJson::Value* value = document.FindMember (object, key);
+	return value != nullptr && value->IsString () ? std::string (value->string) : std::string ();
+}
+
+double GetNumberMember (const RegulationJson::Document& document, const RegulationJson::Value& object, std::string_view key)
+{
+	const RegulationJson::Value* value = document.FindMember (object, key);
+	return value != nullptr && value->IsNumber () ? value->number : -1.0;
+}
+
+double SecondsSince (std::chrono::steady_clock::time_point startTime)
+{
+	return std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime).count ();
+}
+
+} // namespace
+
+RegulationExtractionWorker::RegulationExtractionWorker (const std::vector<std::wstring>& processCommand, const std::wstring& logPath, std::chrono::seconds timeout) :
+	command (processCommand),
+	errorLogPath (logPath),
+	jobTimeout (timeout)
+{
+	worker = std::thread (&RegulationExtractionWorker::Run, this);
+}
+
+RegulationExtractionWorker::~RegulationExtractionWorker ()
+{
+	Shutdown ();
+}
+
+std::uint32_t RegulationExtractionWorker::Submit (const std::wstring& pdfPath, const std::wstring& outputPath)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	const std::uint32_t id = nextJobId++;
+	JobEntry& entry = jobs[id];
+	entry.job.id = id;
+	entry.job.pdfPath = pdfPath;
+	entry.job.outputPath = outputPath;
+	wakeUp.notify_one ();
+	return id;
+}
+
+void RegulationExtractionWorker::Cancel (std::uint32_t id)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	const auto it = jobs.find (id);
+	if (it == jobs.end () || it->second.job.IsFinished ())
+		return;
+
+	// 尚未发给进程的任务直接取消，其余由后台线程处理
+	if (!it->second.sent) {
+		it->second.job.state = JobState::Cancelled;
+		it->second.job.message = "已取消";
+		return;
+	}
+	it->second.cancelRequested = true;
+}
+
+bool RegulationExtractionWorker::GetJob (std::uint32_t id, Job& job) const
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	const auto it = jobs.find (id);
+	if (it == jobs.end ())
+		return false;
+
+	job = it->second.job;
+	if (job.state == JobState::Running)
+		job.elapsedSeconds = SecondsSince (it->second.startTime);
+	return true;
+}
+
+void RegulationExtractionWorker::ForgetJob (std::uint32_t id)
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	const auto it = jobs.find (id);
+	if (it != jobs.end () && it->second.job.IsFinished ())
+		jobs.erase (it);
+}
+
+bool RegulationExtractionWorker::IsReady () const
+{
+	std::lock_guard<std::mutex> lock (mutex);
+	return ready;
+}
+
+void RegulationExtractionWorker::Shutdown ()
+{
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		stopping = true;
+		wakeUp.notify_one ();
+	}
+	if (worker.joinable ())
+		worker.join ();
+}
+
+void RegulationExtractionWorker::Run ()
+{
+	char buffer[kReadBufferSize];
+	for (;;) {
+		{
+			// 没有进程时等待新任务，进程只在需要时启动
+			std::unique_lock<std::mutex> lock (mutex);
+			if (!process.IsStarted ())
+				wakeUp.wait (lock, [this] { return stopping || HasQueuedJobs (); });
+			if (stopping)
+				break;
+		}
+
+		if (!process.IsStarted () && !StartProcess ())
+			continue;
+
+		SendPendingRequests ();
+
+		const long bytesRead = process.Read (buffer, sizeof (buffer), kPollMilliseconds);
+		if (bytesRead > 0)
+			HandleOutput (buffer, static_cast<std::size_t> (bytesRead));
+		else if (bytesRead == ChildProcess::EndOfOutput)
+			std::this_thread::sleep_for (std::chrono::milliseconds (kPollMilliseconds));
+
+		int exitCode = 0;
+		if (process.HasExited (exitCode)) {
+			long remaining = 0;
+			while ((remaining = process.Read (buffer, sizeof (buffer), 0)) > 0)
+				HandleOutput (buffer, static_cast<std::size_t> (remaining));
+			OnProcessExited (exitCode);
+			continue;
+		}
+
+		CheckDeadlines ();
+	}
+
+	// 空闲的进程请求其自行退出，等待超时或仍有任务在执行时直接结束
+	bool busy = false;
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		busy = FindRunningJob () != nullptr;
+	}
+	if (process.IsStarted () && !busy) {
+		SendLine ("{\"type\":\"shutdown\"}");
+		const auto deadline = std::chrono::steady_clock::now () + kShutdownWait;
+		int exitCode = 0;
+		while (!process.HasExited (exitCode) && std::chrono::steady_clock::now () < deadline) {
+			const long bytesRead = process.Read (buffer, sizeof (buffer), kPollMilliseconds);
+			if (bytesRead > 0)
+				HandleOutput (buffer, static_cast<std::size_t> (bytesRead));
+			else if (bytesRead == ChildProcess::EndOfOutput)
+				std::this_thread::sleep_for (std::chrono::milliseconds (kPollMilliseconds));
+		}
+	}
+	process.Terminate ();
+
+	std::lock_guard<std::mutex> lock (mutex);
+	ready = false;
+	for (auto& item : jobs) {
+		if (!item.second.job.IsFinished ()) {
+			item.second.job.state = JobState::Cancelled;
+			item.second.job.message = "提取进程已关闭";
+		}
+	}
+}
+
+bool RegulationExtractionWorker::StartProcess ()
+{
+	ChildProcess::Options options;
+	options.pipeInput = true;
+	options.errorPath = errorLogPath;
+
+	std::string error;
+	if (process.Start (command, options, error)) {
+		pendingOutput.clear ();
+		return true;
+	}
+
+	// 无法启动时排队的任务全部失败，新任务提交后再尝试启动
+	std::lock_guard<std::mutex> lock (mutex);
+	for (auto& item : jobs) {
+		if (item.second.job.state == JobState::Queued) {
+			item.second.job.state = JobState::Failed;
+			item.second.job.message = error;
+		}
+	}
+	return false;
+}
+
+void RegulationExtractionWorker::SendPendingRequests ()
+{
+	std::vector<std::string> lines;
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		for (auto& item : jobs) {
+			JobEntry& entry = item.second;
+			if (entry.job.state != JobState::Queued)
+				continue;
+
+			if (!entry.sent) {
+				std::string line = "{\"type\":\"extract\",\"id\":" + std::to_string (entry.job.id) + ",\"pdf\":";
+				AppendJsonString (line, WideToUtf8 (entry.job.pdfPath));
+				line += ",\"output\":";
+				AppendJsonString (line, WideToUtf8 (entry.job.outputPath));
+				line += '}';
+				lines.push_back (std::move (line));
+				entry.sent = true;
+				entry.deadlineStart = std::chrono::steady_clock::now ();
+			} else if (entry.cancelRequested && !entry.cancelSent) {
+				lines.push_back ("{\"type\":\"cancel\",\"id\":" + std::to_string (entry.job.id) + "}");
+				entry.cancelSent = true;
+			}
+		}
+	}
+
+	// 写入失败说明进程已退出，由Run在读取时处理
+	for (const std::string& line : lines) {
+		if (!SendLine (line))
+			break;
+	}
+}
+
+bool RegulationExtractionWorker::SendLine (const std::string& line)
+{
+	const std::string message = line + "\n";
+	return process.Write (message.data (), message.size ());
+}
+
+void RegulationExtractionWorker::HandleOutput (const char* data, std::size_t size)
+{
+	for (std::size_t i = 0; i < size; ++i) {
+		const char c = data[i];
+		if (c == '\n') {
+			if (!pendingOutput.empty () && pendingOutput.back () == '\r')
+				pendingOutput.pop_back ();
+			if (!pendingOutput.empty () && pendingOutput.size () <= kMaxMessageLength)
+				HandleMessage (pendingOutput);
+			pendingOutput.clear ();
+		} else if (pendingOutput.size () <= kMaxMessageLength) {
+			pendingOutput += c;
+		}
+	}
+}
+
+void RegulationExtractionWorker::HandleMessage (const std::string& line)
+{
+	RegulationJson::Document document;
+	if (!document.Parse (line.data (), line.size ()))
+		return;
+
+	const RegulationJson::Value* root = document.GetRoot ();
+	if (root == nullptr || !root->IsObject ())
+		return;
+
+	const std::string type = GetStringMember (document, *root, "type");
+	std::lock_guard<std::mutex> lock (mutex);
+	if (type == "ready") {
+		ready = true;
+		return;
+	}
+
+	const double id = GetNumberMember (document, *root, "id");
+	const auto it = id >= 0.0 ? jobs.find (static_cast<std::uint32_t> (id)) : jobs.end ();
+	if (it == jobs.end () || it->second.job.IsFinished ())
+		return;
+
+	JobEntry& entry = it->second;
+	if (type == "progress") {
+		if (entry.job.state == JobState::Queued) {
+			entry.job.state = JobState::Running;
+			entry.startTime = std::chrono::steady_clock::now ();
+		}
+		entry.job.stage = GetStringMember (document, *root, "stage");
+		entry.job.message = GetStringMember (document, *root, "message");
+	} else if (type == "result") {
+		const RegulationJson::Value* ok = document.FindMember (*root, "ok");
+		const bool succeeded = ok != nullptr && ok->type == RegulationJson::ValueType::Boolean && ok->boolean;
+		entry.job.state = succeeded ? JobState::Succeeded : JobState::Failed;
+		entry.job.message = succeeded ? std::string () : GetStringMember (document, *root, "error");
+		entry.job.cacheHit = GetStringMember (document, *root, "cached");
+		entry.job.partial = GetStringMember (document, *root, "partial");
+		entry.job.elapsedSeconds = GetNumberMember (document, *root, "seconds");
+		RestartQueuedDeadlines ();
+	} else if (type == "cancelled") {
+		entry.job.state = JobState::Cancelled;
+		entry.job.message = "已取消";
+		RestartQueuedDeadlines ();
+	}
+}
+
+void RegulationExtractionWorker::RestartQueuedDeadlines ()
+{
+	// 进程逐个执行任务，排在后面的任务从前一个任务结束时重新计时
+	const auto now = std::chrono::steady_clock::now ();
+	for (auto& item : jobs) {
+		if (item.second.sent && item.second.job.state == JobState::Queued)
+			item.second.deadlineStart = now;
+	}
+}
+
+RegulationExtractionWorker::JobEntry* RegulationExtractionWorker::FindRunningJob ()
+{
+	for (auto& item : jobs) {
+		if (item.second.job.state == JobState::Running)
+			return &item.second;
+	}
+	return nullptr;
+}
+
+bool RegulationExtractionWorker::HasQueuedJobs () const
+{
+	for (const auto& item : jobs) {
+		if (item.second.job.state == JobState::Queued)
+			return true;
+	}
+	return false;
+}
+
+void RegulationExtractionWorker::CheckDeadlines ()
+{
+	JobState stopState = JobState::Running;
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		const auto now = std::chrono::steady_clock::now ();
+		for (auto& item : jobs) {
+			JobEntry& entry = item.second;
+			if (!entry.sent || entry.job.IsFinished ())
+				continue;
+
+			// 进程就绪前不会读取取消请求（可能卡在启动中），与正在执行的任务一样只能结束进程
+			if (entry.cancelRequested && (entry.job.state == JobState::Running || !ready)) {
+				stopState = JobState::Cancelled;
+				break;
+			}
+
+			// 发出后一直没有完成（包括进程没有响应、任务始终没有开始）的任务超时
+			if (now - entry.deadlineStart >= jobTimeout) {
+				stopState = JobState::TimedOut;
+				if (entry.job.state == JobState::Queued) {
+					entry.job.state = JobState::TimedOut;
+					entry.job.message = "提取进程没有响应，已结束提取进程";
+				}
+				break;
+			}
+		}
+		if (stopState == JobState::Running)
+			return;
+	}
+
+	// 正在执行的任务无法在进程内中断，只能结束进程，其余排队的任务在新进程中执行
+	StopProcess (stopState, stopState == JobState::Cancelled ? "已取消" : "提取超时，已结束提取进程");
+}
+
+void RegulationExtractionWorker::OnProcessExited (int exitCode)
+{
+	char reason[96];
+	std::snprintf (reason, sizeof (reason), "提取进程意外退出（退出码 %d）", exitCode);
+
+	bool wasReady = false;
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		wasReady = ready;
+	}
+
+	StopProcess (JobState::Failed, reason);
+
+	// 进程在初始化完成前退出（找不到Python或依赖库等），重启也不会成功，排队的任务一起失败
+	if (!wasReady) {
+		std::lock_guard<std::mutex> lock (mutex);
+		for (auto& item : jobs) {
+			if (item.second.job.state == JobState::Queued) {
+				item.second.job.state = JobState::Failed;
+				item.second.job.message = reason;
+			}
+		}
+	}
+}
+
+void RegulationExtractionWorker::StopProcess (JobState runningState, const std::string& reason)
+{
+	process.Terminate ();
+	pendingOutput.clear ();
+
+	std::lock_guard<std::mutex> lock (mutex);
+	ready = false;
+	for (auto& item : jobs) {
+		JobEntry& entry = item.second;
+		if (entry.job.state == JobState::Running) {
+			entry.job.state = runningState;
+			entry.job.message = reason;
+			entry.job.elapsedSeconds = SecondsSince (entry.startTime);
+		} else if (entry.job.state == JobState::Queued) {
+			// 排队的任务在新进程中重新提交
+			entry.sent = false;
+			entry.cancelSent = false;
+			if (entry.cancelRequested) {
+				entry.job.state = JobState::Cancelled;
+				entry.job.message = "已取消";
+			}
+		}
+	}
+}
+
+} // namespace StairCore
@@ -0,0 +1,121 @@
+#ifndef REGULATION_EXTRACTION_WORKER_HPP
+#define REGULATION_EXTRACTION_WORKER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChildProcess.hpp"
+
+namespace StairCore {
+
+/**
+ * 常驻规范提取进程的客户端（与ArchiCAD无关）
+ *
+ * 有任务时启动提取进程（python_rag_tool/src/worker.py）并一直复用，解释器启动、PDF库导入和
+ * LLM客户端创建只在进程启动时发生一次。请求和消息为每行一个JSON对象，协议见worker.py。
+ * 进程意外退出、任务超时、取消正在执行的任务或在进程就绪前取消任务时结束进程，
+ * 尚在排队的任务在新进程中重新提交。
+ *
+ * 后台线程负责启动进程、发送请求和读取消息，界面线程只调用Submit/Cancel/GetJob，不会阻塞。
+ */
+class RegulationExtractionWorker {
+public:
+	enum class JobState {
+		Queued,
+		Running,
+		Succeeded,
+		Failed,
+		Cancelled,
+		TimedOut
+	};
+
+	struct Job {
+		std::uint32_t	id = 0;
+		JobState		state = JobState::Queued;
+		std::string		stage;					// 当前阶段：cache / parse / extract / validate / save
+		std::string		message;				// 最近的进度说明或失败原因（UTF-8）
+		std::string		cacheHit;				// 命中的提取缓存："document" / "text"，重新提取时为空
+		std::string		partial;				// 部分批次提取失败时的说明（结果不完整，未写入提取缓存），否则为空
+		std::wstring	pdfPath;
+		std::wstring	outputPath;
+		double			elapsedSeconds = 0.0;	// 开始执行后的用时，排队时间不计
+
+		bool IsFinished () const { return state != JobState::Queued && state != JobState::Running; }
+	};
+
+	/**
+	 * processCommand 为启动提取进程的命令（不经过shell），进程的标准错误追加到logPath。
+	 * 任务从发给进程起（排在前面的任务结束后重新计时）超过timeout仍未完成时结束进程，
+	 * 进程启动后没有响应时排队的任务也不会一直等待。
+	 */
+	RegulationExtractionWorker (const std::vector<std::wstring>& processCommand, const std::wstring& logPath, std::chrono::seconds timeout);
+	~RegulationExtractionWorker ();
+
+	RegulationExtractionWorker (const RegulationExtractionWorker&) = delete;
+	RegulationExtractionWorker& operator= (const RegulationExtractionWorker&) = delete;
+
+	// 提交任务并返回任务编号；提取结果写入outputPath
+	std::uint32_t	Submit (const std::wstring& pdfPath, const std::wstring& outputPath);
+
+	// 取消任务：排队的任务从队列中移除，正在执行的任务或进程尚未就绪时连同进程一起结束
+	void			Cancel (std::uint32_t id);
+
+	// 取得任务状态；任务结束后调用ForgetJob释放记录
+	bool			GetJob (std::uint32_t id, Job& job) const;
+	void			ForgetJob (std::uint32_t id);
+
+	// 进程已启动并完成初始化（收到ready消息）
+	bool			IsReady () const;
+
+	// 关闭进程（空闲时请求其退出，执行中的任务被取消）并停止后台线程
+	void			Shutdown ();
+
+private:
+	struct JobEntry {
+		Job										job;
+		bool									sent = false;
+		bool									cancelRequested = false;
+		bool									cancelSent = false;
+		std::chrono::steady_clock::time_point	startTime;
+		std::chrono::steady_clock::time_point	deadlineStart;	// 超时的起点：发给进程的时刻，前面的任务结束时后移
+	};
+
+	void			Run ();
+	bool			StartProcess ();
+	void			SendPendingRequests ();
+	void			HandleOutput (const char* data, std::size_t size);
+	void			HandleMessage (const std::string& line);
+	void			CheckDeadlines ();
+	void			RestartQueuedDeadlines ();
+	void			OnProcessExited (int exitCode);
+	void			StopProcess (JobState runningState, const std::string& reason);
+	bool			SendLine (const std::string& line);
+	bool			HasQueuedJobs () const;
+	JobEntry*		FindRunningJob ();
+
+	const std::vector<std::wstring>		command;
+	const std::wstring					errorLogPath;
+	const std::chrono::seconds			jobTimeout;
+
+	mutable std::mutex								mutex;
+	std::condition_variable							wakeUp;
+	std::map<std::uint32_t, JobEntry>				jobs;			// 按编号（即提交顺序）排列
+	std::uint32_t									nextJobId = 1;
+	bool											ready = false;
+	bool											stopping = false;
+
+	// 以下只由后台线程访问
+	ChildProcess						process;
+	std::string							pendingOutput;
+	std::thread							worker;
+};
+
+} // namespace StairCore
+
+#endif
@@ -0,0 +1,589 @@
+#include "RegulationJson.hpp"
+
+#include <charconv>
+#include <cstring>
+
+namespace RegulationJson {
+
+constexpr int kMaxDepth = 128;
+
+class Parser {
+public:
+	Parser (Document& target, const char* data, std::size_t size) :
+		document (target),
+		begin (data),
+		cur (data),
+		end (data + size)
+	{
+	}
+
+	bool Run ()
+	{
+		// 跳过UTF-8 BOM
+		if (end - cur >= 3 && static_cast<unsigned char> (cur[0]) == 0xEF && static_cast<unsigned char> (cur[1]) == 0xBB && static_cast<unsigned char> (cur[2]) == 0xBF)
+			cur += 3;
+
+		SkipWhitespace ();
+		if (cur == end)
+			return Fail (cur, "文档为空");
+
+		document.values.emplace_back ();
+		if (!ParseValue (0, 0))
+			return false;
+
+		SkipWhitespace ();
+		if (cur != end)
+			return Fail (cur, "文档末尾有多余内容");
+
+		return true;
+	}
+
+private:
+	bool Fail (const char* at, const char* message)
+	{
+		ParseError& error = document.error;
+		error.offset = static_cast<std::size_t> (at - begin);
+		error.message = message;
+		error.line = 1;
+		error.column = 1;
+		for (const char* p = begin; p < at; ++p) {
+			if (*p == '\n') {
+				++error.line;
+				error.column = 1;
+			} else {
+				++error.column;
+			}
+		}
+		return false;
+	}
+
+	void SkipWhitespace ()
+	{
+		while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r'))
+			++cur;
+	}
+
+	bool ParseValue (std::uint32_t index, int depth)
+	{
+		if (depth > kMaxDepth)
+			return Fail (cur, "嵌套层数过深");
+
+		if (cur == end)
+			return Fail (cur, "缺少值");
+
+		switch (*cur) {
+			case '{':	return ParseObject (index, depth);
+			case '[':	return ParseArray (index, depth);
+			case '"': {
+				std::string_view text;
+				if (!ParseString (text))
+					return false;
+				document.values[index].type = ValueType::String;
+				document.values[index].string = text;
+				return true;
+			}
+			case 't':	return ParseLiteral (index, "true", ValueType::Boolean, true);
+			case 'f':	return ParseLiteral (index, "false", ValueType::Boolean, false);
+			case 'n':	return ParseLiteral (index, "null", ValueType::Null, false);
+			default:
+				if (*cur == '-' || (*cur >= '0' && *cur <= '9')) {
+					double number = 0.0;
+					if (!ParseNumber (number))
+						return false;
+					document.values[index].type = ValueType::Number;
+					document.values[index].number = number;
+					return true;
+				}
+				return Fail (cur, "无效的值");
+		}
+	}
+
+	// 追加子节点并链接到父节点，返回子节点索引
+	std::uint32_t AppendChild (std::uint32_t parent, std::uint32_t previous)
+	{
+		const std::uint32_t child = static_cast<std::uint32_t> (document.values.size ());
+		document.values.emplace_back ();
+		if (previous == kNoValue)
+			document.values[parent].firstChild = child;
+		else
+			document.values[previous].nextSibling = child;
+		++document.values[parent].childCount;
+		return child;
+	}
+
+	bool ParseObject (std::uint32_t index, int depth)
+	{
+		document.values[index].type = ValueType::Object;
+		++cur;
+		SkipWhitespace ();
+		if (cur < end && *cur == '}') {
+			++cur;
+			return true;
+		}
+
+		std::uint32_t previous = kNoValue;
+		for (;;) {
+			if (cur == end || *cur != '"')
+				return Fail (cur, "应为对象键（字符串）");
+
+			std::string_view key;
+			if (!ParseString (key))
+				return false;
+
+			SkipWhitespace ();
+			if (cur == end || *cur != ':')
+				return Fail (cur, "对象键后应为 ':'");
+			++cur;
+			SkipWhitespace ();
+
+			const std::uint32_t child = AppendChild (index, previous);
+			document.values[child].key = key;
+			if (!ParseValue (child, depth + 1))
+				return false;
+			previous = child;
+
+			SkipWhitespace ();
+			if (cur < end && *cur == ',') {
+				++cur;
+				SkipWhitespace ();
+				continue;
+			}
+			if (cur < end && *cur == '}') {
+				++cur;
+				return true;
+			}
+			return Fail (cur, "对象成员后应为 ',' 或 '}'");
+		}
+	}
+
+	bool ParseArray (std::uint32_t index, int depth)
+	{
+		document.values[index].type = ValueType::Array;
+		++cur;
+		SkipWhitespace ();
+		if (cur < end && *cur == ']') {
+			++cur;
+			return true;
+		}
+
+		std::uint32_t previous = kNoValue;
+		for (;;) {
+			const std::uint32_t child = AppendChild (index, previous);
+			if (!ParseValue (child, depth + 1))
+				return false;
+			previous = child;
+
+			SkipWhitespace ();
+			if (cur < end && *cur == ',') {
+				++cur;
+				SkipWhitespace ();
+				continue;
+			}
+			if (cur < end && *cur == ']') {
+				++cur;
+				return true;
+			}
+			return Fail (cur, "数组元素后应为 ',' 或 ']'");
+		}
+	}
+
+	bool ParseLiteral (std::uint32_t index, const char* literal, ValueType type, bool boolean)
+	{
+		const std::size_t length = std::strlen (literal);
+		if (static_cast<std::size_t> (end - cur) < length || std::memcmp (cur, literal, length) != 0)
+			return Fail (cur, "无效的字面量");
+
+		cur += length;
+		document.values[index].type = type;
+		document.values[index].boolean = boolean;
+		return true;
+	}
+
+	bool ParseNumber (double& number)
+	{
+		const char* start = cur;
+
+		if (cur < end && *cur == '-')
+			++cur;
+
+		if (cur < end && *cur == '0') {
+			++cur;
+		} else if (cur < end && *cur >= '1' && *cur <= '9') {
+			while (cur < end && *cur >= '0' && *cur <= '9')
+				++cur;
+		} else {
+			return Fail (cur, "无效的数字");
+		}
+
+		if (cur < end && *cur == '.') {
+			++cur;
+			if (cur == end || *cur < '0' || *cur > '9')
+				return Fail (cur, "小数点后缺少数字");
+			while (cur < end && *cur >= '0' && *cur <= '9')
+				++cur;
+		}
+
+		if (cur < end && (*cur == 'e' || *cur == 'E')) {
+			++cur;
+			if (cur < end && (*cur == '+' || *cur == '-'))
+				++cur;
+			if (cur == end || *cur < '0' || *cur > '9')
+				return Fail (cur, "指数缺少数字");
+			while (cur < end && *cur >= '0' && *cur <= '9')
+				++cur;
+		}
+
+		const std::from_chars_result result = std::from_chars (start, cur, number);
+		if (result.ec != std::errc () || result.ptr != cur)
+			return Fail (start, "数值超出范围");
+
+		return true;
+	}
+
+	static int HexDigit (char c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		return -1;
+	}
+
+	bool ParseHex4 (std::uint32_t& codeUnit)
+	{
+		if (end - cur < 4)
+			return Fail (cur, "\\u 后应为4位十六进制数");
+
+		codeUnit = 0;
+		for (int i = 0; i < 4; ++i) {
+			const int digit = HexDigit (cur[i]);
+			if (digit < 0)
+				return Fail (cur + i, "\\u 后应为4位十六进制数");
+			codeUnit = (codeUnit << 4) | static_cast<std::uint32_t> (digit);
+		}
+		cur += 4;
+		return true;
+	}
+
+	void AppendUtf8 (std::uint32_t codePoint)
+	{
+		std::vector<char>& out = document.decodedStrings;
+		if (codePoint < 0x80) {
+			out.push_back (static_cast<char> (codePoint));
+		} else if (codePoint < 0x800) {
+			out.push_back (static_cast<char> (0xC0 | (codePoint >> 6)));
+			out.push_back (static_cast<char> (0x80 | (codePoint & 0x3F)));
+		} else if (codePoint < 0x10000) {
+			out.push_back (static_cast<char> (0xE0 | (codePoint >> 12)));
+			out.push_back (static_cast<char> (0x80 | ((codePoint >> 6) & 0x3F)));
+			out.push_back (static_cast<char> (0x80 | (codePoint & 0x3F)));
+		} else {
+			out.push_back (static_cast<char> (0xF0 | (codePoint >> 18)));
+			out.push_back (static_cast<char> (0x80 | ((codePoint >> 12) & 0x3F)));
+			out.push_back (static_cast<char> (0x80 | ((codePoint >> 6) & 0x3F)));
+			out.push_back (static_cast<char> (0x80 | (codePoint & 0x3F)));
+		}
+	}
+
+	bool ParseString (std::string_view& text)
+	{
+		const char* quote = cur;
+		++cur;
+		const char* start = cur;
+
+		// 无转义时直接引用源缓冲区
+		while (cur < end && *cur != '"' && *cur != '\\') {
+			if (static_cast<unsigned char> (*cur) < 0x20)
+				return Fail (cur, "字符串中不能包含控制字符");
+			++cur;
+		}
+		if (cur == end)
+			return Fail (quote, "字符串缺少结束引号");
+		if (*cur == '"') {
+			text = std::string_view (start, static_cast<std::size_t> (cur - start));
+			++cur;
+			return true;
+		}
+
+		// 解码后的字符串不会比源文本长，一次预留整个文档大小即可保证
+		// decodedStrings 不再重新分配，已返回的 string_view 始终有效
+		std::vector<char>& out = document.decodedStrings;
+		if (out.empty ())
+			out.reserve (static_cast<std::size_t> (end - begin));
+
+		const std::size_t decodedStart = out.size ();
+		out.insert (out.end (), start, cur);
+
+		while (cur < end && *cur != '"') {
+			const char c = *cur;
+			if (static_cast<unsigned char> (c) < 0x20)
+				return Fail (cur, "字符串中不能包含控制字符");
+
+			if (c != '\\') {
+				out.push_back (c);
+				++cur;
+				continue;
+			}
+
+			const char* escape = cur;
+			++cur;
+			if (cur == end)
+				break;
+
+			switch (*cur++) {
+				case '"':	out.push_back ('"');	break;
+				case '\\':	out.push_back ('\\');	break;
+				case '/':	out.push_back ('/');	break;
+				case 'b':	out.push_back ('\b');	break;
+				case 'f':	out.push_back ('\f');	break;
+				case 'n':	out.push_back ('\n');	break;
+				case 'r':	out.push_back ('\r');	break;
+				case 't':	out.push_back ('\t');	break;
+				case 'u': {
+					std::uint32_t codePoint = 0;
+					if (!ParseHex4 (codePoint))
+						return false;
+					if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+						std::uint32_t low = 0;
+						if (end - cur < 2 || cur[0] != '\\' || cur[1] != 'u')
+							return Fail (escape, "无效的Unicode代理对");
+						cur += 2;
+						if (!ParseHex4 (low))
+							return false;
+						if (low < 0xDC00 || low > 0xDFFF)
+							return Fail (escape, "无效的Unicode代理对");
+						codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+					} else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+						return Fail (escape, "无效的Unicode代理对");
+					}
+					AppendUtf8 (codePoint);
+					break;
+				}
+				default:
+					return Fail (escape, "无效的转义字符");
+			}
+		}
+
+		if (cur == end)
+			return Fail (quote, "字符串缺少结束引号");
+
+		++cur;
+		text = std::string_view (out.data () + decodedStart, out.size () - decodedStart);
+		return true;
+	}
+
+	Document&	document;
+	const char*	begin;
+	const char*	cur;
+	const char*	end;
+};
+
+bool Document::Parse (const char* data, std::size_t size)
+{
+	values.clear ();
+	decodedStrings.clear ();
+	error = ParseError ();
+
+	Parser parser (*this, data, size);
+	if (!parser.Run ()) {
+		values.clear ();
+		return false;
+	}
+	return true;
+}
+
+const Value* Document::GetRoot () const
+{
+	return values.empty () ? nullptr : &values[0];
+}
+
+const Value* Document::GetFirstChild (const Value& value) const
+{
+	return value.firstChild == kNoValue ? nullptr : &values[value.firstChild];
+}
+
+const Value* Document::GetNextSibling (const Value& value) const
+{
+	return value.nextSibling == kNoValue ? nullptr : &values[value.nextSibling];
+}
+
+const Value* Document::FindMember (const Value& object, std::string_view key) const
+{
+	if (!object.IsObject ())
+		return nullptr;
+
+	// 重复的键以最后一个为准
+	const Value* found = nullptr;
+	for (const Value* member = GetFirstChild (object); member != nullptr; member = GetNextSibling (*member)) {
+		if (member->key == key)
+			found = member;
+	}
+	return found;
+}
+
+// ---------------------------------------------------------------------------
+// 规范读取
+// ---------------------------------------------------------------------------
+
+static const char* const kRuleKeys[StairCore::RuleKindCount] = {
+	"riser_height",		// RiserHeightRule
+	"tread_depth",		// TreadDepthRule
+	"landing_length",	// LandingLengthRule
+	"two_r_plus_g",		// TwoRPlusGoingRule
+	"narrow_tread_depth",	// NarrowTreadDepthRule
+	"riser_variation",	// RiserVariationRule
+	"stair_width",		// StairWidthRule
+	"handrail_height",	// HandrailHeightRule
+	"slope_angle",		// SlopeAngleRule（度）
+	"between_flights"	// FlightSpacingRule
+};
+
+const char* GetRuleKey (StairCore::RuleKind kind)
+{
+	return kind < StairCore::RuleKindCount ? kRuleKeys[kind] : "";
+}
+
+bool RegulationRecord::HasAnyRule () const
+{
+	for (const RuleRecord& rule : rules) {
+		if (rule.HasAnyLimit ())
+			return true;
+	}
+	return false;
+}
+
+static bool FindRuleKind (std::string_view key, StairCore::RuleKind& kind)
+{
+	for (std::uint32_t i = 0; i < StairCore::RuleKindCount; ++i) {
+		if (key == kRuleKeys[i]) {
+			kind = static_cast<StairCore::RuleKind> (i);
+			return true;
+		}
+	}
+	return false;
+}
+
+static void ReadLimit (const Value& value, std::optional<double>& limit)
+{
+	if (value.IsNumber ())
+		limit = value.number;
+	else
+		limit.reset ();
+}
+
+static void ReadRule (const Document& document, const Value& object, RuleRecord& rule)
+{
+	rule = RuleRecord ();
+
+	for (const Value* member = document.GetFirstChild (object); member != nullptr; member = document.GetNextSibling (*member)) {
+		if (member->key == "min_value")
+			ReadLimit (*member, rule.minValue);
+		else if (member->key == "max_value")
+			ReadLimit (*member, rule.maxValue);
+		else if (member->key == "unit" && member->IsString ())
+			rule.unit.assign (member->string);
+		else if (member->key == "source" && member->IsString ())
+			rule.source.assign (member->string);
+		else if (member->key == "full_text" && member->IsString ())
+			rule.fullText.assign (member->string);
+	}
+}
+
+static void ReadRules (const Document& document, const Value& object, RegulationRecord& regulation)
+{
+	for (const Value* member = document.GetFirstChild (object); member != nullptr; member = document.GetNextSibling (*member)) {
+		StairCore::RuleKind kind = StairCore::RuleKindCount;
+		if (member->IsObject () && FindRuleKind (member->key, kind))
+			ReadRule (document, *member, regulation.rules[kind]);
+	}
+}
+
+// 读取适用范围字段，不是适用范围字段时返回false
+static bool ReadScope (const Document& document, const Value& member, RegulationRecord& regulation)
+{
+	if (member.key == "jurisdiction") {
+		if (member.IsString ())
+			regulation.jurisdiction.assign (member.string);
+		return true;
+	}
+
+	if (member.key == "building_type") {
+		if (member.IsString ())
+			regulation.buildingTypes.assign (1, std::string (member.string));
+		return true;
+	}
+
+	if (member.key == "building_types") {
+		regulation.buildingTypes.clear ();
+		for (const Value* type = document.GetFirstChild (member); type != nullptr; type = document.GetNextSibling (*type)) {
+			if (type->IsString ())
+				regulation.buildingTypes.emplace_back (type->string);
+		}
+		return true;
+	}
+
+	return false;
+}
+
+static void ReadMeta (const Document& document, const Value& object, RegulationRecord& regulation)
+{
+	for (const Value* member = document.GetFirstChild (object); member != nullptr; member = document.GetNextSibling (*member))
+		ReadScope (document, *member, regulation);
+}
+
+static void ReadRegulation (const Document& document, const Value& object, RegulationRecord& regulation)
+{
+	for (const Value* member = document.GetFirstChild (object); member != nullptr; member = document.GetNextSibling (*member)) {
+		StairCore::RuleKind kind = StairCore::RuleKindCount;
+		if (member->key == "regulation_name" && member->IsString ())
+			regulation.name.assign (member->string);
+		else if (member->key == "regulation_code" && member->IsString ())
+			regulation.code.assign (member->string);
+		else if (member->key == "rules" && member->IsObject ())
+			ReadRules (document, *member, regulation);
+		else if (member->key == "meta" && member->IsObject ())
+			ReadMeta (document, *member, regulation);
+		else if (ReadScope (document, *member, regulation))
+			continue;
+		else if (member->IsObject () && FindRuleKind (member->key, kind))
+			ReadRule (document, *member, regulation.rules[kind]);
+	}
+}
+
+static void ReadRegulationArray (const Document& document, const Value& array, std::vector<RegulationRecord>& regulations)
+{
+	regulations.reserve (regulations.size () + array.childCount);
+	for (const Value* element = document.GetFirstChild (array); element != nullptr; element = document.GetNextSibling (*element)) {
+		if (!element->IsObject ())
+			continue;
+		regulations.emplace_back ();
+		ReadRegulation (document, *element, regulations.back ());
+	}
+}
+
+bool ReadRegulations (const Document& document, std::vector<RegulationRecord>& regulations)
+{
+	const Value* root = document.GetRoot ();
+	if (root == nullptr)
+		return false;
+
+	const std::size_t initialCount = regulations.size ();
+
+	if (root->IsArray ()) {
+		ReadRegulationArray (document, *root, regulations);
+	} else if (root->IsObject ()) {
+		const Value* list = document.FindMember (*root, "regulations");
+		if (list != nullptr && list->IsArray ()) {
+			ReadRegulationArray (document, *list, regulations);
+		} else {
+			regulations.emplace_back ();
+			ReadRegulation (document, *root, regulations.back ());
+		}
+	}
+
+	return regulations.size () > initialCount;
+}
+
+} // namespace RegulationJson
@@ -0,0 +1,115 @@
+#ifndef REGULATION_JSON_HPP
+#define REGULATION_JSON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "StairEvaluationCore.hpp"
+
+/**
+ * 规范JSON解析（与ArchiCAD无关）
+ *
+ * Document 一次遍历UTF-8缓冲区生成扁平的DOM：所有节点存放在一个数组中，
+ * 字符串不含转义时直接引用源缓冲区，含转义时解码到一块预留的内存中。
+ * 解析后源缓冲区必须保持有效。
+ */
+namespace RegulationJson {
+
+constexpr std::uint32_t kNoValue = 0xFFFFFFFFu;
+
+enum class ValueType : std::uint8_t {
+	Null,
+	Boolean,
+	Number,
+	String,
+	Array,
+	Object
+};
+
+struct Value {
+	ValueType			type = ValueType::Null;
+	bool				boolean = false;
+	double				number = 0.0;
+	std::string_view	key;						// 对象成员的键
+	std::string_view	string;
+	std::uint32_t		firstChild = kNoValue;
+	std::uint32_t		nextSibling = kNoValue;
+	std::uint32_t		childCount = 0;
+
+	bool IsNull () const	{ return type == ValueType::Null; }
+	bool IsNumber () const	{ return type == ValueType::Number; }
+	bool IsString () const	{ return type == ValueType::String; }
+	bool IsArray () const	{ return type == ValueType::Array; }
+	bool IsObject () const	{ return type == ValueType::Object; }
+};
+
+// 出错位置：offset 为字节偏移，line/column 从1开始（column 以字节计）
+struct ParseError {
+	std::size_t	offset = 0;
+	std::size_t	line = 0;
+	std::size_t	column = 0;
+	const char*	message = nullptr;		// UTF-8
+};
+
+class Document {
+public:
+	bool				Parse (const char* data, std::size_t size);
+
+	const Value*		GetRoot () const;
+	const Value*		GetFirstChild (const Value& value) const;
+	const Value*		GetNextSibling (const Value& value) const;
+	const Value*		FindMember (const Value& object, std::string_view key) const;
+
+	const ParseError&	GetError () const { return error; }
+	std::size_t			GetValueCount () const { return values.size (); }
+
+private:
+	friend class Parser;
+
+	std::vector<Value>	values;
+	std::vector<char>	decodedStrings;
+	ParseError			error;
+};
+
+// 单条规则（字符串均为UTF-8）
+struct RuleRecord {
+	std::optional<double>	minValue;
+	std::optional<double>	maxValue;
+	std::string				unit = "m";
+	std::string				source;
+	std::string				fullText;
+
+	bool HasAnyLimit () const { return minValue.has_value () || maxValue.has_value (); }
+};
+
+struct RegulationRecord {
+	std::string					name;
+	std::string					code;
+	std::string					jurisdiction;		// 例如 "CN"、"CN-BJ"，为空表示不限地区
+	std::vector<std::string>	buildingTypes;		// 为空表示适用于所有建筑类型
+	RuleRecord					rules[StairCore::RuleKindCount];
+
+	bool HasAnyRule () const;
+};
+
+// 规则键名，例如 RiserHeightRule -> "riser_height"
+const char*	GetRuleKey (StairCore::RuleKind kind);
+
+/**
+ * 读取文档中的规范
+ *
+ * 支持三种布局：单个规范对象（Python工具的输出）、规范对象数组、
+ * 以及 { "regulations": [ ... ] }。规则既可以直接放在规范对象中，
+ * 也可以放在其 "rules" 子对象中。适用范围（"jurisdiction"、"building_types"
+ * 或单个 "building_type"）可以放在规范对象或其 "meta" 子对象中。
+ * 每个规范对象只遍历一次。
+ */
+bool		ReadRegulations (const Document& document, std::vector<RegulationRecord>& regulations);
+
+} // namespace RegulationJson
+
+#endif
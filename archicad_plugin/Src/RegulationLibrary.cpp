@@ -0,0 +1,794 @@
+#include "RegulationLibrary.hpp"
+
+#include <cstring>
+
+namespace StairCore {
+
+namespace {
+
+constexpr std::uint64_t kFnvOffset = 0xcbf29ce484222325ull;
+constexpr std::uint64_t kFnvPrime = 0x100000001b3ull;
+
+void HashBytes (std::uint64_t& hash, const void* data, std::size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*> (data);
+	for (std::size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= kFnvPrime;
+	}
+}
+
+void HashText (std::uint64_t& hash, std::string_view text)
+{
+	const std::uint64_t length = text.size ();
+	HashBytes (hash, &length, sizeof (length));
+	HashBytes (hash, text.data (), text.size ());
+}
+
+void HashLimit (std::uint64_t& hash, const std::optional<double>& limit)
+{
+	const unsigned char present = limit.has_value () ? 1 : 0;
+	HashBytes (hash, &present, sizeof (present));
+	if (limit.has_value ()) {
+		const double value = *limit;
+		HashBytes (hash, &value, sizeof (value));
+	}
+}
+
+// 规范的合并键：地区 + 编号（无编号时为名称），与 RegulationLibrary::GetRegulationKey 一致
+std::string GetRecordKey (const RegulationJson::RegulationRecord& record)
+{
+	return record.jurisdiction + '\n' + (record.code.empty () ? record.name : record.code);
+}
+
+// 下限取较大者，上限取较小者
+void Tighten (ResolvedRules& cell, RuleKind kind, const RuleLimits& limits, std::uint32_t ruleIndex)
+{
+	RuleLimits& target = cell.ruleSet.rules[kind];
+	if (limits.minValue.has_value () && (!target.minValue.has_value () || *limits.minValue > *target.minValue)) {
+		target.minValue = limits.minValue;
+		cell.minRule[kind] = ruleIndex;
+	}
+	if (limits.maxValue.has_value () && (!target.maxValue.has_value () || *limits.maxValue < *target.maxValue)) {
+		target.maxValue = limits.maxValue;
+		cell.maxRule[kind] = ruleIndex;
+	}
+}
+
+bool SameResolved (const ResolvedRules& a, const ResolvedRules& b)
+{
+	if (a.regulationCount != b.regulationCount)
+		return false;
+	for (std::uint32_t kind = 0; kind < RuleKindCount; ++kind) {
+		const RuleLimits& la = a.ruleSet.rules[kind];
+		const RuleLimits& lb = b.ruleSet.rules[kind];
+		if (la.minValue != lb.minValue || la.maxValue != lb.maxValue || la.enabled != lb.enabled ||
+			a.minRule[kind] != b.minRule[kind] || a.maxRule[kind] != b.maxRule[kind])
+			return false;
+	}
+	return true;
+}
+
+std::uint64_t HashResolved (const ResolvedRules& cell)
+{
+	std::uint64_t hash = kFnvOffset;
+	HashBytes (hash, &cell.regulationCount, sizeof (cell.regulationCount));
+	HashBytes (hash, cell.minRule, sizeof (cell.minRule));
+	HashBytes (hash, cell.maxRule, sizeof (cell.maxRule));
+	return hash;
+}
+
+// 二进制读写：定长字段按本机字节序依次排列
+class ByteWriter {
+public:
+	explicit ByteWriter (std::vector<char>& target) : out (target) {}
+
+	template <typename T>
+	void Put (const T& value)
+	{
+		const char* bytes = reinterpret_cast<const char*> (&value);
+		out.insert (out.end (), bytes, bytes + sizeof (T));
+	}
+
+	void PutBytes (const char* data, std::size_t size) { out.insert (out.end (), data, data + size); }
+
+private:
+	std::vector<char>& out;
+};
+
+class ByteReader {
+public:
+	ByteReader (const char* data, std::size_t size) : cur (data), end (data + size) {}
+
+	template <typename T>
+	bool Get (T& value)
+	{
+		if (static_cast<std::size_t> (end - cur) < sizeof (T))
+			return false;
+		std::memcpy (&value, cur, sizeof (T));
+		cur += sizeof (T);
+		return true;
+	}
+
+	bool GetBytes (std::size_t size, const char*& data)
+	{
+		if (static_cast<std::size_t> (end - cur) < size)
+			return false;
+		data = cur;
+		cur += size;
+		return true;
+	}
+
+	bool IsAtEnd () const { return cur == end; }
+
+private:
+	const char*	cur;
+	const char*	end;
+};
+
+enum LimitFlags : std::uint8_t {
+	HasMinValue	= 1,
+	HasMaxValue	= 2,
+	RuleEnabled	= 4
+};
+
+void PutLimits (ByteWriter& writer, const RuleLimits& limits)
+{
+	const std::uint8_t flags = static_cast<std::uint8_t> ((limits.minValue.has_value () ? HasMinValue : 0) |
+		(limits.maxValue.has_value () ? HasMaxValue : 0) | (limits.enabled ? RuleEnabled : 0));
+	writer.Put (flags);
+	writer.Put (limits.minValue.value_or (0.0));
+	writer.Put (limits.maxValue.value_or (0.0));
+}
+
+bool GetLimits (ByteReader& reader, RuleLimits& limits)
+{
+	std::uint8_t flags = 0;
+	double minValue = 0.0;
+	double maxValue = 0.0;
+	if (!reader.Get (flags) || !reader.Get (minValue) || !reader.Get (maxValue))
+		return false;
+
+	limits.minValue.reset ();
+	limits.maxValue.reset ();
+	if ((flags & HasMinValue) != 0)
+		limits.minValue = minValue;
+	if ((flags & HasMaxValue) != 0)
+		limits.maxValue = maxValue;
+	limits.enabled = (flags & RuleEnabled) != 0;
+	return true;
+}
+
+} // namespace
+
+ResolvedRules::ResolvedRules ()
+{
+	for (std::uint32_t kind = 0; kind < RuleKindCount; ++kind) {
+		minRule[kind] = kNoRule;
+		maxRule[kind] = kNoRule;
+	}
+}
+
+RegulationLibrary::RegulationLibrary () :
+	enabledRuleMask ((1u << RuleKindCount) - 1),
+	fingerprint (kFnvOffset)
+{
+	Clear ();
+}
+
+void RegulationLibrary::Clear ()
+{
+	regulations.clear ();
+	rules.clear ();
+	texts.clear ();
+	jurisdictionNames.assign (1, TextRef ());
+	jurisdictionParents.assign (1, 0);
+	jurisdictionIds.clear ();
+	buildingTypeNames.clear ();
+	buildingTypeIds.clear ();
+	BuildIndex ();
+}
+
+void RegulationLibrary::SetEnabledRules (std::uint32_t mask)
+{
+	if (mask == enabledRuleMask)
+		return;
+
+	enabledRuleMask = mask;
+	BuildIndex ();
+}
+
+void RegulationLibrary::Merge (const std::vector<RegulationJson::RegulationRecord>& records)
+{
+	RegulationLibrary merged;
+	merged.enabledRuleMask = enabledRuleMask;
+
+	// 同一批记录中键相同时以最后一个为准
+	std::unordered_map<std::string, std::size_t> recordByKey;
+	std::size_t textSize = texts.size ();
+	std::size_t ruleCount = rules.size ();
+	for (std::size_t i = 0; i < records.size (); ++i) {
+		const RegulationJson::RegulationRecord& record = records[i];
+		if (!record.HasAnyRule ())
+			continue;
+		recordByKey[GetRecordKey (record)] = i;
+		textSize += record.name.size () + record.code.size ();
+		for (const RegulationJson::RuleRecord& rule : record.rules)
+			textSize += rule.unit.size () + rule.source.size () + rule.fullText.size ();
+		ruleCount += RuleKindCount;
+	}
+
+	merged.regulations.reserve (regulations.size () + recordByKey.size ());
+	merged.rules.reserve (ruleCount);
+	merged.texts.reserve (textSize);
+
+	// 被替换的规范保持原来的位置，内容相同的文件重复合并时规则库不变
+	std::vector<bool> recordUsed (records.size (), false);
+	for (const Regulation& regulation : regulations) {
+		const auto found = recordByKey.find (GetRegulationKey (regulation));
+		if (found == recordByKey.end ()) {
+			merged.AppendRegulation (*this, regulation);
+		} else if (!recordUsed[found->second]) {
+			merged.AppendRegulation (records[found->second]);
+			recordUsed[found->second] = true;
+		}
+	}
+
+	// 新规范按记录顺序追加
+	for (std::size_t i = 0; i < records.size (); ++i) {
+		if (recordUsed[i] || !records[i].HasAnyRule () || recordByKey[GetRecordKey (records[i])] != i)
+			continue;
+		merged.AppendRegulation (records[i]);
+		recordUsed[i] = true;
+	}
+
+	merged.BuildIndex ();
+	*this = std::move (merged);
+}
+
+void RegulationLibrary::Merge (const std::vector<std::vector<RegulationJson::RegulationRecord>>& batches)
+{
+	// 先按逐批合并的规则归并为键不重复的一批：已出现的键原位替换，新键按批内最后一次出现的顺序追加
+	std::vector<RegulationJson::RegulationRecord> combined;
+	std::unordered_map<std::string, std::size_t> positionByKey;
+	std::unordered_map<std::string, std::size_t> lastInBatch;
+	for (const std::vector<RegulationJson::RegulationRecord>& batch : batches) {
+		lastInBatch.clear ();
+		for (std::size_t i = 0; i < batch.size (); ++i) {
+			if (batch[i].HasAnyRule ())
+				lastInBatch[GetRecordKey (batch[i])] = i;
+		}
+
+		for (std::size_t i = 0; i < batch.size (); ++i) {
+			if (!batch[i].HasAnyRule ())
+				continue;
+			std::string key = GetRecordKey (batch[i]);
+			if (lastInBatch[key] != i)
+				continue;
+
+			const auto found = positionByKey.find (key);
+			if (found != positionByKey.end ()) {
+				combined[found->second] = batch[i];
+			} else {
+				positionByKey.emplace (std::move (key), combined.size ());
+				combined.push_back (batch[i]);
+			}
+		}
+	}
+
+	Merge (combined);
+}
+
+RuleContext RegulationLibrary::MakeContext (std::string_view jurisdiction, std::string_view buildingType) const
+{
+	RuleContext context;
+
+	if (!jurisdiction.empty ()) {
+		context.jurisdiction = static_cast<std::uint16_t> (jurisdictionParents.size ());
+		for (std::string_view name = jurisdiction; !name.empty ();) {
+			const auto found = jurisdictionIds.find (std::string (name));
+			if (found != jurisdictionIds.end ()) {
+				context.jurisdiction = found->second;
+				break;
+			}
+			const std::size_t separator = name.rfind ('-');
+			name = (separator == std::string_view::npos) ? std::string_view () : name.substr (0, separator);
+		}
+	}
+
+	if (!buildingType.empty ()) {
+		const auto found = buildingTypeIds.find (std::string (buildingType));
+		context.buildingType = (found != buildingTypeIds.end ()) ? found->second : static_cast<std::uint16_t> (buildingTypeNames.size () + 1);
+	}
+
+	return context;
+}
+
+std::uint32_t RegulationLibrary::GetGoverningRule (const ResolvedRules& cell, RuleKind kind, const StairMetrics& metrics) const
+{
+	if (kind >= RuleKindCount)
+		return kNoRule;
+
+	const RuleLimits& limits = cell.ruleSet.rules[kind];
+	if (limits.minValue.has_value () && GetMetricValue (metrics, kind) < *limits.minValue)
+		return cell.minRule[kind];
+	if (cell.maxRule[kind] != kNoRule)
+		return cell.maxRule[kind];
+	return cell.minRule[kind];
+}
+
+std::string_view RegulationLibrary::GetJurisdictionName (std::uint16_t jurisdiction) const
+{
+	if (jurisdiction == 0 || jurisdiction >= jurisdictionNames.size ())
+		return std::string_view ();
+	return GetText (jurisdictionNames[jurisdiction]);
+}
+
+std::string_view RegulationLibrary::GetBuildingTypeName (std::uint16_t buildingType) const
+{
+	if (buildingType == 0 || buildingType > buildingTypeNames.size ())
+		return std::string_view ();
+	return GetText (buildingTypeNames[buildingType - 1]);
+}
+
+std::size_t RegulationLibrary::GetMemoryUsage () const
+{
+	std::size_t bytes = regulations.capacity () * sizeof (Regulation) +
+		rules.capacity () * sizeof (Rule) +
+		texts.capacity () +
+		jurisdictionNames.capacity () * sizeof (TextRef) +
+		jurisdictionParents.capacity () * sizeof (std::uint16_t) +
+		buildingTypeNames.capacity () * sizeof (TextRef) +
+		resolvedIndices.capacity () * sizeof (std::uint32_t) +
+		resolved.capacity () * sizeof (ResolvedRules) +
+		ruleOps.capacity () * sizeof (RuleOp);
+
+	// 名称查找表：每个节点约为键、编号和两个指针
+	for (const auto& entry : jurisdictionIds)
+		bytes += entry.first.capacity () + sizeof (entry) + 2 * sizeof (void*);
+	for (const auto& entry : buildingTypeIds)
+		bytes += entry.first.capacity () + sizeof (entry) + 2 * sizeof (void*);
+
+	return bytes;
+}
+
+RegulationLibrary::TextRef RegulationLibrary::AddText (std::string_view text)
+{
+	TextRef ref;
+	ref.offset = static_cast<std::uint32_t> (texts.size ());
+	ref.length = static_cast<std::uint32_t> (text.size ());
+	texts.append (text.data (), text.size ());
+	return ref;
+}
+
+std::uint16_t RegulationLibrary::InternJurisdiction (std::string_view name)
+{
+	if (name.empty ())
+		return 0;
+
+	const auto found = jurisdictionIds.find (std::string (name));
+	if (found != jurisdictionIds.end ())
+		return found->second;
+
+	if (jurisdictionParents.size () > kMaxJurisdictions)
+		return 0;
+
+	// 先登记上级地区，"CN-BJ-HD" -> "CN-BJ" -> "CN"
+	const std::size_t separator = name.rfind ('-');
+	const std::uint16_t parent = (separator == std::string_view::npos) ? 0 : InternJurisdiction (name.substr (0, separator));
+
+	const std::uint16_t id = static_cast<std::uint16_t> (jurisdictionParents.size ());
+	jurisdictionNames.push_back (AddText (name));
+	jurisdictionParents.push_back (parent);
+	jurisdictionIds.emplace (std::string (name), id);
+	return id;
+}
+
+std::uint64_t RegulationLibrary::InternBuildingType (std::string_view name)
+{
+	if (name.empty ())
+		return 0;
+
+	const auto found = buildingTypeIds.find (std::string (name));
+	if (found != buildingTypeIds.end ())
+		return 1ull << (found->second - 1);
+
+	if (buildingTypeNames.size () >= kMaxBuildingTypes)
+		return 0;
+
+	buildingTypeNames.push_back (AddText (name));
+	const std::uint16_t id = static_cast<std::uint16_t> (buildingTypeNames.size ());
+	buildingTypeIds.emplace (std::string (name), id);
+	return 1ull << (id - 1);
+}
+
+void RegulationLibrary::AppendRule (std::uint32_t regulation, RuleKind kind, const RuleLimits& limits,
+									std::string_view unit, std::string_view source, std::string_view fullText)
+{
+	Rule rule;
+	rule.kind = kind;
+	rule.regulation = regulation;
+	rule.limits = limits;
+	rule.unit = AddText (unit);
+	rule.source = AddText (source);
+	rule.fullText = AddText (fullText);
+	rules.push_back (rule);
+	++regulations[regulation].ruleCount;
+}
+
+void RegulationLibrary::AppendRegulation (const RegulationLibrary& source, const Regulation& regulation)
+{
+	const std::uint32_t index = static_cast<std::uint32_t> (regulations.size ());
+	regulations.emplace_back ();
+	{
+		Regulation& target = regulations.back ();
+		target.name = AddText (source.GetText (regulation.name));
+		target.code = AddText (source.GetText (regulation.code));
+		target.jurisdiction = InternJurisdiction (source.GetJurisdictionName (regulation.jurisdiction));
+		target.firstRule = static_cast<std::uint32_t> (rules.size ());
+	}
+
+	std::uint64_t mask = 0;
+	for (std::size_t bit = 0; bit < kMaxBuildingTypes; ++bit) {
+		if ((regulation.buildingTypeMask & (1ull << bit)) != 0)
+			mask |= InternBuildingType (source.GetBuildingTypeName (static_cast<std::uint16_t> (bit + 1)));
+	}
+	regulations.back ().buildingTypeMask = mask;
+
+	for (std::uint32_t i = 0; i < regulation.ruleCount; ++i) {
+		const Rule& rule = source.rules[regulation.firstRule + i];
+		AppendRule (index, rule.kind, rule.limits, source.GetText (rule.unit), source.GetText (rule.source), source.GetText (rule.fullText));
+	}
+}
+
+void RegulationLibrary::AppendRegulation (const RegulationJson::RegulationRecord& record)
+{
+	const std::uint32_t index = static_cast<std::uint32_t> (regulations.size ());
+	regulations.emplace_back ();
+	{
+		Regulation& target = regulations.back ();
+		target.name = AddText (record.name);
+		target.code = AddText (record.code);
+		target.jurisdiction = InternJurisdiction (record.jurisdiction);
+		target.firstRule = static_cast<std::uint32_t> (rules.size ());
+	}
+
+	// 任一类型超出上限时按不限处理，避免规范被错误地限制到部分类型
+	std::uint64_t mask = 0;
+	for (const std::string& buildingType : record.buildingTypes) {
+		const std::uint64_t bit = InternBuildingType (buildingType);
+		if (bit == 0 && !buildingType.empty ()) {
+			mask = 0;
+			break;
+		}
+		mask |= bit;
+	}
+	regulations.back ().buildingTypeMask = mask;
+
+	for (std::uint32_t kind = 0; kind < RuleKindCount; ++kind) {
+		const RegulationJson::RuleRecord& rule = record.rules[kind];
+		if (!rule.HasAnyLimit ())
+			continue;
+
+		RuleLimits limits;
+		limits.minValue = rule.minValue;
+		limits.maxValue = rule.maxValue;
+		AppendRule (index, static_cast<RuleKind> (kind), limits, rule.unit, rule.source, rule.fullText);
+	}
+}
+
+std::string RegulationLibrary::GetRegulationKey (const Regulation& regulation) const
+{
+	std::string key (GetJurisdictionName (regulation.jurisdiction));
+	key += '\n';
+	key += GetText (regulation.code.length > 0 ? regulation.code : regulation.name);
+	return key;
+}
+
+std::uint32_t RegulationLibrary::FindRule (std::string_view regulationKey, RuleKind kind) const
+{
+	for (const Regulation& regulation : regulations) {
+		if (GetRegulationKey (regulation) != regulationKey)
+			continue;
+
+		for (std::uint32_t rule = regulation.firstRule; rule < regulation.firstRule + regulation.ruleCount; ++rule) {
+			if (rules[rule].kind == kind)
+				return rule;
+		}
+		return kNoRule;
+	}
+	return kNoRule;
+}
+
+bool RegulationLibrary::IsApplicable (const Regulation& regulation, std::size_t column) const
+{
+	if (column == 0 || regulation.buildingTypeMask == 0)
+		return true;
+	if (column > buildingTypeNames.size ())
+		return false;
+	return (regulation.buildingTypeMask & (1ull << (column - 1))) != 0;
+}
+
+void RegulationLibrary::ResolveCell (std::size_t row, std::size_t column, const std::vector<std::uint32_t>& regulationOffsets,
+									 const std::vector<std::uint32_t>& regulationsByJurisdiction, ResolvedRules& cell) const
+{
+	auto applyRegulation = [&] (std::uint32_t regulationIndex) {
+		const Regulation& regulation = regulations[regulationIndex];
+		if (!IsApplicable (regulation, column))
+			return;
+		++cell.regulationCount;
+		for (std::uint32_t i = 0; i < regulation.ruleCount; ++i) {
+			const std::uint32_t ruleIndex = regulation.firstRule + i;
+			Tighten (cell, rules[ruleIndex].kind, rules[ruleIndex].limits, ruleIndex);
+		}
+	};
+
+	auto applyJurisdiction = [&] (std::size_t jurisdiction) {
+		for (std::uint32_t k = regulationOffsets[jurisdiction]; k < regulationOffsets[jurisdiction + 1]; ++k)
+			applyRegulation (regulationsByJurisdiction[k]);
+	};
+
+	if (row == 0) {
+		// 不限地区：所有规范
+		for (std::uint32_t i = 0; i < regulations.size (); ++i)
+			applyRegulation (i);
+	} else {
+		// 本地区及各级上级地区，最后是不限地区的规范；未收录地区只有后者
+		if (row < jurisdictionParents.size ()) {
+			for (std::size_t jurisdiction = row; jurisdiction != 0; jurisdiction = jurisdictionParents[jurisdiction])
+				applyJurisdiction (jurisdiction);
+		}
+		applyJurisdiction (0);
+	}
+
+	for (std::uint32_t kind = 0; kind < RuleKindCount; ++kind)
+		cell.ruleSet.rules[kind].enabled = (enabledRuleMask & (1u << kind)) != 0;
+}
+
+void RegulationLibrary::BuildIndex ()
+{
+	// 按地区分组的规范索引（CSR）
+	const std::size_t jurisdictionCount = jurisdictionParents.size ();
+	std::vector<std::uint32_t> regulationOffsets (jurisdictionCount + 1, 0);
+	for (const Regulation& regulation : regulations)
+		++regulationOffsets[regulation.jurisdiction + 1];
+	for (std::size_t i = 1; i < regulationOffsets.size (); ++i)
+		regulationOffsets[i] += regulationOffsets[i - 1];
+
+	std::vector<std::uint32_t> regulationsByJurisdiction (regulations.size ());
+	{
+		std::vector<std::uint32_t> cursor (regulationOffsets.begin (), regulationOffsets.end () - 1);
+		for (std::uint32_t i = 0; i < regulations.size (); ++i)
+			regulationsByJurisdiction[cursor[regulations[i].jurisdiction]++] = i;
+	}
+
+	// 逐格合并生效规则，相同的结果只保存一份
+	const std::size_t rowCount = jurisdictionCount + 1;
+	const std::size_t columnCount = buildingTypeNames.size () + 2;
+	resolvedIndices.assign (rowCount * columnCount, 0);
+	resolved.clear ();
+
+	std::unordered_multimap<std::uint64_t, std::uint32_t> uniqueCells;
+	for (std::size_t row = 0; row < rowCount; ++row) {
+		for (std::size_t column = 0; column < columnCount; ++column) {
+			ResolvedRules cell;
+			ResolveCell (row, column, regulationOffsets, regulationsByJurisdiction, cell);
+
+			const std::uint64_t hash = HashResolved (cell);
+			std::uint32_t index = kNoRule;
+			const auto range = uniqueCells.equal_range (hash);
+			for (auto it = range.first; it != range.second; ++it) {
+				if (SameResolved (resolved[it->second], cell)) {
+					index = it->second;
+					break;
+				}
+			}
+			if (index == kNoRule) {
+				index = static_cast<std::uint32_t> (resolved.size ());
+				resolved.push_back (cell);
+				uniqueCells.emplace (hash, index);
+			}
+			resolvedIndices[row * columnCount + column] = index;
+		}
+	}
+	resolved.shrink_to_fit ();
+	CompileResolved ();
+
+	// 内容指纹
+	fingerprint = kFnvOffset;
+	HashBytes (fingerprint, &enabledRuleMask, sizeof (enabledRuleMask));
+	for (const Regulation& regulation : regulations) {
+		HashText (fingerprint, GetJurisdictionName (regulation.jurisdiction));
+		for (std::size_t bit = 0; bit < kMaxBuildingTypes; ++bit) {
+			if ((regulation.buildingTypeMask & (1ull << bit)) != 0)
+				HashText (fingerprint, GetBuildingTypeName (static_cast<std::uint16_t> (bit + 1)));
+		}
+		for (std::uint32_t i = 0; i < regulation.ruleCount; ++i) {
+			const Rule& rule = rules[regulation.firstRule + i];
+			HashBytes (fingerprint, &rule.kind, sizeof (rule.kind));
+			HashLimit (fingerprint, rule.limits.minValue);
+			HashLimit (fingerprint, rule.limits.maxValue);
+			HashText (fingerprint, GetText (rule.fullText));
+		}
+	}
+}
+
+void RegulationLibrary::Serialize (std::vector<char>& out) const
+{
+	out.clear ();
+	out.reserve (64 + regulations.size () * 40 + rules.size () * 48 + texts.size () +
+		resolvedIndices.size () * sizeof (std::uint32_t) + resolved.size () * (4 + RuleKindCount * 25));
+
+	ByteWriter writer (out);
+	writer.Put (enabledRuleMask);
+	writer.Put (fingerprint);
+	writer.Put (static_cast<std::uint32_t> (regulations.size ()));
+	writer.Put (static_cast<std::uint32_t> (rules.size ()));
+	writer.Put (static_cast<std::uint32_t> (texts.size ()));
+	writer.Put (static_cast<std::uint32_t> (jurisdictionParents.size ()));
+	writer.Put (static_cast<std::uint32_t> (buildingTypeNames.size ()));
+	writer.Put (static_cast<std::uint32_t> (resolved.size ()));
+
+	writer.PutBytes (texts.data (), texts.size ());
+
+	for (std::size_t i = 0; i < jurisdictionParents.size (); ++i) {
+		writer.Put (jurisdictionNames[i]);
+		writer.Put (jurisdictionParents[i]);
+	}
+	for (const TextRef& name : buildingTypeNames)
+		writer.Put (name);
+
+	for (const Regulation& regulation : regulations) {
+		writer.Put (regulation.name);
+		writer.Put (regulation.code);
+		writer.Put (regulation.jurisdiction);
+		writer.Put (regulation.buildingTypeMask);
+		writer.Put (regulation.firstRule);
+		writer.Put (regulation.ruleCount);
+	}
+
+	for (const Rule& rule : rules) {
+		writer.Put (static_cast<std::uint32_t> (rule.kind));
+		writer.Put (rule.regulation);
+		PutLimits (writer, rule.limits);
+		writer.Put (rule.unit);
+		writer.Put (rule.source);
+		writer.Put (rule.fullText);
+	}
+
+	for (const std::uint32_t index : resolvedIndices)
+		writer.Put (index);
+
+	for (const ResolvedRules& cell : resolved) {
+		writer.Put (cell.regulationCount);
+		for (std::uint32_t kind = 0; kind < RuleKindCount; ++kind) {
+			PutLimits (writer, cell.ruleSet.rules[kind]);
+			writer.Put (cell.minRule[kind]);
+			writer.Put (cell.maxRule[kind]);
+		}
+	}
+}
+
+bool RegulationLibrary::Deserialize (const char* data, std::size_t size)
+{
+	if (ReadPayload (data, size))
+		return true;
+
+	Clear ();
+	return false;
+}
+
+bool RegulationLibrary::ReadPayload (const char* data, std::size_t size)
+{
+	ByteReader reader (data, size);
+
+	// 启用的规则类别和指纹在全部校验通过后才写入，失败时Deserialize用原来的规则类别清空规范库
+	std::uint32_t ruleMask = 0;
+	std::uint64_t storedFingerprint = 0;
+	std::uint32_t regulationCount = 0, ruleCount = 0, textSize = 0, jurisdictionCount = 0, buildingTypeCount = 0, resolvedCount = 0;
+	if (!reader.Get (ruleMask) || !reader.Get (storedFingerprint) ||
+		!reader.Get (regulationCount) || !reader.Get (ruleCount) || !reader.Get (textSize) ||
+		!reader.Get (jurisdictionCount) || !reader.Get (buildingTypeCount) || !reader.Get (resolvedCount))
+		return false;
+
+	// 数量先与剩余字节数比较，避免损坏的数据导致巨大的分配
+	if (jurisdictionCount == 0 || jurisdictionCount > kMaxJurisdictions + 1 || buildingTypeCount > kMaxBuildingTypes ||
+		textSize > size || regulationCount > size || ruleCount > size || resolvedCount == 0 || resolvedCount > size)
+		return false;
+
+	const char* textData = nullptr;
+	if (!reader.GetBytes (textSize, textData))
+		return false;
+	texts.assign (textData, textSize);
+
+	auto validText = [&] (const TextRef& text) {
+		return text.offset <= textSize && text.length <= textSize - text.offset;
+	};
+
+	jurisdictionNames.resize (jurisdictionCount);
+	jurisdictionParents.resize (jurisdictionCount);
+	jurisdictionIds.clear ();
+	for (std::uint32_t i = 0; i < jurisdictionCount; ++i) {
+		if (!reader.Get (jurisdictionNames[i]) || !reader.Get (jurisdictionParents[i]) || !validText (jurisdictionNames[i]))
+			return false;
+		// 上级地区编号总是小于下级
+		if (i > 0 && jurisdictionParents[i] >= i)
+			return false;
+		if (i > 0)
+			jurisdictionIds.emplace (std::string (GetText (jurisdictionNames[i])), static_cast<std::uint16_t> (i));
+	}
+
+	buildingTypeNames.resize (buildingTypeCount);
+	buildingTypeIds.clear ();
+	for (std::uint32_t i = 0; i < buildingTypeCount; ++i) {
+		if (!reader.Get (buildingTypeNames[i]) || !validText (buildingTypeNames[i]))
+			return false;
+		buildingTypeIds.emplace (std::string (GetText (buildingTypeNames[i])), static_cast<std::uint16_t> (i + 1));
+	}
+
+	regulations.resize (regulationCount);
+	for (Regulation& regulation : regulations) {
+		if (!reader.Get (regulation.name) || !reader.Get (regulation.code) || !reader.Get (regulation.jurisdiction) ||
+			!reader.Get (regulation.buildingTypeMask) || !reader.Get (regulation.firstRule) || !reader.Get (regulation.ruleCount))
+			return false;
+		if (!validText (regulation.name) || !validText (regulation.code) || regulation.jurisdiction >= jurisdictionCount ||
+			regulation.firstRule > ruleCount || regulation.ruleCount > ruleCount - regulation.firstRule)
+			return false;
+	}
+
+	rules.resize (ruleCount);
+	for (Rule& rule : rules) {
+		std::uint32_t kind = 0;
+		if (!reader.Get (kind) || !reader.Get (rule.regulation) || !GetLimits (reader, rule.limits) ||
+			!reader.Get (rule.unit) || !reader.Get (rule.source) || !reader.Get (rule.fullText))
+			return false;
+		if (kind >= RuleKindCount || rule.regulation >= regulationCount ||
+			!validText (rule.unit) || !validText (rule.source) || !validText (rule.fullText))
+			return false;
+		rule.kind = static_cast<RuleKind> (kind);
+	}
+
+	const std::size_t cellCount = (static_cast<std::size_t> (jurisdictionCount) + 1) * (buildingTypeCount + 2);
+	resolvedIndices.resize (cellCount);
+	for (std::uint32_t& index : resolvedIndices) {
+		if (!reader.Get (index) || index >= resolvedCount)
+			return false;
+	}
+
+	resolved.resize (resolvedCount);
+	for (ResolvedRules& cell : resolved) {
+		if (!reader.Get (cell.regulationCount))
+			return false;
+		for (std::uint32_t kind = 0; kind < RuleKindCount; ++kind) {
+			if (!GetLimits (reader, cell.ruleSet.rules[kind]) || !reader.Get (cell.minRule[kind]) || !reader.Get (cell.maxRule[kind]))
+				return false;
+			if ((cell.minRule[kind] != kNoRule && cell.minRule[kind] >= ruleCount) || (cell.maxRule[kind] != kNoRule && cell.maxRule[kind] >= ruleCount))
+				return false;
+		}
+	}
+
+	if (!reader.IsAtEnd ())
+		return false;
+
+	enabledRuleMask = ruleMask;
+	fingerprint = storedFingerprint;
+	CompileResolved ();
+	return true;
+}
+
+void RegulationLibrary::CompileResolved ()
+{
+	ruleOps.resize (resolved.size () * RuleKindCount);
+
+	std::size_t opCount = 0;
+	for (ResolvedRules& cell : resolved) {
+		cell.firstOp = static_cast<std::uint32_t> (opCount);
+		cell.opCount = static_cast<std::uint32_t> (CompileRuleSet (cell.ruleSet, ruleOps.data () + opCount));
+		opCount += cell.opCount;
+	}
+
+	ruleOps.resize (opCount);
+	ruleOps.shrink_to_fit ();
+}
+
+} // namespace StairCore
@@ -0,0 +1,187 @@
+#ifndef REGULATION_LIBRARY_HPP
+#define REGULATION_LIBRARY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "RegulationJson.hpp"
+#include "StairEvaluationCore.hpp"
+#include "StairRuleProgram.hpp"
+
+namespace StairCore {
+
+constexpr std::uint32_t	kNoRule = 0xFFFFFFFFu;
+constexpr std::size_t	kMaxBuildingTypes = 64;
+constexpr std::size_t	kMaxJurisdictions = 0xFFF0;
+
+// 某个适用范围下生效的规则：每类规则取所有适用规范中最严格的上下限
+struct ResolvedRules {
+	RuleSet			ruleSet;
+	std::uint32_t	minRule[RuleKindCount];		// 给出下限的规则索引，kNoRule表示没有下限
+	std::uint32_t	maxRule[RuleKindCount];
+	std::uint32_t	regulationCount = 0;		// 适用的规范数
+	std::uint32_t	firstOp = 0;				// 编译后的规则在RegulationLibrary::ruleOps中的位置
+	std::uint32_t	opCount = 0;
+
+	ResolvedRules ();
+};
+
+/**
+ * 多规范规则库（与ArchiCAD无关）
+ *
+ * 规范、规则和文本分别存放在连续数组中，规则库增大时不会产生逐条的小块分配。
+ * 地区按 "-" 分级（"CN-BJ" 的上级为 "CN"），规范适用于其地区及所有下级地区；
+ * 建筑类型最多 kMaxBuildingTypes 种，规范不指定时适用于所有类型。
+ *
+ * Merge后按 (地区, 建筑类型) 预先合并出所有组合的生效规则，Resolve只做一次数组查找。
+ * 相同的合并结果只保存一份，并编译为连续存放的RuleOp供RunRules执行。
+ */
+class RegulationLibrary {
+public:
+	struct TextRef {
+		std::uint32_t	offset = 0;
+		std::uint32_t	length = 0;
+	};
+
+	struct Rule {
+		RuleKind		kind = RuleKindCount;
+		std::uint32_t	regulation = 0;
+		RuleLimits		limits;
+		TextRef			unit;
+		TextRef			source;
+		TextRef			fullText;
+	};
+
+	struct Regulation {
+		TextRef			name;
+		TextRef			code;
+		std::uint16_t	jurisdiction = 0;			// 0 表示不限地区
+		std::uint64_t	buildingTypeMask = 0;		// 第 k 位对应建筑类型 k+1，0 表示不限
+		std::uint32_t	firstRule = 0;
+		std::uint32_t	ruleCount = 0;
+	};
+
+	RegulationLibrary ();
+
+	void					Clear ();
+
+	/**
+	 * 合并规范记录：与已有规范地区和编号（无编号时为名称）都相同的规范被替换，
+	 * 其余追加到末尾，然后重建索引。没有任何规则的记录被忽略。
+	 * 建筑类型超过 kMaxBuildingTypes 种时，多出的类型按不限处理。
+	 */
+	void					Merge (const std::vector<RegulationJson::RegulationRecord>& records);
+
+	/**
+	 * 按顺序合并多批记录（如规范目录中的各个文件），结果与逐批调用 Merge 相同，
+	 * 但只重建一次索引。
+	 */
+	void					Merge (const std::vector<std::vector<RegulationJson::RegulationRecord>>& batches);
+
+	// 参与检测的规则（位掩码，第 k 位对应 RuleKind k），未启用的规则在生效规则中enabled为false
+	void					SetEnabledRules (std::uint32_t mask);
+	std::uint32_t			GetEnabledRules () const { return enabledRuleMask; }
+
+	/**
+	 * 把地区和建筑类型名称转换为适用范围，名称为空表示不限。
+	 * 未收录的地区按最近的已收录上级地区处理，都未收录时只适用不限地区的规范；
+	 * 未收录的建筑类型只适用不限建筑类型的规范。规则库合并后需要重新转换。
+	 */
+	RuleContext				MakeContext (std::string_view jurisdiction, std::string_view buildingType) const;
+
+	const ResolvedRules&	Resolve (RuleContext context) const
+	{
+		const std::size_t row = std::min<std::size_t> (context.jurisdiction, jurisdictionParents.size ());
+		const std::size_t column = std::min<std::size_t> (context.buildingType, buildingTypeNames.size () + 1);
+		return resolved[resolvedIndices[row * (buildingTypeNames.size () + 2) + column]];
+	}
+
+	// 执行生效规则编译后的指令，返回违规规则类别的位掩码
+	std::uint32_t			RunRules (const ResolvedRules& resolvedRules, const StairMetrics& metrics) const
+	{
+		return RunRuleOps (GetRuleOps (resolvedRules), resolvedRules.opCount, metrics);
+	}
+
+	// 生效规则编译后的指令（共resolvedRules.opCount条）
+	const RuleOp*			GetRuleOps (const ResolvedRules& resolvedRules) const { return ruleOps.data () + resolvedRules.firstOp; }
+
+	// 违规时给出限值的规则：实测值低于下限时为下限规则，否则为上限规则
+	std::uint32_t			GetGoverningRule (const ResolvedRules& rules, RuleKind kind, const StairMetrics& metrics) const;
+
+	std::size_t				GetRegulationCount () const { return regulations.size (); }
+	std::size_t				GetRuleCount () const { return rules.size (); }
+	const Regulation&		GetRegulation (std::size_t index) const { return regulations[index]; }
+	const Rule&				GetRule (std::size_t index) const { return rules[index]; }
+	std::string_view		GetText (TextRef text) const { return std::string_view (texts.data () + text.offset, text.length); }
+
+	// 规范的合并键：地区 + 编号（无编号时为名称）。Merge会重排规范和规则，合并键不变，
+	// 需要在合并后继续引用某部规范时保存合并键而不是下标
+	std::string				GetRegulationKey (const Regulation& regulation) const;
+
+	// 合并键为regulationKey的规范中kind类规则的索引，没有时返回kNoRule（按规范逐个比较）
+	std::uint32_t			FindRule (std::string_view regulationKey, RuleKind kind) const;
+
+	std::size_t				GetJurisdictionCount () const { return jurisdictionParents.size () - 1; }
+	std::size_t				GetBuildingTypeCount () const { return buildingTypeNames.size (); }
+	std::string_view		GetJurisdictionName (std::uint16_t jurisdiction) const;
+	std::string_view		GetBuildingTypeName (std::uint16_t buildingType) const;
+
+	// 合并后的生效规则组合数（去重后）
+	std::size_t				GetResolvedCount () const { return resolved.size (); }
+
+	// 规则库内容（含启用的规则）的指纹，内容不变时指纹不变
+	std::uint64_t			GetFingerprint () const { return fingerprint; }
+
+	// 规则库占用的堆内存（字节，按容量估算）
+	std::size_t				GetMemoryUsage () const;
+
+	/**
+	 * 序列化为紧凑的二进制形式（本机字节序，含合并后的生效规则，读取时无需重建索引）。
+	 * Deserialize逐项检查数量和索引范围，数据无效时清空规则库并返回false。
+	 */
+	void					Serialize (std::vector<char>& out) const;
+	bool					Deserialize (const char* data, std::size_t size);
+
+private:
+	TextRef					AddText (std::string_view text);
+	std::uint16_t			InternJurisdiction (std::string_view name);
+	std::uint64_t			InternBuildingType (std::string_view name);
+	void					AppendRule (std::uint32_t regulation, RuleKind kind, const RuleLimits& limits,
+										std::string_view unit, std::string_view source, std::string_view fullText);
+	void					AppendRegulation (const RegulationLibrary& source, const Regulation& regulation);
+	void					AppendRegulation (const RegulationJson::RegulationRecord& record);
+	void					BuildIndex ();
+	void					ResolveCell (std::size_t row, std::size_t column, const std::vector<std::uint32_t>& regulationOffsets,
+										 const std::vector<std::uint32_t>& regulationsByJurisdiction, ResolvedRules& cell) const;
+	bool					IsApplicable (const Regulation& regulation, std::size_t column) const;
+	bool					ReadPayload (const char* data, std::size_t size);
+	void					CompileResolved ();
+
+	std::vector<Regulation>		regulations;
+	std::vector<Rule>			rules;
+	std::string					texts;
+
+	// 地区编号从1开始，jurisdictionParents[0] 占位表示不限地区
+	std::vector<TextRef>							jurisdictionNames;
+	std::vector<std::uint16_t>						jurisdictionParents;
+	std::unordered_map<std::string, std::uint16_t>	jurisdictionIds;
+	std::vector<TextRef>							buildingTypeNames;
+	std::unordered_map<std::string, std::uint16_t>	buildingTypeIds;
+
+	// 行：0 不限 / 1..N 地区 / N+1 未收录地区；列：0 不限 / 1..M 建筑类型 / M+1 未收录类型
+	std::vector<std::uint32_t>	resolvedIndices;
+	std::vector<ResolvedRules>	resolved;
+	std::vector<RuleOp>			ruleOps;		// 所有生效规则编译后的指令，不写入缓存
+
+	std::uint32_t				enabledRuleMask;
+	std::uint64_t				fingerprint;
+};
+
+} // namespace StairCore
+
+#endif
@@ -16,6 +16,10 @@
 #define ID_REGULATION_LABEL		4
 #define ID_REGULATION_INFO_TEXT	5
 #define ID_COMPLIANCE_LISTBOX	7
+#define ID_VIOLATIONS_ONLY_CHECK	8
+#define ID_STOREY_FILTER_POPUP	9
+#define ID_JURISDICTION_POPUP	10
+#define ID_BUILDING_TYPE_POPUP	11
 #define ID_COMPLIANCE_STRINGS	32610
 
 
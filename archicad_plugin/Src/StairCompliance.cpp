@@ -1,23 +1,116 @@
 #include "StairCompliance.hpp"
 
 #include <algorithm>
-#include <cfloat>
-#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "APICommon.h"
 #include "HashTable.hpp"
+#include "RegulationCache.hpp"
 #include "RegulationConfig.hpp"
+#include "RegulationLibrary.hpp"
+#include "StairEvaluationCore.hpp"
+#include "StairInterchange.hpp"
+#include "StairRailings.hpp"
+#include "StairSpatialIndex.hpp"
+#include "StairTrace.hpp"
+#include "StairWorkPool.hpp"
 #include "File.hpp"
+#include "FileSystem.hpp"
 #include "Location.hpp"
 
-// 全局规范配置（运行时从JSON加载）- 可被其他文件访问
+// 项目适用范围下的生效规范（由规范库生成，用于显示）- 可被其他文件访问
 RegulationConfig g_regulationConfig;
 
 namespace {
 
 static bool g_configLoaded = false;
 
-constexpr double kEpsilon = 1e-4;  // Changed from 1e-6 for more robust floating-point comparison
+// 规范库（运行时从JSON加载，每次加载的规范按地区和编号合并到库中）
+static StairCore::RegulationLibrary g_regulationLibrary;
+
+// 项目适用范围（UTF-8名称，为空表示不限），规范库变化后重新转换为编号
+static std::string				g_projectJurisdiction;
+static std::string				g_projectBuildingType;
+static StairCore::RuleContext	g_projectContext;
+
+// 最近一次合并的统一JSON文件标记和规范目录标记，与规范库一起保存在二进制缓存中
+static StairCore::SourceStamp	g_regulationSourceStamp;
+static std::uint64_t			g_regulationFolderStamp = 0;
+static bool						g_regulationCacheChecked = false;
+
+// 参与检测的规则类别（位掩码），默认与命令行检测工具相同，按检测设置文件中的"checked_rules"调整
+static std::uint32_t g_checkedRules = StairCore::kDefaultCheckedRules;
+
+// 检测线程数（0 = 硬件并发数），线程池在首次检测时创建
+static unsigned int g_evaluationThreadCount = 0;
+static std::unique_ptr<StairCore::WorkStealingPool> g_evaluationPool;
+
+// 最近一次读取的检测设置文件标记，文件未变化时不重新读取
+static StairCore::SourceStamp	g_settingsSourceStamp;
+
+static StairCore::WorkStealingPool* GetEvaluationPool ()
+{
+	const unsigned int threadCount = StairCore::WorkStealingPool::ResolveThreadCount (g_evaluationThreadCount);
+	if (threadCount <= 1)
+		return nullptr;
+
+	if (g_evaluationPool == nullptr || g_evaluationPool->GetThreadCount () != threadCount)
+		g_evaluationPool = std::make_unique<StairCore::WorkStealingPool> (threadCount);
+
+	return g_evaluationPool.get ();
+}
+
+// 增量检测缓存：上次检测结果及其输入指纹
+struct CachedStairResult {
+	std::uint64_t			fingerprint = 0;
+	StairComplianceResult	result;
+};
+
+static GS::HashTable<API_Guid, CachedStairResult>	g_resultCache;
+static bool											g_resultCacheValid = false;
+
+// 待检测楼梯（通知回调中只记录GUID，检测推迟到EvaluateDirtyStairs）
+static GS::Array<API_Guid>				g_dirtyStairs;
+static GS::HashTable<API_Guid, bool>	g_dirtyStairSet;
+
+// 违规项引用的规范按合并键（地区 + 编号）登记，编号在插件运行期间不变；Merge会重排规则，
+// 结果和增量检测缓存中只保存登记的编号，条文在显示时按合并键重新查找
+static std::vector<std::string>							g_regulationKeys;
+static std::unordered_map<std::string, std::uint32_t>	g_regulationKeyIds;
+static std::vector<std::uint32_t>						g_ruleRegulationKeys;	// 按当前规范库的规则索引，规范库变化时清空
+
+// 共享的违规项池：集合k的违规项为 g_violationItems[g_violationSetEnds[k - 1], g_violationSetEnds[k])，
+// 集合0为空集合；违规项只引用规范的登记编号，规范库变化时不必清空
+static std::vector<StairViolation>						g_violationItems;
+static std::vector<std::uint32_t>						g_violationSetEnds (1, 0);
+static std::unordered_map<std::string, std::uint32_t>	g_violationSetIds;
+
+// 违规条文按 (规范, 实测值类别) 共享（规范库变化时清空），楼层名表在每次检测时更新，结果中只保存编号
+static GS::HashTable<std::uint64_t, ViolationClause>	g_violationClauses;
+static GS::HashTable<short, GS::UniString>				g_storyNames;
+
+// 栏杆索引在全量检测时批量读取一次，之后按栏杆的修改通知单独更新
+static StairCore::RailingIndex					g_railingIndex;
+static GS::HashTable<API_Guid, std::uint32_t>	g_railingHandles;
+static GS::Array<API_Guid>						g_dirtyRailings;
+static GS::HashTable<API_Guid, bool>			g_dirtyRailingSet;
+
+// 楼梯的平面索引（启用增量检测时随全量检测建立）：栏杆变化时只重新检测其新旧位置附近的楼梯
+static StairCore::SpatialIndex					g_stairIndex;
+static GS::HashTable<API_Guid, std::uint32_t>	g_stairHandles;
+static std::vector<API_Guid>					g_stairGuids;		// 按句柄存放
+
+static bool					g_changeObserverInstalled = false;
+static StairChangeCallback	g_stairChangeCallback = nullptr;
 
 static GS::UniString FormatMillimeters (double meters)
 {
@@ -30,113 +123,403 @@ static GS::UniString FormatMillimeters (double meters)
 	return value;
 }
 
+// 坡度实测值和限值以度为单位，其余为米
+static GS::UniString FormatMetricValue (StairCore::RuleKind metric, double value)
+{
+	if (metric == StairCore::SlopeAngleRule)
+		return GS::UniString::Printf (L"%.1f°", value);
+	return FormatMillimeters (value);
+}
+
+// 输出项目适用范围下的生效规则，origin为规范来源（JSON或缓存）
+static void ReportLoadedRules (const GS::UniString& origin)
+{
+	GS::UniString logMsg = L"[Stair Compliance] ✓ 成功从";
+	logMsg += origin;
+	logMsg += L"加载规范:\n";
+	logMsg += L"  规范名称: ";
+	logMsg += g_regulationConfig.regulationName;
+	logMsg += L" (";
+	logMsg += g_regulationConfig.regulationCode;
+	logMsg += L")\n";
+	logMsg += GS::UniString::Printf (L"  规范库: %u 部规范，%u 条规则，%u 个地区，%u 种建筑类型，%u 组生效规则，约 %u KB\n",
+		(unsigned int) g_regulationLibrary.GetRegulationCount (),
+		(unsigned int) g_regulationLibrary.GetRuleCount (),
+		(unsigned int) g_regulationLibrary.GetJurisdictionCount (),
+		(unsigned int) g_regulationLibrary.GetBuildingTypeCount (),
+		(unsigned int) g_regulationLibrary.GetResolvedCount (),
+		(unsigned int) ((g_regulationLibrary.GetMemoryUsage () + 1023) / 1024));
+
+	// 显示每个规则的详细信息
+	int ruleCount = 0;
+	if (g_regulationConfig.riserHeightRule.HasMaxValue()) {
+		logMsg += L"  - 踏步高度: ≤ ";
+		logMsg += FormatMillimeters(g_regulationConfig.riserHeightRule.maxValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+	if (g_regulationConfig.treadDepthRule.HasMinValue()) {
+		logMsg += L"  - 踏步宽度: ≥ ";
+		logMsg += FormatMillimeters(g_regulationConfig.treadDepthRule.minValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+	if (g_regulationConfig.twoRPlusGRule.HasMinValue() && g_regulationConfig.twoRPlusGRule.HasMaxValue()) {
+		logMsg += L"  - 2R+G公式: ";
+		logMsg += FormatMillimeters(g_regulationConfig.twoRPlusGRule.minValue.value());
+		logMsg += L" ~ ";
+		logMsg += FormatMillimeters(g_regulationConfig.twoRPlusGRule.maxValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+	if (g_regulationConfig.landingLengthRule.HasMinValue()) {
+		logMsg += L"  - 平台长度: ≥ ";
+		logMsg += FormatMillimeters(g_regulationConfig.landingLengthRule.minValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+	if (g_regulationConfig.narrowTreadDepthRule.HasMinValue()) {
+		logMsg += L"  - 踏步窄端宽度: ≥ ";
+		logMsg += FormatMillimeters(g_regulationConfig.narrowTreadDepthRule.minValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+	if (g_regulationConfig.riserVariationRule.HasMaxValue()) {
+		logMsg += L"  - 踢面高度差: ≤ ";
+		logMsg += FormatMillimeters(g_regulationConfig.riserVariationRule.maxValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+	if (g_regulationConfig.stairWidthRule.HasMinValue()) {
+		logMsg += L"  - 梯段净宽: ≥ ";
+		logMsg += FormatMillimeters(g_regulationConfig.stairWidthRule.minValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+	if (g_regulationConfig.handrailHeightRule.HasMinValue()) {
+		logMsg += L"  - 扶手高度: ≥ ";
+		logMsg += FormatMillimeters(g_regulationConfig.handrailHeightRule.minValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+	if (g_regulationConfig.slopeAngleRule.HasMaxValue()) {
+		logMsg += L"  - 梯段坡度: ≤ ";
+		logMsg += FormatMetricValue (StairCore::SlopeAngleRule, g_regulationConfig.slopeAngleRule.maxValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+	if (g_regulationConfig.betweenFlightsRule.HasMinValue()) {
+		logMsg += L"  - 梯段间距: ≥ ";
+		logMsg += FormatMillimeters(g_regulationConfig.betweenFlightsRule.minValue.value());
+		logMsg += L"\n";
+		ruleCount++;
+	}
+
+	logMsg += L"  共加载 ";
+	logMsg += GS::UniString::Printf(L"%d", ruleCount);
+	logMsg += L" 条规则";
+
+	ACAPI_WriteReport(logMsg.ToCStr().Get(), false);
+
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_RULE
+	// 详细调试：输出生效规则的原始数值（以米为单位）
+	std::string debugMsg = "\n[DEBUG] 规则数值详情 (单位:米):\n";
+	char line[128];
+	if (g_regulationConfig.riserHeightRule.HasMaxValue()) {
+		std::snprintf (line, sizeof (line), "  riserHeightRule.maxValue = %.6f\n", g_regulationConfig.riserHeightRule.maxValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.treadDepthRule.HasMinValue()) {
+		std::snprintf (line, sizeof (line), "  treadDepthRule.minValue = %.6f\n", g_regulationConfig.treadDepthRule.minValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.twoRPlusGRule.HasMinValue()) {
+		std::snprintf (line, sizeof (line), "  twoRPlusGRule.minValue = %.6f\n", g_regulationConfig.twoRPlusGRule.minValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.twoRPlusGRule.HasMaxValue()) {
+		std::snprintf (line, sizeof (line), "  twoRPlusGRule.maxValue = %.6f\n", g_regulationConfig.twoRPlusGRule.maxValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.landingLengthRule.HasMinValue()) {
+		std::snprintf (line, sizeof (line), "  landingLengthRule.minValue = %.6f\n", g_regulationConfig.landingLengthRule.minValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.narrowTreadDepthRule.HasMinValue()) {
+		std::snprintf (line, sizeof (line), "  narrowTreadDepthRule.minValue = %.6f\n", g_regulationConfig.narrowTreadDepthRule.minValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.riserVariationRule.HasMaxValue()) {
+		std::snprintf (line, sizeof (line), "  riserVariationRule.maxValue = %.6f\n", g_regulationConfig.riserVariationRule.maxValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.stairWidthRule.HasMinValue()) {
+		std::snprintf (line, sizeof (line), "  stairWidthRule.minValue = %.6f\n", g_regulationConfig.stairWidthRule.minValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.handrailHeightRule.HasMinValue()) {
+		std::snprintf (line, sizeof (line), "  handrailHeightRule.minValue = %.6f\n", g_regulationConfig.handrailHeightRule.minValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.slopeAngleRule.HasMaxValue()) {
+		std::snprintf (line, sizeof (line), "  slopeAngleRule.maxValue = %.6f (度)\n", g_regulationConfig.slopeAngleRule.maxValue.value());
+		debugMsg += line;
+	}
+	if (g_regulationConfig.betweenFlightsRule.HasMinValue()) {
+		std::snprintf (line, sizeof (line), "  betweenFlightsRule.minValue = %.6f\n", g_regulationConfig.betweenFlightsRule.minValue.value());
+		debugMsg += line;
+	}
+	std::snprintf (line, sizeof (line), "  kEpsilon = %.9f\n", StairCore::kEpsilon);
+	debugMsg += line;
+	StairTrace::Write ("%s", debugMsg.c_str ());
+#endif
+}
+
+// 重新计算项目适用范围和用于显示的生效配置（规范库或适用范围变化后调用）
+static void RefreshProjectRules ()
+{
+	g_projectContext = g_regulationLibrary.MakeContext (g_projectJurisdiction, g_projectBuildingType);
+	g_regulationConfig = RegulationConfig::FromLibrary (g_regulationLibrary, g_regulationLibrary.Resolve (g_projectContext));
+}
+
+// 规范目录中按上传顺序排列的JSON文件及其组合标记
+static std::uint64_t ScanRegulationFolder (std::vector<StairCore::RegulationFolderEntry>& entries)
+{
+	StairCore::ListRegulationFolder (std::filesystem::path (USER_REGULATION_FOLDER_PATH), entries);
+	return StairCore::HashRegulationFolder (entries);
+}
+
+// 把解析后的规范记录合并到规范库，规则变化时缓存的结果失效
+static void MergeRegulationRecords (const std::vector<RegulationJson::RegulationRecord>& records)
+{
+	const std::uint64_t previousFingerprint = g_regulationLibrary.GetFingerprint ();
+
+	g_regulationLibrary.SetEnabledRules (g_checkedRules);
+	g_regulationLibrary.Merge (records);
+	g_violationClauses.Clear ();
+	g_ruleRegulationKeys.clear ();
+	RefreshProjectRules ();
+
+	if (g_regulationLibrary.GetFingerprint () != previousFingerprint)
+		InvalidateStairComplianceCache ();
+}
+
+/**
+ * 重新合并统一的规范JSON和规范目录中的全部规范（规范库缓存不可用、目录已变化或统一JSON在有上传规范时变化）。
+ * 统一的规范JSON最先合并，规范目录中的文件按上传顺序合并在其后，与逐次上传时在规范库上合并的顺序相同。
+ */
+static void RebuildRegulationLibrary (const std::vector<StairCore::RegulationFolderEntry>& entries, std::uint64_t folderStamp)
+{
+	const std::uint64_t previousFingerprint = g_regulationLibrary.GetFingerprint ();
+
+	g_regulationLibrary.Clear ();
+	g_regulationLibrary.SetEnabledRules (g_checkedRules);
+	std::vector<std::vector<RegulationJson::RegulationRecord>> batches;
+	batches.reserve (entries.size () + 1);
+
+	const IO::Location legacyPath (GS::UniString (USER_REGULATION_JSON_PATH));
+	StairCore::SourceStamp legacyStamp;
+	std::vector<char> legacyBytes;
+	std::vector<RegulationJson::RegulationRecord> legacyRecords;
+	if (RegulationConfig::GetSourceStamp (legacyPath, legacyStamp) && RegulationConfig::ReadJSONFile (legacyPath, legacyBytes) &&
+		RegulationConfig::ParseRecords (legacyBytes, legacyRecords)) {
+		legacyStamp.size = legacyBytes.size ();
+		legacyStamp.contentHash = StairCore::HashContent (legacyBytes.data (), legacyBytes.size ());
+		batches.push_back (std::move (legacyRecords));
+	} else {
+		// 读取失败时清除标记，下次检测时重新读取
+		legacyStamp = StairCore::SourceStamp ();
+	}
+
+	for (const StairCore::RegulationFolderEntry& entry : entries) {
+		const IO::Location jsonPath (GS::UniString (entry.path.wstring ().c_str ()));
+		std::vector<RegulationJson::RegulationRecord> records;
+		if (RegulationConfig::LoadRecordsFromJSON (jsonPath, records))
+			batches.push_back (std::move (records));
+		else
+			ACAPI_WriteReport (L"[Stair Compliance] ⚠ 规范目录中的文件无法读取，已跳过: " + jsonPath.ToDisplayText (), false);
+	}
+	g_regulationLibrary.Merge (batches);
+
+	g_violationClauses.Clear ();
+	g_ruleRegulationKeys.clear ();
+	g_regulationSourceStamp = legacyStamp;
+	g_regulationFolderStamp = folderStamp;
+	RefreshProjectRules ();
+
+	if (g_regulationLibrary.GetFingerprint () != previousFingerprint)
+		InvalidateStairComplianceCache ();
+
+	if (!batches.empty ()) {
+		RegulationConfig::SaveLibraryCache (IO::Location (GS::UniString (USER_REGULATION_CACHE_PATH)), g_regulationLibrary, g_regulationSourceStamp, g_regulationFolderStamp);
+		ReportLoadedRules (L"规范目录");
+	}
+}
+
+// 启动后首次加载时读取规范库二进制缓存，缓存可用且规范目录未变化时无需解析JSON，否则从规范目录重新合并
+static void LoadRegulationCacheOnce ()
+{
+	if (g_regulationCacheChecked)
+		return;
+
+	g_regulationCacheChecked = true;
+
+	std::vector<StairCore::RegulationFolderEntry> entries;
+	const std::uint64_t folderStamp = ScanRegulationFolder (entries);
+
+	StairCore::RegulationLibrary library;
+	StairCore::SourceStamp stamp;
+	std::uint64_t cachedFolderStamp = 0;
+	if (!RegulationConfig::LoadLibraryCache (IO::Location (GS::UniString (USER_REGULATION_CACHE_PATH)), library, stamp, cachedFolderStamp) ||
+		cachedFolderStamp != folderStamp) {
+		RebuildRegulationLibrary (entries, folderStamp);
+		return;
+	}
+
+	g_regulationLibrary = std::move (library);
+	g_regulationLibrary.SetEnabledRules (g_checkedRules);
+	g_violationClauses.Clear ();
+	g_ruleRegulationKeys.clear ();
+	g_regulationSourceStamp = stamp;
+	g_regulationFolderStamp = folderStamp;
+	RefreshProjectRules ();
+	InvalidateStairComplianceCache ();
+	ReportLoadedRules (L"缓存");
+}
+
+/**
+ * 把统一的规范JSON中的规范合并到规范库，规则变化时缓存的结果失效。
+ * force为false时，文件修改时间和长度与上次相同则不读取，内容哈希相同则不解析。
+ * 规范目录中已有上传的规范时整体重新合并，统一JSON仍排在最前，不覆盖之后上传的规范。
+ * 合并后更新二进制缓存。
+ */
+static bool MergeRegulationFile (const IO::Location& jsonPath, bool force)
+{
+	StairCore::SourceStamp stamp;
+	if (!RegulationConfig::GetSourceStamp (jsonPath, stamp))
+		return false;
+
+	const bool hasRules = g_regulationLibrary.GetRegulationCount () > 0;
+	if (!force && hasRules && stamp.SameFile (g_regulationSourceStamp))
+		return true;
+
+	std::vector<char> jsonBytes;
+	if (!RegulationConfig::ReadJSONFile (jsonPath, jsonBytes))
+		return false;
+
+	stamp.size = jsonBytes.size ();
+	stamp.contentHash = StairCore::HashContent (jsonBytes.data (), jsonBytes.size ());
+	const IO::Location cachePath (GS::UniString (USER_REGULATION_CACHE_PATH));
+
+	if (!force && hasRules && stamp.contentHash == g_regulationSourceStamp.contentHash) {
+		// 只有修改时间变化，记录新的标记以便下次启动跳过读取
+		g_regulationSourceStamp = stamp;
+		RegulationConfig::SaveLibraryCache (cachePath, g_regulationLibrary, g_regulationSourceStamp, g_regulationFolderStamp);
+		return true;
+	}
+
+	std::vector<RegulationJson::RegulationRecord> records;
+	if (!RegulationConfig::ParseRecords (jsonBytes, records))
+		return false;
+
+	if (g_regulationFolderStamp != 0) {
+		std::vector<StairCore::RegulationFolderEntry> entries;
+		const std::uint64_t folderStamp = ScanRegulationFolder (entries);
+		RebuildRegulationLibrary (entries, folderStamp);
+		return true;
+	}
+
+	MergeRegulationRecords (records);
+	g_regulationSourceStamp = stamp;
+
+	RegulationConfig::SaveLibraryCache (cachePath, g_regulationLibrary, g_regulationSourceStamp, g_regulationFolderStamp);
+	ReportLoadedRules (L"JSON");
+	return true;
+}
+
+/**
+ * 读取检测设置文件，例如 { "threads": 4, "checked_rules": ["riser_height", "tread_depth"] }。
+ * "checked_rules"为参与检测的规则类别（键名与规范JSON相同），不设置时使用默认规则类别，未知的键名被忽略。
+ * 文件不存在时保留当前设置；文件未变化时不重新读取；解析失败时报告出错位置并保留当前设置。
+ */
+static void LoadCheckerSettings ()
+{
+	const IO::Location settingsPath (GS::UniString (USER_CHECKER_SETTINGS_PATH));
+
+	StairCore::SourceStamp stamp;
+	if (!RegulationConfig::GetSourceStamp (settingsPath, stamp) || stamp.SameFile (g_settingsSourceStamp))
+		return;
+
+	std::vector<char> settingsBytes;
+	if (!RegulationConfig::ReadJSONFile (settingsPath, settingsBytes))
+		return;
+
+	g_settingsSourceStamp = stamp;
+
+	RegulationJson::Document document;
+	const RegulationJson::Value* root = document.Parse (settingsBytes.data (), settingsBytes.size ()) ? document.GetRoot () : nullptr;
+	if (root == nullptr || !root->IsObject ()) {
+		const RegulationJson::ParseError& error = document.GetError ();
+		GS::UniString warningMsg = GS::UniString::Printf (L"[Stair Compliance] ⚠ 检测设置文件解析失败（第 %u 行第 %u 列）: ",
+			static_cast<unsigned int> (error.line), static_cast<unsigned int> (error.column));
+		warningMsg += GS::UniString (error.message != nullptr ? error.message : "根节点不是对象", CC_UTF8);
+		ACAPI_WriteReport (warningMsg.ToCStr ().Get (), false);
+		return;
+	}
+
+	const RegulationJson::Value* threads = document.FindMember (*root, "threads");
+	if (threads != nullptr && threads->IsNumber () && threads->number >= 0.0 && threads->number <= 1024.0)
+		SetStairEvaluationThreadCount (static_cast<unsigned int> (threads->number));
+
+	std::uint32_t ruleMask = StairCore::kDefaultCheckedRules;
+	const RegulationJson::Value* checkedRules = document.FindMember (*root, "checked_rules");
+	if (checkedRules != nullptr && checkedRules->IsArray ()) {
+		ruleMask = 0;
+		for (const RegulationJson::Value* item = document.GetFirstChild (*checkedRules); item != nullptr; item = document.GetNextSibling (*item)) {
+			for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+				if (item->IsString () && item->string == RegulationJson::GetRuleKey (static_cast<StairCore::RuleKind> (kind)))
+					ruleMask |= 1u << kind;
+			}
+		}
+	}
+	SetCheckedRules (ruleMask);
+}
+
 // 加载规范配置
 static void LoadRegulationConfigIfNeeded()
 {
 	if (g_configLoaded)
 		return;
 
-	// 尝试从JSON文件加载配置
+	g_configLoaded = true;
+
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_SUMMARY
+	const auto startTime = std::chrono::steady_clock::now ();
+#endif
+
+	LoadCheckerSettings ();
+	LoadRegulationCacheOnce ();
+
+	// 尝试从JSON文件加载配置，JSON未变化时直接使用缓存的规范库
 	// 使用统一路径（与上传功能一致）
 	GS::UniString jsonPathStr = USER_REGULATION_JSON_PATH;
 	IO::Location jsonPath (jsonPathStr);
 
-	// 尝试加载JSON配置
-	RegulationConfig loadedConfig = RegulationConfig::LoadFromJSON(jsonPath);
-
-	// 增强验证：检查规范名称有效 AND 至少有一个规则被成功解析
-	if (!loadedConfig.regulationName.IsEmpty() &&
-	    loadedConfig.regulationName != L"未加载规范") {
-
-		// 验证至少有一个规则被成功解析
-		bool hasAnyRule = loadedConfig.riserHeightRule.HasMaxValue() ||
-		                  loadedConfig.riserHeightRule.HasMinValue() ||
-		                  loadedConfig.treadDepthRule.HasMinValue() ||
-		                  loadedConfig.treadDepthRule.HasMaxValue() ||
-		                  loadedConfig.twoRPlusGRule.HasMinValue() ||
-		                  loadedConfig.twoRPlusGRule.HasMaxValue() ||
-		                  loadedConfig.landingLengthRule.HasMinValue() ||
-		                  loadedConfig.landingLengthRule.HasMaxValue();
-
-			if (hasAnyRule) {
-				g_regulationConfig = loadedConfig;
-				g_configLoaded = true;
-
-				// 输出详细的加载成功信息到ArchiCAD日志
-				GS::UniString logMsg = L"[Stair Compliance] ✓ 成功从JSON加载规范:\n";
-				logMsg += L"  规范名称: ";
-				logMsg += g_regulationConfig.regulationName;
-				logMsg += L" (";
-				logMsg += g_regulationConfig.regulationCode;
-				logMsg += L")\n";
-
-				// 显示每个规则的详细信息
-				int ruleCount = 0;
-				if (loadedConfig.riserHeightRule.HasMaxValue()) {
-					logMsg += L"  - 踏步高度: ≤ ";
-					logMsg += FormatMillimeters(loadedConfig.riserHeightRule.maxValue.value());
-					logMsg += L"\n";
-					ruleCount++;
-				}
-				if (loadedConfig.treadDepthRule.HasMinValue()) {
-					logMsg += L"  - 踏步宽度: ≥ ";
-					logMsg += FormatMillimeters(loadedConfig.treadDepthRule.minValue.value());
-					logMsg += L"\n";
-					ruleCount++;
-				}
-				if (loadedConfig.twoRPlusGRule.HasMinValue() && loadedConfig.twoRPlusGRule.HasMaxValue()) {
-					logMsg += L"  - 2R+G公式: ";
-					logMsg += FormatMillimeters(loadedConfig.twoRPlusGRule.minValue.value());
-					logMsg += L" ~ ";
-					logMsg += FormatMillimeters(loadedConfig.twoRPlusGRule.maxValue.value());
-					logMsg += L"\n";
-					ruleCount++;
-				}
-				if (loadedConfig.landingLengthRule.HasMinValue()) {
-					logMsg += L"  - 平台长度: ≥ ";
-					logMsg += FormatMillimeters(loadedConfig.landingLengthRule.minValue.value());
-					logMsg += L"\n";
-					ruleCount++;
-				}
-
-				logMsg += L"  共加载 ";
-				logMsg += GS::UniString::Printf(L"%d", ruleCount);
-				logMsg += L" 条规则";
-
-				ACAPI_WriteReport(logMsg.ToCStr().Get(), false);
-
-				// 详细调试：输出加载的规则原始数值（以米为单位）
-				GS::UniString debugMsg = L"\n[DEBUG] 规则数值详情 (单位:米):\n";
-				if (loadedConfig.riserHeightRule.HasMaxValue()) {
-					debugMsg += GS::UniString::Printf(L"  riserHeightRule.maxValue = %.6f\n",
-						loadedConfig.riserHeightRule.maxValue.value());
-				}
-				if (loadedConfig.treadDepthRule.HasMinValue()) {
-					debugMsg += GS::UniString::Printf(L"  treadDepthRule.minValue = %.6f\n",
-						loadedConfig.treadDepthRule.minValue.value());
-				}
-				if (loadedConfig.twoRPlusGRule.HasMinValue()) {
-					debugMsg += GS::UniString::Printf(L"  twoRPlusGRule.minValue = %.6f\n",
-						loadedConfig.twoRPlusGRule.minValue.value());
-				}
-				if (loadedConfig.twoRPlusGRule.HasMaxValue()) {
-					debugMsg += GS::UniString::Printf(L"  twoRPlusGRule.maxValue = %.6f\n",
-						loadedConfig.twoRPlusGRule.maxValue.value());
-				}
-				if (loadedConfig.landingLengthRule.HasMinValue()) {
-					debugMsg += GS::UniString::Printf(L"  landingLengthRule.minValue = %.6f\n",
-						loadedConfig.landingLengthRule.minValue.value());
-				}
-				debugMsg += GS::UniString::Printf(L"  kEpsilon = %.9f\n", kEpsilon);
-				ACAPI_WriteReport(debugMsg.ToCStr().Get(), false);
-
-				return;
-			}
-		}
+	const bool merged = MergeRegulationFile (jsonPath, false);
+
+	STAIR_TRACE_SUMMARY ("[Stair Compliance] 加载规范配置用时 %.3f 毫秒（%u 部规范）\n",
+		std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - startTime).count (),
+		static_cast<unsigned int> (g_regulationLibrary.GetRegulationCount ()));
+
+	if (merged)
+		return;
+
+	// 文件读取失败时保留之前已加载的规范
+	if (g_regulationLibrary.GetRegulationCount () > 0)
+		return;
 
 	// JSON加载失败或解析失败，使用空配置并提示用户
 	g_regulationConfig = RegulationConfig::GetDefault();
-	g_configLoaded = true;
 
 	// 输出详细的失败警告，指导用户如何操作
 	GS::UniString warningMsg = L"[Stair Compliance] ⚠ 未加载有效规范配置\n";
@@ -168,97 +551,218 @@ static void AppendMetric (GS::UniString& target, const wchar_t* label, double va
 	target += FormatMillimeters (valueMeters);
 }
 
-static double ComputeTwoRPlusGoing (double riserHeight, double treadDepth)
+static StairCore::SegmentType ToSegmentType (const API_StairPolylineEdgeData& edge)
 {
-	return (2.0 * riserHeight) + treadDepth;
+	if (edge.segmentType == APIST_LandingSegment)
+		return StairCore::SegmentType::Landing;
+	if (edge.segmentType == APIST_DividedLandingSegment)
+		return StairCore::SegmentType::DividedLanding;
+	return StairCore::SegmentType::Flight;
 }
 
-static double ComputeSegmentLength (const API_StairPolylineData& polyline, Int32 edgeIndex)
+// 楼梯折线的顶点和圆弧，没有顶点时返回false
+static bool ReadStairPolyline (const API_StairPolylineData& polyline, std::vector<StairCore::Point2D>& points, std::vector<StairCore::ArcRecord>& arcRecords)
 {
-	if (polyline.coords == nullptr || *polyline.coords == nullptr)
-		return 0.0;
+	if (polyline.coords == nullptr || *polyline.coords == nullptr || polyline.polygon.nCoords <= 0)
+		return false;
 
 	const API_Coord* coords = *polyline.coords;
-	const API_Coord& start = coords[edgeIndex - 1];
-	const API_Coord& end = coords[edgeIndex];
-
-	const double dx = end.x - start.x;
-	const double dy = end.y - start.y;
-	const double chordLength = std::sqrt (dx * dx + dy * dy);
+	points.reserve (static_cast<std::size_t> (polyline.polygon.nCoords));
+	for (Int32 i = 0; i < polyline.polygon.nCoords; ++i)
+		points.push_back ({ coords[i].x, coords[i].y });
 
 	if (polyline.parcs != nullptr && *polyline.parcs != nullptr && polyline.polygon.nArcs > 0) {
 		const API_PolyArc* arcs = *polyline.parcs;
-		for (Int32 arcIndex = 0; arcIndex < polyline.polygon.nArcs; ++arcIndex) {
-			const API_PolyArc& arc = arcs[arcIndex];
-			if (arc.begIndex == edgeIndex - 1 && arc.endIndex == edgeIndex) {
-				const double angle = std::fabs (arc.arcAngle);
-				if (angle > kEpsilon) {
-					const double halfChord = chordLength * 0.5;
-					const double radius = halfChord / std::sin (angle * 0.5);
-					return radius * angle;
-				}
-				break;
-			}
-		}
+		arcRecords.reserve (static_cast<std::size_t> (polyline.polygon.nArcs));
+		for (Int32 i = 0; i < polyline.polygon.nArcs; ++i)
+			arcRecords.push_back ({ arcs[i].begIndex, arcs[i].endIndex, arcs[i].arcAngle });
+	}
+	return true;
+}
+
+// 踏板子元素的顶面标高，只在检测踢面高度差时读取（每个踏板需要一次CalcBounds）
+static void ReadTreadLevels (const API_Guid& stairGuid, std::vector<double>& treadLevels)
+{
+	GS::Array<API_Guid> treadGuids;
+	if (ACAPI_Element_GetConnectedElements (stairGuid, API_StairTreadID, &treadGuids) != NoError)
+		return;
+
+	treadLevels.reserve (treadGuids.GetSize ());
+	for (const API_Guid& treadGuid : treadGuids) {
+		API_Elem_Head head;
+		BNZeroMemory (&head, sizeof (API_Elem_Head));
+		head.guid = treadGuid;
+
+		API_Box3D bounds;
+		if (ACAPI_Element_CalcBounds (&head, &bounds) == NoError)
+			treadLevels.push_back (bounds.zMax);
 	}
+}
 
-	return chordLength;
+// 生效规则中有踢面高度差限值时才读取踏板标高
+static bool NeedsTreadLevels ()
+{
+	const StairCore::RuleLimits& limits = g_regulationLibrary.Resolve (g_projectContext).ruleSet.rules[StairCore::RiserVariationRule];
+	return limits.enabled && limits.maxValue.has_value ();
 }
 
-static double ComputeMinimumLandingLength (const API_StairPolylineData& polyline, bool* landingEvaluated)
+// 生效规则中有扶手高度限值时才读取栏杆
+static bool NeedsRailings ()
 {
-	if (landingEvaluated != nullptr)
-		*landingEvaluated = false;
+	const StairCore::RuleLimits& limits = g_regulationLibrary.Resolve (g_projectContext).ruleSet.rules[StairCore::HandrailHeightRule];
+	return limits.enabled && limits.minValue.has_value ();
+}
 
-	if (polyline.coords == nullptr || *polyline.coords == nullptr)
-		return 0.0;
+// 读取栏杆的楼层、平面包围盒和扶手高度（一次Get和CalcBounds）；栏杆已删除时返回false
+static bool ReadRailing (const API_Guid& railingGuid, StairCore::RailingRecord& railing)
+{
+	API_Element element;
+	BNZeroMemory (&element, sizeof (API_Element));
+	element.header.guid = railingGuid;
+	if (ACAPI_Element_Get (&element) != NoError)
+		return false;
+
+	API_Box3D bounds;
+	if (ACAPI_Element_CalcBounds (&element.header, &bounds) != NoError)
+		return false;
+
+	railing.bounds.floorIndex = element.header.floorInd;
+	railing.bounds.minX = bounds.xMin;
+	railing.bounds.minY = bounds.yMin;
+	railing.bounds.maxX = bounds.xMax;
+	railing.bounds.maxY = bounds.yMax;
+	railing.handrailHeight = element.railing.height;
+	return true;
+}
 
-	if (polyline.edgeData == nullptr || polyline.polygon.nCoords <= 1)
-		return 0.0;
+// 批量读取项目中的全部栏杆，重建栏杆索引；启用增量检测时订阅栏杆的修改/删除通知
+static void ReadRailings ()
+{
+	g_railingIndex.Clear ();
+	g_railingHandles.Clear ();
+	if (!NeedsRailings ())
+		return;
 
-	const Int32 segmentCount = polyline.polygon.nCoords - 1;
-	if (segmentCount <= 0)
-		return 0.0;
+	GS::Array<API_Guid> railingGuids;
+	if (ACAPI_Element_GetElemList (API_RailingID, &railingGuids) != NoError || railingGuids.IsEmpty ())
+		return;
 
-	double minLanding = DBL_MAX;
-	double currentLanding = 0.0;
-	bool inLanding = false;
-	bool foundLandingSegment = false;
+	std::vector<StairCore::RailingRecord> railings;
+	GS::Array<API_Guid> loadedGuids;
+	railings.reserve (railingGuids.GetSize ());
+	loadedGuids.SetCapacity (railingGuids.GetSize ());
+	for (const API_Guid& railingGuid : railingGuids) {
+		StairCore::RailingRecord railing;
+		if (!ReadRailing (railingGuid, railing))
+			continue;
+		railings.push_back (railing);
+		loadedGuids.Push (railingGuid);
+	}
 
-	for (Int32 edgeIdx = 1; edgeIdx <= segmentCount; ++edgeIdx) {
-		const API_StairPolylineEdgeData& edge = polyline.edgeData[edgeIdx];
-		const bool isLandingSegment = (edge.segmentType == APIST_LandingSegment || edge.segmentType == APIST_DividedLandingSegment);
-		const double segmentLength = ComputeSegmentLength (polyline, edgeIdx);
+	// Build后的句柄即railings中的下标
+	g_railingIndex.Build (railings);
+	for (UIndex i = 0; i < loadedGuids.GetSize (); ++i) {
+		g_railingHandles.Add (loadedGuids[i], static_cast<std::uint32_t> (i));
+		if (g_changeObserverInstalled)
+			ACAPI_Element_AttachObserver (loadedGuids[i]);
+	}
+}
 
-		if (isLandingSegment) {
-			foundLandingSegment = true;
-			if (!inLanding) {
-				inLanding = true;
-				currentLanding = 0.0;
-			}
-			currentLanding += segmentLength;
-		} else if (inLanding) {
-			minLanding = std::min (minLanding, currentLanding);
-			currentLanding = 0.0;
-			inLanding = false;
-		}
+// 适配器：把ArchiCAD楼梯元素转换为检测核心使用的楼梯记录
+static void BuildStairRecord (const API_Element& element, const API_ElementMemo* memo, StairCore::StairRecord& record)
+{
+	record.Clear ();
+	record.floorIndex = element.header.floorInd;
+	record.riserHeight = element.stair.riserHeight;
+	record.treadDepth = element.stair.treadDepth;
+
+	if (memo == nullptr)
+		return;
+
+	// 左右边界用于计算踏步窄端宽度
+	for (std::size_t side = 0; side < 2; ++side)
+		ReadStairPolyline (memo->stairBoundary[side].polyline, record.boundaries[side].points, record.boundaries[side].arcs);
+
+	const API_StairPolylineData& polyline = memo->stairWalkingLine;
+	if (!ReadStairPolyline (polyline, record.walkingLine, record.walkingLineArcs))
+		return;
+
+	// edgeData 以线段终点顶点为索引（从1开始）
+	if (polyline.edgeData != nullptr) {
+		record.segmentTypes.reserve (static_cast<std::size_t> (polyline.polygon.nCoords - 1));
+		for (Int32 edgeIdx = 1; edgeIdx < polyline.polygon.nCoords; ++edgeIdx)
+			record.segmentTypes.push_back (ToSegmentType (polyline.edgeData[edgeIdx]));
+	}
+}
+
+static GS::UniString ToUniString (std::string_view text)
+{
+	return GS::UniString (std::string (text).c_str (), CC_UTF8);
+}
+
+// 规则所属规范的登记编号，每条规则只在首次违规时查找合并键
+static std::uint32_t GetRegulationKeyId (std::uint32_t ruleId)
+{
+	if (ruleId == StairCore::kNoRule || ruleId >= g_regulationLibrary.GetRuleCount ())
+		return kNoRegulationKey;
+
+	if (g_ruleRegulationKeys.size () != g_regulationLibrary.GetRuleCount ())
+		g_ruleRegulationKeys.assign (g_regulationLibrary.GetRuleCount (), kNoRegulationKey);
+
+	std::uint32_t& keyId = g_ruleRegulationKeys[ruleId];
+	if (keyId != kNoRegulationKey)
+		return keyId;
+
+	const StairCore::RegulationLibrary::Rule& rule = g_regulationLibrary.GetRule (ruleId);
+	std::string key = g_regulationLibrary.GetRegulationKey (g_regulationLibrary.GetRegulation (rule.regulation));
+	const auto found = g_regulationKeyIds.find (key);
+	if (found != g_regulationKeyIds.end ()) {
+		keyId = found->second;
+	} else {
+		keyId = static_cast<std::uint32_t> (g_regulationKeys.size ());
+		g_regulationKeyIds.emplace (key, keyId);
+		g_regulationKeys.push_back (std::move (key));
 	}
+	return keyId;
+}
 
-	if (inLanding)
-		minLanding = std::min (minLanding, currentLanding);
+// 违规项取自给出该限值的规范，没有条文时也保留一项（用于判断是否合规）
+static StairViolationSet CollectViolations (const StairCore::StairEvaluation& evaluation, StairCore::RuleContext context)
+{
+	if (evaluation.IsCompliant ())
+		return StairViolationSet ();
 
-	if (landingEvaluated != nullptr && foundLandingSegment)
-		*landingEvaluated = true;
+	StairViolation violations[StairCore::RuleKindCount];
+	UIndex violationCount = 0;
+	const StairCore::ResolvedRules& rules = g_regulationLibrary.Resolve (context);
 
-	if (minLanding == DBL_MAX)
-		return 0.0;
+	for (std::uint32_t kind = 0; kind < StairCore::RuleKindCount; ++kind) {
+		const StairCore::RuleKind ruleKind = static_cast<StairCore::RuleKind> (kind);
+		if (!evaluation.IsViolated (ruleKind))
+			continue;
 
-	return minLanding;
+		// 与GetGoverningRule一致：低于下限时违反下限，否则违反上限
+		const StairCore::RuleLimits& limits = rules.ruleSet.rules[kind];
+		const double measured = StairCore::GetMetricValue (evaluation.metrics, ruleKind);
+		StairViolation violation;
+		violation.regulationKey = GetRegulationKeyId (g_regulationLibrary.GetGoverningRule (rules, ruleKind, evaluation.metrics));
+		violation.metric = static_cast<std::uint8_t> (ruleKind);
+		if (limits.minValue.has_value () && measured < *limits.minValue) {
+			violation.direction = ViolationDirection::BelowMin;
+			violation.limit = static_cast<float> (*limits.minValue);
+		} else {
+			violation.direction = ViolationDirection::AboveMax;
+			violation.limit = static_cast<float> (limits.maxValue.value_or (0.0));
+		}
+		violations[violationCount++] = violation;
+	}
+	return StairViolationSet::Intern (violations, violationCount);
 }
 
-static void CollectStoryNames (GS::HashTable<short, GS::UniString>& storyNames)
+// 读取楼层表，结果的楼层名和显示名称在显示时从中查找
+static void CollectStoryNames ()
 {
-	storyNames.Clear ();
+	g_storyNames.Clear ();
 
 	API_StoryInfo storyInfo;
 	BNZeroMemory (&storyInfo, sizeof (API_StoryInfo));
@@ -271,7 +775,7 @@ static void CollectStoryNames (GS::HashTable<short, GS::UniString>& storyNames)
 		for (short offset = 0; offset < count; ++offset) {
 			const API_StoryType& info = (*storyInfo.data)[offset];
 			const short floorIndex = static_cast<short> (firstStory + offset);
-			storyNames.Add (floorIndex, GS::UniString (info.uName));
+			g_storyNames.Add (floorIndex, GS::UniString (info.uName));
 		}
 	}
 
@@ -279,21 +783,412 @@ static void CollectStoryNames (GS::HashTable<short, GS::UniString>& storyNames)
 		BMKillHandle (reinterpret_cast<GSHandle*> (&storyInfo.data));
 }
 
-static GS::UniString BuildDisplayName (const API_Element& element, const GS::UniString* storyName)
+static GS::UniString BuildDisplayName (short floorIndex, const GS::UniString* storyName)
 {
 	GS::UniString name;
 	if (storyName != nullptr && !storyName->IsEmpty ()) {
 		name = *storyName;
 		name.Append (L" 楼梯");
 	} else {
-		name = GS::UniString::Printf (L"楼层索引 %d 楼梯", element.header.floorInd);
+		name = GS::UniString::Printf (L"楼层索引 %d 楼梯", floorIndex);
 	}
 
 	return name;
 }
 
+// 读取楼梯元素及其步行线，元素不存在时返回false
+static bool LoadStairRecord (const API_Guid& stairGuid, StairCore::StairRecord& record)
+{
+	API_Element element;
+	BNZeroMemory (&element, sizeof (API_Element));
+	element.header.guid = stairGuid;
+
+	if (ACAPI_Element_Get (&element) != NoError)
+		return false;
+
+	API_ElementMemo memo;
+	BNZeroMemory (&memo, sizeof (API_ElementMemo));
+	const bool memoLoaded = (ACAPI_Element_GetMemo (stairGuid, &memo, 0) == NoError);
+
+	BuildStairRecord (element, memoLoaded ? &memo : nullptr, record);
+	record.context = g_projectContext;
+	if (NeedsTreadLevels ())
+		ReadTreadLevels (stairGuid, record.treadLevels);
+	record.handrailHeight = g_railingIndex.FindHandrailHeight (record);
+
+	if (memoLoaded)
+		ACAPI_DisposeElemMemoHdls (&memo);
+
+	return true;
+}
+
+static StairComplianceResult BuildResult (const API_Guid& stairGuid,
+										  const StairCore::StairRecord& record,
+										  const StairCore::StairEvaluation& evaluation)
+{
+	StairComplianceResult result;
+	result.guid = stairGuid;
+	result.riserHeight = static_cast<float> (evaluation.metrics.riserHeight);
+	result.treadDepth = static_cast<float> (evaluation.metrics.treadDepth);
+	result.minLandingLength = static_cast<float> (evaluation.metrics.minLandingLength);
+	result.twoRPlusGoing = static_cast<float> (evaluation.metrics.twoRPlusGoing);
+	result.narrowTreadDepth = static_cast<float> (evaluation.metrics.narrowTreadDepth);
+	result.riserVariation = static_cast<float> (evaluation.metrics.riserVariation);
+	result.clearWidth = static_cast<float> (evaluation.metrics.clearWidth);
+	result.handrailHeight = static_cast<float> (evaluation.metrics.handrailHeight);
+	result.slopeAngle = static_cast<float> (evaluation.metrics.slopeAngle);
+	result.flightSpacing = static_cast<float> (evaluation.metrics.flightSpacing);
+	result.floorIndex = record.floorIndex;
+	result.landingEvaluated = evaluation.metrics.landingEvaluated;
+	result.violations = CollectViolations (evaluation, record.context);
+	return result;
+}
+
+static void MarkStairDirty (const API_Guid& stairGuid)
+{
+	if (g_dirtyStairSet.ContainsKey (stairGuid))
+		return;
+
+	g_dirtyStairSet.Add (stairGuid, true);
+	g_dirtyStairs.Push (stairGuid);
+}
+
+static void MarkRailingDirty (const API_Guid& railingGuid)
+{
+	if (g_dirtyRailingSet.ContainsKey (railingGuid))
+		return;
+
+	g_dirtyRailingSet.Add (railingGuid, true);
+	g_dirtyRailings.Push (railingGuid);
+}
+
+static void ClearDirtyStairs ()
+{
+	g_dirtyStairs.Clear ();
+	g_dirtyStairSet.Clear ();
+	g_dirtyRailings.Clear ();
+	g_dirtyRailingSet.Clear ();
+}
+
+static void ClearStairIndex ()
+{
+	g_stairIndex.Clear ();
+	g_stairHandles.Clear ();
+	g_stairGuids.clear ();
+}
+
+// 楼梯新建或几何变化后更新其在楼梯索引中的包围盒
+static void UpdateStairIndex (const API_Guid& stairGuid, const StairCore::StairRecord& record)
+{
+	StairCore::ElementBounds bounds;
+	StairCore::ComputeStairBounds (record, bounds);
+
+	const std::uint32_t* handle = g_stairHandles.GetPtr (stairGuid);
+	if (handle != nullptr) {
+		g_stairIndex.Update (*handle, bounds);
+		return;
+	}
+
+	const std::uint32_t stair = g_stairIndex.Insert (bounds);
+	if (stair >= g_stairGuids.size ())
+		g_stairGuids.resize (stair + 1);
+	g_stairGuids[stair] = stairGuid;
+	g_stairHandles.Add (stairGuid, stair);
+}
+
+static void RemoveFromStairIndex (const API_Guid& stairGuid)
+{
+	const std::uint32_t* handle = g_stairHandles.GetPtr (stairGuid);
+	if (handle == nullptr)
+		return;
+
+	g_stairIndex.Remove (*handle);
+	g_stairHandles.Delete (stairGuid);
+}
+
+// 把栏杆包围盒附近的楼梯标记为待检测（与FindHandrailHeight使用相同的外扩量）
+static void MarkStairsNear (const StairCore::ElementBounds& railingBounds, std::vector<std::uint32_t>& stairs)
+{
+	stairs.clear ();
+	g_stairIndex.Query (railingBounds.Expanded (StairCore::kRailingTolerance), stairs);
+	for (const std::uint32_t stair : stairs)
+		MarkStairDirty (g_stairGuids[stair]);
+}
+
+// 栏杆的新建、修改和删除：更新栏杆索引，并把新旧位置附近的楼梯标记为待检测，扶手高度在重新读取楼梯时查找
+static void ApplyRailingChanges ()
+{
+	// 没有扶手高度规则时栏杆不参与检测，启用规则时缓存失效并重新全量检测
+	if (!NeedsRailings ()) {
+		g_dirtyRailings.Clear ();
+		g_dirtyRailingSet.Clear ();
+		return;
+	}
+
+	std::vector<std::uint32_t> stairs;
+	for (const API_Guid& railingGuid : g_dirtyRailings) {
+		const std::uint32_t* handle = g_railingHandles.GetPtr (railingGuid);
+		const std::uint32_t railing = handle != nullptr ? *handle : StairCore::kNoElement;
+		if (railing != StairCore::kNoElement)
+			MarkStairsNear (g_railingIndex.GetRailing (railing).bounds, stairs);
+
+		StairCore::RailingRecord record;
+		if (!ReadRailing (railingGuid, record)) {
+			if (railing != StairCore::kNoElement) {
+				g_railingIndex.Remove (railing);
+				g_railingHandles.Delete (railingGuid);
+			}
+			continue;
+		}
+
+		if (railing != StairCore::kNoElement)
+			g_railingIndex.Update (railing, record);
+		else
+			g_railingHandles.Add (railingGuid, g_railingIndex.Add (record));
+		MarkStairsNear (record.bounds, stairs);
+	}
+
+	g_dirtyRailings.Clear ();
+	g_dirtyRailingSet.Clear ();
+}
+
+static GSErrCode __ACENV_CALL StairElementEventHandler (const API_NotifyElementType* elemType)
+{
+	if (elemType == nullptr)
+		return NoError;
+
+	const API_ElemTypeID typeID = elemType->elemHead.type.typeID;
+	if (typeID != API_StairID && typeID != API_RailingID)
+		return NoError;
+
+	switch (elemType->notifID) {
+		case APINotifyElement_New:
+		case APINotifyElement_Copy:
+		case APINotifyElement_Undo_Created:
+		case APINotifyElement_Redo_Created:
+			// 新楼梯和栏杆需要单独订阅后续的修改/删除通知
+			ACAPI_Element_AttachObserver (elemType->elemHead.guid);
+			break;
+
+		case APINotifyElement_Change:
+		case APINotifyElement_Edit:
+		case APINotifyElement_Delete:
+		case APINotifyElement_Undo_Modified:
+		case APINotifyElement_Undo_Deleted:
+		case APINotifyElement_Redo_Modified:
+		case APINotifyElement_Redo_Deleted:
+			break;
+
+		default:
+			return NoError;
+	}
+
+	// 删除的楼梯和栏杆在EvaluateDirtyStairs中读取失败，作为删除处理
+	if (typeID == API_RailingID)
+		MarkRailingDirty (elemType->elemHead.guid);
+	else
+		MarkStairDirty (elemType->elemHead.guid);
+
+	if (g_stairChangeCallback != nullptr)
+		g_stairChangeCallback ();
+
+	return NoError;
+}
+
+// 项目名（去掉文件名中不允许的字符）用作导出文件名；未保存的项目为"untitled"
+static GS::UniString GetProjectFileStem ()
+{
+	GS::UniString name (L"untitled");
+	API_ProjectInfo projectInfo = {};
+	if (ACAPI_ProjectOperation_Project (&projectInfo) == NoError && !projectInfo.untitled && projectInfo.projectName != nullptr)
+		name = *projectInfo.projectName;
+	delete projectInfo.projectPath;
+	delete projectInfo.projectName;
+	delete projectInfo.location;
+	delete projectInfo.location_team;
+
+	for (const char* invalid : { "\\", "/", ":", "*", "?", "\"", "<", ">", "|" })
+		name.ReplaceAll (GS::UniString (invalid), GS::UniString ("_"));
+	return name;
+}
+
+static bool WriteTextFile (const IO::Location& filePath, const std::string& text)
+{
+	if (text.size () > static_cast<std::size_t> (std::numeric_limits<USize>::max ()))
+		return false;
+
+	IO::File file (filePath, IO::File::Create);
+	if (file.Open (IO::File::WriteEmptyMode) != NoError)
+		return false;
+
+	const GSErrCode err = file.WriteBin (text.data (), static_cast<USize> (text.size ()));
+	file.Close ();
+	return err == NoError;
+}
+
 } // namespace
 
+static_assert (sizeof (StairViolation) == 12, "StairViolation应保持12字节");
+static_assert (sizeof (StairViolationSet) == 4, "StairViolationSet只保存集合编号");
+// 16字节的API_Guid + 10项float实测值（40字节）+ 楼层/平台标记 + 4字节的违规项集合编号
+static_assert (sizeof (StairComplianceResult) <= 64, "StairComplianceResult应保持为几十字节、不含堆内存的紧凑记录");
+
+GS::UniString GetViolationMetricName (StairCore::RuleKind metric)
+{
+	switch (metric) {
+		case StairCore::RiserHeightRule:	return GS::UniString (L"踏步高度");
+		case StairCore::TreadDepthRule:		return GS::UniString (L"踏步宽度");
+		case StairCore::LandingLengthRule:	return GS::UniString (L"平台长度");
+		case StairCore::TwoRPlusGoingRule:	return GS::UniString (L"2R+G");
+		case StairCore::NarrowTreadDepthRule:	return GS::UniString (L"踏步窄端宽度");
+		case StairCore::RiserVariationRule:	return GS::UniString (L"踢面高度差");
+		case StairCore::StairWidthRule:		return GS::UniString (L"梯段净宽");
+		case StairCore::HandrailHeightRule:	return GS::UniString (L"扶手高度");
+		case StairCore::SlopeAngleRule:		return GS::UniString (L"梯段坡度");
+		case StairCore::FlightSpacingRule:	return GS::UniString (L"梯段间距");
+		default:							return GS::UniString (L"未知参数");
+	}
+}
+
+UIndex StairViolationSet::GetSize () const
+{
+	return g_violationSetEnds[setIndex] - (setIndex == 0 ? 0 : g_violationSetEnds[setIndex - 1]);
+}
+
+const StairViolation* StairViolationSet::begin () const
+{
+	return g_violationItems.data () + (setIndex == 0 ? 0 : g_violationSetEnds[setIndex - 1]);
+}
+
+StairViolationSet StairViolationSet::Intern (const StairViolation* items, UIndex count)
+{
+	StairViolationSet set;
+	if (count == 0)
+		return set;
+
+	// 按字段拼接键（StairViolation含填充字节，不能直接按内存比较）
+	std::string key;
+	key.reserve (count * 10);
+	for (UIndex i = 0; i < count; ++i) {
+		key.append (reinterpret_cast<const char*> (&items[i].regulationKey), sizeof (items[i].regulationKey));
+		key.append (reinterpret_cast<const char*> (&items[i].limit), sizeof (items[i].limit));
+		key += static_cast<char> (items[i].metric);
+		key += static_cast<char> (items[i].direction);
+	}
+
+	const auto found = g_violationSetIds.find (key);
+	if (found != g_violationSetIds.end ()) {
+		set.setIndex = found->second;
+		return set;
+	}
+
+	set.setIndex = static_cast<std::uint32_t> (g_violationSetEnds.size ());
+	g_violationItems.insert (g_violationItems.end (), items, items + count);
+	g_violationSetEnds.push_back (static_cast<std::uint32_t> (g_violationItems.size ()));
+	g_violationSetIds.emplace (std::move (key), set.setIndex);
+	return set;
+}
+
+UIndex StairViolationSet::GetPooledSetCount ()
+{
+	return static_cast<UIndex> (g_violationSetEnds.size () - 1);
+}
+
+UInt64 StairViolationSet::GetPoolBytes ()
+{
+	return g_violationItems.capacity () * sizeof (StairViolation) + g_violationSetEnds.capacity () * sizeof (std::uint32_t);
+}
+
+const ViolationClause& StairViolation::GetClause () const
+{
+	const std::uint64_t clauseKey = (static_cast<std::uint64_t> (regulationKey) << 8) | metric;
+	const ViolationClause* cached = g_violationClauses.GetPtr (clauseKey);
+	if (cached != nullptr)
+		return *cached;
+
+	// 规范已被移除或不再给出该类规则时没有条文
+	ViolationClause clause;
+	const std::uint32_t ruleId = regulationKey < g_regulationKeys.size ()
+		? g_regulationLibrary.FindRule (g_regulationKeys[regulationKey], GetMetric ())
+		: StairCore::kNoRule;
+	if (ruleId != StairCore::kNoRule) {
+		const StairCore::RegulationLibrary::Rule& rule = g_regulationLibrary.GetRule (ruleId);
+		clause.regulationCode = ToUniString (g_regulationLibrary.GetText (g_regulationLibrary.GetRegulation (rule.regulation).code));
+		clause.clause = ToUniString (g_regulationLibrary.GetText (rule.source));
+		clause.fullText = ToUniString (g_regulationLibrary.GetText (rule.fullText));
+	}
+	g_violationClauses.Add (clauseKey, clause);
+	return *g_violationClauses.GetPtr (clauseKey);
+}
+
+double StairComplianceResult::GetMetricValue (StairCore::RuleKind metric) const
+{
+	switch (metric) {
+		case StairCore::RiserHeightRule:	return riserHeight;
+		case StairCore::TreadDepthRule:		return treadDepth;
+		case StairCore::LandingLengthRule:	return minLandingLength;
+		case StairCore::TwoRPlusGoingRule:	return twoRPlusGoing;
+		case StairCore::NarrowTreadDepthRule:	return narrowTreadDepth;
+		case StairCore::RiserVariationRule:	return riserVariation;
+		case StairCore::StairWidthRule:		return clearWidth;
+		case StairCore::HandrailHeightRule:	return handrailHeight;
+		case StairCore::SlopeAngleRule:		return slopeAngle;
+		case StairCore::FlightSpacingRule:	return flightSpacing;
+		default:							return 0.0;
+	}
+}
+
+GS::UniString GetStoryName (short floorIndex)
+{
+	const GS::UniString* storyName = g_storyNames.GetPtr (floorIndex);
+	return storyName != nullptr ? *storyName : GS::UniString ();
+}
+
+GS::UniString StairComplianceResult::GetStoryName () const
+{
+	return ::GetStoryName (floorIndex);
+}
+
+GS::UniString StairComplianceResult::GetDisplayName () const
+{
+	return BuildDisplayName (floorIndex, g_storyNames.GetPtr (floorIndex));
+}
+
+GS::UniString StairComplianceResult::GetMetricsSummary () const
+{
+	// 只显示高度和宽度（用户要求简化检测范围），有边界数据时加上踏步窄端宽度
+	GS::UniString metrics;
+	AppendMetric (metrics, L"踏步高度", riserHeight);
+	AppendMetric (metrics, L"踏步宽度", treadDepth);
+	if (narrowTreadDepth > StairCore::kEpsilon)
+		AppendMetric (metrics, L"踏步窄端宽度", narrowTreadDepth);
+	return metrics;
+}
+
+GS::UniString FormatViolation (const StairComplianceResult& result, const StairViolation& violation)
+{
+	GS::UniString text = GetViolationMetricName (violation.GetMetric ());
+	text += L" ";
+	text += FormatMetricValue (violation.GetMetric (), result.GetMetricValue (violation.GetMetric ()));
+	text += violation.direction == ViolationDirection::BelowMin ? L" 低于下限 " : L" 超过上限 ";
+	text += FormatMetricValue (violation.GetMetric (), violation.limit);
+
+	// 出处：规范编号和条文
+	const ViolationClause& clause = violation.GetClause ();
+	GS::UniString reference = clause.regulationCode;
+	if (!clause.clause.IsEmpty ()) {
+		if (!reference.IsEmpty ())
+			reference += L" ";
+		reference += clause.clause;
+	}
+	if (!reference.IsEmpty ()) {
+		text += L"（";
+		text += reference;
+		text += L"）";
+	}
+	return text;
+}
+
 GS::Array<StairComplianceResult> EvaluateStairCompliance ()
 {
 	// 确保配置已加载
@@ -301,193 +1196,143 @@ GS::Array<StairComplianceResult> EvaluateStairCompliance ()
 
 	GS::Array<StairComplianceResult> results;
 
-	GS::HashTable<short, GS::UniString> storyNames;
-	CollectStoryNames (storyNames);
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_SUMMARY
+	const auto startTime = std::chrono::steady_clock::now ();
+#endif
+
+	CollectStoryNames ();
 
 	GS::Array<API_Guid> stairGuids;
-	if (ACAPI_Element_GetElemList (API_StairID, &stairGuids) != NoError || stairGuids.IsEmpty ())
+	if (ACAPI_Element_GetElemList (API_StairID, &stairGuids) != NoError || stairGuids.IsEmpty ()) {
+		InvalidateStairComplianceCache ();
 		return results;
+	}
+
+	// 第一阶段：单线程读取元素数据（ArchiCAD API不是线程安全的），栏杆先批量读取一次，各楼梯在索引中查找
+	ReadRailings ();
 
-	results.SetCapacity (stairGuids.GetSize ());
+	std::vector<StairCore::StairRecord> records;
+	GS::Array<UIndex> sourceIndices;
+	records.reserve (stairGuids.GetSize ());
+	sourceIndices.SetCapacity (stairGuids.GetSize ());
 
 	for (UIndex i = 0; i < stairGuids.GetSize (); ++i) {
+		records.emplace_back ();
+		if (!LoadStairRecord (stairGuids[i], records.back ())) {
+			records.pop_back ();
+			continue;
+		}
+		sourceIndices.Push (i);
+	}
+
+	// 第二阶段：并行执行规则检测，evaluations与records一一对应
+	// （不使用按列的StairMetricsTable：耗时几乎全在计算实测值，按列检测省下的时间抵不上填表和逐行取回的开销）
+	std::vector<StairCore::StairEvaluation> evaluations;
+	StairCore::EvaluateStairs (records, g_regulationLibrary, evaluations, GetEvaluationPool ());
+
+	// 第三阶段：按stairGuids顺序生成结果，同时重建增量检测缓存；违规条文只为违规的楼梯生成
+	results.SetCapacity (sourceIndices.GetSize ());
+	g_resultCache.Clear ();
+	ClearDirtyStairs ();
+	ClearStairIndex ();
+	if (g_changeObserverInstalled)
+		g_stairIndex.Reserve (sourceIndices.GetSize ());
+
+	for (UIndex k = 0; k < sourceIndices.GetSize (); ++k) {
+		const UIndex i = sourceIndices[k];
 		const API_Guid& stairGuid = stairGuids[i];
+		results.Push (BuildResult (stairGuid, records[k], evaluations[k]));
+		const StairComplianceResult& result = results.GetLast ();
 
-		API_Element element;
-		BNZeroMemory (&element, sizeof (API_Element));
-		element.header.guid = stairGuid;
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_STAIR
+		StairCore::TraceEvaluation (i, result.GetDisplayName ().ToCStr (CC_UTF8).Get (), evaluations[k], g_regulationLibrary.Resolve (records[k].context).ruleSet);
+#endif
 
-		if (ACAPI_Element_Get (&element) != NoError)
-			continue;
+		if (g_changeObserverInstalled) {
+			ACAPI_Element_AttachObserver (stairGuid);
 
-		API_ElementMemo memo;
-		BNZeroMemory (&memo, sizeof (API_ElementMemo));
-		const bool memoLoaded = (ACAPI_Element_GetMemo (stairGuid, &memo, 0) == NoError);
+			CachedStairResult cached;
+			cached.fingerprint = StairCore::ComputeInputFingerprint (records[k]);
+			cached.result = result;
+			g_resultCache.Put (stairGuid, cached);
+			UpdateStairIndex (stairGuid, records[k]);
+		}
+	}
 
-		StairComplianceResult result;
-		result.guid = stairGuid;
-		result.floorIndex = element.header.floorInd;
-		result.riserHeight = element.stair.riserHeight;
-		result.treadDepth = element.stair.treadDepth;
-		result.twoRPlusGoing = ComputeTwoRPlusGoing (result.riserHeight, result.treadDepth);
-		result.minLandingLength = 0.0;
-		result.landingEvaluated = false;
+	g_resultCacheValid = g_changeObserverInstalled;
 
-		const GS::UniString* storyNamePtr = nullptr;
-		if (storyNames.Get (result.floorIndex, &storyNamePtr) && storyNamePtr != nullptr)
-			result.storyName = *storyNamePtr;
+	STAIR_TRACE_SUMMARY ("[Stair Compliance] 评估 %u 个楼梯（%u 个违规），用时 %.3f 毫秒\n",
+		static_cast<unsigned int> (results.GetSize ()),
+		static_cast<unsigned int> (std::count_if (evaluations.begin (), evaluations.end (), [] (const StairCore::StairEvaluation& evaluation) { return !evaluation.IsCompliant (); })),
+		std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - startTime).count ());
 
-		result.displayName = BuildDisplayName (element, storyNamePtr);
+	// 结果不含堆内存，违规项集合和条文共享
+	STAIR_TRACE_SUMMARY ("[Stair Compliance] 结果占用 %u 字节（每个楼梯 %u 字节），共享违规项集合 %u 个（%u 字节），共享条文 %u 条\n",
+		static_cast<unsigned int> (results.GetSize () * sizeof (StairComplianceResult)),
+		static_cast<unsigned int> (sizeof (StairComplianceResult)),
+		static_cast<unsigned int> (StairViolationSet::GetPooledSetCount ()),
+		static_cast<unsigned int> (StairViolationSet::GetPoolBytes ()),
+		static_cast<unsigned int> (g_violationClauses.GetSize ()));
 
-		if (memoLoaded) {
-			result.minLandingLength = ComputeMinimumLandingLength (memo.stairWalkingLine, &result.landingEvaluated);
-		}
+	return results;
+}
 
-		// 调试：输出当前楼梯的实测数据
-		GS::UniString stairDebug;
-		stairDebug.Printf(L"\n[DEBUG] 楼梯 #%u (%s) 实测数据:\n", (unsigned int)i + 1, result.displayName.ToCStr().Get());
-		stairDebug += GS::UniString::Printf(L"  riserHeight = %.6f 米 (%.0f 毫米)\n",
-			result.riserHeight, result.riserHeight * 1000.0);
-		stairDebug += GS::UniString::Printf(L"  treadDepth = %.6f 米 (%.0f 毫米)\n",
-			result.treadDepth, result.treadDepth * 1000.0);
-		stairDebug += GS::UniString::Printf(L"  twoRPlusGoing = %.6f 米 (%.0f 毫米)\n",
-			result.twoRPlusGoing, result.twoRPlusGoing * 1000.0);
-		if (result.landingEvaluated) {
-			stairDebug += GS::UniString::Printf(L"  minLandingLength = %.6f 米 (%.0f 毫米)\n",
-				result.minLandingLength, result.minLandingLength * 1000.0);
-		} else {
-			stairDebug += L"  minLandingLength = 未评估\n";
-		}
-		ACAPI_WriteReport(stairDebug.ToCStr().Get(), false);
-
-		// 使用动态规范配置进行检查
-
-		// 检查踏步高度
-		if (g_regulationConfig.riserHeightRule.HasMaxValue()) {
-			const double maxHeight = g_regulationConfig.riserHeightRule.maxValue.value();
-			const double difference = result.riserHeight - maxHeight;
-
-			GS::UniString comparisonMsg;
-			comparisonMsg.Printf(L"[DEBUG] 踏步高度检查: 实测%.6f vs 限制≤%.6f, 差值=%.9f, kEpsilon=%.9f\n",
-				result.riserHeight, maxHeight, difference, kEpsilon);
-
-			if (difference > kEpsilon) {
-				comparisonMsg += L"  → 结果: ✗ 违规! 超出限制\n";
-				ACAPI_WriteReport(comparisonMsg.ToCStr().Get(), false);
-				result.violations.Push (g_regulationConfig.riserHeightRule.fullText);
-			} else {
-				comparisonMsg += L"  → 结果: ✓ 符合规范\n";
-				ACAPI_WriteReport(comparisonMsg.ToCStr().Get(), false);
-			}
-		} else {
-			ACAPI_WriteReport(L"[DEBUG] 踏步高度检查: 跳过（规则未设置maxValue）\n", false);
-		}
+bool ExportStairInterchange (const IO::Location& folder, IO::Location& exportedFile, UInt32& stairCount)
+{
+	stairCount = 0;
 
-		// 检查踏步宽度/深度
-		// 注意：只有当treadDepth有效时才检查（大于0）
-		// 某些楼梯类型可能无法通过API获取treadDepth，跳过检查
-		if (g_regulationConfig.treadDepthRule.HasMinValue()) {
-			if (result.treadDepth > kEpsilon) {
-				const double minDepth = g_regulationConfig.treadDepthRule.minValue.value();
-				const double difference = minDepth - result.treadDepth;
-
-				GS::UniString comparisonMsg;
-				comparisonMsg.Printf(L"[DEBUG] 踏步宽度检查: 实测%.6f vs 限制≥%.6f, 差值=%.9f, kEpsilon=%.9f\n",
-					result.treadDepth, minDepth, difference, kEpsilon);
-
-				if (difference > kEpsilon) {
-					comparisonMsg += L"  → 结果: ✗ 违规! 低于限制\n";
-					ACAPI_WriteReport(comparisonMsg.ToCStr().Get(), false);
-					result.violations.Push (g_regulationConfig.treadDepthRule.fullText);
-				} else {
-					comparisonMsg += L"  → 结果: ✓ 符合规范\n";
-					ACAPI_WriteReport(comparisonMsg.ToCStr().Get(), false);
-				}
-			} else {
-				ACAPI_WriteReport(L"[DEBUG] 踏步宽度检查: 跳过（treadDepth无效或为0）\n", false);
-			}
-		} else {
-			ACAPI_WriteReport(L"[DEBUG] 踏步宽度检查: 跳过（规则未设置minValue）\n", false);
-		}
+	const GS::UniString fileStem = GetProjectFileStem ();
 
-		// 【已禁用】检查平台长度 - 用户要求只检查踏步高度和宽度
-		/*
-		if (result.landingEvaluated && result.minLandingLength > 0.0) {
-			if (g_regulationConfig.landingLengthRule.HasMinValue()) {
-				const double minLanding = g_regulationConfig.landingLengthRule.minValue.value();
-				const double difference = minLanding - result.minLandingLength;
-
-				GS::UniString comparisonMsg;
-				comparisonMsg.Printf(L"[DEBUG] 平台长度检查: 实测%.6f vs 限制≥%.6f, 差值=%.9f, kEpsilon=%.9f\n",
-					result.minLandingLength, minLanding, difference, kEpsilon);
-
-				if (difference > kEpsilon) {
-					comparisonMsg += L"  → 结果: ✗ 违规! 低于限制\n";
-					ACAPI_WriteReport(comparisonMsg.ToCStr().Get(), false);
-					result.violations.Push (g_regulationConfig.landingLengthRule.fullText);
-				} else {
-					comparisonMsg += L"  → 结果: ✓ 符合规范\n";
-					ACAPI_WriteReport(comparisonMsg.ToCStr().Get(), false);
-				}
-			} else {
-				ACAPI_WriteReport(L"[DEBUG] 平台长度检查: 跳过（规则未设置minValue）\n", false);
-			}
-		} else {
-			ACAPI_WriteReport(L"[DEBUG] 平台长度检查: 跳过（未评估或长度为0）\n", false);
-		}
-		*/
-		ACAPI_WriteReport(L"[DEBUG] 平台长度检查: 已禁用（只检查踏步高度和宽度）\n", false);
-
-		// 【已禁用】检查2R+G公式 - 用户要求只检查踏步高度和宽度
-		/*
-		if (g_regulationConfig.twoRPlusGRule.HasMinValue() && g_regulationConfig.twoRPlusGRule.HasMaxValue()) {
-			const double minValue = g_regulationConfig.twoRPlusGRule.minValue.value();
-			const double maxValue = g_regulationConfig.twoRPlusGRule.maxValue.value();
-
-			GS::UniString comparisonMsg;
-			comparisonMsg.Printf(L"[DEBUG] 2R+G检查: 实测%.6f vs 限制范围[%.6f, %.6f], kEpsilon=%.9f\n",
-				result.twoRPlusGoing, minValue, maxValue, kEpsilon);
-
-			if (result.twoRPlusGoing + kEpsilon < minValue) {
-				const double difference = minValue - result.twoRPlusGoing;
-				comparisonMsg += GS::UniString::Printf(L"  差值=%.9f (低于下限)\n", difference);
-				comparisonMsg += L"  → 结果: ✗ 违规! 低于下限\n";
-				ACAPI_WriteReport(comparisonMsg.ToCStr().Get(), false);
-				result.violations.Push (g_regulationConfig.twoRPlusGRule.fullText);
-			} else if (result.twoRPlusGoing - maxValue > kEpsilon) {
-				const double difference = result.twoRPlusGoing - maxValue;
-				comparisonMsg += GS::UniString::Printf(L"  差值=%.9f (超出上限)\n", difference);
-				comparisonMsg += L"  → 结果: ✗ 违规! 超出上限\n";
-				ACAPI_WriteReport(comparisonMsg.ToCStr().Get(), false);
-				result.violations.Push (g_regulationConfig.twoRPlusGRule.fullText);
-			} else {
-				comparisonMsg += L"  → 结果: ✓ 符合规范\n";
-				ACAPI_WriteReport(comparisonMsg.ToCStr().Get(), false);
-			}
-		} else {
-			ACAPI_WriteReport(L"[DEBUG] 2R+G检查: 跳过（规则未设置min或max值）\n", false);
+	StairInterchange::ModelRecord model;
+	model.name = fileStem.ToCStr (CC_UTF8).Get ();
+	model.jurisdiction = g_projectJurisdiction;
+	model.buildingType = g_projectBuildingType;
+
+	// 导出全部检测输入，不受当前启用的规则影响：踏板标高和栏杆总是读取，扶手高度由读取方按栏杆关联
+	GS::Array<API_Guid> stairGuids;
+	if (ACAPI_Element_GetElemList (API_StairID, &stairGuids) == NoError) {
+		model.stairs.reserve (stairGuids.GetSize ());
+		model.stairIds.reserve (stairGuids.GetSize ());
+		for (const API_Guid& stairGuid : stairGuids) {
+			StairCore::StairRecord record;
+			if (!LoadStairRecord (stairGuid, record))
+				continue;
+			if (!NeedsTreadLevels ())
+				ReadTreadLevels (stairGuid, record.treadLevels);
+			model.stairIds.emplace_back (APIGuidToString (stairGuid).ToCStr (CC_UTF8).Get ());
+			model.stairs.push_back (std::move (record));
 		}
-		*/
-		ACAPI_WriteReport(L"[DEBUG] 2R+G检查: 已禁用（只检查踏步高度和宽度）\n", false);
+	}
 
-		// 只显示高度和宽度（用户要求简化检测范围）
-		GS::UniString metrics;
-		AppendMetric (metrics, L"踏步高度", result.riserHeight);
-		AppendMetric (metrics, L"踏步宽度", result.treadDepth);
-		result.metricsSummary = metrics;
+	GS::Array<API_Guid> railingGuids;
+	if (ACAPI_Element_GetElemList (API_RailingID, &railingGuids) == NoError) {
+		model.railings.reserve (railingGuids.GetSize ());
+		for (const API_Guid& railingGuid : railingGuids) {
+			StairCore::RailingRecord railing;
+			if (ReadRailing (railingGuid, railing))
+				model.railings.push_back (railing);
+		}
+	}
 
-		results.Push (result);
+	std::string json;
+	StairInterchange::WriteModel (model, json);
 
-		if (memoLoaded)
-			ACAPI_DisposeElemMemoHdls (&memo);
-	}
+	// 目录已存在时CreateFolder返回错误，忽略
+	IO::fileSystem.CreateFolder (folder);
+	exportedFile = folder;
+	GS::UniString fileName = fileStem;
+	fileName.Append (StairInterchange::kFileSuffix);
+	exportedFile.AppendToLocal (IO::Name (fileName));
+	if (!WriteTextFile (exportedFile, json))
+		return false;
 
-	return results;
+	stairCount = static_cast<UInt32> (model.stairs.size ());
+	return true;
 }
 
 void ForceReloadRegulationConfig ()
 {
-	// 重置加载标志，强制重新加载JSON
+	// 重置加载标志，重新检查JSON（文件未变化时不会重新解析，规则变化时缓存的结果在合并时失效）
 	g_configLoaded = false;
 
 	// 输出日志
@@ -496,3 +1341,214 @@ void ForceReloadRegulationConfig ()
 	// 重新加载配置
 	LoadRegulationConfigIfNeeded();
 }
+
+bool StoreRegulationFile (const IO::Location& jsonPath, const GS::UniString& name)
+{
+	g_configLoaded = true;
+	LoadCheckerSettings ();
+	LoadRegulationCacheOnce ();
+
+	std::vector<RegulationJson::RegulationRecord> records;
+	if (!RegulationConfig::LoadRecordsFromJSON (jsonPath, records))
+		return false;
+
+	// 目录已存在时CreateFolder返回错误，忽略
+	IO::Location storedPath (GS::UniString (USER_REGULATION_FOLDER_PATH));
+	IO::fileSystem.CreateFolder (storedPath);
+	GS::UniString fileName = name;
+	fileName.Append (L".json");
+	storedPath.AppendToLocal (IO::Name (fileName));
+
+	IO::fileSystem.Delete (storedPath);
+	if (IO::fileSystem.Move (jsonPath, storedPath) != NoError) {
+		ACAPI_WriteReport (L"[Stair Compliance] ⚠ 无法把规范存入规范目录: " + storedPath.ToDisplayText (), false);
+		return false;
+	}
+
+	// 新文件排在规范目录最后且其余文件未变化时，合并到规范库与重新合并的结果相同；替换了同名文件等情况下重新合并
+	std::vector<StairCore::RegulationFolderEntry> entries;
+	const std::uint64_t folderStamp = ScanRegulationFolder (entries);
+	const bool appended = !entries.empty () && GS::UniString (entries.back ().path.filename ().wstring ().c_str ()) == fileName &&
+		StairCore::HashRegulationFolder (std::vector<StairCore::RegulationFolderEntry> (entries.begin (), entries.end () - 1)) == g_regulationFolderStamp;
+	if (!appended) {
+		RebuildRegulationLibrary (entries, folderStamp);
+		return true;
+	}
+
+	// 统一JSON的标记不变，下次检测时不会用它覆盖刚合并的规范
+	MergeRegulationRecords (records);
+	g_regulationFolderStamp = folderStamp;
+	RegulationConfig::SaveLibraryCache (IO::Location (GS::UniString (USER_REGULATION_CACHE_PATH)), g_regulationLibrary, g_regulationSourceStamp, g_regulationFolderStamp);
+	ReportLoadedRules (L"规范目录");
+	return true;
+}
+
+void SetRegulationScope (const GS::UniString& jurisdiction, const GS::UniString& buildingType)
+{
+	g_projectJurisdiction = jurisdiction.ToCStr (CC_UTF8).Get ();
+	g_projectBuildingType = buildingType.ToCStr (CC_UTF8).Get ();
+
+	const StairCore::RuleContext previousContext = g_projectContext;
+	RefreshProjectRules ();
+
+	if (previousContext.jurisdiction != g_projectContext.jurisdiction || previousContext.buildingType != g_projectContext.buildingType)
+		InvalidateStairComplianceCache ();
+}
+
+void GetRegulationScopeChoices (GS::Array<GS::UniString>& jurisdictions, GS::Array<GS::UniString>& buildingTypes)
+{
+	LoadRegulationConfigIfNeeded ();
+
+	jurisdictions.Clear ();
+	buildingTypes.Clear ();
+
+	// 编号从1开始，0表示不限
+	for (std::size_t id = 1; id <= g_regulationLibrary.GetJurisdictionCount (); ++id) {
+		const std::string_view name = g_regulationLibrary.GetJurisdictionName (static_cast<std::uint16_t> (id));
+		if (!name.empty ())
+			jurisdictions.Push (ToUniString (name));
+	}
+	for (std::size_t id = 1; id <= g_regulationLibrary.GetBuildingTypeCount (); ++id) {
+		const std::string_view name = g_regulationLibrary.GetBuildingTypeName (static_cast<std::uint16_t> (id));
+		if (!name.empty ())
+			buildingTypes.Push (ToUniString (name));
+	}
+}
+
+void SetCheckedRules (std::uint32_t ruleMask)
+{
+	if (ruleMask == g_checkedRules)
+		return;
+
+	g_checkedRules = ruleMask;
+
+	// 规范库重新编译生效规则，指纹随之变化，缓存的结果失效
+	g_regulationLibrary.SetEnabledRules (g_checkedRules);
+	RefreshProjectRules ();
+	InvalidateStairComplianceCache ();
+}
+
+std::uint32_t GetCheckedRules ()
+{
+	return g_checkedRules;
+}
+
+void SetStairEvaluationThreadCount (unsigned int threadCount)
+{
+	g_evaluationThreadCount = threadCount;
+}
+
+void ShutdownStairEvaluation ()
+{
+	// 在插件卸载前回收工作线程，避免在DLL卸载时join
+	g_evaluationPool.reset ();
+}
+
+GSErrCode InstallStairChangeObserver (StairChangeCallback callback)
+{
+	API_ToolBoxItem stairType = {};
+	stairType.type = API_StairID;
+	API_ToolBoxItem railingType = {};
+	railingType.type = API_RailingID;
+
+	GSErrCode err = ACAPI_Notification_CatchNewElement (&stairType, StairElementEventHandler);
+	if (err == NoError)
+		err = ACAPI_Notification_CatchNewElement (&railingType, StairElementEventHandler);
+	if (err == NoError)
+		err = ACAPI_Notification_InstallElementObserver (StairElementEventHandler);
+
+	if (err != NoError) {
+		UninstallStairChangeObserver ();
+		return err;
+	}
+
+	g_stairChangeCallback = callback;
+	g_changeObserverInstalled = true;
+	return NoError;
+}
+
+void UninstallStairChangeObserver ()
+{
+	API_ToolBoxItem stairType = {};
+	stairType.type = API_StairID;
+	API_ToolBoxItem railingType = {};
+	railingType.type = API_RailingID;
+
+	ACAPI_Notification_CatchNewElement (&stairType, nullptr);
+	ACAPI_Notification_CatchNewElement (&railingType, nullptr);
+	ACAPI_Notification_InstallElementObserver (nullptr);
+
+	g_stairChangeCallback = nullptr;
+	g_changeObserverInstalled = false;
+	InvalidateStairComplianceCache ();
+}
+
+bool IsStairComplianceCacheValid ()
+{
+	return g_resultCacheValid;
+}
+
+void InvalidateStairComplianceCache ()
+{
+	g_resultCacheValid = false;
+	g_resultCache.Clear ();
+	ClearDirtyStairs ();
+	ClearStairIndex ();
+}
+
+bool HasDirtyStairs ()
+{
+	return !g_dirtyStairs.IsEmpty () || !g_dirtyRailings.IsEmpty ();
+}
+
+StairComplianceDelta EvaluateDirtyStairs ()
+{
+	StairComplianceDelta delta;
+	if (!g_resultCacheValid || !HasDirtyStairs ())
+		return delta;
+
+	LoadRegulationConfigIfNeeded ();
+
+	CollectStoryNames ();
+
+	// 先处理栏杆，受影响的楼梯与修改过的楼梯一起重新检测
+	ApplyRailingChanges ();
+
+	StairCore::StairRecord record;
+
+	for (const API_Guid& stairGuid : g_dirtyStairs) {
+		if (!LoadStairRecord (stairGuid, record)) {
+			if (g_resultCache.ContainsKey (stairGuid)) {
+				g_resultCache.Delete (stairGuid);
+				delta.removed.Push (stairGuid);
+			}
+			RemoveFromStairIndex (stairGuid);
+			continue;
+		}
+
+		// 只改了材质、图层等与检测无关的属性时不重新检测
+		const std::uint64_t fingerprint = StairCore::ComputeInputFingerprint (record);
+		const CachedStairResult* cached = g_resultCache.GetPtr (stairGuid);
+		if (cached != nullptr && cached->fingerprint == fingerprint)
+			continue;
+
+		UpdateStairIndex (stairGuid, record);
+
+		const StairCore::StairEvaluation evaluation = StairCore::EvaluateStair (record, g_regulationLibrary);
+
+		CachedStairResult updated;
+		updated.fingerprint = fingerprint;
+		updated.result = BuildResult (stairGuid, record, evaluation);
+		g_resultCache.Put (stairGuid, updated);
+
+		delta.updated.Push (updated.result);
+	}
+
+	ClearDirtyStairs ();
+
+	STAIR_TRACE_SUMMARY ("[Stair Compliance] 增量检测：%u 个楼梯已更新，%u 个已删除\n",
+		static_cast<unsigned int> (delta.updated.GetSize ()),
+		static_cast<unsigned int> (delta.removed.GetSize ()));
+
+	return delta;
+}
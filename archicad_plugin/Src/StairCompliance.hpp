@@ -4,29 +4,176 @@
 #include "APIEnvir.h"
 #include "ACAPinc.h"
 
+#include <cstdint>
+
+#include "Location.hpp"
 #include "UniString.hpp"
 
+#include "StairEvaluationCore.hpp"
+
+// 楼梯数据导出目录（与规范JSON同在shared目录下）
+#define USER_STAIR_EXPORT_FOLDER L"E:\\ArchiCAD_Development_File\\BuildingCodeChecker_Stair\\shared\\stair_exports"
+
+// 检测设置（线程数等），每次加载规范时读取，文件不存在时使用默认设置
+#define USER_CHECKER_SETTINGS_PATH L"E:\\ArchiCAD_Development_File\\BuildingCodeChecker_Stair\\shared\\stair_check_settings.json"
+
+// 违规方向：实测值低于下限或超过上限
+enum class ViolationDirection : std::uint8_t {
+    BelowMin,
+    AboveMax
+};
+
+// 违规项的条文出处：每部规范的每类规则只转换一次UniString，所有结果共享，规范库变化时清空
+struct ViolationClause {
+    GS::UniString               regulationCode;     // 给出限值的规范编号
+    GS::UniString               clause;             // 条文出处（JSON中的source）
+    GS::UniString               fullText;           // 完整条文
+};
+
+// 没有给出限值的规范（违规项没有条文）
+constexpr std::uint32_t kNoRegulationKey = 0xFFFFFFFFu;
+
+// 结构化的违规项（12字节），实测值取自所属的结果，条文按 (regulationKey, metric) 取共享的ViolationClause
+struct StairViolation {
+    std::uint32_t               regulationKey;      // 给出该限值的规范（按合并键登记的编号，规范库合并后不变），kNoRegulationKey表示没有条文
+    float                       limit;              // 被违反的限值（米，适用规范中最严格的）
+    std::uint8_t                metric;             // StairCore::RuleKind
+    ViolationDirection          direction;
+
+    StairCore::RuleKind         GetMetric () const { return static_cast<StairCore::RuleKind> (metric); }
+
+    // 条文在规范库中按规范的合并键和实测值类别查找，规范库合并后取替换后的条文；返回的引用在下一次调用GetClause前有效
+    const ViolationClause&      GetClause () const;
+
+    bool operator== (const StairViolation& other) const
+    {
+        return regulationKey == other.regulationKey && limit == other.limit && metric == other.metric && direction == other.direction;
+    }
+    bool operator!= (const StairViolation& other) const { return !(*this == other); }
+};
+
+/**
+ * 违规项集合（4字节的集合编号）
+ *
+ * 违规项只取决于规则类别、限值和规范，大量楼梯的违规项相同，因此集合在构建结果时（主线程）
+ * 登记到共享的违规项池中，内容相同的集合只存一份；登记后不变，池在插件运行期间只增不减。
+ * begin/end 返回的指针在下一次登记前有效。
+ */
+class StairViolationSet {
+public:
+    UIndex                      GetSize () const;
+    bool                        IsEmpty () const { return setIndex == 0; }
+    const StairViolation&       operator[] (UIndex index) const { return begin ()[index]; }
+    const StairViolation*       begin () const;
+    const StairViolation*       end () const { return begin () + GetSize (); }
+
+    // 登记违规项（每类规则最多一项），内容相同时返回已登记的集合
+    static StairViolationSet    Intern (const StairViolation* items, UIndex count);
+
+    // 池中登记的集合数和违规项占用的字节数
+    static UIndex               GetPooledSetCount ();
+    static UInt64               GetPoolBytes ();
+
+    // 内容相同的集合编号相同
+    bool operator== (const StairViolationSet& other) const { return setIndex == other.setIndex; }
+    bool operator!= (const StairViolationSet& other) const { return !(*this == other); }
+
+private:
+    std::uint32_t               setIndex = 0;       // 0表示没有违规项
+};
+
+/**
+ * 单个楼梯的检测结果（64字节，不含堆内存，违规项存放在共享的违规项池中）
+ *
+ * 只保存实测值和违规项，名称、楼层名和实测参数说明在显示时格式化；
+ * 楼层名取自最近一次检测时读取的楼层表。
+ */
 struct StairComplianceResult {
     API_Guid                    guid;
-    GS::UniString               displayName;
-    GS::UniString               storyName;
+    float                       riserHeight;        // 实测值（米）以float保存，显示精度为毫米
+    float                       treadDepth;
+    float                       minLandingLength;
+    float                       twoRPlusGoing;
+    float                       narrowTreadDepth;
+    float                       riserVariation;
+    float                       clearWidth;
+    float                       handrailHeight;
+    float                       slopeAngle;         // 度
+    float                       flightSpacing;
     short                       floorIndex;
-    double                      riserHeight;
-    double                      treadDepth;
-    double                      minLandingLength;
-    double                      twoRPlusGoing;
     bool                        landingEvaluated;
-    GS::UniString               metricsSummary;
-    GS::Array<GS::UniString>    violations;
-    GS::Array<GS::UniString>    notices;
+    StairViolationSet           violations;
 
     bool IsCompliant () const { return violations.IsEmpty (); }
+
+    double                      GetMetricValue (StairCore::RuleKind metric) const;
+    GS::UniString               GetStoryName () const;
+    GS::UniString               GetDisplayName () const;        // 如"1F 楼梯"
+    GS::UniString               GetMetricsSummary () const;     // 如"踏步高度 175 毫米；踏步宽度 260 毫米"
+};
+
+// 增量检测结果：只包含自上次检测以来发生变化的楼梯
+struct StairComplianceDelta {
+    GS::Array<StairComplianceResult>    updated;    // 新增或输入已变化的楼梯
+    GS::Array<API_Guid>                 removed;    // 已删除的楼梯
+
+    bool IsEmpty () const { return updated.IsEmpty () && removed.IsEmpty (); }
 };
 
+typedef void (*StairChangeCallback) ();
+
+// 最近一次检测时读取的楼层名，未找到时为空
+GS::UniString GetStoryName (short floorIndex);
+
+// 实测值类别的显示名称（如"踏步高度"）
+GS::UniString GetViolationMetricName (StairCore::RuleKind metric);
+
+// 违规项的一行说明，如"踏步高度 180 毫米 超过上限 175 毫米（GB 50096-2011 6.3.2）"
+GS::UniString FormatViolation (const StairComplianceResult& result, const StairViolation& violation);
+
 GS::Array<StairComplianceResult> EvaluateStairCompliance ();
 
+// 导出项目中全部楼梯和栏杆的检测输入（楼梯交换格式，见StairInterchange），写入folder下的"<项目名>.stairs.json"，
+// 供命令行批量检测工具在没有ArchiCAD的机器上检测
+bool ExportStairInterchange (const IO::Location& folder, IO::Location& exportedFile, UInt32& stairCount);
+
 // 强制重新加载规范配置（供"开始检测"按钮使用）
 void ForceReloadRegulationConfig ();
 
+// 把JSON文件移入规范目录（USER_REGULATION_FOLDER_PATH，文件名为"<name>.json"，同名文件被替换），
+// 再把其中的规范合并到规范库（地区和编号相同的规范被替换）；没有规则被成功解析或无法移入时返回false，文件保留在原处
+bool StoreRegulationFile (const IO::Location& jsonPath, const GS::UniString& name);
+
+// 设置项目的地区（如"CN-BJ"）和建筑类型（如"residential"），为空表示不限；
+// 检测时使用规范库中适用于该范围的所有规范，每条规则取最严格的限值
+void SetRegulationScope (const GS::UniString& jurisdiction, const GS::UniString& buildingType);
+
+// 规范库中收录的地区和建筑类型名称（按收录顺序），供面板选择适用范围；规范尚未加载时先加载
+void GetRegulationScopeChoices (GS::Array<GS::UniString>& jurisdictions, GS::Array<GS::UniString>& buildingTypes);
+
+// 设置参与检测的规则类别（位掩码，第k位对应StairCore::RuleKind k），无需重新编译插件即可开关规则；
+// 加载规范时按检测设置文件中的"checked_rules"调用
+void SetCheckedRules (std::uint32_t ruleMask);
+std::uint32_t GetCheckedRules ();
+
+// 设置规则检测使用的线程数（0 = 硬件并发数，1 = 单线程），结果顺序不受影响；
+// 加载规范时按检测设置文件中的"threads"调用
+void SetStairEvaluationThreadCount (unsigned int threadCount);
+
+// 释放检测线程池（插件FreeData时调用）
+void ShutdownStairEvaluation ();
+
+// 订阅楼梯新建/修改/删除通知，变更的楼梯记为待检测，随后调用callback
+GSErrCode InstallStairChangeObserver (StairChangeCallback callback);
+void UninstallStairChangeObserver ();
+
+// 缓存有效时（已完成一次全量检测、规则未变化）可以只检测变更的楼梯
+bool IsStairComplianceCacheValid ();
+void InvalidateStairComplianceCache ();
+bool HasDirtyStairs ();
+
+// 只重新检测待检测的楼梯；输入指纹未变化的楼梯不会出现在结果中
+StairComplianceDelta EvaluateDirtyStairs ();
+
 #endif
 
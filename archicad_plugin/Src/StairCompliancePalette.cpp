@@ -1,13 +1,19 @@
 ﻿#include "StairCompliancePalette.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "APICommon.h"
 #include "ResourceIDs.h"
 #include "RegulationConfig.hpp"
 #include "File.hpp"
+#include "HashTable.hpp"
+#include "StairTrace.hpp"
 
 // 外部函数声明
 extern RegulationConfig g_regulationConfig;
@@ -20,6 +26,22 @@ constexpr const char* kColumnWidthKey_Name = "StairCompliance_ColumnWidth_Name";
 constexpr const char* kColumnWidthKey_Status = "StairCompliance_ColumnWidth_Status";
 constexpr const char* kColumnWidthKey_Detail = "StairCompliance_ColumnWidth_Detail";
 
+// ArchiCAD偏好设置：版本1只有列宽，版本2起加上项目适用范围（UTF-8，以0结尾）
+constexpr Int32 kColumnWidthPrefsVersion = 1;
+constexpr Int32 kPalettePrefsVersion = 2;
+
+struct ColumnWidthPrefs {
+    short nameWidth;
+    short statusWidth;
+    short detailWidth;
+};
+
+struct PalettePrefs {
+    ColumnWidthPrefs columns;
+    char             jurisdiction[64];
+    char             buildingType[64];
+};
+
 static GS::UniString LoadString (short resId, short index)
 {
     GS::UniString value = RSGetIndString (resId, index, ACAPI_GetOwnResModule ());
@@ -44,6 +66,26 @@ static GS::UniString LoadString (short resId, short index)
 constexpr short kPaletteMenuResId = ID_PALETTE_MENU_STRINGS;
 constexpr short kPaletteMenuItemIndex = 1;
 
+// 列表控件中最多放置的结果行数，翻页时窗口移动半页以保留上下文
+constexpr std::size_t kListWindowRows = 200;
+constexpr std::size_t kListPageStep = kListWindowRows / 2;
+
+// PDF规范提取常驻进程（Python）及其日志
+constexpr const wchar_t* kExtractorWorkerPath = L"E:\\ArchiCAD_Development\\StairRegulationRAG\\src\\worker.py";
+constexpr const wchar_t* kExtractorLogPath = L"E:\\ArchiCAD_Development\\python_output.log";
+// 按PDF内容缓存的提取结果，同一份规范再次上传时不再解析和调用LLM
+constexpr const wchar_t* kExtractionCachePath = L"E:\\ArchiCAD_Development_File\\BuildingCodeChecker_Stair\\shared\\extraction_cache";
+constexpr std::chrono::seconds kExtractionTimeout (15 * 60);
+
+static std::wstring ToWideString (const GS::UniString& text)
+{
+    std::wstring result;
+    result.reserve (text.GetLength ());
+    for (UIndex i = 0; i < text.GetLength (); ++i)
+        result += static_cast<wchar_t> (text[i]);
+    return result;
+}
+
 // 注意：规范条文现在从JSON配置文件加载，不再使用硬编码
 
 static GS::UniString GetStatusText (const StairComplianceResult& result)
@@ -53,6 +95,215 @@ static GS::UniString GetStatusText (const StairComplianceResult& result)
     return LoadString (ID_COMPLIANCE_STRINGS, 4);
 }
 
+struct ResultRow {
+    GS::UniString   name;
+    GS::UniString   regulation;
+    GS::UniString   measured;
+};
+
+static GS::UniString FormatMM (double meters)
+{
+    return GS::UniString::Printf (L"%.0lf mm", meters * 1000.0);
+}
+
+// 坡度以度为单位，其余实测值以米为单位
+static GS::UniString FormatMetric (StairCore::RuleKind metric, double value)
+{
+    if (metric == StairCore::SlopeAngleRule)
+        return GS::UniString::Printf (L"%.1lf°", value);
+    return FormatMM (value);
+}
+
+// 楼梯行：楼梯名称和检测状态
+static ResultRow BuildStairRow (const StairComplianceResult& result)
+{
+    // 统计违规项数量
+    UIndex violationCount = result.violations.GetSize ();
+
+    // 显示所有楼梯（包括符合规范的）
+    if (violationCount == 0) {
+        // 符合规范的楼梯
+        GS::UniString statusText = L"✓ 符合规范";
+
+        // 显示实测参数
+        GS::UniString debugInfo;
+        debugInfo.Printf (L" [实测: 踏步高度%.0fmm 踏步宽度%.0fmm 2R+G%.0fmm]",
+                         result.riserHeight * 1000.0,
+                         result.treadDepth * 1000.0,
+                         result.twoRPlusGoing * 1000.0);
+        statusText.Append (debugInfo);
+
+        return { result.GetDisplayName (), GS::UniString (), statusText };
+    }
+
+    // 违规的楼梯
+    GS::UniString statusText = GetStatusText (result);
+    statusText.Append (GS::UniString::Printf (L"（%d项违规）", (int)violationCount));
+
+    // 调试信息：显示楼梯的实测数据
+    GS::UniString debugInfo;
+    debugInfo.Printf (L"[调试] 踏步高度:%.0fmm 踏步深度:%.0fmm",
+                     result.riserHeight * 1000.0,
+                     result.treadDepth * 1000.0);
+    statusText.Append (L" ");
+    statusText.Append (debugInfo);
+
+    return { result.GetDisplayName (), GS::UniString (), statusText };
+}
+
+// 违规项行：按违规项的实测值类别、方向和限值生成，规范条例列显示完整条文
+static ResultRow BuildViolationRow (const StairComplianceResult& result, UIndex violationIndex)
+{
+    const StairViolation& violation = result.violations[violationIndex];
+    const ViolationClause& clause = violation.GetClause ();
+    const bool belowMin = violation.direction == ViolationDirection::BelowMin;
+
+    GS::UniString itemName;
+    GS::UniString verdict = belowMin ? L" ✗ 不足" : L" ✗ 超标";
+    switch (violation.GetMetric ()) {
+        case StairCore::RiserHeightRule:    itemName = L"踏步高度";       break;
+        case StairCore::TreadDepthRule:     itemName = L"踏步宽度/深度";  break;
+        case StairCore::LandingLengthRule:  itemName = L"平台长度";       break;
+        case StairCore::NarrowTreadDepthRule: itemName = L"踏步窄端宽度"; break;
+        case StairCore::RiserVariationRule: itemName = L"踢面高度差";     break;
+        case StairCore::StairWidthRule:     itemName = L"梯段净宽";       break;
+        case StairCore::HandrailHeightRule: itemName = L"扶手高度";       break;
+        case StairCore::FlightSpacingRule:  itemName = L"梯段间距";       break;
+        case StairCore::SlopeAngleRule:
+            itemName = L"梯段坡度";
+            verdict = L" ✗ 过陡";
+            break;
+        case StairCore::TwoRPlusGoingRule:
+            itemName = L"步行舒适度";
+            verdict = belowMin ? L" ✗ 过于陡峭" : L" ✗ 过于平缓";
+            break;
+        default:
+            itemName = GS::UniString::Printf (L"违规项 %d", (int)(violationIndex + 1));
+            break;
+    }
+
+    // 最后一项使用└─而不是├─
+    const bool isLast = violationIndex == result.violations.GetSize () - 1;
+    itemName = GS::UniString (isLast ? L"  └─ " : L"  ├─ ") + itemName;
+
+    GS::UniString measuredValue = FormatMetric (violation.GetMetric (), result.GetMetricValue (violation.GetMetric ())) + verdict;
+    measuredValue += belowMin ? L"（≥ " : L"（≤ ";
+    measuredValue += FormatMetric (violation.GetMetric (), violation.limit);
+    measuredValue += L"）";
+
+    // 没有条文全文时显示规范编号和条文出处
+    GS::UniString regulation = clause.fullText;
+    if (regulation.IsEmpty ()) {
+        regulation = clause.regulationCode;
+        if (!clause.clause.IsEmpty ()) {
+            if (!regulation.IsEmpty ())
+                regulation += L" ";
+            regulation += clause.clause;
+        }
+    }
+
+    return { itemName, regulation, measuredValue };
+}
+
+// 模型行的显示内容：detail为0时是楼梯行，否则是第detail个违规项
+static ResultRow BuildResultRow (const StairComplianceResult& result, std::uint32_t detail)
+{
+    if (detail == 0 || detail > result.violations.GetSize ())
+        return BuildStairRow (result);
+    return BuildViolationRow (result, detail - 1);
+}
+
+// 两次检测中同一楼梯的显示内容是否相同
+static bool IsSameResult (const StairComplianceResult& a, const StairComplianceResult& b)
+{
+    // 名称由楼层决定；违规项保存规范的登记编号，条文在绘制时按编号查找，
+    // 重新上传后条文文字变化时由RenderWindow按单元格文字比较更新
+    return a.floorIndex == b.floorIndex &&
+           a.riserHeight == b.riserHeight && a.treadDepth == b.treadDepth &&
+           a.minLandingLength == b.minLandingLength && a.twoRPlusGoing == b.twoRPlusGoing &&
+           a.narrowTreadDepth == b.narrowTreadDepth && a.riserVariation == b.riserVariation &&
+           a.clearWidth == b.clearWidth && a.handrailHeight == b.handrailHeight &&
+           a.slopeAngle == b.slopeAngle && a.flightSpacing == b.flightSpacing &&
+           a.violations == b.violations;
+}
+
+static StairCore::ResultListEntry MakeListEntry (const StairComplianceResult& result)
+{
+    StairCore::ResultListEntry entry;
+    entry.name = ToWideString (result.GetDisplayName ());
+    entry.floorIndex = result.floorIndex;
+    entry.violationCount = static_cast<std::uint32_t> (result.violations.GetSize ());
+    return entry;
+}
+
+static GS::UniString BuildCheckSummary (const GS::Array<StairComplianceResult>& results)
+{
+    // 统计结果
+    unsigned int totalCount = static_cast<unsigned int> (results.GetSize ());
+    unsigned int nonCompliantCount = 0;
+    unsigned int compliantCount = 0;
+
+    for (const StairComplianceResult& result : results) {
+        if (!result.IsCompliant ())
+            nonCompliantCount++;
+        else
+            compliantCount++;
+    }
+
+    GS::UniString summary;
+    summary.Append (GS::UniString (L"【检测结果】共检测 "));
+    summary.Append (GS::UniString::Printf ("%u", totalCount));
+    summary.Append (GS::UniString (L" 个楼梯，其中 "));
+    summary.Append (GS::UniString::Printf ("%u", nonCompliantCount));
+    summary.Append (GS::UniString (L" 个存在违规，"));
+    summary.Append (GS::UniString::Printf ("%u", compliantCount));
+    summary.Append (GS::UniString (L" 个符合规范"));
+    return summary;
+}
+
+static void CopyPrefsText (const GS::UniString& text, char (&target)[64])
+{
+    std::memset (target, 0, sizeof (target));
+    const std::string utf8 = text.ToCStr (CC_UTF8).Get ();
+    if (utf8.size () < sizeof (target))
+        std::memcpy (target, utf8.data (), utf8.size ());
+}
+
+// 重建适用范围下拉框：第1项为不限，其后为规范库中的名称；
+// 选中的名称不在规范库中时也列出（规范库按最近的已收录上级地区处理），选项未变化时不重建
+static void FillScopePopup (DG::PopUp& popup, const wchar_t* anyText, GS::Array<GS::UniString>&& names,
+                            const GS::UniString& selected, GS::Array<GS::UniString>& choices)
+{
+    if (!selected.IsEmpty () && !names.Contains (selected))
+        names.Push (selected);
+
+    if (names != choices || popup.GetItemCount () == 0) {
+        choices = std::move (names);
+        popup.DeleteItem (DG::PopUp::AllItems);
+        popup.AppendItem ();
+        popup.SetItemText (DG::PopUp::BottomItem, GS::UniString (anyText));
+        for (const GS::UniString& name : choices) {
+            popup.AppendItem ();
+            popup.SetItemText (DG::PopUp::BottomItem, name);
+        }
+    }
+
+    short selectedItem = 1;
+    for (UIndex i = 0; i < choices.GetSize (); ++i) {
+        if (choices[i] == selected)
+            selectedItem = static_cast<short> (i + 2);
+    }
+    popup.SelectItem (selectedItem);
+}
+
+static GS::UniString GetSelectedScope (const DG::PopUp& popup, const GS::Array<GS::UniString>& choices)
+{
+    const short item = popup.GetSelectedItem ();
+    if (item < 2 || static_cast<UIndex> (item - 2) >= choices.GetSize ())
+        return GS::UniString ();
+    return choices[static_cast<UIndex> (item - 2)];
+}
+
 } // namespace
 
 StairCompliancePalette* StairCompliancePalette::instance = nullptr;
@@ -76,27 +327,55 @@ StairCompliancePalette::StairCompliancePalette () :
     uploadPdfButton (GetReference (), ID_UPLOAD_PDF_BUTTON),
     checkNowButton (GetReference (), ID_CHECK_NOW_BUTTON),
     regulationInfoText (GetReference (), ID_REGULATION_INFO_TEXT),
-    listBox (GetReference (), ID_COMPLIANCE_LISTBOX)
+    listBox (GetReference (), ID_COMPLIANCE_LISTBOX),
+    violationsOnlyCheck (GetReference (), ID_VIOLATIONS_ONLY_CHECK),
+    storeyPopup (GetReference (), ID_STOREY_FILTER_POPUP),
+    jurisdictionPopup (GetReference (), ID_JURISDICTION_POPUP),
+    buildingTypePopup (GetReference (), ID_BUILDING_TYPE_POPUP),
+    stairChangesPending (false),
+    windowStart (0),
+    windowRowCount (0),
+    windowHasPrevPage (false),
+    windowHasNextPage (false),
+    // -u 关闭输出缓冲以便及时收到消息，-X utf8 让标准输入输出统一为UTF-8
+    extractionWorker ({ L"python", L"-u", L"-X", L"utf8", kExtractorWorkerPath, L"--cache-dir", kExtractionCachePath }, kExtractorLogPath, kExtractionTimeout),
+    extractionSerial (0),
+    extractionBatchSize (0),
+    appliedExtractionCount (0)
 {
     Attach (*this);
     listBox.Attach (*this);
     uploadPdfButton.Attach (*this);  // 附加上传按钮观察者
     checkNowButton.Attach (*this);    // 附加检测按钮观察者
+    violationsOnlyCheck.Attach (*this);
+    storeyPopup.Attach (*this);
+    jurisdictionPopup.Attach (*this);
+    buildingTypePopup.Attach (*this);
 
     summaryText.SetText (GS::UniString (L"汇总信息将在检查后显示"));
 
+    InitializeListBox ();
+    LoadPreferences ();   // 加载保存的列宽和项目适用范围
+
+    // 保存的适用范围在规范加载前传给规范库，下拉框在面板打开时按规范库填充
+    SetRegulationScope (projectJurisdiction, projectBuildingType);
+
     // 初始化规范信息显示
     UpdateRegulationInfo ();
 
-    InitializeListBox ();
-    LoadColumnWidths ();  // 加载保存的列宽
+    EnableIdleEvent ();   // 空闲时轮询后台提取任务的进度
     BeginEventProcessing ();
 }
 
 StairCompliancePalette::~StairCompliancePalette ()
 {
-    SaveColumnWidths ();  // 保存列宽
+    extractionWorker.Shutdown ();  // 面板销毁时关闭提取进程
+    SavePreferences ();   // 保存列宽和项目适用范围
     EndEventProcessing ();
+    buildingTypePopup.Detach (*this);
+    jurisdictionPopup.Detach (*this);
+    storeyPopup.Detach (*this);
+    violationsOnlyCheck.Detach (*this);
     checkNowButton.Detach (*this);
     uploadPdfButton.Detach (*this);
     listBox.Detach (*this);
@@ -144,14 +423,46 @@ void StairCompliancePalette::UnregisterPalette ()
     }
 }
 
-void StairCompliancePalette::UpdateResults (const GS::Array<StairComplianceResult>& results,
+void StairCompliancePalette::UpdateResults (GS::Array<StairComplianceResult>&& results,
                                             const GS::UniString& summary,
                                             const GS::UniString& /*regulation*/)
 {
-    storedResults = results;
-
     UpdateSummary (summary);
-    FillListBox (results);
+
+    // 按GUID与上次的结果比较，未变化的楼梯沿用原来的模型键；列表控件只更新可见窗口内变化的行
+    const UIndex selectedResult = GetSelectedResult ();
+    const API_Guid selectedGuid = selectedResult != InvalidResultIndex ? storedResults[selectedResult].guid : APINULLGuid;
+
+    std::vector<StairCore::ResultListEntry> entries;
+    entries.reserve (results.GetSize ());
+    UIndex newSelectedResult = InvalidResultIndex;
+    UIndex addedCount = 0;
+    UIndex changedCount = 0;
+    for (UIndex i = 0; i < results.GetSize (); ++i) {
+        const StairComplianceResult& result = results[i];
+        const UIndex* previous = resultIndices.GetPtr (result.guid);
+        if (previous == nullptr) {
+            entries.push_back (MakeListEntry (result));
+            ++addedCount;
+        } else if (!IsSameResult (storedResults[*previous], result)) {
+            entries.push_back (MakeListEntry (result));
+            ++changedCount;
+        } else {
+            entries.push_back (resultModel.GetEntry (*previous));
+        }
+
+        if (selectedResult != InvalidResultIndex && result.guid == selectedGuid)
+            newSelectedResult = i;
+    }
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_STAIR
+    const UIndex removedCount = storedResults.GetSize () + addedCount - results.GetSize ();
+    STAIR_TRACE_STAIR ("[Stair Compliance] 列表更新: 新增 %u，删除 %u，变化 %u\n", addedCount, removedCount, changedCount);
+#endif
+
+    storedResults = std::move (results);
+    RebuildResultIndices ();
+    resultModel.SetEntries (std::move (entries));
+    RefreshResultView (newSelectedResult);
 }
 
 void StairCompliancePalette::UpdateSummary (const GS::UniString& summary)
@@ -231,11 +542,21 @@ void StairCompliancePalette::PanelOpened (const DG::PanelOpenEvent&)
 
     // 清空之前的检测结果，让用户重新上传PDF和执行检测
     storedResults.Clear();
-    listBox.DeleteItem(DG::ListBox::AllItems);
+    resultIndices.Clear ();
+    stairChangesPending = false;
+    ClearListBox ();
     summaryText.SetText(L"请先上传PDF规范，然后点击'开始检测'按钮");
 
-    // 更新规范信息显示（如果已有规范则显示，否则显示提示）
+    // 按规范库填充适用范围下拉框，更新规范信息显示（如果已有规范则显示，否则显示提示）
+    UpdateScopePopups ();
     UpdateRegulationInfo();
+
+    // 提取仍在进行时继续显示进度
+    if (!pendingExtractions.IsEmpty ()) {
+        uploadPdfButton.SetText (L"取消提取");
+        extractionStatus.Clear ();
+        PollExtraction ();
+    }
 }
 
 void StairCompliancePalette::PanelClosed (const DG::PanelCloseEvent&)
@@ -257,16 +578,69 @@ void StairCompliancePalette::ItemToolTipRequested (const DG::ItemHelpEvent& ev,
     if (ev.GetSource () != &listBox || toolTipText == nullptr)
         return;
 
-    // 获取当前选中的行，显示其tooltip
-    const short row = listBox.GetSelectedItem ();
-    if (row > 0) {
-        GS::UniString tooltip;
-        if (rowTooltips.Get (row, &tooltip)) {
-            *toolTipText = tooltip;
-        }
+    // 获取当前选中的行，违规项行显示违规说明和完整的规范条文
+    std::size_t modelRow = 0;
+    if (!GetModelRow (listBox.GetSelectedItem (), modelRow))
+        return;
+
+    const StairCore::ResultListRow& row = resultModel.GetRow (modelRow);
+    if (row.result >= storedResults.GetSize () || row.detail == 0 || row.detail > storedResults[row.result].violations.GetSize ())
+        return;
+
+    // 违规说明（实测值、限值、出处），其后为完整条文
+    const StairViolation& violation = storedResults[row.result].violations[row.detail - 1];
+    const GS::UniString& fullText = violation.GetClause ().fullText;
+    *toolTipText = FormatViolation (storedResults[row.result], violation);
+    if (!fullText.IsEmpty ()) {
+        *toolTipText += L"\n";
+        *toolTipText += fullText;
+    }
+}
+
+void StairCompliancePalette::ListBoxSelectionChanged (const DG::ListBoxSelectionEvent& ev)
+{
+    if (ev.GetSource () != &listBox)
+        return;
+
+    // 选中翻页行时移动窗口，并选中新窗口中与原窗口相接的行
+    const short listIndex = listBox.GetSelectedItem ();
+    if (windowHasPrevPage && listIndex == 1) {
+        const std::size_t previousRow = windowStart - 1;
+        windowStart -= std::min (windowStart, kListPageStep);
+        ShowModelRow (previousRow);
+    } else if (windowHasNextPage && listIndex == listBox.GetItemCount ()) {
+        const std::size_t nextRow = windowStart + windowRowCount;
+        windowStart += kListPageStep;
+        ShowModelRow (nextRow);
     }
 }
 
+void StairCompliancePalette::ListBoxHeaderItemClicked (const DG::ListBoxHeaderItemClickEvent& ev)
+{
+    if (ev.GetSource () != &listBox)
+        return;
+
+    StairCore::ResultSortKey key;
+    if (ev.GetHeaderItem () == NameColumn)
+        key = StairCore::ResultSortKey::Name;
+    else if (ev.GetHeaderItem () == DetailColumn)
+        key = StairCore::ResultSortKey::Violations;
+    else
+        return;
+
+    // 同一列依次为升序、降序、恢复检测顺序
+    const UIndex selectedResult = GetSelectedResult ();
+    if (resultModel.GetSortKey () != key)
+        resultModel.SetSort (key, false);
+    else if (!resultModel.IsSortDescending ())
+        resultModel.SetSort (key, true);
+    else
+        resultModel.SetSort (StairCore::ResultSortKey::Order, false);
+
+    UpdateSortArrows ();
+    ShowModelRow (selectedResult != InvalidResultIndex ? resultModel.FindResultRow (selectedResult) : StairCore::ResultListModel::NotFound);
+}
+
 void StairCompliancePalette::ButtonClicked (const DG::ButtonClickEvent& ev)
 {
     if (ev.GetSource () == &uploadPdfButton) {
@@ -276,6 +650,49 @@ void StairCompliancePalette::ButtonClicked (const DG::ButtonClickEvent& ev)
     }
 }
 
+void StairCompliancePalette::CheckItemChanged (const DG::CheckItemChangeEvent& ev)
+{
+    if (ev.GetSource () != &violationsOnlyCheck)
+        return;
+
+    const UIndex selectedResult = GetSelectedResult ();
+    resultModel.SetViolationsOnly (violationsOnlyCheck.IsChecked ());
+    ShowModelRow (selectedResult != InvalidResultIndex ? resultModel.FindResultRow (selectedResult) : StairCore::ResultListModel::NotFound);
+}
+
+void StairCompliancePalette::PopUpChanged (const DG::PopUpChangeEvent& ev)
+{
+    if (ev.GetSource () == &jurisdictionPopup || ev.GetSource () == &buildingTypePopup) {
+        OnScopeChanged ();
+        return;
+    }
+
+    if (ev.GetSource () != &storeyPopup)
+        return;
+
+    // 第1项为全部楼层
+    const short item = storeyPopup.GetSelectedItem ();
+    const short floorIndex = (item >= 2 && static_cast<std::size_t> (item - 2) < storeyPopupFloors.size ())
+                             ? storeyPopupFloors[static_cast<std::size_t> (item - 2)]
+                             : StairCore::ResultListModel::AllStoreys;
+
+    const UIndex selectedResult = GetSelectedResult ();
+    resultModel.SetStoreyFilter (floorIndex);
+    ShowModelRow (selectedResult != InvalidResultIndex ? resultModel.FindResultRow (selectedResult) : StairCore::ResultListModel::NotFound);
+}
+
+void StairCompliancePalette::PanelIdle (const DG::PanelIdleEvent&)
+{
+    PollExtraction ();
+
+    // 一连串变更通知（如移动多个楼梯）合并为一次增量检测
+    if (stairChangesPending) {
+        stairChangesPending = false;
+        if (IsVisible () && !storedResults.IsEmpty () && IsStairComplianceCacheValid ())
+            RunIncrementalCheck ();
+    }
+}
+
 GSErrCode __ACENV_CALL StairCompliancePalette::PaletteCallback (Int32 referenceID, API_PaletteMessageID messageID, GS::IntPtr param)
 {
     if (referenceID != PaletteReferenceId ())
@@ -348,140 +765,255 @@ void StairCompliancePalette::InitializeListBox ()
     listBox.SetHeaderItemSizeableFlag (DetailColumn, true);
 }
 
-void StairCompliancePalette::FillListBox (const GS::Array<StairComplianceResult>& results)
+// 把模型中[windowStart, windowStart + kListWindowRows)的行写入列表控件。
+// 与上次绘制的行比较：首尾相同的行保留，只在中间插入或删除列表项，保留的行只更新变化的单元格，
+// 因此只有少数楼梯变化时只需很少的控件调用，滚动位置也不变
+void StairCompliancePalette::RenderWindow ()
 {
-    ClearListBox ();
-    displayedRowToResult.SetCapacity (results.GetSize () * 5);
-    rowTooltips.Clear ();  // 清空tooltip映射
-
-    const auto appendRow = [this](const GS::UniString& name,
-                                  const GS::UniString& regulation,
-                                  const GS::UniString& measured,
-                                  UIndex resultIndex,
-                                  const GS::UniString& tooltip = GS::UniString())
-    {
-        listBox.AppendItem ();
-        const short row = listBox.GetItemCount ();
-        listBox.SetTabItemText (row, NameColumn, name);
-        listBox.SetTabItemText (row, StatusColumn, regulation);
-        listBox.SetTabItemText (row, DetailColumn, measured);
-        displayedRowToResult.Push (resultIndex);
-
-        // 保存tooltip文本（如果提供）
-        if (!tooltip.IsEmpty ()) {
-            rowTooltips.Add (row, tooltip);
-        }
+    const std::size_t rowCount = resultModel.GetRowCount ();
+    if (windowStart >= rowCount)
+        windowStart = rowCount > kListWindowRows ? rowCount - kListWindowRows : 0;
+
+    windowRowCount = std::min (kListWindowRows, rowCount - windowStart);
+    windowHasPrevPage = windowStart > 0;
+    windowHasNextPage = windowStart + windowRowCount < rowCount;
+
+    const GS::UniString rangeText = GS::UniString::Printf (L"第 %u-%u 行，共 %u 行",
+                                                           static_cast<unsigned int> (windowStart + 1),
+                                                           static_cast<unsigned int> (windowStart + windowRowCount),
+                                                           static_cast<unsigned int> (rowCount));
+
+    GS::Array<DisplayedRow> rows;
+    rows.SetCapacity (static_cast<UIndex> (windowRowCount + 2));
+    if (windowHasPrevPage)
+        rows.Push ({ APINULLGuid, 0, GS::UniString (L"▲ 上一页"), GS::UniString (), rangeText });
+
+    for (std::size_t i = 0; i < windowRowCount; ++i) {
+        const StairCore::ResultListRow& row = resultModel.GetRow (windowStart + i);
+        const StairComplianceResult& result = storedResults[row.result];
+        const ResultRow resultRow = BuildResultRow (result, row.detail);
+        rows.Push ({ result.guid, row.detail, resultRow.name, resultRow.regulation, resultRow.measured });
+    }
+
+    if (windowHasNextPage)
+        rows.Push ({ APINULLGuid, 1, GS::UniString (L"▼ 下一页"), GS::UniString (), rangeText });
+
+    const auto sameRow = [] (const DisplayedRow& a, const DisplayedRow& b) {
+        return a.guid == b.guid && a.detail == b.detail;
     };
 
-    const auto formatMM = [](double meters) -> GS::UniString {
-        return GS::UniString::Printf (L"%.0lf mm", meters * 1000.0);
+    // 首尾相同的行
+    const UIndex oldCount = displayedRows.GetSize ();
+    const UIndex newCount = rows.GetSize ();
+    UIndex prefix = 0;
+    while (prefix < oldCount && prefix < newCount && sameRow (displayedRows[prefix], rows[prefix]))
+        ++prefix;
+    UIndex suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix &&
+           sameRow (displayedRows[oldCount - 1 - suffix], rows[newCount - 1 - suffix]))
+        ++suffix;
+
+    const UIndex removedCount = oldCount - prefix - suffix;
+    const UIndex insertedCount = newCount - prefix - suffix;
+    bool changed = removedCount > 0 || insertedCount > 0;
+
+    const auto setText = [this] (short listIndex, short column, const GS::UniString& text) {
+        listBox.SetTabItemText (listIndex, column, text);
     };
 
-    for (UIndex i = 0; i < results.GetSize (); ++i) {
-        const StairComplianceResult& result = results[i];
+    if (changed)
+        listBox.DisableDraw ();
 
-        // 统计违规项数量
-        UIndex violationCount = result.violations.GetSize ();
+    for (UIndex i = 0; i < removedCount; ++i)
+        listBox.DeleteItem (static_cast<short> (prefix + 1));
 
-        // 显示所有楼梯（包括符合规范的）
-        if (violationCount == 0) {
-            // 符合规范的楼梯
-            GS::UniString statusText = L"✓ 符合规范";
+    for (UIndex i = 0; i < insertedCount; ++i) {
+        const short listIndex = static_cast<short> (prefix + i + 1);
+        if (listIndex > listBox.GetItemCount ())
+            listBox.AppendItem ();
+        else
+            listBox.InsertItem (listIndex);
 
-            // 显示实测参数
-            GS::UniString debugInfo;
-            debugInfo.Printf (L" [实测: 踏步高度%.0fmm 踏步宽度%.0fmm 2R+G%.0fmm]",
-                             result.riserHeight * 1000.0,
-                             result.treadDepth * 1000.0,
-                             result.twoRPlusGoing * 1000.0);
-            statusText.Append (debugInfo);
+        const DisplayedRow& row = rows[prefix + i];
+        setText (listIndex, NameColumn, row.name);
+        setText (listIndex, StatusColumn, row.regulation);
+        setText (listIndex, DetailColumn, row.measured);
+    }
 
-            appendRow (result.displayName, GS::UniString (), statusText, i);
-            continue;  // 跳过下面的违规项显示逻辑
+    // 保留的行只更新文字变化的单元格（楼梯重新检测后状态改变、翻页行的行号改变）
+    for (UIndex i = 0; i < newCount; ++i) {
+        if (i >= prefix && i < prefix + insertedCount)
+            continue;
+
+        const DisplayedRow& oldRow = displayedRows[i < prefix ? i : i - insertedCount + removedCount];
+        const DisplayedRow& row = rows[i];
+        const short listIndex = static_cast<short> (i + 1);
+        if (oldRow.name != row.name) {
+            setText (listIndex, NameColumn, row.name);
+            changed = true;
         }
+        if (oldRow.regulation != row.regulation) {
+            setText (listIndex, StatusColumn, row.regulation);
+            changed = true;
+        }
+        if (oldRow.measured != row.measured) {
+            setText (listIndex, DetailColumn, row.measured);
+            changed = true;
+        }
+    }
 
-        // 违规的楼梯
-        GS::UniString statusText = GetStatusText (result);
-        statusText.Append (GS::UniString::Printf (L"（%d项违规）", (int)violationCount));
+    displayedRows = std::move (rows);
 
-        // 调试信息：显示楼梯的实测数据
-        GS::UniString debugInfo;
-        debugInfo.Printf (L"[调试] 踏步高度:%.0fmm 踏步深度:%.0fmm",
-                         result.riserHeight * 1000.0,
-                         result.treadDepth * 1000.0);
-        statusText.Append (L" ");
-        statusText.Append (debugInfo);
+    if (removedCount > 0 || insertedCount > 0)
+        listBox.EnableDraw ();
+    if (changed)
+        listBox.Redraw ();
+}
 
-        appendRow (result.displayName, GS::UniString (), statusText, i);
-
-        // 显示所有违规项（violations中已包含完整的规范条文）
-        UIndex violationIndex = 0;
-        for (const GS::UniString& violation : result.violations) {
-            GS::UniString itemName;
-            GS::UniString measuredValue;
-
-            // 根据违规内容判断是哪个参数
-            if (violation.Contains (L"踏步高度")) {
-                itemName = L"  ├─ 踏步高度";
-                measuredValue = formatMM (result.riserHeight) + L" ✗ 超标";
-            } else if (violation.Contains (L"踏步宽度") || violation.Contains (L"踏步深度")) {
-                itemName = L"  ├─ 踏步宽度/深度";
-                measuredValue = formatMM (result.treadDepth) + L" ✗ 不足";
-            } else if (violation.Contains (L"2R+G") || violation.Contains (L"步行舒适度") || violation.Contains (L"舒适度")) {
-                itemName = L"  ├─ 步行舒适度";
-                // 判断是低于下限还是超过上限（简化判断）
-                if (result.twoRPlusGoing < 0.57) {
-                    measuredValue = formatMM (result.twoRPlusGoing) + L" ✗ 过于陡峭";
-                } else {
-                    measuredValue = formatMM (result.twoRPlusGoing) + L" ✗ 过于平缓";
-                }
-            } else if (violation.Contains (L"平台")) {
-                itemName = L"  ├─ 平台长度";
-                measuredValue = formatMM (result.minLandingLength) + L" ✗ 不足";
-            } else if (violation.Contains (L"楼梯") && violation.Contains (L"净宽度")) {
-                itemName = L"  ├─ 楼梯净宽度";
-                measuredValue = L"需在ARCHICAD中手动测量";
-            } else if (violation.Contains (L"栏杆") || violation.Contains (L"扶手")) {
-                itemName = L"  ├─ 栏杆扶手高度";
-                measuredValue = L"需在ARCHICAD中手动测量";
-            } else if (violation.Contains (L"倾斜") || violation.Contains (L"角度")) {
-                itemName = L"  ├─ 倾斜角度";
-                measuredValue = L"需在ARCHICAD中手动测量";
-            } else if (violation.Contains (L"梯段") && violation.Contains (L"间距")) {
-                itemName = L"  ├─ 两梯段间距";
-                measuredValue = L"需在ARCHICAD中手动测量";
-            } else {
-                // 未识别的违规项，使用通用显示
-                itemName = GS::UniString::Printf (L"  ├─ 违规项 %d", (int)(violationIndex + 1));
-                measuredValue = L"详见规范条文";
-            }
+// 重新绘制窗口并选中模型行（NotFound时清除选择），行不在当前窗口内时把窗口移到该行所在的位置
+void StairCompliancePalette::ShowModelRow (std::size_t modelRow)
+{
+    if (modelRow != StairCore::ResultListModel::NotFound && modelRow < resultModel.GetRowCount () &&
+        (modelRow < windowStart || modelRow >= windowStart + kListWindowRows))
+        windowStart = modelRow - std::min (modelRow, kListPageStep);
 
-            // 最后一项使用└─而不是├─
-            if (violationIndex == result.violations.GetSize() - 1) {
-                itemName.ReplaceAll (L"├", L"└");
-            }
+    RenderWindow ();
 
-            // violation本身就是完整的规范条文
-            // 添加tooltip，当规范条文被截断时鼠标悬停显示完整文本
-            appendRow (itemName, violation, measuredValue, i, violation);
-            violationIndex++;
-        }
+    if (modelRow == StairCore::ResultListModel::NotFound || modelRow < windowStart || modelRow >= windowStart + windowRowCount) {
+        listBox.DeselectItem (DG::ListBox::AllItems);
+        return;
+    }
+
+    const short listIndex = static_cast<short> (modelRow - windowStart + (windowHasPrevPage ? 2 : 1));
+    listBox.SelectItem (listIndex);
+    listBox.EnsureVisible (listIndex);
+}
+
+// 模型重建后更新楼层下拉框并重新绘制，保持选中的楼梯和窗口位置
+void StairCompliancePalette::RefreshResultView (UIndex selectedResult)
+{
+    UpdateStoreyPopup ();
+    ShowModelRow (selectedResult != InvalidResultIndex ? resultModel.FindResultRow (selectedResult) : StairCore::ResultListModel::NotFound);
+}
+
+bool StairCompliancePalette::GetModelRow (short listIndex, std::size_t& modelRow) const
+{
+    const short firstResultIndex = windowHasPrevPage ? 2 : 1;
+    if (listIndex < firstResultIndex || static_cast<std::size_t> (listIndex - firstResultIndex) >= windowRowCount)
+        return false;
+
+    modelRow = windowStart + static_cast<std::size_t> (listIndex - firstResultIndex);
+    return modelRow < resultModel.GetRowCount ();
+}
+
+UIndex StairCompliancePalette::GetSelectedResult () const
+{
+    std::size_t modelRow = 0;
+    if (!GetModelRow (listBox.GetSelectedItem (), modelRow))
+        return InvalidResultIndex;
+    return resultModel.GetRow (modelRow).result;
+}
+
+// 楼层列表变化时重建楼层下拉框，原来筛选的楼层已不存在时恢复为全部楼层
+void StairCompliancePalette::UpdateStoreyPopup ()
+{
+    std::vector<short> floors = resultModel.GetFloorIndices ();
+    if (floors == storeyPopupFloors && storeyPopup.GetItemCount () > 0)
+        return;
+
+    storeyPopupFloors = std::move (floors);
+    storeyPopup.DeleteItem (DG::PopUp::AllItems);
+    storeyPopup.AppendItem ();
+    storeyPopup.SetItemText (DG::PopUp::BottomItem, GS::UniString (L"全部楼层"));
+
+    short selectedItem = 1;
+    for (std::size_t i = 0; i < storeyPopupFloors.size (); ++i) {
+        const short floorIndex = storeyPopupFloors[i];
+        const GS::UniString storyName = GetStoryName (floorIndex);
+        storeyPopup.AppendItem ();
+        storeyPopup.SetItemText (DG::PopUp::BottomItem, storyName.IsEmpty () ? GS::UniString::Printf (L"%d 层", (int)floorIndex) : storyName);
+        if (floorIndex == resultModel.GetStoreyFilter ())
+            selectedItem = static_cast<short> (i + 2);
     }
+
+    storeyPopup.SelectItem (selectedItem);
+    if (selectedItem == 1 && resultModel.GetStoreyFilter () != StairCore::ResultListModel::AllStoreys)
+        resultModel.SetStoreyFilter (StairCore::ResultListModel::AllStoreys);
+}
+
+// 规范库变化后（加载、上传）重建适用范围下拉框，并把项目适用范围重新传给规范库
+void StairCompliancePalette::UpdateScopePopups ()
+{
+    GS::Array<GS::UniString> jurisdictions;
+    GS::Array<GS::UniString> buildingTypes;
+    GetRegulationScopeChoices (jurisdictions, buildingTypes);
+
+    FillScopePopup (jurisdictionPopup, L"全部地区", std::move (jurisdictions), projectJurisdiction, jurisdictionChoices);
+    FillScopePopup (buildingTypePopup, L"全部建筑类型", std::move (buildingTypes), projectBuildingType, buildingTypeChoices);
+    SetRegulationScope (projectJurisdiction, projectBuildingType);
+}
+
+// 适用范围变化后生效规则随之变化，已有结果时重新检测
+void StairCompliancePalette::OnScopeChanged ()
+{
+    const GS::UniString jurisdiction = GetSelectedScope (jurisdictionPopup, jurisdictionChoices);
+    const GS::UniString buildingType = GetSelectedScope (buildingTypePopup, buildingTypeChoices);
+    if (jurisdiction == projectJurisdiction && buildingType == projectBuildingType)
+        return;
+
+    projectJurisdiction = jurisdiction;
+    projectBuildingType = buildingType;
+    SetRegulationScope (projectJurisdiction, projectBuildingType);
+    UpdateRegulationInfo ();
+
+    if (!storedResults.IsEmpty () && pendingExtractions.IsEmpty ())
+        OnCheckNowClicked ();
+}
+
+void StairCompliancePalette::UpdateSortArrows ()
+{
+    const auto arrowFor = [this] (StairCore::ResultSortKey key) {
+        if (resultModel.GetSortKey () != key)
+            return DG::ListBox::NoArrow;
+        return resultModel.IsSortDescending () ? DG::ListBox::Down : DG::ListBox::Up;
+    };
+
+    listBox.SetHeaderItemArrowType (NameColumn, arrowFor (StairCore::ResultSortKey::Name));
+    listBox.SetHeaderItemArrowType (DetailColumn, arrowFor (StairCore::ResultSortKey::Violations));
+}
+
+UIndex StairCompliancePalette::FindResultIndex (const API_Guid& guid) const
+{
+    const UIndex* resultIndex = resultIndices.GetPtr (guid);
+    return resultIndex != nullptr ? *resultIndex : InvalidResultIndex;
+}
+
+void StairCompliancePalette::RebuildResultIndices ()
+{
+    resultIndices.Clear ();
+    for (UIndex i = 0; i < storedResults.GetSize (); ++i)
+        resultIndices.Put (storedResults[i].guid, i);
 }
 
 void StairCompliancePalette::ClearListBox ()
 {
     listBox.DeleteItem (DG::ListBox::AllItems);
-    displayedRowToResult.Clear ();
+    displayedRows.Clear ();
+    resultModel.SetEntries ({});
+    windowStart = 0;
+    windowRowCount = 0;
+    windowHasPrevPage = false;
+    windowHasNextPage = false;
 }
 
 void StairCompliancePalette::SelectResult (short listIndex) const
 {
-    if (listIndex < 1 || listIndex > static_cast<short> (displayedRowToResult.GetSize ()))
+    std::size_t modelRow = 0;
+    if (!GetModelRow (listIndex, modelRow))
         return;
 
-    const UIndex resultIndex = displayedRowToResult[listIndex - 1];
-    if (resultIndex == InvalidResultIndex || resultIndex >= storedResults.GetSize ())
+    const UIndex resultIndex = resultModel.GetRow (modelRow).result;
+    if (resultIndex >= storedResults.GetSize ())
         return;
 
     const StairComplianceResult& result = storedResults[resultIndex];
@@ -508,55 +1040,54 @@ void StairCompliancePalette::SetMenuItemCheckedState (bool isChecked)
     ACAPI_MenuItem_SetMenuItemFlags (&itemRef, &itemFlags);
 }
 
-void StairCompliancePalette::SaveColumnWidths ()
+void StairCompliancePalette::SavePreferences ()
 {
-    // 获取当前列宽
-    short nameWidth = listBox.GetHeaderItemSize (NameColumn);
-    short statusWidth = listBox.GetHeaderItemSize (StatusColumn);
-    short detailWidth = listBox.GetHeaderItemSize (DetailColumn);
-
-    // 保存到ARCHICAD偏好设置
-    struct PrefsData {
-        short nameWidth;
-        short statusWidth;
-        short detailWidth;
-    };
-
-    PrefsData data;
-    data.nameWidth = nameWidth;
-    data.statusWidth = statusWidth;
-    data.detailWidth = detailWidth;
-
-    ACAPI_SetPreferences (1, sizeof(PrefsData), &data);
+    // 保存到ARCHICAD偏好设置：当前列宽和项目适用范围
+    PalettePrefs data;
+    data.columns.nameWidth = listBox.GetHeaderItemSize (NameColumn);
+    data.columns.statusWidth = listBox.GetHeaderItemSize (StatusColumn);
+    data.columns.detailWidth = listBox.GetHeaderItemSize (DetailColumn);
+    CopyPrefsText (projectJurisdiction, data.jurisdiction);
+    CopyPrefsText (projectBuildingType, data.buildingType);
+
+    ACAPI_SetPreferences (kPalettePrefsVersion, sizeof(PalettePrefs), &data);
 }
 
-void StairCompliancePalette::LoadColumnWidths ()
+void StairCompliancePalette::LoadPreferences ()
 {
-    // 从ARCHICAD偏好设置加载
-    struct PrefsData {
-        short nameWidth;
-        short statusWidth;
-        short detailWidth;
-    };
-
+    // 从ARCHICAD偏好设置加载，版本1的偏好设置只有列宽
     Int32 version = 0;
     GSSize size = 0;
 
     // 先获取大小
-    if (ACAPI_GetPreferences (&version, &size, nullptr) == NoError && size == sizeof(PrefsData)) {
-        PrefsData data;
-        // 再获取实际数据
-        if (ACAPI_GetPreferences (&version, &size, &data) == NoError && version == 1) {
-            // 验证宽度值合理性（避免加载到损坏的数据）
-            if (data.nameWidth >= 100 && data.nameWidth <= 500 &&
-                data.statusWidth >= 100 && data.statusWidth <= 600 &&
-                data.detailWidth >= 100 && data.detailWidth <= 500) {
-
-                listBox.SetHeaderItemSize (NameColumn, data.nameWidth);
-                listBox.SetHeaderItemSize (StatusColumn, data.statusWidth);
-                listBox.SetHeaderItemSize (DetailColumn, data.detailWidth);
-            }
-        }
+    if (ACAPI_GetPreferences (&version, &size, nullptr) != NoError)
+        return;
+
+    PalettePrefs data = {};
+    if (!(version == kPalettePrefsVersion && size == sizeof(PalettePrefs)) &&
+        !(version == kColumnWidthPrefsVersion && size == sizeof(ColumnWidthPrefs)))
+        return;
+
+    // 再获取实际数据
+    if (ACAPI_GetPreferences (&version, &size, &data) != NoError)
+        return;
+
+    // 验证宽度值合理性（避免加载到损坏的数据）
+    const ColumnWidthPrefs& columns = data.columns;
+    if (columns.nameWidth >= 100 && columns.nameWidth <= 500 &&
+        columns.statusWidth >= 100 && columns.statusWidth <= 600 &&
+        columns.detailWidth >= 100 && columns.detailWidth <= 500) {
+
+        listBox.SetHeaderItemSize (NameColumn, columns.nameWidth);
+        listBox.SetHeaderItemSize (StatusColumn, columns.statusWidth);
+        listBox.SetHeaderItemSize (DetailColumn, columns.detailWidth);
+    }
+
+    if (version == kPalettePrefsVersion) {
+        data.jurisdiction[sizeof (data.jurisdiction) - 1] = '\0';
+        data.buildingType[sizeof (data.buildingType) - 1] = '\0';
+        projectJurisdiction = GS::UniString (data.jurisdiction, CC_UTF8);
+        projectBuildingType = GS::UniString (data.buildingType, CC_UTF8);
     }
 }
 
@@ -568,8 +1099,16 @@ void StairCompliancePalette::SetupTooltips ()
 
 void StairCompliancePalette::OnUploadPdfClicked ()
 {
-    // 创建文件选择对话框
-    DG::FileDialog dialog (DG::FileDialog::OpenFile);
+    // 提取进行中时按钮用于取消本批所有任务
+    if (!pendingExtractions.IsEmpty ()) {
+        for (const PendingExtraction& pending : pendingExtractions)
+            extractionWorker.Cancel (pending.jobId);
+        summaryText.SetText (GS::UniString (L"正在取消PDF提取..."));
+        return;
+    }
+
+    // 创建文件选择对话框（可以一次选择多个规范）
+    DG::FileDialog dialog (DG::FileDialog::OpenMultiFile);
     dialog.SetTitle (GS::UniString (L"选择建筑规范PDF文件"));
 
     // 设置文件过滤器
@@ -580,9 +1119,13 @@ void StairCompliancePalette::OnUploadPdfClicked ()
 
     // 显示对话框
     if (dialog.Invoke ()) {
-        // GetSelectedFile返回const引用，索引默认为0
-        const IO::Location& selectedFile = dialog.GetSelectedFile (0);
-        ProcessPdfFile (selectedFile);
+        extractionBatchSize = 0;
+        appliedExtractionCount = 0;
+        extractionFailures.Clear ();
+
+        // GetSelectedFile返回const引用
+        for (UIndex i = 0; i < dialog.GetSelectedFileCount (); ++i)
+            ProcessPdfFile (dialog.GetSelectedFile (i));
     }
 }
 
@@ -592,75 +1135,169 @@ void StairCompliancePalette::ProcessPdfFile (const IO::Location& pdfLocation)
     IO::Name fileName;
     pdfLocation.GetLastLocalName (&fileName);
 
-    GS::UniString pdfPath = pdfLocation.ToDisplayText ();
-    GS::UniString fileNameStr = fileName.ToString ();
+    const GS::UniString pdfPath = pdfLocation.ToDisplayText ();
 
-    // 更新状态：正在处理
-    GS::UniString statusMsg = GS::UniString::Printf (L"📄 正在处理: %s ...", fileNameStr.ToCStr ().Get ());
-    summaryText.SetText (statusMsg);
+    // 每个任务写入单独的文件，加载时才移入规范目录，排队的任务不会互相覆盖
+    GS::UniString outputPath = USER_REGULATION_JSON_PATH;
+    outputPath.Append (GS::UniString::Printf (".%u.part", ++extractionSerial));
 
-    // 使用统一的输出路径（与LoadRegulationConfigIfNeeded一致）
-    GS::UniString jsonPath = USER_REGULATION_JSON_PATH;
-    IO::Location jsonLocation (jsonPath);
+    PendingExtraction pending;
+    pending.jobId = extractionWorker.Submit (ToWideString (pdfPath), ToWideString (outputPath));
+    pending.fileName = fileName.ToString ();
+    pendingExtractions.Push (pending);
+    ++extractionBatchSize;
 
-    // 构建Python命令
-    GS::UniString pythonCmd;
-    pythonCmd = L"python \"E:\\ArchiCAD_Development\\StairRegulationRAG\\src\\main.py\"";
-    pythonCmd += L" --pdf \"" + pdfPath + L"\"";
-    pythonCmd += L" --output \"" + jsonPath + L"\"";
+    ACAPI_WriteReport (L"[Stair Compliance] 提交PDF规范提取任务: " + pdfPath, false);
 
-    // 更新状态：调用AI分析
-    statusMsg = GS::UniString::Printf (L"🤖 正在使用AI分析PDF: %s ...", fileNameStr.ToCStr ().Get ());
-    summaryText.SetText (statusMsg);
+    // 提取期间规范文件会被替换，暂不允许手动检测
+    uploadPdfButton.SetText (L"取消提取");
+    checkNowButton.Disable ();
+    extractionStatus.Clear ();
+    PollExtraction ();
+}
 
-    // 执行Python命令 - 使用Unicode
-    // 将输出重定向到日志文件以便调试
-    GS::UniString logPath = L"E:\\ArchiCAD_Development\\python_output.log";
-    GS::UniString cmdWithLog = pythonCmd + L" > \"" + logPath + L"\" 2>&1";
-
-    // 在Windows上使用_wsystem来支持Unicode路径
-    #ifdef WINDOWS
-        int result = _wsystem (cmdWithLog.ToUStr ().Get ());
-    #else
-        char cmdBuffer[2048];
-        strcpy (cmdBuffer, cmdWithLog.ToCStr ().Get ());
-        int result = system (cmdBuffer);
-    #endif
-
-    if (result != 0) {
-        // Python执行失败 - 显示详细错误信息
-        statusMsg = GS::UniString::Printf (L"❌ Python执行失败 (代码: %d)\n请查看日志: %s",
-                                           result, logPath.ToCStr ().Get ());
-        summaryText.SetText (statusMsg);
+void StairCompliancePalette::PollExtraction ()
+{
+    using Job = StairCore::RegulationExtractionWorker::Job;
+
+    if (pendingExtractions.IsEmpty ())
         return;
+
+    // 按提交顺序加载已结束的任务
+    Job job;
+    while (!pendingExtractions.IsEmpty ()) {
+        const PendingExtraction first = pendingExtractions[0];
+        if (!extractionWorker.GetJob (first.jobId, job) || !job.IsFinished ())
+            break;
+
+        FinishExtraction (job, first.fileName);
+        extractionWorker.ForgetJob (first.jobId);
+        pendingExtractions.Delete (0);
     }
 
-    // 检查JSON文件是否生成 - 使用IO::File检查
-    IO::File jsonFile (jsonLocation);
-    GSErrCode openErr = jsonFile.Open (IO::File::ReadMode);
-    if (openErr != NoError) {
-        // 文件未生成 - 提供详细的错误信息
-        statusMsg = GS::UniString::Printf (
-            L"❌ 处理失败: 未找到输出文件\n"
-            L"预期路径: %s\n"
-            L"请查看Python日志: %s",
-            jsonPath.ToCStr ().Get (),
-            logPath.ToCStr ().Get ()
-        );
-        summaryText.SetText (statusMsg);
+    if (pendingExtractions.IsEmpty ()) {
+        uploadPdfButton.SetText (L"上传PDF");
+        checkNowButton.Enable ();
+        extractionStatus.Clear ();
+
+        if (appliedExtractionCount > 0)
+            RecheckAfterExtraction ();
+        if (!extractionFailures.IsEmpty ()) {
+            GS::UniString statusMsg;
+            if (appliedExtractionCount > 0)
+                statusMsg = summaryText.GetText () + L"\n";
+            statusMsg.Append (extractionFailures);
+            statusMsg.Append (L"请查看日志: ");
+            statusMsg.Append (kExtractorLogPath);
+            summaryText.SetText (statusMsg);
+        }
         return;
     }
-    jsonFile.Close ();
+
+    // 进度文字按秒刷新：第几个任务、所处阶段和用时
+    GS::UniString status;
+    if (job.state == StairCore::RegulationExtractionWorker::JobState::Queued && !extractionWorker.IsReady ()) {
+        status = L"⏳ 正在启动提取进程...";
+    } else {
+        const UInt32 current = extractionBatchSize - pendingExtractions.GetSize () + 1;
+        status = GS::UniString::Printf ("(%u/%u) ", current, extractionBatchSize);
+        status.Append (L"🤖 正在使用AI分析PDF: ");
+        status.Append (pendingExtractions[0].fileName);
+        status.Append (GS::UniString::Printf (" (%u s)", static_cast<unsigned int> (job.elapsedSeconds)));
+        if (!job.message.empty ()) {
+            status.Append (L"\n");
+            status.Append (GS::UniString (job.message.c_str (), CC_UTF8));
+        }
+    }
+
+    if (status != extractionStatus) {
+        extractionStatus = status;
+        summaryText.SetText (status);
+    }
+}
+
+void StairCompliancePalette::FinishExtraction (const StairCore::RegulationExtractionWorker::Job& job, const GS::UniString& fileName)
+{
+    using State = StairCore::RegulationExtractionWorker::JobState;
+
+    GS::UniString report = GS::UniString::Printf ("[Stair Compliance] PDF提取结束: 任务 %u, 状态 %d, 用时 %.1f 秒",
+                                                   job.id, static_cast<int> (job.state), job.elapsedSeconds);
+    if (!job.cacheHit.empty ()) {
+        report.Append (L", 使用缓存: ");
+        report.Append (GS::UniString (job.cacheHit.c_str (), CC_UTF8));
+    }
+    ACAPI_WriteReport (report, false);
+
+    GS::UniString failure;
+    switch (job.state) {
+        case State::Succeeded:
+            if (!ApplyExtractedRegulation (GS::UniString (job.outputPath.c_str ()), fileName, failure))
+                break;
+
+            ++appliedExtractionCount;
+            if (job.partial.empty ())
+                return;
+
+            // 结果已应用但不完整，提示用户稍后重新上传（提取缓存中没有这次的结果）
+            extractionFailures.Append (L"⚠ ");
+            extractionFailures.Append (fileName);
+            extractionFailures.Append (L": 提取不完整，请稍后重新上传（");
+            extractionFailures.Append (GS::UniString (job.partial.c_str (), CC_UTF8));
+            extractionFailures.Append (L"）\n");
+            summaryText.SetText (extractionFailures);
+            return;
+        case State::Cancelled:
+            failure = L"已取消";
+            break;
+        case State::TimedOut:
+            failure = GS::UniString::Printf (L"提取超时（超过 %d 分钟）", static_cast<int> (kExtractionTimeout.count () / 60));
+            break;
+        default:
+            failure = GS::UniString (job.message.c_str (), CC_UTF8);
+            break;
+    }
+
+    extractionFailures.Append (job.state == State::Cancelled ? L"⚠ " : L"❌ ");
+    extractionFailures.Append (fileName);
+    extractionFailures.Append (L": ");
+    extractionFailures.Append (failure);
+    extractionFailures.Append (L"\n");
+    summaryText.SetText (extractionFailures);
+}
+
+bool StairCompliancePalette::ApplyExtractedRegulation (const GS::UniString& outputPath, const GS::UniString& fileName, GS::UniString& failure)
+{
+    const IO::Location outputLocation (outputPath);
+
+    // 检查JSON文件是否生成 - 使用IO::File检查
+    IO::File outputFile (outputLocation);
+    if (outputFile.Open (IO::File::ReadMode) != NoError) {
+        failure = L"未找到输出文件 " + outputPath;
+        return false;
+    }
+    outputFile.Close ();
 
     // 更新状态：正在加载配置
-    statusMsg = GS::UniString::Printf (L"📥 正在加载新规范配置...");
-    summaryText.SetText (statusMsg);
+    summaryText.SetText (GS::UniString (L"📥 正在加载新规范配置..."));
+
+    // 本次结果按PDF文件名存入规范目录（同一份PDF再次上传时替换），其他已上传的规范保留；
+    // 再合并到规范库，g_regulationConfig随之更新为项目适用范围下的生效规则
+    IO::Name regulationName (fileName);
+    regulationName.DeleteExtension ();
+    if (!StoreRegulationFile (outputLocation, regulationName.ToString ())) {
+        failure = L"规范解析失败或无法存入规范目录，请查看ArchiCAD报告窗口";
+        return false;
+    }
+    return true;
+}
 
-    // 加载JSON配置并更新全局规范
-    RegulationConfig newConfig = RegulationConfig::LoadFromJSON (jsonLocation);
-    g_regulationConfig = newConfig;
+void StairCompliancePalette::RecheckAfterExtraction ()
+{
+    GS::UniString statusMsg;
+    const RegulationConfig newConfig = g_regulationConfig;
 
-    // 更新规范信息显示
+    // 规范库已变化：重建适用范围下拉框，更新规范信息显示
+    UpdateScopePopups ();
     UpdateRegulationInfo ();
 
     // 显示加载的配置信息（调试用）
@@ -686,7 +1323,7 @@ void StairCompliancePalette::ProcessPdfFile (const IO::Location& pdfLocation)
     summaryText.SetText (statusMsg);
 
     // 重新执行检查
-    const GS::Array<StairComplianceResult> newResults = EvaluateStairCompliance ();
+    GS::Array<StairComplianceResult> newResults = EvaluateStairCompliance ();
 
     if (newResults.IsEmpty ()) {
         statusMsg = L"❌ 未检测到楼梯元素";
@@ -716,7 +1353,7 @@ void StairCompliancePalette::ProcessPdfFile (const IO::Location& pdfLocation)
     newSummary.Append (L" 个符合规范。");
 
     // 更新显示
-    UpdateResults (newResults, newSummary, newConfig.regulationName);
+    UpdateResults (std::move (newResults), newSummary, newConfig.regulationName);
 
     // 完成
     statusMsg = GS::UniString::Printf (L"✅ 完成! 已使用新规范 [%s] 重新检查",
@@ -736,12 +1373,23 @@ void StairCompliancePalette::OnCheckNowClicked ()
     // 强制重新加载JSON配置
     ForceReloadRegulationConfig ();
 
-    // 更新规范信息显示
+    // 更新适用范围下拉框和规范信息显示
+    UpdateScopePopups ();
     UpdateRegulationInfo ();
 
+    // 规则未变化且已有结果时只检测变更过的楼梯
+    if (!storedResults.IsEmpty () && IsStairComplianceCacheValid ()) {
+        ACAPI_WriteReport(L"[Stair Compliance] 规范未变化，只检测已修改的楼梯...", false);
+        RunIncrementalCheck ();
+        UpdateSummary (BuildCheckSummary (storedResults));
+        ACAPI_WriteReport(L"[Stair Compliance] ✅ 增量检测完成!", false);
+        ACAPI_WriteReport(L"━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━", false);
+        return;
+    }
+
     // 重新检测所有楼梯
     ACAPI_WriteReport(L"[Stair Compliance] 开始检测楼梯...", false);
-    const GS::Array<StairComplianceResult> results = EvaluateStairCompliance ();
+    GS::Array<StairComplianceResult> results = EvaluateStairCompliance ();
 
     if (results.IsEmpty ()) {
         summaryText.SetText (GS::UniString (L"未检测到楼梯元素，请确认模型中存在可校验的楼梯。"));
@@ -749,27 +1397,8 @@ void StairCompliancePalette::OnCheckNowClicked ()
         return;
     }
 
-    // 统计结果
-    unsigned int totalCount = static_cast<unsigned int> (results.GetSize ());
-    unsigned int nonCompliantCount = 0;
-    unsigned int compliantCount = 0;
-
-    for (const StairComplianceResult& result : results) {
-        if (!result.IsCompliant ())
-            nonCompliantCount++;
-        else
-            compliantCount++;
-    }
-
     // 构建汇总信息
-    GS::UniString summary;
-    summary.Append (GS::UniString (L"【检测结果】共检测 "));
-    summary.Append (GS::UniString::Printf ("%u", totalCount));
-    summary.Append (GS::UniString (L" 个楼梯，其中 "));
-    summary.Append (GS::UniString::Printf ("%u", nonCompliantCount));
-    summary.Append (GS::UniString (L" 个存在违规，"));
-    summary.Append (GS::UniString::Printf ("%u", compliantCount));
-    summary.Append (GS::UniString (L" 个符合规范"));
+    const GS::UniString summary = BuildCheckSummary (results);
 
     // 获取当前规范名称
     extern RegulationConfig g_regulationConfig;
@@ -782,10 +1411,90 @@ void StairCompliancePalette::OnCheckNowClicked ()
     }
 
     // 更新面板显示
-    UpdateResults (results, summary, regulationText);
+    UpdateResults (std::move (results), summary, regulationText);
 
     // 输出完成日志
     ACAPI_WriteReport(summary.ToCStr ().Get (), false);
     ACAPI_WriteReport(L"[Stair Compliance] ✅ 检测完成!", false);
     ACAPI_WriteReport(L"━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━", false);
 }
+
+void StairCompliancePalette::OnStairsChanged ()
+{
+    // 面板未显示结果时只记录变更，下次检测时处理；变更的楼梯已记为待检测，这里只做标记
+    if (instance == nullptr || !instance->IsVisible () || instance->storedResults.IsEmpty ())
+        return;
+
+    instance->stairChangesPending = true;
+}
+
+void StairCompliancePalette::RunIncrementalCheck ()
+{
+    const StairComplianceDelta delta = EvaluateDirtyStairs ();
+    if (!delta.IsEmpty ())
+        ApplyResultDelta (delta);
+}
+
+void StairCompliancePalette::ApplyResultDelta (const StairComplianceDelta& delta)
+{
+    // 结果索引会因删除而变化，按GUID记住选中的楼梯
+    const UIndex selectedResult = GetSelectedResult ();
+    const API_Guid selectedGuid = selectedResult != InvalidResultIndex ? storedResults[selectedResult].guid : APINULLGuid;
+
+    // 删除的楼梯一次压缩掉，其余结果保持检测顺序
+    bool rowsChanged = false;
+    if (!delta.removed.IsEmpty ()) {
+        std::vector<bool> removed (storedResults.GetSize (), false);
+        bool anyRemoved = false;
+        for (const API_Guid& guid : delta.removed) {
+            const UIndex resultIndex = FindResultIndex (guid);
+            if (resultIndex != InvalidResultIndex) {
+                removed[resultIndex] = true;
+                anyRemoved = true;
+            }
+        }
+
+        if (anyRemoved) {
+            UIndex kept = 0;
+            for (UIndex i = 0; i < storedResults.GetSize (); ++i) {
+                if (removed[i])
+                    continue;
+                if (kept != i)
+                    storedResults[kept] = storedResults[i];
+                ++kept;
+            }
+            storedResults.SetSize (kept);
+            resultModel.RemoveEntries (removed);
+            RebuildResultIndices ();
+            rowsChanged = true;
+        }
+    }
+
+    for (const StairComplianceResult& result : delta.updated) {
+        const UIndex resultIndex = FindResultIndex (result.guid);
+        if (resultIndex == InvalidResultIndex) {
+            // 新建的楼梯追加在列表末尾
+            resultIndices.Put (result.guid, storedResults.GetSize ());
+            storedResults.Push (result);
+            resultModel.AppendEntry (MakeListEntry (result));
+            rowsChanged = true;
+            continue;
+        }
+
+        // 违规项行数、楼层和排序键不变时原位更新，行模型不重建
+        storedResults[resultIndex] = result;
+        if (!resultModel.UpdateEntry (resultIndex, MakeListEntry (result)))
+            rowsChanged = true;
+    }
+
+    // 列表控件中只更新可见窗口内变化的行
+    const UIndex newSelectedResult = selectedResult != InvalidResultIndex ? FindResultIndex (selectedGuid) : InvalidResultIndex;
+    if (rowsChanged) {
+        resultModel.Rebuild ();
+        RefreshResultView (newSelectedResult);
+    } else {
+        ShowModelRow (newSelectedResult != InvalidResultIndex ? resultModel.FindResultRow (newSelectedResult) : StairCore::ResultListModel::NotFound);
+    }
+
+    UpdateSummary (BuildCheckSummary (storedResults));
+}
@@ -6,12 +6,16 @@
 
 #include "DGModule.hpp"
 
+#include "RegulationExtractionWorker.hpp"
 #include "StairCompliance.hpp"
+#include "StairResultListModel.hpp"
 
 class StairCompliancePalette :	public DG::Palette,
 								public DG::PanelObserver,
 								public DG::ListBoxObserver,
-								public DG::ButtonItemObserver
+								public DG::ButtonItemObserver,
+								public DG::CheckItemObserver,
+								public DG::PopUpObserver
 {
 public:
 	enum Columns {
@@ -24,19 +28,28 @@ public:
 	static GSErrCode				RegisterPalette ();
 	static void						UnregisterPalette ();
 
-	void							UpdateResults (const GS::Array<StairComplianceResult>& results,
+	// 结果移入面板，不复制
+	void							UpdateResults (GS::Array<StairComplianceResult>&& results,
 												   const GS::UniString& summary,
 												   const GS::UniString& regulation);
 	void							EnsureShown ();
 	void							HidePalette ();
 	void							ToggleFromMenu ();
 
+	// 楼梯变更通知回调：只记下有待检测的楼梯，界面空闲时一次检测并刷新所有变更的楼梯
+	static void						OnStairsChanged ();
+
 protected:
 	virtual void					PanelOpened (const DG::PanelOpenEvent& ev) override;
 	virtual void					PanelClosed (const DG::PanelCloseEvent& ev) override;
 	virtual void					ListBoxDoubleClicked (const DG::ListBoxDoubleClickEvent& ev) override;
+	virtual void					ListBoxSelectionChanged (const DG::ListBoxSelectionEvent& ev) override;
+	virtual void					ListBoxHeaderItemClicked (const DG::ListBoxHeaderItemClickEvent& ev) override;
 	virtual void					ItemToolTipRequested (const DG::ItemHelpEvent& ev, GS::UniString* toolTipText) override;
 	virtual void					ButtonClicked (const DG::ButtonClickEvent& ev) override;
+	virtual void					CheckItemChanged (const DG::CheckItemChangeEvent& ev) override;
+	virtual void					PopUpChanged (const DG::PopUpChangeEvent& ev) override;
+	virtual void					PanelIdle (const DG::PanelIdleEvent& ev) override;
 private:
 	static GSErrCode __ACENV_CALL	PaletteCallback (Int32 referenceID, API_PaletteMessageID messageID, GS::IntPtr param);
 
@@ -52,15 +65,26 @@ private:
 	static void						SetMenuItemCheckedState (bool isChecked);
 
 	void							InitializeListBox ();
-	void							FillListBox (const GS::Array<StairComplianceResult>& results);
 	void							ClearListBox ();
+	UIndex							FindResultIndex (const API_Guid& guid) const;
 	void							SelectResult (short listIndex) const;
+
+	// 虚拟列表：筛选和排序在行模型上进行，列表控件中只放可见窗口内的行（最多kListWindowRows行加翻页行）
+	void							RenderWindow ();
+	void							ShowModelRow (std::size_t modelRow);
+	void							RefreshResultView (UIndex selectedResult);
+	bool							GetModelRow (short listIndex, std::size_t& modelRow) const;
+	UIndex							GetSelectedResult () const;
+	void							UpdateStoreyPopup ();
+	void							UpdateScopePopups ();
+	void							OnScopeChanged ();
+	void							UpdateSortArrows ();
 	void							UpdateSummary (const GS::UniString& summary);
 	void							UpdateRegulationInfo ();
 
-	// 列宽记忆功能
-	void							SaveColumnWidths ();
-	void							LoadColumnWidths ();
+	// 偏好设置：列宽和项目适用范围
+	void							SavePreferences ();
+	void							LoadPreferences ();
 
 	// 详情功能：tooltip提示
 	void							SetupTooltips ();
@@ -69,20 +93,67 @@ private:
 	void							OnUploadPdfClicked ();
 	void							ProcessPdfFile (const IO::Location& pdfLocation);
 
+	// 提取任务交给常驻提取进程排队执行，界面空闲时在主线程轮询进度，按提交顺序在主线程加载结果
+	void							PollExtraction ();
+	void							FinishExtraction (const StairCore::RegulationExtractionWorker::Job& job, const GS::UniString& fileName);
+	bool							ApplyExtractedRegulation (const GS::UniString& outputPath, const GS::UniString& fileName, GS::UniString& failure);
+	void							RecheckAfterExtraction ();
+
 	// 手动检测功能
 	void							OnCheckNowClicked ();
 
+	// 增量检测：只更新变更楼梯对应的行
+	void							RunIncrementalCheck ();
+	void							ApplyResultDelta (const StairComplianceDelta& delta);
+	void							RebuildResultIndices ();
+
 	DG::LeftText					summaryText;
 	DG::Button						uploadPdfButton;
 	DG::Button						checkNowButton;
 	DG::LeftText					regulationInfoText;
 	DG::SingleSelListBox			listBox;
+	DG::CheckBox					violationsOnlyCheck;
+	DG::PopUp						storeyPopup;
+	DG::PopUp						jurisdictionPopup;
+	DG::PopUp						buildingTypePopup;
 	GS::Array<StairComplianceResult> storedResults;
-	GS::Array<UIndex>				displayedRowToResult;
+	GS::HashTable<API_Guid, UIndex>	resultIndices;			// 楼梯GUID -> storedResults中的索引
+	bool							stairChangesPending;	// 收到变更通知后尚未检测，在PanelIdle中处理
 	static constexpr UIndex			InvalidResultIndex = static_cast<UIndex> (-1);
 
-	// Tooltip映射: 行号 -> 规范条文完整文本
-	GS::HashTable<short, GS::UniString> rowTooltips;
+	StairCore::ResultListModel		resultModel;
+	std::vector<short>				storeyPopupFloors;		// 楼层下拉框第2项起对应的楼层
+	GS::Array<GS::UniString>		jurisdictionChoices;	// 地区下拉框第2项起对应的地区
+	GS::Array<GS::UniString>		buildingTypeChoices;	// 建筑类型下拉框第2项起对应的建筑类型
+	GS::UniString					projectJurisdiction;	// 项目适用范围，为空表示不限
+	GS::UniString					projectBuildingType;
+	std::size_t						windowStart;			// 列表控件中第一个结果行对应的模型行
+	std::size_t						windowRowCount;			// 列表控件中的结果行数
+	bool							windowHasPrevPage;		// 第一行为"上一页"
+	bool							windowHasNextPage;		// 最后一行为"下一页"
+
+	// 列表控件中一行的内容；重新绘制时与上次的内容比较，只插入、删除或更新变化的行
+	struct DisplayedRow {
+		API_Guid					guid;		// 翻页行为APINULLGuid
+		UInt32						detail;		// 0为楼梯行，k为第k个违规项；翻页行：0为上一页，1为下一页
+		GS::UniString				name;
+		GS::UniString				regulation;
+		GS::UniString				measured;
+	};
+	GS::Array<DisplayedRow>			displayedRows;
+
+	struct PendingExtraction {
+		UInt32						jobId = 0;
+		GS::UniString				fileName;
+	};
+
+	StairCore::RegulationExtractionWorker	extractionWorker;
+	GS::Array<PendingExtraction>	pendingExtractions;		// 按提交顺序排列
+	UInt32							extractionSerial;		// 用于生成每个任务的输出文件名
+	UInt32							extractionBatchSize;	// 本批提交的任务数
+	UInt32							appliedExtractionCount;	// 本批已加载的规范数
+	GS::UniString					extractionFailures;		// 本批失败的任务
+	GS::UniString					extractionStatus;		// 最近显示的进度文字，未变化时不重复设置
 };
 
 #endif
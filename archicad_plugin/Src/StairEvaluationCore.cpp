@@ -0,0 +1,355 @@
+#include "StairEvaluationCore.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "RegulationLibrary.hpp"
+#include "StairRuleProgram.hpp"
+#include "StairTrace.hpp"
+#include "StairTreadGeometry.hpp"
+#include "StairWalkingLine.hpp"
+#include "StairWorkPool.hpp"
+
+namespace StairCore {
+
+void StairRecord::Clear ()
+{
+	context = RuleContext ();
+	floorIndex = 0;
+	riserHeight = 0.0;
+	treadDepth = 0.0;
+	walkingLine.clear ();
+	walkingLineArcs.clear ();
+	segmentTypes.clear ();
+	for (BoundaryRecord& boundary : boundaries) {
+		boundary.points.clear ();
+		boundary.arcs.clear ();
+	}
+	treadLevels.clear ();
+	handrailHeight = 0.0;
+}
+
+double ComputeTwoRPlusGoing (double riserHeight, double treadDepth)
+{
+	return (2.0 * riserHeight) + treadDepth;
+}
+
+// FNV-1a
+static void HashBytes (std::uint64_t& hash, const void* data, std::size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*> (data);
+	for (std::size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+}
+
+static void HashDouble (std::uint64_t& hash, double value)
+{
+	std::uint64_t bits;
+	std::memcpy (&bits, &value, sizeof (bits));
+	HashBytes (hash, &bits, sizeof (bits));
+}
+
+std::uint64_t ComputeInputFingerprint (const StairRecord& stair)
+{
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+
+	HashBytes (hash, &stair.context.jurisdiction, sizeof (stair.context.jurisdiction));
+	HashBytes (hash, &stair.context.buildingType, sizeof (stair.context.buildingType));
+	HashBytes (hash, &stair.floorIndex, sizeof (stair.floorIndex));
+	HashDouble (hash, stair.riserHeight);
+	HashDouble (hash, stair.treadDepth);
+
+	const std::uint64_t vertexCount = stair.walkingLine.size ();
+	HashBytes (hash, &vertexCount, sizeof (vertexCount));
+	for (const Point2D& point : stair.walkingLine) {
+		HashDouble (hash, point.x);
+		HashDouble (hash, point.y);
+	}
+
+	const std::uint64_t arcCount = stair.walkingLineArcs.size ();
+	HashBytes (hash, &arcCount, sizeof (arcCount));
+	for (const ArcRecord& arc : stair.walkingLineArcs) {
+		HashBytes (hash, &arc.begIndex, sizeof (arc.begIndex));
+		HashBytes (hash, &arc.endIndex, sizeof (arc.endIndex));
+		HashDouble (hash, arc.arcAngle);
+	}
+
+	if (!stair.segmentTypes.empty ())
+		HashBytes (hash, stair.segmentTypes.data (), stair.segmentTypes.size () * sizeof (SegmentType));
+
+	for (const BoundaryRecord& boundary : stair.boundaries) {
+		const std::uint64_t boundaryCount = boundary.points.size ();
+		HashBytes (hash, &boundaryCount, sizeof (boundaryCount));
+		for (const Point2D& point : boundary.points) {
+			HashDouble (hash, point.x);
+			HashDouble (hash, point.y);
+		}
+		for (const ArcRecord& arc : boundary.arcs) {
+			HashBytes (hash, &arc.begIndex, sizeof (arc.begIndex));
+			HashBytes (hash, &arc.endIndex, sizeof (arc.endIndex));
+			HashDouble (hash, arc.arcAngle);
+		}
+	}
+
+	const std::uint64_t levelCount = stair.treadLevels.size ();
+	HashBytes (hash, &levelCount, sizeof (levelCount));
+	for (const double level : stair.treadLevels)
+		HashDouble (hash, level);
+	HashDouble (hash, stair.handrailHeight);
+
+	return hash;
+}
+
+// 坡度按度输出
+constexpr double kDegreesPerRadian = 180.0 / 3.14159265358979323846;
+
+StairMetrics ComputeMetrics (const StairRecord& stair)
+{
+	// 步行线几何每个楼梯构建一次，平台长度和逐个踏步的几何共用；每个线程复用缓冲区
+	thread_local WalkingLineGeometry walkingLine;
+	walkingLine.Build (stair);
+
+	TreadMetrics treads;
+	ComputeTreadMetrics (stair, walkingLine, treads);
+
+	// 能划分踏步时踏步宽度取最窄的踏步，否则取名义值
+	StairMetrics metrics;
+	metrics.riserHeight = stair.riserHeight;
+	metrics.treadDepth = treads.treadCount > 0 ? treads.minGoing : stair.treadDepth;
+	metrics.twoRPlusGoing = ComputeTwoRPlusGoing (metrics.riserHeight, metrics.treadDepth);
+	metrics.minLandingLength = walkingLine.GetMinimumLandingLength ();
+	metrics.landingEvaluated = walkingLine.HasLanding ();
+	metrics.narrowTreadDepth = treads.minNarrowGoing;
+	metrics.riserVariation = treads.riserVariation;
+	metrics.clearWidth = treads.minClearWidth;
+	metrics.handrailHeight = stair.handrailHeight;
+	metrics.slopeAngle = metrics.treadDepth > kEpsilon ? std::atan (metrics.riserHeight / metrics.treadDepth) * kDegreesPerRadian : 0.0;
+	metrics.flightSpacing = treads.flightSpacing;
+	return metrics;
+}
+
+double GetMetricValue (const StairMetrics& metrics, RuleKind kind)
+{
+	switch (kind) {
+		case RiserHeightRule:	return metrics.riserHeight;
+		case TreadDepthRule:	return metrics.treadDepth;
+		case LandingLengthRule:	return metrics.minLandingLength;
+		case TwoRPlusGoingRule:	return metrics.twoRPlusGoing;
+		case NarrowTreadDepthRule:	return metrics.narrowTreadDepth;
+		case RiserVariationRule:	return metrics.riserVariation;
+		case StairWidthRule:	return metrics.clearWidth;
+		case HandrailHeightRule:	return metrics.handrailHeight;
+		case SlopeAngleRule:	return metrics.slopeAngle;
+		case FlightSpacingRule:	return metrics.flightSpacing;
+		default:				return 0.0;
+	}
+}
+
+std::uint32_t EvaluateRules (const StairMetrics& metrics, const RuleSet& ruleSet)
+{
+	RuleOp ops[RuleKindCount];
+	const std::size_t opCount = CompileRuleSet (ruleSet, ops);
+	return RunRuleOps (ops, opCount, metrics);
+}
+
+StairEvaluation EvaluateStair (const StairRecord& stair, const RuleSet& ruleSet)
+{
+	StairEvaluation evaluation;
+	evaluation.metrics = ComputeMetrics (stair);
+	evaluation.violationMask = EvaluateRules (evaluation.metrics, ruleSet);
+	return evaluation;
+}
+
+StairEvaluation EvaluateStair (const StairRecord& stair, const RegulationLibrary& library)
+{
+	StairEvaluation evaluation;
+	evaluation.metrics = ComputeMetrics (stair);
+	evaluation.violationMask = library.RunRules (library.Resolve (stair.context), evaluation.metrics);
+	return evaluation;
+}
+
+void EvaluateStairs (const std::vector<StairRecord>& stairs, const RuleSet& ruleSet, std::vector<StairEvaluation>& evaluations, WorkStealingPool* pool)
+{
+	evaluations.resize (stairs.size ());
+
+	// 规则集只编译一次
+	RuleOp ops[RuleKindCount];
+	const std::size_t opCount = CompileRuleSet (ruleSet, ops);
+
+	// 每个任务只写入自己区间内的结果，结果顺序与输入一致
+	auto evaluateRange = [&] (std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i) {
+			StairEvaluation& evaluation = evaluations[i];
+			evaluation.metrics = ComputeMetrics (stairs[i]);
+			evaluation.violationMask = RunRuleOps (ops, opCount, evaluation.metrics);
+		}
+	};
+
+	if (pool != nullptr)
+		pool->ParallelFor (stairs.size (), kEvaluationGrainSize, evaluateRange);
+	else
+		evaluateRange (0, stairs.size ());
+}
+
+void EvaluateStairs (const std::vector<StairRecord>& stairs, const RegulationLibrary& library, std::vector<StairEvaluation>& evaluations, WorkStealingPool* pool)
+{
+	evaluations.resize (stairs.size ());
+
+	auto evaluateRange = [&] (std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i)
+			evaluations[i] = EvaluateStair (stairs[i], library);
+	};
+
+	if (pool != nullptr)
+		pool->ParallelFor (stairs.size (), kEvaluationGrainSize, evaluateRange);
+	else
+		evaluateRange (0, stairs.size ());
+}
+
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_RULE
+static const char* ResultText (bool violated, const char* violationText)
+{
+	return violated ? violationText : "✓ 符合规范";
+}
+
+// 实测值为0表示无法测量（RequirePositiveMetric）的单限值规则
+static void TraceMeasuredRule (const char* name, const char* missing, double value, const RuleLimits& limits, bool atLeast, bool violated)
+{
+	const std::optional<double>& limit = atLeast ? limits.minValue : limits.maxValue;
+	if (!limits.enabled) {
+		STAIR_TRACE_RULE ("[DEBUG] %s检查: 已禁用\n", name);
+	} else if (!limit.has_value ()) {
+		STAIR_TRACE_RULE ("[DEBUG] %s检查: 跳过（规则未设置%s）\n", name, atLeast ? "minValue" : "maxValue");
+	} else if (value <= kEpsilon) {
+		STAIR_TRACE_RULE ("[DEBUG] %s检查: 跳过（%s）\n", name, missing);
+	} else {
+		STAIR_TRACE_RULE ("[DEBUG] %s检查: 实测%.6f vs 限制%s%.6f, 差值=%.9f, kEpsilon=%.9f\n  → 结果: %s\n",
+			name, value, atLeast ? "≥" : "≤", *limit, atLeast ? *limit - value : value - *limit, kEpsilon,
+			ResultText (violated, atLeast ? "✗ 违规! 低于限制" : "✗ 违规! 超出限制"));
+	}
+}
+#endif
+
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_STAIR
+
+void TraceEvaluation (std::size_t stairIndex, const char* displayName, const StairEvaluation& evaluation, const RuleSet& ruleSet)
+{
+	const StairMetrics& m = evaluation.metrics;
+
+	StairTrace::Write ("\n[DEBUG] 楼梯 #%u (%s) 实测数据:\n"
+		"  riserHeight = %.6f 米 (%.0f 毫米)\n"
+		"  treadDepth = %.6f 米 (%.0f 毫米)\n"
+		"  twoRPlusGoing = %.6f 米 (%.0f 毫米)\n"
+		"  narrowTreadDepth = %.6f 米 (%.0f 毫米)\n"
+		"  riserVariation = %.6f 米 (%.0f 毫米)\n"
+		"  clearWidth = %.6f 米 (%.0f 毫米)\n"
+		"  handrailHeight = %.6f 米 (%.0f 毫米)\n"
+		"  slopeAngle = %.2f 度\n"
+		"  flightSpacing = %.6f 米 (%.0f 毫米)\n",
+		static_cast<unsigned int> (stairIndex) + 1, displayName,
+		m.riserHeight, m.riserHeight * 1000.0,
+		m.treadDepth, m.treadDepth * 1000.0,
+		m.twoRPlusGoing, m.twoRPlusGoing * 1000.0,
+		m.narrowTreadDepth, m.narrowTreadDepth * 1000.0,
+		m.riserVariation, m.riserVariation * 1000.0,
+		m.clearWidth, m.clearWidth * 1000.0,
+		m.handrailHeight, m.handrailHeight * 1000.0,
+		m.slopeAngle,
+		m.flightSpacing, m.flightSpacing * 1000.0);
+	if (m.landingEvaluated)
+		StairTrace::Write ("  minLandingLength = %.6f 米 (%.0f 毫米)\n", m.minLandingLength, m.minLandingLength * 1000.0);
+	else
+		StairTrace::Write ("  minLandingLength = 未评估\n");
+
+	const RuleLimits& riser = ruleSet.rules[RiserHeightRule];
+	if (!riser.enabled) {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步高度检查: 已禁用\n");
+	} else if (riser.maxValue.has_value ()) {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步高度检查: 实测%.6f vs 限制≤%.6f, 差值=%.9f, kEpsilon=%.9f\n  → 结果: %s\n",
+			m.riserHeight, *riser.maxValue, m.riserHeight - *riser.maxValue, kEpsilon,
+			ResultText (evaluation.IsViolated (RiserHeightRule), "✗ 违规! 超出限制"));
+	} else {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步高度检查: 跳过（规则未设置maxValue）\n");
+	}
+
+	const RuleLimits& tread = ruleSet.rules[TreadDepthRule];
+	if (!tread.enabled) {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步宽度检查: 已禁用\n");
+	} else if (!tread.minValue.has_value ()) {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步宽度检查: 跳过（规则未设置minValue）\n");
+	} else if (m.treadDepth <= kEpsilon) {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步宽度检查: 跳过（treadDepth无效或为0）\n");
+	} else {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步宽度检查: 实测%.6f vs 限制≥%.6f, 差值=%.9f, kEpsilon=%.9f\n  → 结果: %s\n",
+			m.treadDepth, *tread.minValue, *tread.minValue - m.treadDepth, kEpsilon,
+			ResultText (evaluation.IsViolated (TreadDepthRule), "✗ 违规! 低于限制"));
+	}
+
+	const RuleLimits& landing = ruleSet.rules[LandingLengthRule];
+	if (!landing.enabled) {
+		STAIR_TRACE_RULE ("[DEBUG] 平台长度检查: 已禁用\n");
+	} else if (!m.landingEvaluated || m.minLandingLength <= 0.0) {
+		STAIR_TRACE_RULE ("[DEBUG] 平台长度检查: 跳过（未评估或长度为0）\n");
+	} else if (!landing.minValue.has_value ()) {
+		STAIR_TRACE_RULE ("[DEBUG] 平台长度检查: 跳过（规则未设置minValue）\n");
+	} else {
+		STAIR_TRACE_RULE ("[DEBUG] 平台长度检查: 实测%.6f vs 限制≥%.6f, 差值=%.9f, kEpsilon=%.9f\n  → 结果: %s\n",
+			m.minLandingLength, *landing.minValue, *landing.minValue - m.minLandingLength, kEpsilon,
+			ResultText (evaluation.IsViolated (LandingLengthRule), "✗ 违规! 低于限制"));
+	}
+
+	const RuleLimits& twoRPlusG = ruleSet.rules[TwoRPlusGoingRule];
+	if (!twoRPlusG.enabled) {
+		STAIR_TRACE_RULE ("[DEBUG] 2R+G检查: 已禁用\n");
+	} else if (!twoRPlusG.minValue.has_value () || !twoRPlusG.maxValue.has_value ()) {
+		STAIR_TRACE_RULE ("[DEBUG] 2R+G检查: 跳过（规则未设置min或max值）\n");
+	} else {
+		STAIR_TRACE_RULE ("[DEBUG] 2R+G检查: 实测%.6f vs 限制范围[%.6f, %.6f], kEpsilon=%.9f\n  → 结果: %s\n",
+			m.twoRPlusGoing, *twoRPlusG.minValue, *twoRPlusG.maxValue, kEpsilon,
+			ResultText (evaluation.IsViolated (TwoRPlusGoingRule), "✗ 违规! 超出范围"));
+	}
+
+	const RuleLimits& narrow = ruleSet.rules[NarrowTreadDepthRule];
+	if (!narrow.enabled) {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步窄端宽度检查: 已禁用\n");
+	} else if (!narrow.minValue.has_value ()) {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步窄端宽度检查: 跳过（规则未设置minValue）\n");
+	} else if (m.narrowTreadDepth <= kEpsilon) {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步窄端宽度检查: 跳过（没有边界数据）\n");
+	} else {
+		STAIR_TRACE_RULE ("[DEBUG] 踏步窄端宽度检查: 实测%.6f vs 限制≥%.6f, 差值=%.9f, kEpsilon=%.9f\n  → 结果: %s\n",
+			m.narrowTreadDepth, *narrow.minValue, *narrow.minValue - m.narrowTreadDepth, kEpsilon,
+			ResultText (evaluation.IsViolated (NarrowTreadDepthRule), "✗ 违规! 低于限制"));
+	}
+
+	const RuleLimits& variation = ruleSet.rules[RiserVariationRule];
+	if (!variation.enabled) {
+		STAIR_TRACE_RULE ("[DEBUG] 踢面高度差检查: 已禁用\n");
+	} else if (!variation.maxValue.has_value ()) {
+		STAIR_TRACE_RULE ("[DEBUG] 踢面高度差检查: 跳过（规则未设置maxValue）\n");
+	} else {
+		STAIR_TRACE_RULE ("[DEBUG] 踢面高度差检查: 实测%.6f vs 限制≤%.6f, 差值=%.9f, kEpsilon=%.9f\n  → 结果: %s\n",
+			m.riserVariation, *variation.maxValue, m.riserVariation - *variation.maxValue, kEpsilon,
+			ResultText (evaluation.IsViolated (RiserVariationRule), "✗ 违规! 超出限制"));
+	}
+
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_RULE
+	TraceMeasuredRule ("梯段净宽", "没有边界数据", m.clearWidth, ruleSet.rules[StairWidthRule], true, evaluation.IsViolated (StairWidthRule));
+	TraceMeasuredRule ("扶手高度", "没有关联栏杆", m.handrailHeight, ruleSet.rules[HandrailHeightRule], true, evaluation.IsViolated (HandrailHeightRule));
+	TraceMeasuredRule ("梯段坡度", "踏步宽度为0", m.slopeAngle, ruleSet.rules[SlopeAngleRule], false, evaluation.IsViolated (SlopeAngleRule));
+	TraceMeasuredRule ("梯段间距", "没有相对的梯段", m.flightSpacing, ruleSet.rules[FlightSpacingRule], true, evaluation.IsViolated (FlightSpacingRule));
+#endif
+}
+
+#else
+
+void TraceEvaluation (std::size_t, const char*, const StairEvaluation&, const RuleSet&)
+{
+}
+
+#endif
+
+} // namespace StairCore
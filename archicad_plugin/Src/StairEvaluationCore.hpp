@@ -0,0 +1,158 @@
+#ifndef STAIR_EVALUATION_CORE_HPP
+#define STAIR_EVALUATION_CORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * 楼梯检测核心（与ArchiCAD无关）
+ *
+ * 只依赖标准库，输入为普通的楼梯记录，ArchiCAD插件通过适配器把
+ * API_Element/API_ElementMemo转换为StairRecord后调用。
+ * 所有长度单位为米，角度单位为弧度；只有坡度实测值以度为单位，与规范条文一致。
+ */
+namespace StairCore {
+
+class WorkStealingPool;
+class RegulationLibrary;
+
+constexpr double kEpsilon = 1e-4;
+
+// 并行检测时每个任务包含的楼梯数
+constexpr std::size_t kEvaluationGrainSize = 256;
+
+struct Point2D {
+	double	x;
+	double	y;
+};
+
+// 步行线线段类型（对应API_StairPolylineEdgeData::segmentType）
+enum class SegmentType : std::uint8_t {
+	Flight,
+	Landing,
+	DividedLanding
+};
+
+// 圆弧段：begIndex/endIndex 为步行线顶点索引，arcAngle 为圆心角
+struct ArcRecord {
+	std::int32_t	begIndex;
+	std::int32_t	endIndex;
+	double			arcAngle;
+};
+
+// 规范适用范围：地区与建筑类型编号由RegulationLibrary::MakeContext分配，0表示不限
+struct RuleContext {
+	std::uint16_t	jurisdiction = 0;
+	std::uint16_t	buildingType = 0;
+};
+
+// 楼梯边界折线（对应API_ElementMemo::stairBoundary）
+struct BoundaryRecord {
+	std::vector<Point2D>		points;
+	std::vector<ArcRecord>		arcs;
+};
+
+// 楼梯输入记录
+struct StairRecord {
+	RuleContext					context;
+	short						floorIndex = 0;
+	double						riserHeight = 0.0;
+	double						treadDepth = 0.0;
+	std::vector<Point2D>		walkingLine;		// 步行线顶点
+	std::vector<ArcRecord>		walkingLineArcs;
+	std::vector<SegmentType>	segmentTypes;		// segmentTypes[k] 对应顶点 k 到 k+1 的线段
+	BoundaryRecord				boundaries[2];		// 左右边界，没有边界数据时为空
+	std::vector<double>			treadLevels;		// 各踏板顶面标高（任意顺序），没有踏板数据时为空
+	double						handrailHeight = 0.0;	// 关联栏杆的扶手高度（取最低的，见StairRailings），没有栏杆时为0
+
+	void Clear ();
+};
+
+/**
+ * 实测值。有步行线时踏步宽度按逐个踏步计算（见StairTreadGeometry）：
+ * treadDepth 为最窄踏步在步行线上的宽度，narrowTreadDepth 为踏步窄端的宽度，
+ * riserVariation 为相邻踏板标高差（踢面高度）的最大差值。
+ * clearWidth 为踢面线上左右边界之间最窄处的距离，flightSpacing 为相对（反向）梯段之间的最小距离。
+ */
+struct StairMetrics {
+	double	riserHeight = 0.0;
+	double	treadDepth = 0.0;
+	double	twoRPlusGoing = 0.0;
+	double	minLandingLength = 0.0;
+	double	narrowTreadDepth = 0.0;		// 没有边界数据时为0
+	double	riserVariation = 0.0;		// 踏板少于3个时为0
+	double	clearWidth = 0.0;			// 没有边界数据时为0
+	double	handrailHeight = 0.0;		// 没有关联栏杆时为0
+	double	slopeAngle = 0.0;			// 度，atan(踏步高度 / 踏步宽度)，踏步宽度为0时为0
+	double	flightSpacing = 0.0;		// 没有相对的梯段或梯段相接时为0
+	bool	landingEvaluated = false;
+};
+
+// 新增类别时须同时修改规则检测方式（StairRuleProgram）、按列存放的实测值、JSON键名和缓存版本
+enum RuleKind : std::uint32_t {
+	RiserHeightRule = 0,
+	TreadDepthRule,
+	LandingLengthRule,
+	TwoRPlusGoingRule,
+	NarrowTreadDepthRule,		// 扇形/斜踏步窄端的踏步宽度
+	RiserVariationRule,			// 同一楼梯内踢面高度的差值
+	StairWidthRule,				// 梯段净宽
+	HandrailHeightRule,			// 栏杆扶手高度
+	SlopeAngleRule,				// 梯段坡度
+	FlightSpacingRule,			// 相邻梯段（梯井两侧）之间的水平净距
+	RuleKindCount
+};
+
+// 默认参与检测的规则类别：踏步高度和宽度（含逐个踏步的窄端宽度和踢面高度差）及防火规范四项
+constexpr std::uint32_t kDefaultCheckedRules =
+	(1u << RiserHeightRule) | (1u << TreadDepthRule) | (1u << NarrowTreadDepthRule) | (1u << RiserVariationRule) |
+	(1u << StairWidthRule) | (1u << HandrailHeightRule) | (1u << SlopeAngleRule) | (1u << FlightSpacingRule);
+
+struct RuleLimits {
+	std::optional<double>	minValue;
+	std::optional<double>	maxValue;
+	bool					enabled = true;
+};
+
+struct RuleSet {
+	RuleLimits	rules[RuleKindCount];
+};
+
+struct StairEvaluation {
+	StairMetrics	metrics;
+	std::uint32_t	violationMask = 0;
+
+	bool IsViolated (RuleKind kind) const { return (violationMask & (1u << kind)) != 0; }
+	bool IsCompliant () const { return violationMask == 0; }
+};
+
+double			ComputeTwoRPlusGoing (double riserHeight, double treadDepth);
+
+// 线段长度、累计距离、平台和梯段长度等查询见StairWalkingLine（WalkingLineGeometry）
+
+// 检测输入指纹（踏步高度、踏步宽度、楼层、步行线、边界、踏板标高、扶手高度），用于判断楼梯是否需要重新检测
+std::uint64_t	ComputeInputFingerprint (const StairRecord& stair);
+
+StairMetrics	ComputeMetrics (const StairRecord& stair);
+double			GetMetricValue (const StairMetrics& metrics, RuleKind kind);
+// 规则集编译为RuleOp后执行（见StairRuleProgram），批量检测时应先编译一次
+std::uint32_t	EvaluateRules (const StairMetrics& metrics, const RuleSet& ruleSet);
+StairEvaluation	EvaluateStair (const StairRecord& stair, const RuleSet& ruleSet);
+
+// 使用规范库中与stair.context对应的已编译规则
+StairEvaluation	EvaluateStair (const StairRecord& stair, const RegulationLibrary& library);
+
+// 批量检测，evaluations[i] 对应 stairs[i]；pool 为空时在当前线程顺序执行
+void			EvaluateStairs (const std::vector<StairRecord>& stairs, const RuleSet& ruleSet, std::vector<StairEvaluation>& evaluations, WorkStealingPool* pool);
+
+// 同上，每个楼梯使用规范库中与其context对应的规则
+void			EvaluateStairs (const std::vector<StairRecord>& stairs, const RegulationLibrary& library, std::vector<StairEvaluation>& evaluations, WorkStealingPool* pool);
+
+// 按StairTrace级别输出单个楼梯的实测数据和规则比较过程
+void			TraceEvaluation (std::size_t stairIndex, const char* displayName, const StairEvaluation& evaluation, const RuleSet& ruleSet);
+
+} // namespace StairCore
+
+#endif
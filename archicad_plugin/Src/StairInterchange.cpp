@@ -0,0 +1,457 @@
+#include "StairInterchange.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+
+#include "RegulationJson.hpp"
+
+namespace StairInterchange {
+
+using RegulationJson::Document;
+using RegulationJson::Value;
+
+namespace {
+
+const char* const kSegmentNames[] = {
+	"flight",			// SegmentType::Flight
+	"landing",			// SegmentType::Landing
+	"divided_landing"	// SegmentType::DividedLanding
+};
+
+// ---------------------------------------------------------------------------
+// 写出
+// ---------------------------------------------------------------------------
+
+void AppendMember (std::string& json, const char* key)
+{
+	json += '"';
+	json += key;
+	json += "\": ";
+}
+
+void AppendPoints (std::string& json, const std::vector<StairCore::Point2D>& points)
+{
+	json += '[';
+	for (std::size_t i = 0; i < points.size (); ++i) {
+		if (i > 0)
+			json += ", ";
+		json += '[';
+		AppendJsonNumber (json, points[i].x);
+		json += ", ";
+		AppendJsonNumber (json, points[i].y);
+		json += ']';
+	}
+	json += ']';
+}
+
+void AppendArcs (std::string& json, const std::vector<StairCore::ArcRecord>& arcs)
+{
+	json += '[';
+	for (std::size_t i = 0; i < arcs.size (); ++i) {
+		if (i > 0)
+			json += ", ";
+		json += "{\"begin\": ";
+		json += std::to_string (arcs[i].begIndex);
+		json += ", \"end\": ";
+		json += std::to_string (arcs[i].endIndex);
+		json += ", \"angle\": ";
+		AppendJsonNumber (json, arcs[i].arcAngle);
+		json += '}';
+	}
+	json += ']';
+}
+
+// 只写出左花括号和points、arcs，调用方补充其余成员后闭合
+void AppendPolyline (std::string& json, const std::vector<StairCore::Point2D>& points, const std::vector<StairCore::ArcRecord>& arcs)
+{
+	json += '{';
+	AppendMember (json, "points");
+	AppendPoints (json, points);
+	json += ", ";
+	AppendMember (json, "arcs");
+	AppendArcs (json, arcs);
+}
+
+void AppendStair (std::string& json, const std::string& id, const StairCore::StairRecord& stair)
+{
+	json += "{\"id\": ";
+	AppendJsonString (json, id);
+	json += ", \"floor\": ";
+	json += std::to_string (stair.floorIndex);
+	json += ", \"riser_height\": ";
+	AppendJsonNumber (json, stair.riserHeight);
+	json += ", \"tread_depth\": ";
+	AppendJsonNumber (json, stair.treadDepth);
+
+	json += ", \"walking_line\": ";
+	AppendPolyline (json, stair.walkingLine, stair.walkingLineArcs);
+	json += ", \"segments\": [";
+	for (std::size_t i = 0; i < stair.segmentTypes.size (); ++i) {
+		if (i > 0)
+			json += ", ";
+		json += '"';
+		json += kSegmentNames[static_cast<std::size_t> (stair.segmentTypes[i])];
+		json += '"';
+	}
+	json += "]}";
+
+	// 没有边界数据时省略
+	if (!stair.boundaries[0].points.empty () || !stair.boundaries[1].points.empty ()) {
+		json += ", \"boundaries\": [";
+		for (std::size_t side = 0; side < 2; ++side) {
+			if (side > 0)
+				json += ", ";
+			AppendPolyline (json, stair.boundaries[side].points, stair.boundaries[side].arcs);
+			json += '}';
+		}
+		json += ']';
+	}
+
+	if (!stair.treadLevels.empty ()) {
+		json += ", \"tread_levels\": [";
+		for (std::size_t i = 0; i < stair.treadLevels.size (); ++i) {
+			if (i > 0)
+				json += ", ";
+			AppendJsonNumber (json, stair.treadLevels[i]);
+		}
+		json += ']';
+	}
+	json += '}';
+}
+
+void AppendRailing (std::string& json, const StairCore::RailingRecord& railing)
+{
+	const StairCore::ElementBounds& bounds = railing.bounds;
+	json += "{\"floor\": ";
+	json += std::to_string (bounds.floorIndex);
+	json += ", \"bounds\": [";
+	AppendJsonNumber (json, bounds.minX);
+	json += ", ";
+	AppendJsonNumber (json, bounds.minY);
+	json += ", ";
+	AppendJsonNumber (json, bounds.maxX);
+	json += ", ";
+	AppendJsonNumber (json, bounds.maxY);
+	json += "], \"handrail_height\": ";
+	AppendJsonNumber (json, railing.handrailHeight);
+	json += '}';
+}
+
+// ---------------------------------------------------------------------------
+// 读取
+// ---------------------------------------------------------------------------
+
+double ReadNumber (const Value* value)
+{
+	return value != nullptr && value->IsNumber () ? value->number : 0.0;
+}
+
+bool ReadFloor (const Value* value, short& floorIndex)
+{
+	if (value == nullptr) {
+		floorIndex = 0;
+		return true;
+	}
+	if (!value->IsNumber () || value->number != std::floor (value->number) || value->number < -32768.0 || value->number > 32767.0)
+		return false;
+	floorIndex = static_cast<short> (value->number);
+	return true;
+}
+
+bool ReadPoints (const Document& document, const Value* array, std::vector<StairCore::Point2D>& points)
+{
+	points.clear ();
+	if (array == nullptr)
+		return true;
+	if (!array->IsArray ())
+		return false;
+
+	points.reserve (array->childCount);
+	for (const Value* point = document.GetFirstChild (*array); point != nullptr; point = document.GetNextSibling (*point)) {
+		const Value* x = point->IsArray () && point->childCount == 2 ? document.GetFirstChild (*point) : nullptr;
+		const Value* y = x != nullptr ? document.GetNextSibling (*x) : nullptr;
+		if (x == nullptr || y == nullptr || !x->IsNumber () || !y->IsNumber ())
+			return false;
+		points.push_back ({ x->number, y->number });
+	}
+	return true;
+}
+
+// 圆弧的顶点索引须在折线范围内
+bool ReadArcs (const Document& document, const Value* array, std::size_t pointCount, std::vector<StairCore::ArcRecord>& arcs)
+{
+	arcs.clear ();
+	if (array == nullptr)
+		return true;
+	if (!array->IsArray ())
+		return false;
+
+	arcs.reserve (array->childCount);
+	for (const Value* arc = document.GetFirstChild (*array); arc != nullptr; arc = document.GetNextSibling (*arc)) {
+		if (!arc->IsObject ())
+			return false;
+		const Value* begin = document.FindMember (*arc, "begin");
+		const Value* end = document.FindMember (*arc, "end");
+		const Value* angle = document.FindMember (*arc, "angle");
+		if (begin == nullptr || end == nullptr || angle == nullptr || !begin->IsNumber () || !end->IsNumber () || !angle->IsNumber ())
+			return false;
+		if (begin->number < 0.0 || end->number < 0.0 ||
+			begin->number >= static_cast<double> (pointCount) || end->number >= static_cast<double> (pointCount))
+			return false;
+		arcs.push_back ({ static_cast<std::int32_t> (begin->number), static_cast<std::int32_t> (end->number), angle->number });
+	}
+	return true;
+}
+
+bool ReadPolyline (const Document& document, const Value* object, std::vector<StairCore::Point2D>& points, std::vector<StairCore::ArcRecord>& arcs)
+{
+	points.clear ();
+	arcs.clear ();
+	if (object == nullptr)
+		return true;
+	if (!object->IsObject ())
+		return false;
+	return ReadPoints (document, document.FindMember (*object, "points"), points) &&
+		ReadArcs (document, document.FindMember (*object, "arcs"), points.size (), arcs);
+}
+
+// 线段类型可以省略（不划分梯段和平台），给出时须与步行线的线段数相同
+bool ReadSegments (const Document& document, const Value* array, std::size_t pointCount, std::vector<StairCore::SegmentType>& segmentTypes)
+{
+	segmentTypes.clear ();
+	if (array == nullptr)
+		return true;
+	if (!array->IsArray () || (array->childCount > 0 && array->childCount + 1 != pointCount))
+		return false;
+
+	segmentTypes.reserve (array->childCount);
+	for (const Value* segment = document.GetFirstChild (*array); segment != nullptr; segment = document.GetNextSibling (*segment)) {
+		if (!segment->IsString ())
+			return false;
+		std::size_t type = 0;
+		while (type < std::size (kSegmentNames) && segment->string != kSegmentNames[type])
+			++type;
+		if (type == std::size (kSegmentNames))
+			return false;
+		segmentTypes.push_back (static_cast<StairCore::SegmentType> (type));
+	}
+	return true;
+}
+
+// 返回出错的字段名，成功时返回nullptr
+const char* ReadStair (const Document& document, const Value& object, std::string& id, StairCore::StairRecord& stair)
+{
+	stair.Clear ();
+	id.clear ();
+
+	const Value* idValue = document.FindMember (object, "id");
+	if (idValue != nullptr && idValue->IsString ())
+		id.assign (idValue->string);
+	if (!ReadFloor (document.FindMember (object, "floor"), stair.floorIndex))
+		return "floor";
+	stair.riserHeight = ReadNumber (document.FindMember (object, "riser_height"));
+	stair.treadDepth = ReadNumber (document.FindMember (object, "tread_depth"));
+
+	const Value* walkingLine = document.FindMember (object, "walking_line");
+	if (!ReadPolyline (document, walkingLine, stair.walkingLine, stair.walkingLineArcs))
+		return "walking_line";
+	if (walkingLine != nullptr && !ReadSegments (document, document.FindMember (*walkingLine, "segments"), stair.walkingLine.size (), stair.segmentTypes))
+		return "walking_line.segments";
+
+	const Value* boundaries = document.FindMember (object, "boundaries");
+	if (boundaries != nullptr) {
+		if (!boundaries->IsArray () || boundaries->childCount > 2)
+			return "boundaries";
+		std::size_t side = 0;
+		for (const Value* boundary = document.GetFirstChild (*boundaries); boundary != nullptr; boundary = document.GetNextSibling (*boundary), ++side) {
+			if (!ReadPolyline (document, boundary, stair.boundaries[side].points, stair.boundaries[side].arcs))
+				return "boundaries";
+		}
+	}
+
+	const Value* treadLevels = document.FindMember (object, "tread_levels");
+	if (treadLevels != nullptr) {
+		if (!treadLevels->IsArray ())
+			return "tread_levels";
+		stair.treadLevels.reserve (treadLevels->childCount);
+		for (const Value* level = document.GetFirstChild (*treadLevels); level != nullptr; level = document.GetNextSibling (*level)) {
+			if (!level->IsNumber ())
+				return "tread_levels";
+			stair.treadLevels.push_back (level->number);
+		}
+	}
+	return nullptr;
+}
+
+bool ReadRailing (const Document& document, const Value& object, StairCore::RailingRecord& railing)
+{
+	if (!object.IsObject () || !ReadFloor (document.FindMember (object, "floor"), railing.bounds.floorIndex))
+		return false;
+
+	const Value* bounds = document.FindMember (object, "bounds");
+	if (bounds == nullptr || !bounds->IsArray () || bounds->childCount != 4)
+		return false;
+	double coordinates[4];
+	std::size_t count = 0;
+	for (const Value* value = document.GetFirstChild (*bounds); value != nullptr; value = document.GetNextSibling (*value)) {
+		if (!value->IsNumber ())
+			return false;
+		coordinates[count++] = value->number;
+	}
+	railing.bounds.minX = coordinates[0];
+	railing.bounds.minY = coordinates[1];
+	railing.bounds.maxX = coordinates[2];
+	railing.bounds.maxY = coordinates[3];
+	railing.handrailHeight = ReadNumber (document.FindMember (object, "handrail_height"));
+	return true;
+}
+
+// 读取失败时清空模型，调用方不会用到读了一半的楼梯和栏杆
+bool Fail (ModelRecord& model, std::string& error, const std::string& message)
+{
+	model.Clear ();
+	error = message;
+	return false;
+}
+
+} // namespace
+
+void ModelRecord::Clear ()
+{
+	name.clear ();
+	jurisdiction.clear ();
+	buildingType.clear ();
+	stairIds.clear ();
+	stairs.clear ();
+	railings.clear ();
+}
+
+void AppendJsonString (std::string& json, std::string_view text)
+{
+	json += '"';
+	for (const char c : text) {
+		switch (c) {
+			case '"':	json += "\\\"";	break;
+			case '\\':	json += "\\\\";	break;
+			case '\n':	json += "\\n";	break;
+			case '\r':	json += "\\r";	break;
+			case '\t':	json += "\\t";	break;
+			default:
+				if (static_cast<unsigned char> (c) < 0x20) {
+					char escaped[8];
+					std::snprintf (escaped, sizeof (escaped), "\\u%04x", static_cast<unsigned int> (c));
+					json += escaped;
+				} else {
+					json += c;
+				}
+				break;
+		}
+	}
+	json += '"';
+}
+
+void AppendJsonNumber (std::string& json, double value)
+{
+	// JSON没有NaN和无穷大
+	if (!std::isfinite (value)) {
+		json += "null";
+		return;
+	}
+	// 优先使用15位有效数字（0.17而不是0.17000000000000001），读回不相等时才写出17位
+	char buffer[32];
+	std::snprintf (buffer, sizeof (buffer), "%.15g", value);
+	if (std::strtod (buffer, nullptr) != value)
+		std::snprintf (buffer, sizeof (buffer), "%.17g", value);
+	json += buffer;
+}
+
+void WriteModel (const ModelRecord& model, std::string& json)
+{
+	json += "{\n  \"format\": ";
+	AppendJsonString (json, kFormatName);
+	json += ",\n  \"version\": ";
+	json += std::to_string (kFormatVersion);
+	json += ",\n  \"model\": ";
+	AppendJsonString (json, model.name);
+	json += ",\n  \"jurisdiction\": ";
+	AppendJsonString (json, model.jurisdiction);
+	json += ",\n  \"building_type\": ";
+	AppendJsonString (json, model.buildingType);
+
+	json += ",\n  \"stairs\": [";
+	for (std::size_t i = 0; i < model.stairs.size (); ++i) {
+		json += i > 0 ? ",\n    " : "\n    ";
+		AppendStair (json, i < model.stairIds.size () ? model.stairIds[i] : std::string (), model.stairs[i]);
+	}
+	json += model.stairs.empty () ? "]" : "\n  ]";
+
+	json += ",\n  \"railings\": [";
+	for (std::size_t i = 0; i < model.railings.size (); ++i) {
+		json += i > 0 ? ",\n    " : "\n    ";
+		AppendRailing (json, model.railings[i]);
+	}
+	json += model.railings.empty () ? "]" : "\n  ]";
+	json += "\n}\n";
+}
+
+bool ReadModel (const char* data, std::size_t size, ModelRecord& model, std::string& error)
+{
+	model.Clear ();
+	error.clear ();
+
+	Document document;
+	if (!document.Parse (data, size)) {
+		const RegulationJson::ParseError& parseError = document.GetError ();
+		return Fail (model, error, std::string ("JSON格式错误: ") + (parseError.message != nullptr ? parseError.message : "") +
+			"（第" + std::to_string (parseError.line) + "行，第" + std::to_string (parseError.column) + "列）");
+	}
+
+	const Value* root = document.GetRoot ();
+	const Value* format = root != nullptr && root->IsObject () ? document.FindMember (*root, "format") : nullptr;
+	if (format == nullptr || !format->IsString () || format->string != kFormatName)
+		return Fail (model, error, std::string ("不是楼梯交换格式（format应为\"") + kFormatName + "\"）");
+
+	const Value* version = document.FindMember (*root, "version");
+	if (version == nullptr || !version->IsNumber () || version->number < 1.0 || version->number > static_cast<double> (kFormatVersion))
+		return Fail (model, error, "不支持的格式版本（最高支持 " + std::to_string (kFormatVersion) + "）");
+
+	const Value* name = document.FindMember (*root, "model");
+	if (name != nullptr && name->IsString ())
+		model.name.assign (name->string);
+	const Value* jurisdiction = document.FindMember (*root, "jurisdiction");
+	if (jurisdiction != nullptr && jurisdiction->IsString ())
+		model.jurisdiction.assign (jurisdiction->string);
+	const Value* buildingType = document.FindMember (*root, "building_type");
+	if (buildingType != nullptr && buildingType->IsString ())
+		model.buildingType.assign (buildingType->string);
+
+	const Value* stairs = document.FindMember (*root, "stairs");
+	if (stairs == nullptr || !stairs->IsArray ())
+		return Fail (model, error, "缺少stairs数组");
+
+	model.stairs.resize (stairs->childCount);
+	model.stairIds.resize (stairs->childCount);
+	std::size_t index = 0;
+	for (const Value* stair = document.GetFirstChild (*stairs); stair != nullptr; stair = document.GetNextSibling (*stair), ++index) {
+		const char* field = stair->IsObject () ? ReadStair (document, *stair, model.stairIds[index], model.stairs[index]) : "stairs";
+		if (field != nullptr)
+			return Fail (model, error, "第 " + std::to_string (index + 1) + " 个楼梯的 " + field + " 无效");
+	}
+
+	const Value* railings = document.FindMember (*root, "railings");
+	if (railings != nullptr) {
+		if (!railings->IsArray ())
+			return Fail (model, error, "railings不是数组");
+		model.railings.resize (railings->childCount);
+		index = 0;
+		for (const Value* railing = document.GetFirstChild (*railings); railing != nullptr; railing = document.GetNextSibling (*railing), ++index) {
+			if (!ReadRailing (document, *railing, model.railings[index]))
+				return Fail (model, error, "第 " + std::to_string (index + 1) + " 个栏杆无效");
+		}
+	}
+	return true;
+}
+
+} // namespace StairInterchange
@@ -0,0 +1,49 @@
+#ifndef STAIR_INTERCHANGE_HPP
+#define STAIR_INTERCHANGE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "StairEvaluationCore.hpp"
+#include "StairRailings.hpp"
+
+/**
+ * 楼梯交换格式（与ArchiCAD无关）
+ *
+ * 插件把项目中楼梯和栏杆的检测输入导出为UTF-8 JSON文件（*.stairs.json），
+ * 命令行批量检测工具（Cli/StairCheck.cpp）在没有ArchiCAD的机器上读取后用同一检测核心检测。
+ * 坐标和长度单位为米，圆心角为弧度；字段说明见README的“楼梯交换格式”。
+ * 扶手高度不随楼梯导出，读取后由栏杆按StairRailings的规则关联。
+ */
+namespace StairInterchange {
+
+constexpr const char*	kFormatName = "stair-interchange";
+constexpr int			kFormatVersion = 1;
+constexpr const char*	kFileSuffix = ".stairs.json";
+
+struct ModelRecord {
+	std::string								name;
+	std::string								jurisdiction;		// 为空表示不限地区
+	std::string								buildingType;		// 为空表示不限建筑类型
+	std::vector<std::string>				stairIds;			// stairIds[i] 对应 stairs[i]，插件导出时为GUID
+	std::vector<StairCore::StairRecord>		stairs;				// 不含context和handrailHeight
+	std::vector<StairCore::RailingRecord>	railings;
+
+	void Clear ();
+};
+
+// 把模型追加到json末尾（每个楼梯、栏杆一行）
+void	WriteModel (const ModelRecord& model, std::string& json);
+
+// 解析失败或字段无效时返回false并清空model，error为UTF-8说明（含出错位置或楼梯序号）
+bool	ReadModel (const char* data, std::size_t size, ModelRecord& model, std::string& error);
+
+// JSON输出辅助：转义后的字符串（含引号），以及可无损读回的数值
+void	AppendJsonString (std::string& json, std::string_view text);
+void	AppendJsonNumber (std::string& json, double value);
+
+} // namespace StairInterchange
+
+#endif
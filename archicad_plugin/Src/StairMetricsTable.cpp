@@ -0,0 +1,194 @@
+#include "StairMetricsTable.hpp"
+
+#include <algorithm>
+
+#include "RegulationLibrary.hpp"
+#include "StairWorkPool.hpp"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define STAIR_TABLE_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define STAIR_TABLE_USE_SSE2 0
+#endif
+
+namespace StairCore {
+
+void StairMetricsTable::Resize (std::size_t rowCount)
+{
+	riserHeight.resize (rowCount);
+	treadDepth.resize (rowCount);
+	minLandingLength.resize (rowCount);
+	twoRPlusGoing.resize (rowCount);
+	narrowTreadDepth.resize (rowCount);
+	riserVariation.resize (rowCount);
+	clearWidth.resize (rowCount);
+	handrailHeight.resize (rowCount);
+	slopeAngle.resize (rowCount);
+	flightSpacing.resize (rowCount);
+	floorIndex.resize (rowCount);
+	landingEvaluated.resize (rowCount);
+	violationMask.resize (rowCount);
+}
+
+const double* StairMetricsTable::GetColumn (RuleKind kind) const
+{
+	switch (kind) {
+		case RiserHeightRule:	return riserHeight.data ();
+		case TreadDepthRule:	return treadDepth.data ();
+		case LandingLengthRule:	return minLandingLength.data ();
+		case TwoRPlusGoingRule:	return twoRPlusGoing.data ();
+		case NarrowTreadDepthRule:	return narrowTreadDepth.data ();
+		case RiserVariationRule:	return riserVariation.data ();
+		case StairWidthRule:	return clearWidth.data ();
+		case HandrailHeightRule:	return handrailHeight.data ();
+		case SlopeAngleRule:	return slopeAngle.data ();
+		case FlightSpacingRule:	return flightSpacing.data ();
+		default:				return nullptr;
+	}
+}
+
+void StairMetricsTable::SetMetrics (std::size_t row, const StairMetrics& metrics)
+{
+	riserHeight[row] = metrics.riserHeight;
+	treadDepth[row] = metrics.treadDepth;
+	minLandingLength[row] = metrics.landingEvaluated ? metrics.minLandingLength : 0.0;
+	twoRPlusGoing[row] = metrics.twoRPlusGoing;
+	narrowTreadDepth[row] = metrics.narrowTreadDepth;
+	riserVariation[row] = metrics.riserVariation;
+	clearWidth[row] = metrics.clearWidth;
+	handrailHeight[row] = metrics.handrailHeight;
+	slopeAngle[row] = metrics.slopeAngle;
+	flightSpacing[row] = metrics.flightSpacing;
+	landingEvaluated[row] = metrics.landingEvaluated ? 1 : 0;
+}
+
+StairMetrics StairMetricsTable::GetMetrics (std::size_t row) const
+{
+	StairMetrics metrics;
+	metrics.riserHeight = riserHeight[row];
+	metrics.treadDepth = treadDepth[row];
+	metrics.minLandingLength = minLandingLength[row];
+	metrics.twoRPlusGoing = twoRPlusGoing[row];
+	metrics.narrowTreadDepth = narrowTreadDepth[row];
+	metrics.riserVariation = riserVariation[row];
+	metrics.clearWidth = clearWidth[row];
+	metrics.handrailHeight = handrailHeight[row];
+	metrics.slopeAngle = slopeAngle[row];
+	metrics.flightSpacing = flightSpacing[row];
+	metrics.landingEvaluated = landingEvaluated[row] != 0;
+	return metrics;
+}
+
+StairEvaluation StairMetricsTable::GetEvaluation (std::size_t row) const
+{
+	StairEvaluation evaluation;
+	evaluation.metrics = GetMetrics (row);
+	evaluation.violationMask = violationMask[row];
+	return evaluation;
+}
+
+std::size_t StairMetricsTable::CountViolations () const
+{
+	return static_cast<std::size_t> (std::count_if (violationMask.begin (), violationMask.end (), [] (std::uint32_t mask) { return mask != 0; }));
+}
+
+void ApplyRuleOps (const RuleOp* ops, std::size_t count, StairMetricsTable& table, std::size_t begin, std::size_t end)
+{
+	const double* landing = table.minLandingLength.data ();
+	std::uint32_t* masks = table.violationMask.data ();
+
+	for (std::size_t k = 0; k < count; ++k) {
+		const RuleOp& op = ops[k];
+		const double* values = table.GetColumn (static_cast<RuleKind> (op.metric));
+		const std::uint32_t bit = op.violationBit;
+		std::size_t row = begin;
+
+#if STAIR_TABLE_USE_SSE2
+		// 不需要的前提用全1代替，循环内没有分支
+		const __m128d allOnes = _mm_castsi128_pd (_mm_set1_epi32 (-1));
+		const __m128d skipPositive = (op.guards & RequirePositiveMetric) != 0 ? _mm_setzero_pd () : allOnes;
+		const __m128d skipLanding = (op.guards & RequireLanding) != 0 ? _mm_setzero_pd () : allOnes;
+		const __m128d lower = _mm_set1_pd (op.lower);
+		const __m128d upper = _mm_set1_pd (op.upper);
+		const __m128d tolerance = _mm_set1_pd (op.tolerance);
+		const __m128d epsilon = _mm_set1_pd (kEpsilon);
+		const __m128d zero = _mm_setzero_pd ();
+
+		for (; row + 2 <= end; row += 2) {
+			const __m128d value = _mm_loadu_pd (values + row);
+			const __m128d outside = _mm_or_pd (_mm_cmpgt_pd (_mm_sub_pd (lower, value), tolerance), _mm_cmpgt_pd (_mm_sub_pd (value, upper), tolerance));
+			const __m128d positive = _mm_or_pd (_mm_cmpgt_pd (value, epsilon), skipPositive);
+			const __m128d hasLanding = _mm_or_pd (_mm_cmpgt_pd (_mm_loadu_pd (landing + row), zero), skipLanding);
+			const std::uint32_t lanes = static_cast<std::uint32_t> (_mm_movemask_pd (_mm_and_pd (outside, _mm_and_pd (positive, hasLanding))));
+			masks[row] |= bit & (0u - (lanes & 1u));
+			masks[row + 1] |= bit & (0u - (lanes >> 1));
+		}
+#endif
+
+		for (; row < end; ++row) {
+			const double value = values[row];
+			const std::uint32_t outside = static_cast<std::uint32_t> (op.lower - value > op.tolerance) | static_cast<std::uint32_t> (value - op.upper > op.tolerance);
+			const std::uint32_t satisfied = (static_cast<std::uint32_t> (value > kEpsilon) * RequirePositiveMetric) | (static_cast<std::uint32_t> (landing[row] > 0.0) * RequireLanding);
+			const std::uint32_t guarded = static_cast<std::uint32_t> ((op.guards & ~satisfied) == 0);
+			masks[row] |= bit & (0u - (outside & guarded));
+		}
+	}
+}
+
+static void ComputeTableRows (const std::vector<StairRecord>& stairs, StairMetricsTable& table, std::size_t begin, std::size_t end)
+{
+	for (std::size_t row = begin; row < end; ++row) {
+		table.SetMetrics (row, ComputeMetrics (stairs[row]));
+		table.floorIndex[row] = stairs[row].floorIndex;
+		table.violationMask[row] = 0;
+	}
+}
+
+template <typename Body>
+static void ForEachBlock (std::size_t rowCount, WorkStealingPool* pool, Body& body)
+{
+	if (pool != nullptr)
+		pool->ParallelFor (rowCount, kEvaluationGrainSize, body);
+	else
+		body (0, rowCount);
+}
+
+void EvaluateStairTable (const std::vector<StairRecord>& stairs, const RuleSet& ruleSet, StairMetricsTable& table, WorkStealingPool* pool)
+{
+	table.Resize (stairs.size ());
+
+	RuleOp ops[RuleKindCount];
+	const std::size_t opCount = CompileRuleSet (ruleSet, ops);
+
+	// 每个任务先算出本块的实测值，再趁数据还在缓存中按列检测
+	auto evaluateRange = [&] (std::size_t begin, std::size_t end) {
+		ComputeTableRows (stairs, table, begin, end);
+		ApplyRuleOps (ops, opCount, table, begin, end);
+	};
+	ForEachBlock (stairs.size (), pool, evaluateRange);
+}
+
+void EvaluateStairTable (const std::vector<StairRecord>& stairs, const RegulationLibrary& library, StairMetricsTable& table, WorkStealingPool* pool)
+{
+	table.Resize (stairs.size ());
+
+	auto evaluateRange = [&] (std::size_t begin, std::size_t end) {
+		ComputeTableRows (stairs, table, begin, end);
+
+		// 适用范围相同的相邻楼梯共用一组指令（项目只有一个适用范围时整块一次检测）
+		std::size_t runBegin = begin;
+		while (runBegin < end) {
+			const ResolvedRules& rules = library.Resolve (stairs[runBegin].context);
+			std::size_t runEnd = runBegin + 1;
+			while (runEnd < end && &library.Resolve (stairs[runEnd].context) == &rules)
+				++runEnd;
+
+			ApplyRuleOps (library.GetRuleOps (rules), rules.opCount, table, runBegin, runEnd);
+			runBegin = runEnd;
+		}
+	};
+	ForEachBlock (stairs.size (), pool, evaluateRange);
+}
+
+} // namespace StairCore
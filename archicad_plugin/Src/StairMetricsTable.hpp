@@ -0,0 +1,66 @@
+#ifndef STAIR_METRICS_TABLE_HPP
+#define STAIR_METRICS_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "StairEvaluationCore.hpp"
+#include "StairRuleProgram.hpp"
+
+/**
+ * 按列存放的楼梯实测值（与ArchiCAD无关）
+ *
+ * 批量检测时每个实测值一列，规则按列用SIMD比较，违规结果为每行一个位掩码；
+ * 提示信息只需为violationMask不为0的行生成。
+ * minLandingLength 在未评估平台时为0，因此"须找到平台段"的前提即为长度大于0。
+ * 端到端并不比逐个楼梯检测（EvaluateStairs）快，插件和命令行工具不使用，只在StairBench --table中对比。
+ */
+namespace StairCore {
+
+class WorkStealingPool;
+class RegulationLibrary;
+
+struct StairMetricsTable {
+	std::vector<double>			riserHeight;
+	std::vector<double>			treadDepth;
+	std::vector<double>			minLandingLength;
+	std::vector<double>			twoRPlusGoing;
+	std::vector<double>			narrowTreadDepth;
+	std::vector<double>			riserVariation;
+	std::vector<double>			clearWidth;
+	std::vector<double>			handrailHeight;
+	std::vector<double>			slopeAngle;
+	std::vector<double>			flightSpacing;
+	std::vector<short>			floorIndex;
+	std::vector<std::uint8_t>	landingEvaluated;
+	std::vector<std::uint32_t>	violationMask;
+
+	void				Resize (std::size_t rowCount);
+	std::size_t			GetRowCount () const { return violationMask.size (); }
+
+	// 规则类别对应的实测值列
+	const double*		GetColumn (RuleKind kind) const;
+
+	void				SetMetrics (std::size_t row, const StairMetrics& metrics);
+	StairMetrics		GetMetrics (std::size_t row) const;
+	StairEvaluation		GetEvaluation (std::size_t row) const;
+
+	std::size_t			CountViolations () const;
+};
+
+// 对[begin, end)行执行规则指令，结果按位或到violationMask
+void	ApplyRuleOps (const RuleOp* ops, std::size_t count, StairMetricsTable& table, std::size_t begin, std::size_t end);
+
+/**
+ * 计算实测值并检测，table的第i行对应stairs[i]。
+ * 按kEvaluationGrainSize分块执行，pool为空时在当前线程顺序执行
+ */
+void	EvaluateStairTable (const std::vector<StairRecord>& stairs, const RuleSet& ruleSet, StairMetricsTable& table, WorkStealingPool* pool);
+
+// 同上，每个楼梯使用规范库中与其context对应的规则（适用范围相同的相邻楼梯一起按列检测）
+void	EvaluateStairTable (const std::vector<StairRecord>& stairs, const RegulationLibrary& library, StairMetricsTable& table, WorkStealingPool* pool);
+
+} // namespace StairCore
+
+#endif
@@ -0,0 +1,74 @@
+#include "StairRailings.hpp"
+
+namespace StairCore {
+
+void RailingIndex::Build (const std::vector<RailingRecord>& records)
+{
+	Clear ();
+	spatialIndex.Reserve (records.size ());
+	railings.reserve (records.size ());
+	for (const RailingRecord& record : records)
+		Add (record);
+}
+
+void RailingIndex::Clear ()
+{
+	spatialIndex.Clear ();
+	railings.clear ();
+}
+
+std::uint32_t RailingIndex::Add (const RailingRecord& record)
+{
+	const std::uint32_t railing = spatialIndex.Insert (record.bounds);
+	if (railing >= railings.size ())
+		railings.resize (railing + 1);
+	railings[railing] = record;
+	return railing;
+}
+
+void RailingIndex::Update (std::uint32_t railing, const RailingRecord& record)
+{
+	if (!spatialIndex.IsValid (railing))
+		return;
+	spatialIndex.Update (railing, record.bounds);
+	railings[railing] = record;
+}
+
+void RailingIndex::Remove (std::uint32_t railing)
+{
+	spatialIndex.Remove (railing);
+}
+
+double RailingIndex::FindHandrailHeight (const StairRecord& stair) const
+{
+	if (spatialIndex.GetElementCount () == 0)
+		return 0.0;
+
+	ElementBounds bounds;
+	if (!ComputeStairBounds (stair, bounds))
+		return 0.0;
+	const ElementBounds area = bounds.Expanded (kRailingTolerance);
+
+	// 查询缓冲区按线程复用，并行评估时各线程互不干扰
+	thread_local std::vector<std::uint32_t> candidates;
+	candidates.clear ();
+	spatialIndex.Query (area, candidates);
+
+	double handrailHeight = 0.0;
+	for (const std::uint32_t candidate : candidates) {
+		const RailingRecord& railing = railings[candidate];
+		if (!area.Contains (railing.bounds) || railing.handrailHeight <= kEpsilon)
+			continue;
+		if (handrailHeight <= 0.0 || railing.handrailHeight < handrailHeight)
+			handrailHeight = railing.handrailHeight;
+	}
+	return handrailHeight;
+}
+
+void AssignHandrailHeights (std::vector<StairRecord>& stairs, const RailingIndex& index)
+{
+	for (StairRecord& stair : stairs)
+		stair.handrailHeight = index.FindHandrailHeight (stair);
+}
+
+} // namespace StairCore
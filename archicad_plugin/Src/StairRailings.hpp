@@ -0,0 +1,58 @@
+#ifndef STAIR_RAILINGS_HPP
+#define STAIR_RAILINGS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "StairEvaluationCore.hpp"
+#include "StairSpatialIndex.hpp"
+
+/**
+ * 栏杆与楼梯的空间关联（与ArchiCAD无关）
+ *
+ * 栏杆元素与楼梯之间没有直接的引用，按平面位置关联：同一楼层中平面包围盒落在楼梯包围盒
+ * （ComputeStairBounds，外扩kRailingTolerance）内的栏杆视为该楼梯的栏杆，取其中最低的扶手高度。
+ * 只部分落在楼梯范围内的栏杆（如相邻的走廊栏杆）不参与关联。
+ * 栏杆存放在SpatialIndex中，每个楼梯的查询只访问楼梯附近的网格；栏杆可单独增删改，无需重建。
+ */
+namespace StairCore {
+
+// 栏杆包围盒外扩量（米），栏杆通常沿边界布置，中心线可略超出楼梯边界
+constexpr double kRailingTolerance = 0.1;
+
+struct RailingRecord {
+	ElementBounds	bounds;
+	double			handrailHeight = 0.0;		// 扶手顶面距踏步前缘的高度
+};
+
+class RailingIndex {
+public:
+	// 重新构建时复用已分配的缓冲区；句柄即railings中的下标
+	void						Build (const std::vector<RailingRecord>& railings);
+	void						Clear ();
+
+	// 返回栏杆句柄
+	std::uint32_t				Add (const RailingRecord& railing);
+	void						Update (std::uint32_t railing, const RailingRecord& record);
+	void						Remove (std::uint32_t railing);
+
+	bool						IsEmpty () const			{ return spatialIndex.GetElementCount () == 0; }
+	std::size_t					GetRailingCount () const	{ return spatialIndex.GetElementCount (); }
+	bool						IsValid (std::uint32_t railing) const	{ return spatialIndex.IsValid (railing); }
+	const RailingRecord&		GetRailing (std::uint32_t railing) const	{ return railings[railing]; }
+
+	// 关联栏杆中最低的扶手高度，没有关联栏杆或楼梯没有几何数据时返回0
+	double						FindHandrailHeight (const StairRecord& stair) const;
+
+private:
+	SpatialIndex				spatialIndex;
+	std::vector<RailingRecord>	railings;		// 按句柄存放
+};
+
+// 为每个楼梯填写handrailHeight（覆盖原值）
+void	AssignHandrailHeights (std::vector<StairRecord>& stairs, const RailingIndex& index);
+
+} // namespace StairCore
+
+#endif
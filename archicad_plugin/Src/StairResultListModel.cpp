@@ -0,0 +1,126 @@
+#include "StairResultListModel.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace StairCore {
+
+void ResultListModel::SetEntries (std::vector<ResultListEntry>&& newEntries)
+{
+	entries = std::move (newEntries);
+	Rebuild ();
+}
+
+void ResultListModel::SetEntry (std::size_t index, const ResultListEntry& entry)
+{
+	entries[index] = entry;
+}
+
+void ResultListModel::AppendEntry (const ResultListEntry& entry)
+{
+	entries.push_back (entry);
+}
+
+bool ResultListModel::UpdateEntry (std::size_t index, const ResultListEntry& entry)
+{
+	ResultListEntry& current = entries[index];
+	const bool rowsUnchanged = entry.violationCount == current.violationCount && entry.floorIndex == current.floorIndex &&
+							   (sortKey != ResultSortKey::Name || entry.name == current.name);
+	current = entry;
+	return rowsUnchanged;
+}
+
+void ResultListModel::RemoveEntries (const std::vector<bool>& removed)
+{
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < entries.size (); ++i) {
+		if (i < removed.size () && removed[i])
+			continue;
+		if (kept != i)
+			entries[kept] = std::move (entries[i]);
+		++kept;
+	}
+	entries.resize (kept);
+}
+
+bool ResultListModel::IsShown (const ResultListEntry& entry) const
+{
+	if (violationsOnly && entry.violationCount == 0)
+		return false;
+	return storeyFilter == AllStoreys || entry.floorIndex == storeyFilter;
+}
+
+void ResultListModel::Rebuild ()
+{
+	std::vector<std::uint32_t> order;
+	order.reserve (entries.size ());
+	for (std::size_t i = 0; i < entries.size (); ++i) {
+		if (IsShown (entries[i]))
+			order.push_back (static_cast<std::uint32_t> (i));
+	}
+
+	// 稳定排序：键相同的结果保持检测顺序
+	if (sortKey == ResultSortKey::Name) {
+		std::stable_sort (order.begin (), order.end (), [this] (std::uint32_t a, std::uint32_t b) {
+			return sortDescending ? entries[b].name < entries[a].name : entries[a].name < entries[b].name;
+		});
+	} else if (sortKey == ResultSortKey::Violations) {
+		std::stable_sort (order.begin (), order.end (), [this] (std::uint32_t a, std::uint32_t b) {
+			return sortDescending ? entries[b].violationCount < entries[a].violationCount
+								  : entries[a].violationCount < entries[b].violationCount;
+		});
+	} else if (sortDescending) {
+		std::reverse (order.begin (), order.end ());
+	}
+
+	std::size_t rowCount = 0;
+	for (std::uint32_t result : order)
+		rowCount += 1 + entries[result].violationCount;
+
+	rows.clear ();
+	rows.reserve (rowCount);
+	resultRow.assign (entries.size (), NotFound);
+	for (std::uint32_t result : order) {
+		resultRow[result] = rows.size ();
+		for (std::uint32_t detail = 0; detail <= entries[result].violationCount; ++detail)
+			rows.push_back ({ result, detail });
+	}
+}
+
+void ResultListModel::SetViolationsOnly (bool newViolationsOnly)
+{
+	violationsOnly = newViolationsOnly;
+	Rebuild ();
+}
+
+void ResultListModel::SetStoreyFilter (short floorIndex)
+{
+	storeyFilter = floorIndex;
+	Rebuild ();
+}
+
+void ResultListModel::SetSort (ResultSortKey key, bool descending)
+{
+	sortKey = key;
+	sortDescending = descending;
+	Rebuild ();
+}
+
+std::size_t ResultListModel::FindResultRow (std::size_t result) const
+{
+	return result < resultRow.size () ? resultRow[result] : NotFound;
+}
+
+std::vector<short> ResultListModel::GetFloorIndices () const
+{
+	std::vector<short> floors;
+	floors.reserve (entries.size ());
+	for (const ResultListEntry& entry : entries)
+		floors.push_back (entry.floorIndex);
+
+	std::sort (floors.begin (), floors.end ());
+	floors.erase (std::unique (floors.begin (), floors.end ()), floors.end ());
+	return floors;
+}
+
+} // namespace StairCore
@@ -0,0 +1,90 @@
+#ifndef STAIR_RESULT_LIST_MODEL_HPP
+#define STAIR_RESULT_LIST_MODEL_HPP
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 检测结果列表的行模型（与ArchiCAD无关）
+ *
+ * 每个结果显示为一个楼梯行加每个违规项一行。模型只保存排序和筛选用的键，
+ * 筛选和排序后的行用 (结果索引, 违规项序号) 表示，每行8字节；
+ * 行的文字由面板在绘制可见窗口时按需生成，列表控件中只放可见窗口内的行。
+ */
+namespace StairCore {
+
+// 一个检测结果的排序和筛选键
+struct ResultListEntry {
+	std::wstring	name;
+	short			floorIndex = 0;
+	std::uint32_t	violationCount = 0;
+};
+
+// 显示行：detail为0表示楼梯行，k表示第k个违规项
+struct ResultListRow {
+	std::uint32_t	result = 0;
+	std::uint32_t	detail = 0;
+};
+
+enum class ResultSortKey {
+	Order,			// 检测顺序
+	Name,
+	Violations		// 违规项数量
+};
+
+class ResultListModel {
+public:
+	static constexpr short			AllStoreys = SHRT_MIN;
+	static constexpr std::size_t	NotFound = static_cast<std::size_t> (-1);
+
+	// 修改结果后须调用Rebuild；筛选和排序条件的设置函数会自动重建
+	void					SetEntries (std::vector<ResultListEntry>&& newEntries);
+	void					SetEntry (std::size_t index, const ResultListEntry& entry);
+	void					AppendEntry (const ResultListEntry& entry);
+	void					Rebuild ();
+
+	// 原位更新结果的键：行（筛选、排序、违规项行数）和楼层列表不变时返回true，无需Rebuild
+	bool					UpdateEntry (std::size_t index, const ResultListEntry& entry);
+
+	// 一次删除所有removed[i]为true的结果，其余结果保持顺序，之后须调用Rebuild
+	void					RemoveEntries (const std::vector<bool>& removed);
+
+	void					SetViolationsOnly (bool violationsOnly);
+	void					SetStoreyFilter (short floorIndex);
+	void					SetSort (ResultSortKey key, bool descending);
+
+	bool					IsViolationsOnly () const	{ return violationsOnly; }
+	short					GetStoreyFilter () const	{ return storeyFilter; }
+	ResultSortKey			GetSortKey () const			{ return sortKey; }
+	bool					IsSortDescending () const	{ return sortDescending; }
+
+	std::size_t				GetEntryCount () const		{ return entries.size (); }
+	const ResultListEntry&	GetEntry (std::size_t index) const	{ return entries[index]; }
+	std::size_t				GetRowCount () const		{ return rows.size (); }
+	const ResultListRow&	GetRow (std::size_t row) const	{ return rows[row]; }
+
+	// 结果的楼梯行在筛选后的行号，被筛选掉时返回NotFound
+	std::size_t				FindResultRow (std::size_t result) const;
+
+	// 所有结果涉及的楼层（升序，不受筛选影响）
+	std::vector<short>		GetFloorIndices () const;
+
+private:
+	bool					IsShown (const ResultListEntry& entry) const;
+
+	std::vector<ResultListEntry>	entries;
+	std::vector<ResultListRow>		rows;
+	std::vector<std::size_t>		resultRow;		// 每个结果的楼梯行号，NotFound表示被筛选掉
+
+	bool							violationsOnly = false;
+	short							storeyFilter = AllStoreys;
+	ResultSortKey					sortKey = ResultSortKey::Order;
+	bool							sortDescending = false;
+};
+
+} // namespace StairCore
+
+#endif
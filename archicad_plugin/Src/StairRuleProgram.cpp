@@ -0,0 +1,123 @@
+#include "StairRuleProgram.hpp"
+
+#include <limits>
+
+namespace StairCore {
+
+namespace {
+
+struct RuleCheck {
+	Comparator		comparator;
+	std::uint8_t	guards;
+};
+
+const RuleCheck kRuleChecks[RuleKindCount] = {
+	{ Comparator::AtMost,	NoGuard },					// RiserHeightRule
+	{ Comparator::AtLeast,	RequirePositiveMetric },	// TreadDepthRule
+	{ Comparator::AtLeast,	RequireLanding },			// LandingLengthRule
+	{ Comparator::Between,	NoGuard },					// TwoRPlusGoingRule
+	{ Comparator::AtLeast,	RequirePositiveMetric },	// NarrowTreadDepthRule
+	{ Comparator::AtMost,	NoGuard },					// RiserVariationRule
+	{ Comparator::AtLeast,	RequirePositiveMetric },	// StairWidthRule
+	{ Comparator::AtLeast,	RequirePositiveMetric },	// HandrailHeightRule
+	{ Comparator::AtMost,	RequirePositiveMetric },	// SlopeAngleRule
+	{ Comparator::AtLeast,	RequirePositiveMetric }		// FlightSpacingRule
+};
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity ();
+
+} // namespace
+
+RuleDefinition MakeRuleDefinition (RuleKind kind, const RuleLimits& limits)
+{
+	RuleDefinition definition;
+	if (kind >= RuleKindCount) {
+		definition.enabled = false;
+		return definition;
+	}
+
+	const RuleCheck& check = kRuleChecks[kind];
+	definition.metric = kind;
+	definition.comparator = check.comparator;
+	definition.guards = check.guards;
+	definition.minValue = limits.minValue.value_or (0.0);
+	definition.maxValue = limits.maxValue.value_or (0.0);
+
+	const bool hasMin = limits.minValue.has_value ();
+	const bool hasMax = limits.maxValue.has_value ();
+	switch (check.comparator) {
+		case Comparator::AtMost:	definition.enabled = limits.enabled && hasMax; break;
+		case Comparator::AtLeast:	definition.enabled = limits.enabled && hasMin; break;
+		case Comparator::Between:	definition.enabled = limits.enabled && hasMin && hasMax; break;
+	}
+	return definition;
+}
+
+bool CompileRule (const RuleDefinition& definition, RuleOp& op)
+{
+	if (!definition.enabled || definition.metric >= RuleKindCount)
+		return false;
+
+	op.lower = -kInfinity;
+	op.upper = kInfinity;
+	if (definition.comparator != Comparator::AtMost)
+		op.lower = definition.minValue;
+	if (definition.comparator != Comparator::AtLeast)
+		op.upper = definition.maxValue;
+
+	op.tolerance = definition.tolerance;
+	op.violationBit = 1u << definition.metric;
+	op.metric = static_cast<std::uint8_t> (definition.metric);
+	op.guards = definition.guards;
+	return true;
+}
+
+std::size_t CompileRuleSet (const RuleSet& ruleSet, RuleOp* ops)
+{
+	std::size_t count = 0;
+	for (std::uint32_t kind = 0; kind < RuleKindCount; ++kind) {
+		if (CompileRule (MakeRuleDefinition (static_cast<RuleKind> (kind), ruleSet.rules[kind]), ops[count]))
+			++count;
+	}
+	return count;
+}
+
+namespace {
+
+// 按RuleKind排列的实测值及其满足的前提，每个楼梯只计算一次
+struct MetricInputs {
+	double			values[RuleKindCount];
+	std::uint32_t	guards[RuleKindCount];
+
+	explicit MetricInputs (const StairMetrics& metrics) :
+		values { metrics.riserHeight, metrics.treadDepth, metrics.minLandingLength, metrics.twoRPlusGoing, metrics.narrowTreadDepth, metrics.riserVariation,
+			metrics.clearWidth, metrics.handrailHeight, metrics.slopeAngle, metrics.flightSpacing }
+	{
+		const std::uint32_t landingGuard = static_cast<std::uint32_t> (metrics.landingEvaluated && metrics.minLandingLength > 0.0) * RequireLanding;
+		for (std::uint32_t kind = 0; kind < RuleKindCount; ++kind)
+			guards[kind] = landingGuard | (static_cast<std::uint32_t> (values[kind] > kEpsilon) * RequirePositiveMetric);
+	}
+
+	// 按位组合比较结果，循环体内没有条件跳转
+	bool IsViolated (const RuleOp& op) const
+	{
+		const double value = values[op.metric];
+		const std::uint32_t outside = static_cast<std::uint32_t> (op.lower - value > op.tolerance) | static_cast<std::uint32_t> (value - op.upper > op.tolerance);
+		const std::uint32_t guarded = static_cast<std::uint32_t> ((op.guards & ~guards[op.metric]) == 0);
+		return (outside & guarded) != 0;
+	}
+};
+
+} // namespace
+
+std::uint32_t RunRuleOps (const RuleOp* ops, std::size_t count, const StairMetrics& metrics)
+{
+	const MetricInputs inputs (metrics);
+
+	std::uint32_t mask = 0;
+	for (std::size_t i = 0; i < count; ++i)
+		mask |= ops[i].violationBit & (0u - static_cast<std::uint32_t> (inputs.IsViolated (ops[i])));
+	return mask;
+}
+
+} // namespace StairCore
@@ -0,0 +1,71 @@
+#ifndef STAIR_RULE_PROGRAM_HPP
+#define STAIR_RULE_PROGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "StairEvaluationCore.hpp"
+
+/**
+ * 数据驱动的规则检测（与ArchiCAD无关）
+ *
+ * 每条规则是一组数据：实测值、比较方式、限值和容差。
+ * 规则集编译一次为扁平的RuleOp数组，检测时对每个楼梯只做一次无分支的循环：
+ * 缺少的限值编译为无穷大，未启用的规则不生成指令。
+ */
+namespace StairCore {
+
+enum class Comparator : std::uint8_t {
+	AtMost,		// 不大于maxValue
+	AtLeast,	// 不小于minValue
+	Between		// 在[minValue, maxValue]内，需同时设置上下限
+};
+
+// 规则前提：不满足时跳过规则（不算违规）
+enum RuleGuard : std::uint8_t {
+	NoGuard					= 0,
+	RequirePositiveMetric	= 1,	// 实测值大于kEpsilon（某些楼梯类型无法获取该值，为0）
+	RequireLanding			= 2		// 找到了长度大于0的平台段
+};
+
+struct RuleDefinition {
+	RuleKind		metric = RuleKindCount;		// 实测值，违规时在结果中置位的规则类别
+	Comparator		comparator = Comparator::AtMost;
+	double			minValue = 0.0;
+	double			maxValue = 0.0;
+	double			tolerance = kEpsilon;
+	std::uint8_t	guards = NoGuard;
+	bool			enabled = true;
+};
+
+// 编译后的一条规则：lower - 实测值 > tolerance 或 实测值 - upper > tolerance 时违规
+struct RuleOp {
+	double			lower;
+	double			upper;
+	double			tolerance;
+	std::uint32_t	violationBit;
+	std::uint8_t	metric;
+	std::uint8_t	guards;
+};
+
+/**
+ * 每类规则的默认检测方式：
+ *   踏步高度 AtMost，踏步宽度 AtLeast（实测值须大于0），平台长度 AtLeast（须找到平台段），2R+G Between，
+ *   踏步窄端宽度 AtLeast（实测值须大于0，即有边界数据），踢面高度差 AtMost，
+ *   梯段净宽、扶手高度、梯段间距 AtLeast，坡度 AtMost（均须实测值大于0，即能够测量）
+ * 限值取自limits，缺少所需限值时enabled为false
+ */
+RuleDefinition	MakeRuleDefinition (RuleKind kind, const RuleLimits& limits);
+
+// 编译单条规则，未启用或限值不完整时返回false
+bool			CompileRule (const RuleDefinition& definition, RuleOp& op);
+
+// 把RuleSet编译到ops（容量至少RuleKindCount），返回指令数
+std::size_t		CompileRuleSet (const RuleSet& ruleSet, RuleOp* ops);
+
+// 执行指令，返回违规规则类别的位掩码
+std::uint32_t	RunRuleOps (const RuleOp* ops, std::size_t count, const StairMetrics& metrics);
+
+} // namespace StairCore
+
+#endif
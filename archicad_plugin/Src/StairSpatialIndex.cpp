@@ -0,0 +1,274 @@
+#include "StairSpatialIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "StairWalkingLine.hpp"
+
+namespace StairCore {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// 覆盖网格数超过此值的元素放入楼层的大元素表
+constexpr std::int64_t kMaxElementCells = 64;
+
+// 网格坐标限制在24位有符号整数范围内，与楼层一起组成64位键
+constexpr std::int64_t kMaxCellCoordinate = (1 << 23) - 1;
+
+// 圆弧中点只在弦高可能超过此值（米）时计算
+constexpr double kArcBulgeTolerance = 0.05;
+
+void AddPoint (const Point2D& point, bool& empty, ElementBounds& bounds)
+{
+	if (empty) {
+		bounds.minX = bounds.maxX = point.x;
+		bounds.minY = bounds.maxY = point.y;
+		empty = false;
+		return;
+	}
+	bounds.minX = std::min (bounds.minX, point.x);
+	bounds.minY = std::min (bounds.minY, point.y);
+	bounds.maxX = std::max (bounds.maxX, point.x);
+	bounds.maxY = std::max (bounds.maxY, point.y);
+}
+
+// 折线顶点和圆弧中点（圆弧外凸最多的位置）；弦高较小的圆弧只取顶点
+void AddPolyline (const std::vector<Point2D>& points, const std::vector<ArcRecord>& arcs, bool& empty, ElementBounds& bounds)
+{
+	for (const Point2D& point : points)
+		AddPoint (point, empty, bounds);
+
+	for (const ArcRecord& arc : arcs) {
+		if (arc.begIndex < 0 || arc.endIndex < 0)
+			continue;
+		const std::size_t begIndex = static_cast<std::size_t> (arc.begIndex);
+		const std::size_t endIndex = static_cast<std::size_t> (arc.endIndex);
+		if (begIndex >= points.size () || endIndex >= points.size ())
+			continue;
+
+		// 圆心角不超过180度时弦高 = 弦长/2·tan(|θ|/4) ≤ 0.16·弦长·|θ|
+		const Point2D& start = points[begIndex];
+		const Point2D& end = points[endIndex];
+		const double angle = std::fabs (arc.arcAngle);
+		const double chord = std::sqrt ((end.x - start.x) * (end.x - start.x) + (end.y - start.y) * (end.y - start.y));
+		if (angle <= kPi && 0.16 * chord * angle <= kArcBulgeTolerance)
+			continue;
+		AddPoint (PointOnArc (start, end, arc.arcAngle, 0.5), empty, bounds);
+	}
+}
+
+void EraseElement (std::vector<std::uint32_t>& elements, std::uint32_t element)
+{
+	const auto it = std::find (elements.begin (), elements.end (), element);
+	if (it == elements.end ())
+		return;
+	*it = elements.back ();
+	elements.pop_back ();
+}
+
+} // namespace
+
+bool ElementBounds::Intersects (const ElementBounds& other) const
+{
+	return floorIndex == other.floorIndex &&
+		minX <= other.maxX && other.minX <= maxX &&
+		minY <= other.maxY && other.minY <= maxY;
+}
+
+bool ElementBounds::Contains (const ElementBounds& other) const
+{
+	return floorIndex == other.floorIndex &&
+		other.minX >= minX && other.maxX <= maxX &&
+		other.minY >= minY && other.maxY <= maxY;
+}
+
+ElementBounds ElementBounds::Expanded (double margin) const
+{
+	ElementBounds bounds = *this;
+	bounds.minX -= margin;
+	bounds.minY -= margin;
+	bounds.maxX += margin;
+	bounds.maxY += margin;
+	return bounds;
+}
+
+bool ComputeStairBounds (const StairRecord& stair, ElementBounds& bounds)
+{
+	// 有边界数据时步行线位于边界之间，只取边界
+	bool empty = true;
+	for (const BoundaryRecord& boundary : stair.boundaries)
+		AddPolyline (boundary.points, boundary.arcs, empty, bounds);
+	if (empty)
+		AddPolyline (stair.walkingLine, stair.walkingLineArcs, empty, bounds);
+
+	bounds.floorIndex = stair.floorIndex;
+	return !empty;
+}
+
+SpatialIndex::SpatialIndex (double size) :
+	inverseCellSize (1.0 / (size > 0.0 ? size : kSpatialCellSize))
+{
+}
+
+void SpatialIndex::Clear ()
+{
+	entries.clear ();
+	freeElements.clear ();
+	elementCount = 0;
+	cells.clear ();
+	largeElements.clear ();
+}
+
+void SpatialIndex::Reserve (std::size_t count)
+{
+	entries.reserve (count);
+	cells.reserve (count);
+}
+
+std::uint32_t SpatialIndex::Insert (const ElementBounds& bounds)
+{
+	std::uint32_t element;
+	if (!freeElements.empty ()) {
+		element = freeElements.back ();
+		freeElements.pop_back ();
+	} else {
+		element = static_cast<std::uint32_t> (entries.size ());
+		entries.emplace_back ();
+	}
+
+	entries[element].bounds = bounds;
+	entries[element].live = true;
+	++elementCount;
+	Link (element);
+	return element;
+}
+
+void SpatialIndex::Update (std::uint32_t element, const ElementBounds& bounds)
+{
+	if (!IsValid (element))
+		return;
+
+	Unlink (element);
+	entries[element].bounds = bounds;
+	Link (element);
+}
+
+void SpatialIndex::Remove (std::uint32_t element)
+{
+	if (!IsValid (element))
+		return;
+
+	Unlink (element);
+	entries[element].live = false;
+	freeElements.push_back (element);
+	--elementCount;
+}
+
+bool SpatialIndex::IsValid (std::uint32_t element) const
+{
+	return element < entries.size () && entries[element].live;
+}
+
+void SpatialIndex::Query (const ElementBounds& box, std::vector<std::uint32_t>& elements) const
+{
+	const auto large = largeElements.find (box.floorIndex);
+	if (large != largeElements.end ()) {
+		for (const std::uint32_t element : large->second) {
+			if (entries[element].bounds.Intersects (box))
+				elements.push_back (element);
+		}
+	}
+
+	// 查询框覆盖的网格多于元素数时直接逐个比较
+	const CellRange range = GetCellRange (box);
+	const std::int64_t cellCount = (range.maxX - range.minX + 1) * (range.maxY - range.minY + 1);
+	if (cellCount > static_cast<std::int64_t> (elementCount)) {
+		for (std::uint32_t element = 0; element < entries.size (); ++element) {
+			const Entry& entry = entries[element];
+			if (entry.live && !entry.large && entry.bounds.Intersects (box))
+				elements.push_back (element);
+		}
+		return;
+	}
+
+	for (std::int64_t x = range.minX; x <= range.maxX; ++x) {
+		for (std::int64_t y = range.minY; y <= range.maxY; ++y) {
+			const auto cell = cells.find (MakeCellKey (box.floorIndex, x, y));
+			if (cell == cells.end ())
+				continue;
+
+			for (const std::uint32_t element : cell->second) {
+				const ElementBounds& bounds = entries[element].bounds;
+				if (!bounds.Intersects (box))
+					continue;
+				// 元素位于多个网格中，只在重叠区域左下角所在的网格中输出一次
+				if (ToCell (std::max (bounds.minX, box.minX)) == x && ToCell (std::max (bounds.minY, box.minY)) == y)
+					elements.push_back (element);
+			}
+		}
+	}
+}
+
+std::int64_t SpatialIndex::ToCell (double coordinate) const
+{
+	const double cell = std::floor (coordinate * inverseCellSize);
+	if (!(cell > -static_cast<double> (kMaxCellCoordinate)))
+		return -kMaxCellCoordinate;
+	if (cell > static_cast<double> (kMaxCellCoordinate))
+		return kMaxCellCoordinate;
+	return static_cast<std::int64_t> (cell);
+}
+
+SpatialIndex::CellRange SpatialIndex::GetCellRange (const ElementBounds& bounds) const
+{
+	return { ToCell (bounds.minX), ToCell (bounds.minY), ToCell (bounds.maxX), ToCell (bounds.maxY) };
+}
+
+std::uint64_t SpatialIndex::MakeCellKey (short floorIndex, std::int64_t x, std::int64_t y)
+{
+	return (static_cast<std::uint64_t> (static_cast<std::uint16_t> (floorIndex)) << 48) |
+		((static_cast<std::uint64_t> (x) & 0xFFFFFFu) << 24) |
+		(static_cast<std::uint64_t> (y) & 0xFFFFFFu);
+}
+
+void SpatialIndex::Link (std::uint32_t element)
+{
+	Entry& entry = entries[element];
+	const CellRange range = GetCellRange (entry.bounds);
+	entry.large = (range.maxX - range.minX + 1) * (range.maxY - range.minY + 1) > kMaxElementCells;
+	if (entry.large) {
+		largeElements[entry.bounds.floorIndex].push_back (element);
+		return;
+	}
+
+	for (std::int64_t x = range.minX; x <= range.maxX; ++x) {
+		for (std::int64_t y = range.minY; y <= range.maxY; ++y)
+			cells[MakeCellKey (entry.bounds.floorIndex, x, y)].push_back (element);
+	}
+}
+
+void SpatialIndex::Unlink (std::uint32_t element)
+{
+	const Entry& entry = entries[element];
+	if (entry.large) {
+		const auto large = largeElements.find (entry.bounds.floorIndex);
+		if (large != largeElements.end ())
+			EraseElement (large->second, element);
+		return;
+	}
+
+	// 空网格保留，元素移回时无需重新分配
+	const CellRange range = GetCellRange (entry.bounds);
+	for (std::int64_t x = range.minX; x <= range.maxX; ++x) {
+		for (std::int64_t y = range.minY; y <= range.maxY; ++y) {
+			const auto cell = cells.find (MakeCellKey (entry.bounds.floorIndex, x, y));
+			if (cell != cells.end ())
+				EraseElement (cell->second, element);
+		}
+	}
+}
+
+} // namespace StairCore
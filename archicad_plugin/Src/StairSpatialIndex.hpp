@@ -0,0 +1,93 @@
+#ifndef STAIR_SPATIAL_INDEX_HPP
+#define STAIR_SPATIAL_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "StairEvaluationCore.hpp"
+
+/**
+ * 按楼层划分的平面网格索引（与ArchiCAD无关）
+ *
+ * 楼梯、栏杆等元素的平面包围盒按楼层放入均匀网格（边长默认kSpatialCellSize），查询只访问与查询框
+ * 重叠的网格，与项目中的元素总数无关。覆盖网格过多的元素（如贯穿整层的走廊栏杆）
+ * 单独存放在所在楼层的大元素表中，每次查询时逐个比较。
+ * 元素以句柄表示，可单独插入、更新和删除，元素变化时无需重建索引；删除的句柄被复用。
+ * 查询不修改索引，多个线程可以同时查询，但不能与修改同时进行。
+ */
+namespace StairCore {
+
+// 网格边长（米），与常见楼梯的平面尺寸相当
+constexpr double kSpatialCellSize = 4.0;
+
+constexpr std::uint32_t kNoElement = 0xFFFFFFFFu;
+
+struct ElementBounds {
+	short	floorIndex = 0;
+	double	minX = 0.0;
+	double	minY = 0.0;
+	double	maxX = 0.0;
+	double	maxY = 0.0;
+
+	// 同一楼层且平面包围盒相交（含边界相接）
+	bool	Intersects (const ElementBounds& other) const;
+	// other 的平面范围完全位于本包围盒内，且在同一楼层
+	bool	Contains (const ElementBounds& other) const;
+	// 各方向外扩margin
+	ElementBounds	Expanded (double margin) const;
+};
+
+// 楼梯的平面包围盒：左右边界的顶点和外凸较多的圆弧中点，没有边界数据时取步行线；没有几何数据时返回false
+bool	ComputeStairBounds (const StairRecord& stair, ElementBounds& bounds);
+
+class SpatialIndex {
+public:
+	explicit SpatialIndex (double size = kSpatialCellSize);
+
+	void					Clear ();
+	void					Reserve (std::size_t count);
+
+	// 返回新元素的句柄
+	std::uint32_t			Insert (const ElementBounds& bounds);
+	// 元素移动或所在楼层变化，句柄不变
+	void					Update (std::uint32_t element, const ElementBounds& bounds);
+	void					Remove (std::uint32_t element);
+
+	bool					IsValid (std::uint32_t element) const;
+	const ElementBounds&	GetBounds (std::uint32_t element) const		{ return entries[element].bounds; }
+	std::size_t				GetElementCount () const					{ return elementCount; }
+
+	// 与box相交的元素句柄追加到elements，每个元素只出现一次
+	void					Query (const ElementBounds& box, std::vector<std::uint32_t>& elements) const;
+
+private:
+	struct Entry {
+		ElementBounds	bounds;
+		bool			live = false;
+		bool			large = false;		// 存放在楼层的大元素表中
+	};
+
+	struct CellRange {
+		std::int64_t	minX, minY, maxX, maxY;
+	};
+
+	std::int64_t			ToCell (double coordinate) const;
+	CellRange				GetCellRange (const ElementBounds& bounds) const;
+	static std::uint64_t	MakeCellKey (short floorIndex, std::int64_t x, std::int64_t y);
+
+	void					Link (std::uint32_t element);
+	void					Unlink (std::uint32_t element);
+
+	double														inverseCellSize;	// 网格边长的倒数
+	std::vector<Entry>											entries;		// 按句柄存放
+	std::vector<std::uint32_t>									freeElements;
+	std::size_t													elementCount = 0;
+	std::unordered_map<std::uint64_t, std::vector<std::uint32_t>>	cells;			// 键为楼层和网格坐标
+	std::unordered_map<short, std::vector<std::uint32_t>>			largeElements;	// 按楼层
+};
+
+} // namespace StairCore
+
+#endif
@@ -0,0 +1,119 @@
+#include "StairTrace.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace StairTrace {
+
+namespace {
+
+constexpr std::size_t kMaxMessageLength = 2048;
+
+std::mutex					g_mutex;
+Sink						g_sink = nullptr;
+std::vector<std::string>	g_ring;
+std::size_t					g_ringNext = 0;
+std::size_t					g_ringCount = 0;
+
+#if STAIR_TRACE_RING_CAPACITY > 0
+struct RingBufferInitializer {
+	RingBufferInitializer ()
+	{
+		g_ring.resize (static_cast<std::size_t> (STAIR_TRACE_RING_CAPACITY));
+	}
+};
+
+static RingBufferInitializer g_ringInitializer;
+#endif
+
+} // namespace
+
+void SetSink (Sink sink)
+{
+	std::lock_guard<std::mutex> lock (g_mutex);
+	g_sink = sink;
+}
+
+void Write (const char* format, ...)
+{
+	char buffer[kMaxMessageLength];
+
+	va_list args;
+	va_start (args, format);
+	const int length = std::vsnprintf (buffer, sizeof (buffer), format, args);
+	va_end (args);
+
+	if (length < 0)
+		return;
+
+	std::lock_guard<std::mutex> lock (g_mutex);
+	if (!g_ring.empty ()) {
+		g_ring[g_ringNext].assign (buffer);
+		g_ringNext = (g_ringNext + 1) % g_ring.size ();
+		if (g_ringCount < g_ring.size ())
+			++g_ringCount;
+		return;
+	}
+
+	if (g_sink != nullptr)
+		g_sink (buffer);
+}
+
+void EnableRingBuffer (std::size_t capacity)
+{
+	std::lock_guard<std::mutex> lock (g_mutex);
+	g_ring.assign (capacity, std::string ());
+	g_ringNext = 0;
+	g_ringCount = 0;
+}
+
+void DisableRingBuffer ()
+{
+	std::lock_guard<std::mutex> lock (g_mutex);
+	g_ring.clear ();
+	g_ring.shrink_to_fit ();
+	g_ringNext = 0;
+	g_ringCount = 0;
+}
+
+bool IsRingBufferEnabled ()
+{
+	std::lock_guard<std::mutex> lock (g_mutex);
+	return !g_ring.empty ();
+}
+
+std::size_t DumpRingBuffer ()
+{
+	std::vector<std::string> entries;
+	Sink sink = nullptr;
+	{
+		std::lock_guard<std::mutex> lock (g_mutex);
+		if (g_ring.empty () || g_ringCount == 0)
+			return 0;
+
+		// 最早的一条位于 g_ringNext - g_ringCount
+		entries.reserve (g_ringCount);
+		const std::size_t first = (g_ringNext + g_ring.size () - g_ringCount) % g_ring.size ();
+		for (std::size_t i = 0; i < g_ringCount; ++i) {
+			std::string& entry = g_ring[(first + i) % g_ring.size ()];
+			entries.push_back (std::move (entry));
+			entry.clear ();
+		}
+
+		g_ringNext = 0;
+		g_ringCount = 0;
+		sink = g_sink;
+	}
+
+	if (sink != nullptr) {
+		for (const std::string& entry : entries)
+			sink (entry.c_str ());
+	}
+
+	return entries.size ();
+}
+
+} // namespace StairTrace
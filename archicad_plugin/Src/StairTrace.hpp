@@ -0,0 +1,68 @@
+#ifndef STAIR_TRACE_HPP
+#define STAIR_TRACE_HPP
+
+#include <cstddef>
+
+/**
+ * 检测过程跟踪（调试输出）
+ *
+ * 跟踪级别在编译期确定（STAIR_TRACE_LEVEL），低于该级别的跟踪宏展开为空操作，
+ * 参数表达式（包括字符串格式化）不会被求值。
+ *   0 = 关闭
+ *   1 = 汇总（每次检测一条）
+ *   2 = 逐楼梯（每个楼梯的实测数据）
+ *   3 = 逐规则（每条规则的比较过程）
+ */
+#define STAIR_TRACE_LEVEL_OFF			0
+#define STAIR_TRACE_LEVEL_SUMMARY		1
+#define STAIR_TRACE_LEVEL_PER_STAIR		2
+#define STAIR_TRACE_LEVEL_PER_RULE		3
+
+#ifndef STAIR_TRACE_LEVEL
+#define STAIR_TRACE_LEVEL STAIR_TRACE_LEVEL_SUMMARY
+#endif
+
+// 环形缓冲区默认容量（条），0表示默认不启用
+#ifndef STAIR_TRACE_RING_CAPACITY
+#define STAIR_TRACE_RING_CAPACITY 0
+#endif
+
+namespace StairTrace {
+
+// 输出目标，text为UTF-8编码
+typedef void (*Sink) (const char* text);
+
+void		SetSink (Sink sink);
+
+// printf风格格式化（UTF-8），写入环形缓冲区（若启用）或直接输出到sink
+void		Write (const char* format, ...);
+
+// 启用后跟踪消息只保存在内存中，保留最近capacity条
+void		EnableRingBuffer (std::size_t capacity);
+void		DisableRingBuffer ();
+bool		IsRingBufferEnabled ();
+
+// 按时间顺序把缓冲区内容输出到sink并清空，返回输出的条数
+std::size_t	DumpRingBuffer ();
+
+} // namespace StairTrace
+
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_SUMMARY
+#define STAIR_TRACE_SUMMARY(...)	StairTrace::Write (__VA_ARGS__)
+#else
+#define STAIR_TRACE_SUMMARY(...)	((void) 0)
+#endif
+
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_STAIR
+#define STAIR_TRACE_STAIR(...)		StairTrace::Write (__VA_ARGS__)
+#else
+#define STAIR_TRACE_STAIR(...)		((void) 0)
+#endif
+
+#if STAIR_TRACE_LEVEL >= STAIR_TRACE_LEVEL_PER_RULE
+#define STAIR_TRACE_RULE(...)		StairTrace::Write (__VA_ARGS__)
+#else
+#define STAIR_TRACE_RULE(...)		((void) 0)
+#endif
+
+#endif
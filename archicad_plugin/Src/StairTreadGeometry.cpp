@@ -0,0 +1,425 @@
+#include "StairTreadGeometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "StairWalkingLine.hpp"
+
+namespace StairCore {
+
+namespace {
+
+// 边界折线每kBlockSize条线段一组的包围盒，求交时跳过不可能更近的分组
+constexpr std::size_t kBlockSize = 16;
+
+struct BoundaryBlock {
+	double		minX, minY, maxX, maxY;
+	std::size_t	firstEdge;
+	std::size_t	endEdge;
+};
+
+struct FlatBoundary {
+	std::vector<Point2D>		points;		// 圆弧离散后的边界折线
+	std::vector<BoundaryBlock>	blocks;
+	std::size_t					hint = 0;	// 上一个交点所在的分组，相邻踢面线的交点通常在同一组
+};
+
+// 梯段轮廓每kOutlineBlockSize段一组的包围盒，计算梯段间距时跳过不可能更近的分组
+constexpr std::size_t kOutlineBlockSize = 4;
+
+// 梯段的踢面线与两侧边界的交点：stations[side] 中的 [firstStation, endStation)，
+// 两侧的分组为 outlineBlocks[side] 中的 [firstBlock, endBlock)
+struct FlightOutline {
+	std::size_t		firstStation;
+	std::size_t		endStation;
+	std::size_t		firstBlock;
+	std::size_t		endBlock;
+	Point2D			direction;		// 梯段起点到终点的单位向量
+	BoundaryBlock	bounds;			// 两侧交点的包围盒
+};
+
+// 每个线程复用的临时数据
+struct TreadScratch {
+	WalkingLineArcIndex			arcIndex;
+	FlatBoundary				boundaries[2];
+	std::vector<Point2D>		stations[2];
+	std::vector<BoundaryBlock>	outlineBlocks[2];
+	std::vector<FlightOutline>	flights;
+	std::vector<double>			levels;
+};
+
+void FlattenBoundary (const BoundaryRecord& boundary, WalkingLineArcIndex& arcIndex, FlatBoundary& flat)
+{
+	std::vector<Point2D>& points = flat.points;
+	points.clear ();
+	flat.blocks.clear ();
+	flat.hint = 0;
+	if (boundary.points.size () < 2)
+		return;
+
+	arcIndex.Build (boundary.points.size (), boundary.arcs);
+	points.push_back (boundary.points[0]);
+	for (std::size_t edge = 0; edge + 1 < boundary.points.size (); ++edge) {
+		const double arcAngle = arcIndex.GetArcAngle (edge);
+		const std::size_t steps = std::fabs (arcAngle) > kEpsilon ? static_cast<std::size_t> (std::ceil (std::fabs (arcAngle) / kBoundaryArcStep)) : 1;
+		for (std::size_t step = 1; step < steps; ++step)
+			points.push_back (PointOnArc (boundary.points[edge], boundary.points[edge + 1], arcAngle, static_cast<double> (step) / static_cast<double> (steps)));
+		points.push_back (boundary.points[edge + 1]);
+	}
+
+	for (std::size_t first = 0; first + 1 < points.size (); first += kBlockSize) {
+		const std::size_t end = std::min (first + kBlockSize, points.size () - 1);
+		BoundaryBlock block = { points[first].x, points[first].y, points[first].x, points[first].y, first, end };
+		for (std::size_t i = first + 1; i <= end; ++i) {
+			block.minX = std::min (block.minX, points[i].x);
+			block.minY = std::min (block.minY, points[i].y);
+			block.maxX = std::max (block.maxX, points[i].x);
+			block.maxY = std::max (block.maxY, points[i].y);
+		}
+		flat.blocks.push_back (block);
+	}
+}
+
+double Cross (double ax, double ay, double bx, double by)
+{
+	return ax * by - ay * bx;
+}
+
+// 直线 origin + t * normal 与 [firstEdge, endEdge) 中线段的交点，只保留|t|比nearest小的
+void IntersectEdges (const std::vector<Point2D>& points, std::size_t firstEdge, std::size_t endEdge, const Point2D& origin, const Point2D& normal, bool& found, double& nearest)
+{
+	// 踢面线常恰好经过边界端点，端点处放宽舍入误差
+	constexpr double kSideTolerance = 1e-9;
+
+	// 顶点到直线的有向距离，线段两端异号（或在直线上）时才求交点
+	double side = Cross (normal.x, normal.y, points[firstEdge].x - origin.x, points[firstEdge].y - origin.y);
+	for (std::size_t i = firstEdge; i < endEdge; ++i) {
+		const double px = points[i + 1].x - origin.x;
+		const double py = points[i + 1].y - origin.y;
+		const double nextSide = Cross (normal.x, normal.y, px, py);
+		const bool crosses = (side <= kSideTolerance && nextSide >= -kSideTolerance) || (side >= -kSideTolerance && nextSide <= kSideTolerance);
+		const double denominator = side - nextSide;
+		if (crosses && std::fabs (denominator) > 1e-12) {
+			// 交点在线段上的比例为 side / (side - nextSide)
+			const double u = side / denominator;
+			const double ax = points[i].x - origin.x;
+			const double ay = points[i].y - origin.y;
+			const double t = normal.x * (ax + (px - ax) * u) + normal.y * (ay + (py - ay) * u);
+			if (!found || std::fabs (t) < std::fabs (nearest)) {
+				nearest = t;
+				found = true;
+			}
+		}
+		side = nextSide;
+	}
+}
+
+// 包围盒是否可能含有比|t| = reach更近的交点：直线须穿过包围盒，且origin到包围盒的距离小于reach
+bool MayContainCloser (const BoundaryBlock& block, const Point2D& origin, const Point2D& normal, bool found, double reach)
+{
+	const double x0 = block.minX - origin.x;
+	const double x1 = block.maxX - origin.x;
+	const double y0 = block.minY - origin.y;
+	const double y1 = block.maxY - origin.y;
+
+	// 四个角点在直线同一侧时不相交（角点恰在直线上时按相交处理）
+	constexpr double kSideTolerance = 1e-9;
+	const double c00 = Cross (normal.x, normal.y, x0, y0);
+	const double c01 = Cross (normal.x, normal.y, x0, y1);
+	const double c10 = Cross (normal.x, normal.y, x1, y0);
+	const double c11 = Cross (normal.x, normal.y, x1, y1);
+	if (std::min ({ c00, c01, c10, c11 }) > kSideTolerance || std::max ({ c00, c01, c10, c11 }) < -kSideTolerance)
+		return false;
+
+	if (!found)
+		return true;
+
+	const double dx = std::max ({ x0, 0.0, -x1 });
+	const double dy = std::max ({ y0, 0.0, -y1 });
+	return dx * dx + dy * dy < reach * reach;
+}
+
+// 直线 origin + t * normal 与折线最近的交点，返回false表示没有交点，找到时offset为t
+bool IntersectBoundary (FlatBoundary& boundary, const Point2D& origin, const Point2D& normal, double& offset)
+{
+	if (boundary.blocks.empty ())
+		return false;
+
+	// 先查上一个交点所在的分组，得到的|t|用于跳过其余较远的分组
+	bool found = false;
+	double nearest = 0.0;
+	const BoundaryBlock& hinted = boundary.blocks[boundary.hint];
+	IntersectEdges (boundary.points, hinted.firstEdge, hinted.endEdge, origin, normal, found, nearest);
+	std::size_t nearestBlock = boundary.hint;
+
+	for (std::size_t blockIndex = 0; blockIndex < boundary.blocks.size (); ++blockIndex) {
+		const BoundaryBlock& block = boundary.blocks[blockIndex];
+		if (blockIndex == boundary.hint || !MayContainCloser (block, origin, normal, found, std::fabs (nearest)))
+			continue;
+
+		const bool wasFound = found;
+		const double previous = nearest;
+		IntersectEdges (boundary.points, block.firstEdge, block.endEdge, origin, normal, found, nearest);
+		if (found && (!wasFound || nearest != previous))
+			nearestBlock = blockIndex;
+	}
+
+	if (!found)
+		return false;
+
+	boundary.hint = nearestBlock;
+	offset = nearest;
+	return true;
+}
+
+// 交点向origin方向退回kNarrowTreadOffset后的点（不越过origin）
+Point2D InsetPoint (const Point2D& origin, const Point2D& normal, double offset)
+{
+	const double reach = std::fabs (offset);
+	const double inset = reach > kNarrowTreadOffset ? (reach - kNarrowTreadOffset) / reach * offset : 0.0;
+	return { origin.x + normal.x * inset, origin.y + normal.y * inset };
+}
+
+double Distance (const Point2D& a, const Point2D& b)
+{
+	const double dx = b.x - a.x;
+	const double dy = b.y - a.y;
+	return std::sqrt (dx * dx + dy * dy);
+}
+
+double SegmentPointDistance (const Point2D& a, const Point2D& b, const Point2D& p)
+{
+	const double ex = b.x - a.x;
+	const double ey = b.y - a.y;
+	const double lengthSquared = ex * ex + ey * ey;
+	double u = lengthSquared > 0.0 ? ((p.x - a.x) * ex + (p.y - a.y) * ey) / lengthSquared : 0.0;
+	u = std::min (std::max (u, 0.0), 1.0);
+	return Distance ({ a.x + ex * u, a.y + ey * u }, p);
+}
+
+// 两条线段的最短距离，相交时为0
+double SegmentDistance (const Point2D& a, const Point2D& b, const Point2D& c, const Point2D& d)
+{
+	const double abC = Cross (b.x - a.x, b.y - a.y, c.x - a.x, c.y - a.y);
+	const double abD = Cross (b.x - a.x, b.y - a.y, d.x - a.x, d.y - a.y);
+	const double cdA = Cross (d.x - c.x, d.y - c.y, a.x - c.x, a.y - c.y);
+	const double cdB = Cross (d.x - c.x, d.y - c.y, b.x - c.x, b.y - c.y);
+	if (((abC > 0.0 && abD < 0.0) || (abC < 0.0 && abD > 0.0)) && ((cdA > 0.0 && cdB < 0.0) || (cdA < 0.0 && cdB > 0.0)))
+		return 0.0;
+
+	return std::min ({ SegmentPointDistance (a, b, c), SegmentPointDistance (a, b, d), SegmentPointDistance (c, d, a), SegmentPointDistance (c, d, b) });
+}
+
+// 两个包围盒之间的距离，重叠时为0
+double BoxDistance (const BoundaryBlock& a, const BoundaryBlock& b)
+{
+	const double dx = std::max ({ a.minX - b.maxX, b.minX - a.maxX, 0.0 });
+	const double dy = std::max ({ a.minY - b.maxY, b.minY - a.maxY, 0.0 });
+	return std::sqrt (dx * dx + dy * dy);
+}
+
+// 折线 points 的 [first, end] 顶点的包围盒
+BoundaryBlock MakeBlock (const std::vector<Point2D>& points, std::size_t first, std::size_t end)
+{
+	BoundaryBlock block = { points[first].x, points[first].y, points[first].x, points[first].y, first, end };
+	for (std::size_t i = first + 1; i <= end; ++i) {
+		block.minX = std::min (block.minX, points[i].x);
+		block.minY = std::min (block.minY, points[i].y);
+		block.maxX = std::max (block.maxX, points[i].x);
+		block.maxY = std::max (block.maxY, points[i].y);
+	}
+	return block;
+}
+
+// 记录梯段轮廓：两侧交点折线分组，并求整个梯段的包围盒
+void AddFlightOutline (TreadScratch& scratch, std::size_t firstStation, const Point2D& direction)
+{
+	FlightOutline flight;
+	flight.firstStation = firstStation;
+	flight.endStation = scratch.stations[0].size ();
+	flight.firstBlock = scratch.outlineBlocks[0].size ();
+	flight.direction = direction;
+	for (std::size_t side = 0; side < 2; ++side) {
+		for (std::size_t first = flight.firstStation; first + 1 < flight.endStation; first += kOutlineBlockSize)
+			scratch.outlineBlocks[side].push_back (MakeBlock (scratch.stations[side], first, std::min (first + kOutlineBlockSize, flight.endStation - 1)));
+	}
+	flight.endBlock = scratch.outlineBlocks[0].size ();
+
+	flight.bounds = MakeBlock (scratch.stations[0], flight.firstStation, flight.endStation - 1);
+	const BoundaryBlock other = MakeBlock (scratch.stations[1], flight.firstStation, flight.endStation - 1);
+	flight.bounds.minX = std::min (flight.bounds.minX, other.minX);
+	flight.bounds.minY = std::min (flight.bounds.minY, other.minY);
+	flight.bounds.maxX = std::max (flight.bounds.maxX, other.maxX);
+	flight.bounds.maxY = std::max (flight.bounds.maxY, other.maxY);
+	scratch.flights.push_back (flight);
+}
+
+// 两个梯段轮廓（两侧交点连成的折线）之间的最短距离；只计算比limit更近的部分，都不更近时返回limit
+double FlightDistance (const TreadScratch& scratch, const FlightOutline& first, const FlightOutline& second, double limit)
+{
+	double distance = limit;
+	for (std::size_t sideA = 0; sideA < 2; ++sideA) {
+		const std::vector<Point2D>& a = scratch.stations[sideA];
+		for (std::size_t sideB = 0; sideB < 2; ++sideB) {
+			const std::vector<Point2D>& b = scratch.stations[sideB];
+			for (std::size_t blockA = first.firstBlock; blockA < first.endBlock; ++blockA) {
+				const BoundaryBlock& rangeA = scratch.outlineBlocks[sideA][blockA];
+				for (std::size_t blockB = second.firstBlock; blockB < second.endBlock; ++blockB) {
+					const BoundaryBlock& rangeB = scratch.outlineBlocks[sideB][blockB];
+					if (BoxDistance (rangeA, rangeB) >= distance)
+						continue;
+					for (std::size_t i = rangeA.firstEdge; i < rangeA.endEdge; ++i) {
+						for (std::size_t j = rangeB.firstEdge; j < rangeB.endEdge; ++j)
+							distance = std::min (distance, SegmentDistance (a[i], a[i + 1], b[j], b[j + 1]));
+					}
+					// 相接的梯段不计入，无需继续
+					if (distance <= kEpsilon)
+						return distance;
+				}
+			}
+		}
+	}
+	return distance;
+}
+
+// 相对（方向夹角大于120度）的梯段之间的最小距离，相接的梯段不计入
+double ComputeFlightSpacing (const TreadScratch& scratch)
+{
+	constexpr double kOpposingCosine = -0.5;
+
+	double spacing = std::numeric_limits<double>::infinity ();
+	for (std::size_t i = 0; i < scratch.flights.size (); ++i) {
+		for (std::size_t j = i + 1; j < scratch.flights.size (); ++j) {
+			const FlightOutline& first = scratch.flights[i];
+			const FlightOutline& second = scratch.flights[j];
+			if (first.direction.x * second.direction.x + first.direction.y * second.direction.y > kOpposingCosine)
+				continue;
+			if (BoxDistance (first.bounds, second.bounds) >= spacing)
+				continue;
+
+			const double distance = FlightDistance (scratch, first, second, spacing);
+			if (distance > kEpsilon)
+				spacing = distance;
+		}
+	}
+	return std::isinf (spacing) ? 0.0 : spacing;
+}
+
+} // namespace
+
+void ComputeTreadMetrics (const StairRecord& stair, const WalkingLineGeometry& walkingLine, TreadMetrics& metrics, std::vector<TreadGeometry>* treads)
+{
+	metrics = TreadMetrics ();
+	if (treads != nullptr)
+		treads->clear ();
+
+	thread_local TreadScratch scratch;
+	for (std::size_t side = 0; side < 2; ++side) {
+		FlattenBoundary (stair.boundaries[side], scratch.arcIndex, scratch.boundaries[side]);
+		scratch.stations[side].clear ();
+		scratch.outlineBlocks[side].clear ();
+	}
+	scratch.flights.clear ();
+
+	if (stair.treadDepth > kEpsilon) {
+		for (const WalkingLineRun& run : walkingLine.GetRuns ()) {
+			if (run.landing || run.length <= kEpsilon)
+				continue;
+
+			// 梯段按名义踏步宽度取整后等分
+			const double start = walkingLine.GetDistance (run.firstEdge);
+			const std::size_t treadCount = std::max<std::size_t> (1, static_cast<std::size_t> (std::llround (run.length / stair.treadDepth)));
+			const double going = run.length / static_cast<double> (treadCount);
+
+			Point2D previous[2] = {};
+			bool previousFound[2] = { false, false };
+			bool outlined = true;		// 每条踢面线都与两侧边界相交时记录梯段轮廓
+			Point2D first = {};
+			Point2D last = {};
+			const std::size_t firstStation = scratch.stations[0].size ();
+			for (std::size_t riser = 0; riser <= treadCount; ++riser) {
+				Point2D point, tangent;
+				// 最后一条踢面线恰在梯段终点，限定在梯段内定位，不取相接平台的切线
+				walkingLine.Locate (stair, run.firstEdge, run.endEdge, start + going * static_cast<double> (riser), point, tangent);
+				const Point2D normal = { -tangent.y, tangent.x };
+				if (riser == 0)
+					first = point;
+				last = point;
+
+				double narrowGoing = 0.0;
+				double offsets[2] = { 0.0, 0.0 };
+				bool found[2] = { false, false };
+				for (std::size_t side = 0; side < 2; ++side) {
+					found[side] = IntersectBoundary (scratch.boundaries[side], point, normal, offsets[side]);
+					const Point2D current = found[side] ? InsetPoint (point, normal, offsets[side]) : point;
+					if (riser > 0 && found[side] && previousFound[side]) {
+						const double sideGoing = Distance (previous[side], current);
+						narrowGoing = narrowGoing > 0.0 ? std::min (narrowGoing, sideGoing) : sideGoing;
+					}
+					previous[side] = current;
+					previousFound[side] = found[side];
+				}
+
+				// 净宽取两侧交点之间的距离
+				if (found[0] && found[1]) {
+					const double width = std::fabs (offsets[0] - offsets[1]);
+					metrics.minClearWidth = metrics.minClearWidth > 0.0 ? std::min (metrics.minClearWidth, width) : width;
+					for (std::size_t side = 0; side < 2; ++side)
+						scratch.stations[side].push_back ({ point.x + normal.x * offsets[side], point.y + normal.y * offsets[side] });
+				} else {
+					outlined = false;
+				}
+
+				if (riser == 0)
+					continue;
+
+				// 第riser个踏步位于第riser-1和第riser条踢面线之间
+				metrics.minGoing = metrics.treadCount == 0 ? going : std::min (metrics.minGoing, going);
+				metrics.maxGoing = std::max (metrics.maxGoing, going);
+				if (narrowGoing > 0.0)
+					metrics.minNarrowGoing = metrics.minNarrowGoing > 0.0 ? std::min (metrics.minNarrowGoing, narrowGoing) : narrowGoing;
+				++metrics.treadCount;
+
+				if (treads != nullptr)
+					treads->push_back ({ going, narrowGoing });
+			}
+
+			const double dx = last.x - first.x;
+			const double dy = last.y - first.y;
+			const double length = std::sqrt (dx * dx + dy * dy);
+			if (outlined && length > kEpsilon)
+				AddFlightOutline (scratch, firstStation, { dx / length, dy / length });
+		}
+	}
+
+	metrics.flightSpacing = ComputeFlightSpacing (scratch);
+
+	scratch.levels.assign (stair.treadLevels.begin (), stair.treadLevels.end ());
+	metrics.riserVariation = ComputeRiserVariation (scratch.levels, stair.riserHeight);
+}
+
+double ComputeRiserVariation (std::vector<double>& levels, double nominalRiserHeight)
+{
+	std::sort (levels.begin (), levels.end ());
+
+	std::size_t riserCount = 0;
+	double minRiser = 0.0;
+	double maxRiser = 0.0;
+	for (std::size_t i = 1; i < levels.size (); ++i) {
+		const double difference = levels[i] - levels[i - 1];
+		if (difference <= kEpsilon)
+			continue;		// 同一标高的踏板（如分块的踏板）
+
+		// 跨过平台的差值包含多个踢面
+		const double steps = nominalRiserHeight > kEpsilon ? std::max (1.0, std::round (difference / nominalRiserHeight)) : 1.0;
+		const double riser = difference / steps;
+		minRiser = riserCount == 0 ? riser : std::min (minRiser, riser);
+		maxRiser = std::max (maxRiser, riser);
+		++riserCount;
+	}
+
+	return riserCount >= 2 ? maxRiser - minRiser : 0.0;
+}
+
+} // namespace StairCore
@@ -0,0 +1,60 @@
+#ifndef STAIR_TREAD_GEOMETRY_HPP
+#define STAIR_TREAD_GEOMETRY_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "StairEvaluationCore.hpp"
+
+/**
+ * 逐个踏步的几何（与ArchiCAD无关）
+ *
+ * 踏步沿步行线划分：每个梯段按名义踏步宽度取整得到踏步数，再在步行线上等分。
+ * 分界处垂直于步行线的直线近似为踢面线（直跑和弧形梯段与踢面重合，转角扇形踏步为近似）。
+ * 踢面线与边界的交点向步行线方向退回kNarrowTreadOffset，相邻两条踢面线上的点之间的距离
+ * 即为该侧的踏步宽度，两侧中较小的为窄端宽度。边界折线按分组包围盒求交，
+ * 从上一条踢面线的交点所在分组开始，较远的分组直接跳过。
+ *
+ * 两侧交点之间的距离为该处的梯段净宽。每条踢面线都与两侧边界相交的梯段，交点连成的轮廓
+ * 用于计算相对梯段（如双跑楼梯梯井两侧）之间的水平净距。
+ *
+ * 踢面高度取相邻踏板顶面标高之差；跨过平台的差值按名义踢面高度折算为多个踢面。
+ * 楼梯底部和顶部的踢面不参与计算（需要楼层标高）。
+ */
+namespace StairCore {
+
+class WalkingLineGeometry;
+
+// 扇形踏步宽度的测量位置：距边界0.25米（GB 50352-2019 6.8.10，距内侧扶手中心0.25米处）
+constexpr double kNarrowTreadOffset = 0.25;
+
+// 边界圆弧离散为折线时每段的最大圆心角（弧度，约5度）
+constexpr double kBoundaryArcStep = 0.0873;
+
+struct TreadGeometry {
+	double	going = 0.0;			// 步行线上的踏步宽度
+	double	narrowGoing = 0.0;		// 窄端的踏步宽度，踢面线与边界没有交点时为0
+};
+
+struct TreadMetrics {
+	std::size_t	treadCount = 0;			// 0表示无法划分踏步（没有步行线或名义踏步宽度）
+	double		minGoing = 0.0;
+	double		maxGoing = 0.0;
+	double		minNarrowGoing = 0.0;	// 没有边界数据时为0
+	double		riserVariation = 0.0;	// 踢面少于2个时为0
+	double		minClearWidth = 0.0;	// 没有边界数据时为0
+	double		flightSpacing = 0.0;	// 没有相对的梯段时为0
+};
+
+/**
+ * 计算逐个踏步的几何，walkingLine 须由同一楼梯构建。
+ * treads 不为空时按步行线顺序输出每个踏步；边界和标高的临时数据在每个线程中复用。
+ */
+void	ComputeTreadMetrics (const StairRecord& stair, const WalkingLineGeometry& walkingLine, TreadMetrics& metrics, std::vector<TreadGeometry>* treads = nullptr);
+
+// 踏板顶面标高（任意顺序）对应的踢面高度差值；levels会被排序
+double	ComputeRiserVariation (std::vector<double>& levels, double nominalRiserHeight);
+
+} // namespace StairCore
+
+#endif
@@ -0,0 +1,191 @@
+#include "StairWalkingLine.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace StairCore {
+
+Point2D PointOnArc (const Point2D& start, const Point2D& end, double arcAngle, double fraction)
+{
+	const double dx = end.x - start.x;
+	const double dy = end.y - start.y;
+	const double chordLength = std::sqrt (dx * dx + dy * dy);
+	if (std::fabs (arcAngle) <= kEpsilon || chordLength <= 0.0)
+		return { start.x + dx * fraction, start.y + dy * fraction };
+
+	// 圆心在弦的中垂线上，逆时针圆弧的圆心位于弦的左侧
+	const double offset = (chordLength * 0.5) / std::tan (arcAngle * 0.5);
+	const Point2D center = { (start.x + end.x) * 0.5 - dy / chordLength * offset, (start.y + end.y) * 0.5 + dx / chordLength * offset };
+
+	const double angle = arcAngle * fraction;
+	const double rx = start.x - center.x;
+	const double ry = start.y - center.y;
+	return { center.x + rx * std::cos (angle) - ry * std::sin (angle), center.y + rx * std::sin (angle) + ry * std::cos (angle) };
+}
+
+void WalkingLineArcIndex::Build (std::size_t vertexCount, const std::vector<ArcRecord>& arcs)
+{
+	edgeCount = vertexCount > 1 ? vertexCount - 1 : 0;
+
+	// 没有圆弧时不建表，所有线段按弦长计算
+	edgeArcAngles.clear ();
+	if (arcs.empty ())
+		return;
+
+	// 同一线段有多条记录时以第一条为准
+	edgeArcAngles.assign (edgeCount, std::numeric_limits<double>::quiet_NaN ());
+	for (const ArcRecord& arc : arcs) {
+		if (arc.begIndex < 0 || arc.endIndex != arc.begIndex + 1)
+			continue;
+		const std::size_t edgeIndex = static_cast<std::size_t> (arc.begIndex);
+		if (edgeIndex < edgeCount && std::isnan (edgeArcAngles[edgeIndex]))
+			edgeArcAngles[edgeIndex] = arc.arcAngle;
+	}
+}
+
+double WalkingLineArcIndex::GetArcAngle (std::size_t edgeIndex) const
+{
+	if (edgeIndex >= edgeArcAngles.size () || std::isnan (edgeArcAngles[edgeIndex]))
+		return 0.0;
+	return edgeArcAngles[edgeIndex];
+}
+
+double WalkingLineArcIndex::GetSegmentLength (const std::vector<Point2D>& points, std::size_t edgeIndex) const
+{
+	if (edgeIndex >= edgeCount)
+		return 0.0;
+
+	const Point2D& start = points[edgeIndex];
+	const Point2D& end = points[edgeIndex + 1];
+
+	const double dx = end.x - start.x;
+	const double dy = end.y - start.y;
+	const double chordLength = std::sqrt (dx * dx + dy * dy);
+
+	const double angle = std::fabs (GetArcAngle (edgeIndex));
+	if (angle > kEpsilon) {
+		const double halfChord = chordLength * 0.5;
+		const double radius = halfChord / std::sin (angle * 0.5);
+		return radius * angle;
+	}
+
+	return chordLength;
+}
+
+WalkingLineGeometry::WalkingLineGeometry (const StairRecord& stair)
+{
+	Build (stair);
+}
+
+void WalkingLineGeometry::Build (const StairRecord& stair)
+{
+	const std::size_t vertexCount = stair.walkingLine.size ();
+	const std::size_t edgeCount = vertexCount > 1 ? vertexCount - 1 : 0;
+
+	arcIndex.Build (stair);
+
+	segmentLengths.resize (edgeCount);
+	distances.resize (vertexCount);
+	if (vertexCount > 0)
+		distances[0] = 0.0;
+
+	for (std::size_t edgeIndex = 0; edgeIndex < edgeCount; ++edgeIndex) {
+		segmentLengths[edgeIndex] = arcIndex.GetSegmentLength (stair.walkingLine, edgeIndex);
+		distances[edgeIndex + 1] = distances[edgeIndex] + segmentLengths[edgeIndex];
+	}
+
+	// 连续的同类线段合并为一段；段内逐段累加，与逐段扫描的结果完全一致
+	runs.clear ();
+	landingCount = 0;
+	minLandingLength = 0.0;
+	maxFlightLength = 0.0;
+
+	const std::size_t typedCount = std::min (edgeCount, stair.segmentTypes.size ());
+	for (std::size_t edgeIndex = 0; edgeIndex < typedCount; ++edgeIndex) {
+		const SegmentType type = stair.segmentTypes[edgeIndex];
+		const bool landing = (type == SegmentType::Landing || type == SegmentType::DividedLanding);
+
+		if (runs.empty () || runs.back ().landing != landing) {
+			WalkingLineRun run;
+			run.firstEdge = edgeIndex;
+			run.landing = landing;
+			runs.push_back (run);
+		}
+
+		WalkingLineRun& run = runs.back ();
+		run.endEdge = edgeIndex + 1;
+		run.length += segmentLengths[edgeIndex];
+	}
+
+	for (const WalkingLineRun& run : runs) {
+		if (run.landing) {
+			minLandingLength = (landingCount == 0) ? run.length : std::min (minLandingLength, run.length);
+			++landingCount;
+		} else {
+			maxFlightLength = std::max (maxFlightLength, run.length);
+		}
+	}
+}
+
+double WalkingLineGeometry::GetSegmentLength (std::size_t edgeIndex) const
+{
+	return edgeIndex < segmentLengths.size () ? segmentLengths[edgeIndex] : 0.0;
+}
+
+double WalkingLineGeometry::GetDistance (std::size_t vertexIndex) const
+{
+	if (distances.empty ())
+		return 0.0;
+	return distances[std::min (vertexIndex, distances.size () - 1)];
+}
+
+double WalkingLineGeometry::GetLength (std::size_t firstEdge, std::size_t endEdge) const
+{
+	if (endEdge <= firstEdge)
+		return 0.0;
+	return GetDistance (endEdge) - GetDistance (firstEdge);
+}
+
+bool WalkingLineGeometry::Locate (const StairRecord& stair, double distance, Point2D& point, Point2D& tangent) const
+{
+	return Locate (stair, 0, GetEdgeCount (), distance, point, tangent);
+}
+
+bool WalkingLineGeometry::Locate (const StairRecord& stair, std::size_t firstEdge, std::size_t endEdge, double distance, Point2D& point, Point2D& tangent) const
+{
+	endEdge = std::min (endEdge, GetEdgeCount ());
+	if (firstEdge >= endEdge)
+		return false;
+
+	// 范围内包含distance的线段：distances[edge] <= distance < distances[edge+1]
+	const auto next = std::upper_bound (distances.begin () + static_cast<std::ptrdiff_t> (firstEdge + 1), distances.begin () + static_cast<std::ptrdiff_t> (endEdge), distance);
+	const std::size_t edgeIndex = static_cast<std::size_t> (next - distances.begin ()) - 1;
+
+	const Point2D& start = stair.walkingLine[edgeIndex];
+	const Point2D& end = stair.walkingLine[edgeIndex + 1];
+	const double length = segmentLengths[edgeIndex];
+	double fraction = length > 0.0 ? (distance - distances[edgeIndex]) / length : 0.0;
+	fraction = std::min (std::max (fraction, 0.0), 1.0);
+
+	const double arcAngle = arcIndex.GetArcAngle (edgeIndex);
+	double dx = end.x - start.x;
+	double dy = end.y - start.y;
+	if (std::fabs (arcAngle) > kEpsilon) {
+		// 圆弧上的切线为弦方向旋转 (fraction - 0.5) * 圆心角
+		const double rotation = arcAngle * (fraction - 0.5);
+		const double rx = dx * std::cos (rotation) - dy * std::sin (rotation);
+		const double ry = dx * std::sin (rotation) + dy * std::cos (rotation);
+		dx = rx;
+		dy = ry;
+		point = PointOnArc (start, end, arcAngle, fraction);
+	} else {
+		point = { start.x + dx * fraction, start.y + dy * fraction };
+	}
+
+	const double norm = std::sqrt (dx * dx + dy * dy);
+	tangent = norm > 0.0 ? Point2D { dx / norm, dy / norm } : Point2D { 1.0, 0.0 };
+	return true;
+}
+
+} // namespace StairCore
@@ -0,0 +1,91 @@
+#ifndef STAIR_WALKING_LINE_HPP
+#define STAIR_WALKING_LINE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "StairEvaluationCore.hpp"
+
+/**
+ * 步行线几何索引（与ArchiCAD无关）
+ *
+ * WalkingLineArcIndex 把圆弧记录按起点顶点映射到线段，查询单段长度不再扫描全部圆弧；
+ * WalkingLineGeometry 在此基础上计算每段长度（圆弧段为弧长）的前缀和，并把线段按类型
+ * 划分为连续的梯段和平台。两者都是每条步行线构建一次，构建后的查询均为O(1)，
+ * 按距离定位点为O(log n)。圆弧索引也用于楼梯边界等其他带圆弧的折线。
+ */
+namespace StairCore {
+
+// 圆弧段上的点：start到end的圆心角为arcAngle（正值为逆时针），fraction为0到1
+Point2D		PointOnArc (const Point2D& start, const Point2D& end, double arcAngle, double fraction);
+
+class WalkingLineArcIndex {
+public:
+	// 重新构建时复用已分配的缓冲区
+	void					Build (std::size_t vertexCount, const std::vector<ArcRecord>& arcs);
+	void					Build (const StairRecord& stair) { Build (stair.walkingLine.size (), stair.walkingLineArcs); }
+
+	// 线段的圆心角（带符号），直线段为0
+	double					GetArcAngle (std::size_t edgeIndex) const;
+
+	// points 须为构建索引时的折线；edgeIndex 为线段索引（顶点 edgeIndex 到 edgeIndex+1），越界时返回0
+	double					GetSegmentLength (const std::vector<Point2D>& points, std::size_t edgeIndex) const;
+
+private:
+	std::vector<double>		edgeArcAngles;		// 线段对应的圆心角，NaN表示没有圆弧记录；没有圆弧的折线为空
+	std::size_t				edgeCount = 0;
+};
+
+// 同类型的连续线段 [firstEdge, endEdge)
+struct WalkingLineRun {
+	std::size_t	firstEdge = 0;
+	std::size_t	endEdge = 0;
+	double		length = 0.0;
+	bool		landing = false;		// Landing或DividedLanding
+};
+
+class WalkingLineGeometry {
+public:
+	WalkingLineGeometry () = default;
+	explicit WalkingLineGeometry (const StairRecord& stair);
+
+	// 重新构建时复用已分配的缓冲区
+	void							Build (const StairRecord& stair);
+
+	std::size_t						GetEdgeCount () const		{ return distances.empty () ? 0 : distances.size () - 1; }
+	double							GetTotalLength () const		{ return distances.empty () ? 0.0 : distances.back (); }
+
+	// edgeIndex 为线段索引（顶点 edgeIndex 到 edgeIndex+1），越界时返回0
+	double							GetSegmentLength (std::size_t edgeIndex) const;
+	// 从起点到顶点 vertexIndex 的步行线长度
+	double							GetDistance (std::size_t vertexIndex) const;
+	// 线段 [firstEdge, endEdge) 的总长度
+	double							GetLength (std::size_t firstEdge, std::size_t endEdge) const;
+
+	// 距起点distance处的点和单位切线方向（超出范围时取端点），stair 须为构建时的楼梯；没有线段时返回false
+	bool							Locate (const StairRecord& stair, double distance, Point2D& point, Point2D& tangent) const;
+	// 只在线段 [firstEdge, endEdge) 中定位（如一个梯段），超出范围时取范围的端点；
+	// 范围端点处不会因舍入误差落到相邻线段（如平台）上，范围为空时返回false
+	bool							Locate (const StairRecord& stair, std::size_t firstEdge, std::size_t endEdge, double distance, Point2D& point, Point2D& tangent) const;
+
+	// 只覆盖有类型的线段（min(顶点数-1, segmentTypes数)）
+	const std::vector<WalkingLineRun>&	GetRuns () const		{ return runs; }
+	bool							HasLanding () const			{ return landingCount > 0; }
+	// 最短的平台长度，没有平台时为0
+	double							GetMinimumLandingLength () const	{ return minLandingLength; }
+	// 最长的梯段长度，没有梯段时为0
+	double							GetMaximumFlightLength () const		{ return maxFlightLength; }
+
+private:
+	WalkingLineArcIndex				arcIndex;
+	std::vector<double>				segmentLengths;
+	std::vector<double>				distances;		// distances[k] 为起点到顶点k的长度
+	std::vector<WalkingLineRun>		runs;
+	std::size_t						landingCount = 0;
+	double							minLandingLength = 0.0;
+	double							maxFlightLength = 0.0;
+};
+
+} // namespace StairCore
+
+#endif
@@ -0,0 +1,148 @@
+#include "StairWorkPool.hpp"
+
+#include <algorithm>
+
+namespace StairCore {
+
+unsigned int WorkStealingPool::ResolveThreadCount (unsigned int requested)
+{
+	if (requested > 0)
+		return requested;
+
+	const unsigned int hardwareCount = std::thread::hardware_concurrency ();
+	return hardwareCount > 0 ? hardwareCount : 1;
+}
+
+WorkStealingPool::WorkStealingPool (unsigned int requestedThreadCount) :
+	threadCount (ResolveThreadCount (requestedThreadCount))
+{
+	queues.reserve (threadCount);
+	for (unsigned int i = 0; i < threadCount; ++i)
+		queues.push_back (std::make_unique<WorkQueue> ());
+
+	// 调用线程占用最后一个队列，只需创建threadCount-1个工作线程
+	workers.reserve (threadCount - 1);
+	for (unsigned int i = 0; i + 1 < threadCount; ++i)
+		workers.emplace_back (&WorkStealingPool::WorkerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool ()
+{
+	{
+		std::lock_guard<std::mutex> lock (stateMutex);
+		stopping = true;
+	}
+	workAvailable.notify_all ();
+
+	for (std::thread& worker : workers)
+		worker.join ();
+}
+
+void WorkStealingPool::ParallelFor (std::size_t count, std::size_t grainSize, RangeFunction function, void* context)
+{
+	if (count == 0)
+		return;
+
+	grainSize = std::max<std::size_t> (grainSize, 1);
+
+	// 任务量不足两块或没有工作线程时直接在调用线程执行
+	if (workers.empty () || count <= grainSize) {
+		function (context, 0, count);
+		return;
+	}
+
+	std::lock_guard<std::mutex> runLock (runMutex);
+
+	const std::size_t taskCount = (count + grainSize - 1) / grainSize;
+	currentFunction = function;
+	currentContext = context;
+	pendingCount.store (taskCount);
+
+	// 连续的块轮流分配给各队列，工作线程各自从队尾取、从别人队头偷。
+	// 上一批次还在RunOne循环里的工作线程可能立刻取走新任务，所以计数在入队前逐个增加，
+	// 出队时在同一把队列锁内减少，两者始终成对
+	for (std::size_t task = 0; task < taskCount; ++task) {
+		const std::size_t begin = task * grainSize;
+		const Range range = { begin, std::min (begin + grainSize, count) };
+		WorkQueue& queue = *queues[task % threadCount];
+		std::lock_guard<std::mutex> queueLock (queue.mutex);
+		queuedCount.fetch_add (1);
+		queue.ranges.push_back (range);
+	}
+
+	// 经过stateMutex再通知，避免工作线程在检查条件与进入等待之间错过唤醒
+	{
+		std::lock_guard<std::mutex> lock (stateMutex);
+	}
+	workAvailable.notify_all ();
+
+	const unsigned int callerQueue = threadCount - 1;
+	while (RunOne (callerQueue)) {
+	}
+
+	std::unique_lock<std::mutex> lock (stateMutex);
+	workFinished.wait (lock, [this] { return pendingCount.load () == 0; });
+
+	currentFunction = nullptr;
+	currentContext = nullptr;
+}
+
+bool WorkStealingPool::PopLocal (unsigned int queueIndex, Range& range)
+{
+	WorkQueue& queue = *queues[queueIndex];
+	std::lock_guard<std::mutex> lock (queue.mutex);
+	if (queue.ranges.empty ())
+		return false;
+
+	range = queue.ranges.back ();
+	queue.ranges.pop_back ();
+	queuedCount.fetch_sub (1);
+	return true;
+}
+
+bool WorkStealingPool::Steal (unsigned int queueIndex, Range& range)
+{
+	for (unsigned int offset = 1; offset < threadCount; ++offset) {
+		WorkQueue& victim = *queues[(queueIndex + offset) % threadCount];
+		std::lock_guard<std::mutex> lock (victim.mutex);
+		if (!victim.ranges.empty ()) {
+			range = victim.ranges.front ();
+			victim.ranges.pop_front ();
+			queuedCount.fetch_sub (1);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool WorkStealingPool::RunOne (unsigned int queueIndex)
+{
+	Range range;
+	if (!PopLocal (queueIndex, range) && !Steal (queueIndex, range))
+		return false;
+
+	currentFunction (currentContext, range.begin, range.end);
+
+	if (pendingCount.fetch_sub (1) == 1) {
+		std::lock_guard<std::mutex> lock (stateMutex);
+		workFinished.notify_all ();
+	}
+	return true;
+}
+
+void WorkStealingPool::WorkerLoop (unsigned int queueIndex)
+{
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock (stateMutex);
+			workAvailable.wait (lock, [this] { return stopping || queuedCount.load () > 0; });
+			if (stopping)
+				return;
+		}
+
+		while (RunOne (queueIndex)) {
+		}
+	}
+}
+
+} // namespace StairCore
@@ -0,0 +1,82 @@
+#ifndef STAIR_WORK_POOL_HPP
+#define STAIR_WORK_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace StairCore {
+
+/**
+ * 工作窃取线程池（与ArchiCAD无关）
+ *
+ * 每个线程有自己的任务队列，队列空时从其他线程的队列头部窃取任务。
+ * 调用ParallelFor的线程也参与执行，threadCount为1时不创建任何工作线程。
+ * 同一时刻只执行一个ParallelFor。
+ */
+class WorkStealingPool {
+public:
+	typedef void (*RangeFunction) (void* context, std::size_t begin, std::size_t end);
+
+	// threadCount为0时使用硬件并发数
+	explicit		WorkStealingPool (unsigned int threadCount = 0);
+					~WorkStealingPool ();
+
+	WorkStealingPool (const WorkStealingPool&) = delete;
+	WorkStealingPool& operator= (const WorkStealingPool&) = delete;
+
+	unsigned int	GetThreadCount () const { return threadCount; }
+
+	// 把[0, count)按grainSize切分为任务并行执行，返回时所有任务均已完成
+	void			ParallelFor (std::size_t count, std::size_t grainSize, RangeFunction function, void* context);
+
+	template <typename Body>
+	void			ParallelFor (std::size_t count, std::size_t grainSize, Body& body)
+	{
+		ParallelFor (count, grainSize, [] (void* context, std::size_t begin, std::size_t end) {
+			(*static_cast<Body*> (context)) (begin, end);
+		}, &body);
+	}
+
+	static unsigned int	ResolveThreadCount (unsigned int requested);
+
+private:
+	struct Range {
+		std::size_t	begin;
+		std::size_t	end;
+	};
+
+	struct WorkQueue {
+		std::mutex			mutex;
+		std::deque<Range>	ranges;
+	};
+
+	void			WorkerLoop (unsigned int queueIndex);
+	bool			PopLocal (unsigned int queueIndex, Range& range);
+	bool			Steal (unsigned int queueIndex, Range& range);
+	bool			RunOne (unsigned int queueIndex);
+
+	unsigned int								threadCount;
+	std::vector<std::unique_ptr<WorkQueue>>	queues;			// 最后一个队列属于调用线程
+	std::vector<std::thread>					workers;
+
+	std::mutex					runMutex;			// 串行化ParallelFor调用
+	std::mutex					stateMutex;
+	std::condition_variable		workAvailable;
+	std::condition_variable		workFinished;
+	std::atomic<std::size_t>	queuedCount { 0 };	// 尚未被取走的任务数
+	std::atomic<std::size_t>	pendingCount { 0 };	// 尚未完成的任务数
+	bool						stopping = false;
+
+	RangeFunction				currentFunction = nullptr;
+	void*						currentContext = nullptr;
+};
+
+} // namespace StairCore
+
+#endif
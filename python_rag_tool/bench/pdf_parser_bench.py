@@ -0,0 +1,97 @@
+"""
+PDF解析基准：顺序pdfplumber全量解析 与 并行预扫描 + 候选页表格提取的流水线对比
+
+  python bench/pdf_parser_bench.py                      生成600页的合成规范PDF后测试
+  python bench/pdf_parser_bench.py --pdf 规范.pdf        测试指定的PDF（如完整的国家规范）
+  python bench/pdf_parser_bench.py --pages 1200         合成PDF的页数
+
+合成PDF每页约40行条文，每隔几页有一张带边框的表格，约5%的页面包含楼梯条文。
+顺序解析即原来的 extract_text_with_pdfplumber + extract_stair_related_content；
+流水线分别测试首次解析（含启动工作进程）和进程池已启动时的解析，并核对两者找到的楼梯页相同。
+"""
+import argparse
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "src"))
+
+import fitz  # PyMuPDF
+from pdf_parser import PDFParser, PROCESS_POOL_WORKERS
+
+STAIR_LINE = "6.3.{n} 楼梯踏步高度不应大于0.175m，踏步宽度不应小于0.26m，中间平台宽度不应小于1.20m。"
+PLAIN_LINE = "{n}.{m} 建筑物的耐火等级、防火分区面积和安全疏散距离应符合本规范相关条文的规定。"
+
+
+def make_synthetic_pdf(path: str, pages: int) -> None:
+    """生成合成规范PDF"""
+    doc = fitz.open()
+    for page_index in range(pages):
+        page = doc.new_page()
+        lines = [PLAIN_LINE.format(n=page_index, m=m) for m in range(40)]
+        if page_index % 20 == 7:
+            lines[5] = STAIR_LINE.format(n=page_index)
+        page.insert_text((40, 50), "\n".join(lines), fontname="china-s", fontsize=8)
+
+        # 表格：4行5列的边框和单元格文字
+        if page_index % 3 == 0:
+            top = 620
+            for row in range(5):
+                page.draw_line((40, top + row * 30), (540, top + row * 30))
+            for col in range(6):
+                page.draw_line((40 + col * 100, top), (40 + col * 100, top + 120))
+            for row in range(4):
+                for col in range(5):
+                    page.insert_text((45 + col * 100, top + 20 + row * 30), f"{row}-{col}", fontsize=8)
+    doc.save(path)
+    doc.close()
+
+
+def run_sequential(pdf_path: str):
+    parser = PDFParser(pdf_path)
+    return parser.extract_stair_related_content(parser.extract_text_with_pdfplumber())
+
+
+def run_pipeline(pdf_path: str):
+    return PDFParser(pdf_path).parse(method="auto")
+
+
+def measure(label: str, func, pdf_path: str):
+    started = time.perf_counter()
+    result = func(pdf_path)
+    seconds = time.perf_counter() - started
+    print(f"{label:<28}{seconds:>9.2f} s   楼梯页 {len(result)}")
+    return seconds, [page["page_number"] for page in result]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="PDF解析基准")
+    parser.add_argument("--pdf", help="要测试的PDF（默认生成合成PDF）")
+    parser.add_argument("--pages", type=int, default=600, help="合成PDF的页数（默认: 600）")
+    args = parser.parse_args()
+
+    pdf_path = args.pdf
+    if not pdf_path:
+        pdf_path = str(Path(tempfile.gettempdir()) / f"stair_bench_{args.pages}.pdf")
+        make_synthetic_pdf(pdf_path, args.pages)
+
+    doc = fitz.open(pdf_path)
+    page_count = len(doc)
+    doc.close()
+    print(f"PDF: {pdf_path}（{page_count} 页），工作进程 {PROCESS_POOL_WORKERS} 个\n")
+
+    sequential, sequential_pages = measure("顺序 pdfplumber 全量", run_sequential, pdf_path)
+    cold, cold_pages = measure("流水线（首次，含进程启动）", run_pipeline, pdf_path)
+    warm, warm_pages = measure("流水线（进程池已启动）", run_pipeline, pdf_path)
+
+    print(f"\n加速: 首次 {sequential / cold:.1f}x，进程池已启动 {sequential / warm:.1f}x")
+    if sequential_pages != cold_pages or sequential_pages != warm_pages:
+        print("警告: 流水线找到的楼梯页与顺序解析不同")
+        missing = sorted(set(sequential_pages) - set(warm_pages))
+        print(f"  只有顺序解析找到: {missing[:20]}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,251 @@
+"""
+条文检索模块
+按条文编号把规范文本切分为条文，建立本地BM25索引，为每类楼梯规则检索最相关的条文
+
+替代原先把所有楼梯相关页面拼接后截取前15000字符的做法：长规范中靠后的条文不会再被截掉，
+发送给LLM的文本只包含检索到的条文，提示词更短。
+"""
+import math
+import re
+from collections import Counter
+from dataclasses import dataclass, field
+from typing import Dict, List
+from rich.console import Console
+
+from pdf_parser import STAIR_KEYWORDS
+
+console = Console()
+
+# 行首的条文编号，如 "6.3.2"、"6.3.2　"
+CLAUSE_START = re.compile(r"^\s*(\d{1,3}(?:\.\d{1,3}){1,3})(?=[\s　])", re.MULTILINE)
+
+# 单个条文的最大长度，更长的条文按句号切分为多段
+MAX_CLAUSE_CHARS = 800
+
+# 每类规则检索的条文数
+DEFAULT_TOP_K = 4
+
+# 每类规则的检索词（中英文），条文同时出现多个检索词时得分更高
+RULE_QUERIES: Dict[str, List[str]] = {
+    "riser_height": ["踏步高度", "踢面高度", "踏步", "不应大于", "riser", "height"],
+    "tread_depth": ["踏步宽度", "踏面宽度", "踏步", "不应小于", "tread", "depth"],
+    "two_r_plus_g": ["2R+G", "踏步高度", "踏步宽度", "2倍", "之和", "riser", "tread"],
+    "landing_length": ["平台宽度", "平台长度", "休息平台", "中间平台", "梯段", "landing"],
+    "narrow_tread_depth": ["扇形踏步", "螺旋楼梯", "内侧扶手", "踏步宽度", "winder", "spiral"],
+    "riser_variation": ["踏步高度", "高度差", "一致", "均匀", "riser", "variation"],
+    "stair_width": ["梯段净宽", "净宽度", "疏散楼梯", "梯段", "不应小于", "width"],
+    "handrail_height": ["扶手高度", "栏杆", "扶手", "踏步前缘", "handrail", "height"],
+    "slope_angle": ["坡度", "倾斜角", "楼梯", "不宜大于", "slope", "angle"],
+    "between_flights": ["梯段", "水平净距", "梯井", "扶手间", "flights", "well"],
+}
+
+# 楼梯关键词的加权：条文每包含一个关键词，得分乘以 (1 + KEYWORD_BOOST)，最多计3个
+KEYWORD_BOOST = 0.3
+
+# BM25参数
+BM25_K1 = 1.5
+BM25_B = 0.75
+
+
+@dataclass
+class Clause:
+    """检索的基本单位：一条（或一段）规范条文"""
+    number: str
+    text: str
+    page_number: int
+    position: int                          # 在全文中的顺序，输出时按原文顺序排列
+    tokens: Counter = field(default_factory=Counter, repr=False)
+
+
+def tokenize(text: str) -> List[str]:
+    """
+    分词：英文和数字按词，中文按单字和相邻两字（二元组），无需中文分词词典
+
+    Args:
+        text: 文本
+
+    Returns:
+        List[str]: 词元列表
+    """
+    tokens = []
+    for match in re.finditer(r"[A-Za-z]+|\d+(?:\.\d+)?|[\u4e00-\u9fff]+", text):
+        word = match.group()
+        if "\u4e00" <= word[0] <= "\u9fff":
+            tokens.extend(word)
+            tokens.extend(word[i:i + 2] for i in range(len(word) - 1))
+        else:
+            tokens.append(word.lower())
+    return tokens
+
+
+def split_long_text(text: str) -> List[str]:
+    """按句号把过长的条文切分为不超过MAX_CLAUSE_CHARS的段落"""
+    if len(text) <= MAX_CLAUSE_CHARS:
+        return [text]
+
+    pieces = []
+    current = ""
+    for sentence in re.split(r"(?<=[。；;])", text):
+        if current and len(current) + len(sentence) > MAX_CLAUSE_CHARS:
+            pieces.append(current)
+            current = ""
+        current += sentence
+        while len(current) > MAX_CLAUSE_CHARS:
+            pieces.append(current[:MAX_CLAUSE_CHARS])
+            current = current[MAX_CLAUSE_CHARS:]
+    if current.strip():
+        pieces.append(current)
+    return pieces
+
+
+def split_clauses(pages_content: List[Dict]) -> List[Clause]:
+    """
+    按行首的条文编号切分页面文本；页首没有编号的文字属于上一页的最后一个条文
+
+    Args:
+        pages_content: 页面内容列表
+
+    Returns:
+        List[Clause]: 按原文顺序排列的条文
+    """
+    raw_clauses = []   # [编号, 文本, 页码]
+    for page in pages_content:
+        text = page["text"]
+        starts = [(match.start(), match.group(1)) for match in CLAUSE_START.finditer(text)]
+
+        leading = text[:starts[0][0]] if starts else text
+        if leading.strip():
+            if raw_clauses:
+                raw_clauses[-1][1] += leading
+            else:
+                raw_clauses.append(["", leading, page["page_number"]])
+
+        for i, (start, number) in enumerate(starts):
+            end = starts[i + 1][0] if i + 1 < len(starts) else len(text)
+            raw_clauses.append([number, text[start:end], page["page_number"]])
+
+    clauses = []
+    for number, text, page_number in raw_clauses:
+        for piece in split_long_text(text.strip()):
+            clause = Clause(number=number, text=piece, page_number=page_number, position=len(clauses))
+            clause.tokens = Counter(tokenize(piece))
+            clauses.append(clause)
+    return clauses
+
+
+class ClauseRetriever:
+    """条文的BM25索引"""
+
+    def __init__(self, pages_content: List[Dict]):
+        """
+        Args:
+            pages_content: 页面内容列表（PDFParser.parse的结果）
+        """
+        self.clauses = split_clauses(pages_content)
+        self.document_frequency = Counter()
+        for clause in self.clauses:
+            self.document_frequency.update(clause.tokens.keys())
+
+        lengths = [sum(clause.tokens.values()) for clause in self.clauses]
+        self.average_length = sum(lengths) / len(lengths) if lengths else 0.0
+
+    def idf(self, token: str) -> float:
+        count = self.document_frequency.get(token, 0)
+        return math.log(1.0 + (len(self.clauses) - count + 0.5) / (count + 0.5))
+
+    def score(self, clause: Clause, query_tokens: List[str]) -> float:
+        """BM25得分，再按条文包含的楼梯关键词加权"""
+        length = sum(clause.tokens.values())
+        norm = BM25_K1 * (1.0 - BM25_B + BM25_B * length / self.average_length) if self.average_length else BM25_K1
+
+        total = 0.0
+        for token in set(query_tokens):
+            frequency = clause.tokens.get(token, 0)
+            if frequency:
+                total += self.idf(token) * frequency * (BM25_K1 + 1.0) / (frequency + norm)
+
+        lowered = clause.text.lower()
+        keyword_hits = sum(1 for keyword in STAIR_KEYWORDS if keyword in lowered)
+        return total * (1.0 + KEYWORD_BOOST * min(keyword_hits, 3))
+
+    def search(self, query_terms: List[str], top_k: int = DEFAULT_TOP_K) -> List[Clause]:
+        """
+        检索与检索词最相关的条文
+
+        Args:
+            query_terms: 检索词
+            top_k: 返回的条文数
+
+        Returns:
+            List[Clause]: 按得分从高到低排列的条文（不含得分为0的条文）
+        """
+        query_tokens = [token for term in query_terms for token in tokenize(term)]
+        scored = [(self.score(clause, query_tokens), clause) for clause in self.clauses]
+        scored = [item for item in scored if item[0] > 0.0]
+        scored.sort(key=lambda item: (-item[0], item[1].position))
+        return [clause for _, clause in scored[:top_k]]
+
+    def retrieve_for_rules(self, top_k: int = DEFAULT_TOP_K) -> List[Clause]:
+        """
+        为每类楼梯规则检索top_k个条文，合并去重后按原文顺序排列
+
+        Args:
+            top_k: 每类规则的条文数
+
+        Returns:
+            List[Clause]: 发送给LLM的条文
+        """
+        selected = {}
+        for query_terms in RULE_QUERIES.values():
+            for clause in self.search(query_terms, top_k):
+                selected[clause.position] = clause
+
+        clauses = [selected[position] for position in sorted(selected)]
+        console.print(f"[cyan]条文检索: 共 {len(self.clauses)} 条，选出 {len(clauses)} 条发送给LLM[/cyan]")
+        return clauses
+
+
+def format_clauses(clauses: List[Clause]) -> str:
+    """把检索到的条文格式化为提示词中的规范文本（标明页码）"""
+    return "\n\n".join(f"=== 第{clause.page_number}页 ===\n{clause.text}" for clause in clauses)
+
+
+def batch_clauses(clauses: List[Clause], max_chars: int) -> List[str]:
+    """
+    把条文按原文顺序分批，每批格式化后不超过max_chars（单个条文超长时单独成批）
+
+    Args:
+        clauses: 检索到的条文
+        max_chars: 每批的最大字符数
+
+    Returns:
+        List[str]: 每批的规范文本（至少一批）
+    """
+    batches = []
+    current = []
+    length = 0
+    for clause in clauses:
+        clause_length = len(format_clauses([clause])) + 2
+        if current and length + clause_length > max_chars:
+            batches.append(format_clauses(current))
+            current = []
+            length = 0
+        current.append(clause)
+        length += clause_length
+    if current or not batches:
+        batches.append(format_clauses(current))
+    return batches
+
+
+if __name__ == "__main__":
+    # 测试代码
+    test_pages = [
+        {"page_number": 1, "text": "住宅建筑规范 GB 50368-2005\n1.0.1 为贯彻执行国家技术经济政策，制定本规范。\n"},
+        {"page_number": 12, "text": "6.3 楼梯\n6.3.1 楼梯间应设置采光窗。\n6.3.2 楼梯梯段净宽不应小于1.10m，踏步宽度不应小于0.26m，"},
+        {"page_number": 13, "text": "踏步高度不应大于0.175m。\n6.3.3 中间平台宽度不应小于1.20m。\n6.4 电梯\n6.4.1 七层及以上的住宅应设置电梯。\n"},
+    ]
+
+    retriever = ClauseRetriever(test_pages)
+    for rule_name, query_terms in RULE_QUERIES.items():
+        print(rule_name, [clause.number for clause in retriever.search(query_terms, 2)])
+    print(format_clauses(retriever.retrieve_for_rules(2)))
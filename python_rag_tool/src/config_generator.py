@@ -57,6 +57,24 @@ class ConfigGenerator:
         if regulation.landing_length:
             config["landing_length"] = rule_to_dict(regulation.landing_length)
 
+        if regulation.narrow_tread_depth:
+            config["narrow_tread_depth"] = rule_to_dict(regulation.narrow_tread_depth)
+
+        if regulation.riser_variation:
+            config["riser_variation"] = rule_to_dict(regulation.riser_variation)
+
+        if regulation.stair_width:
+            config["stair_width"] = rule_to_dict(regulation.stair_width)
+
+        if regulation.handrail_height:
+            config["handrail_height"] = rule_to_dict(regulation.handrail_height)
+
+        if regulation.slope_angle:
+            config["slope_angle"] = rule_to_dict(regulation.slope_angle)
+
+        if regulation.between_flights:
+            config["between_flights"] = rule_to_dict(regulation.between_flights)
+
         return config
 
     @staticmethod
@@ -136,6 +154,54 @@ namespace RegulationConfig {{
     constexpr const wchar_t* LANDING_LENGTH_TEXT = L"{regulation.landing_length.full_text}";
 """
 
+        if regulation.narrow_tread_depth and regulation.narrow_tread_depth.min_value:
+            header_content += f"""
+    // {regulation.narrow_tread_depth.full_text}
+    constexpr double NARROW_TREAD_DEPTH_MIN = {regulation.narrow_tread_depth.min_value};  // {regulation.narrow_tread_depth.unit}
+    constexpr const wchar_t* NARROW_TREAD_DEPTH_SOURCE = L"{regulation.narrow_tread_depth.source}";
+    constexpr const wchar_t* NARROW_TREAD_DEPTH_TEXT = L"{regulation.narrow_tread_depth.full_text}";
+"""
+
+        if regulation.riser_variation and regulation.riser_variation.max_value:
+            header_content += f"""
+    // {regulation.riser_variation.full_text}
+    constexpr double RISER_VARIATION_MAX = {regulation.riser_variation.max_value};  // {regulation.riser_variation.unit}
+    constexpr const wchar_t* RISER_VARIATION_SOURCE = L"{regulation.riser_variation.source}";
+    constexpr const wchar_t* RISER_VARIATION_TEXT = L"{regulation.riser_variation.full_text}";
+"""
+
+        if regulation.stair_width and regulation.stair_width.min_value:
+            header_content += f"""
+    // {regulation.stair_width.full_text}
+    constexpr double STAIR_WIDTH_MIN = {regulation.stair_width.min_value};  // {regulation.stair_width.unit}
+    constexpr const wchar_t* STAIR_WIDTH_SOURCE = L"{regulation.stair_width.source}";
+    constexpr const wchar_t* STAIR_WIDTH_TEXT = L"{regulation.stair_width.full_text}";
+"""
+
+        if regulation.handrail_height and regulation.handrail_height.min_value:
+            header_content += f"""
+    // {regulation.handrail_height.full_text}
+    constexpr double HANDRAIL_HEIGHT_MIN = {regulation.handrail_height.min_value};  // {regulation.handrail_height.unit}
+    constexpr const wchar_t* HANDRAIL_HEIGHT_SOURCE = L"{regulation.handrail_height.source}";
+    constexpr const wchar_t* HANDRAIL_HEIGHT_TEXT = L"{regulation.handrail_height.full_text}";
+"""
+
+        if regulation.slope_angle and regulation.slope_angle.max_value:
+            header_content += f"""
+    // {regulation.slope_angle.full_text}
+    constexpr double SLOPE_ANGLE_MAX = {regulation.slope_angle.max_value};  // {regulation.slope_angle.unit}
+    constexpr const wchar_t* SLOPE_ANGLE_SOURCE = L"{regulation.slope_angle.source}";
+    constexpr const wchar_t* SLOPE_ANGLE_TEXT = L"{regulation.slope_angle.full_text}";
+"""
+
+        if regulation.between_flights and regulation.between_flights.min_value:
+            header_content += f"""
+    // {regulation.between_flights.full_text}
+    constexpr double BETWEEN_FLIGHTS_MIN = {regulation.between_flights.min_value};  // {regulation.between_flights.unit}
+    constexpr const wchar_t* BETWEEN_FLIGHTS_SOURCE = L"{regulation.between_flights.source}";
+    constexpr const wchar_t* BETWEEN_FLIGHTS_TEXT = L"{regulation.between_flights.full_text}";
+"""
+
         header_content += """
 }}  // namespace RegulationConfig
 
@@ -204,6 +270,54 @@ namespace RegulationConfig {{
                 regulation.landing_length.full_text
             )
 
+        if regulation.narrow_tread_depth and regulation.narrow_tread_depth.min_value:
+            table.add_row(
+                "扇形踏步窄端宽度",
+                f"≥ {regulation.narrow_tread_depth.min_value} {regulation.narrow_tread_depth.unit}",
+                regulation.narrow_tread_depth.source,
+                regulation.narrow_tread_depth.full_text
+            )
+
+        if regulation.riser_variation and regulation.riser_variation.max_value:
+            table.add_row(
+                "踢面高度差",
+                f"≤ {regulation.riser_variation.max_value} {regulation.riser_variation.unit}",
+                regulation.riser_variation.source,
+                regulation.riser_variation.full_text
+            )
+
+        if regulation.stair_width and regulation.stair_width.min_value:
+            table.add_row(
+                "梯段净宽",
+                f"≥ {regulation.stair_width.min_value} {regulation.stair_width.unit}",
+                regulation.stair_width.source,
+                regulation.stair_width.full_text
+            )
+
+        if regulation.handrail_height and regulation.handrail_height.min_value:
+            table.add_row(
+                "扶手高度",
+                f"≥ {regulation.handrail_height.min_value} {regulation.handrail_height.unit}",
+                regulation.handrail_height.source,
+                regulation.handrail_height.full_text
+            )
+
+        if regulation.slope_angle and regulation.slope_angle.max_value:
+            table.add_row(
+                "梯段坡度",
+                f"≤ {regulation.slope_angle.max_value}°",
+                regulation.slope_angle.source,
+                regulation.slope_angle.full_text
+            )
+
+        if regulation.between_flights and regulation.between_flights.min_value:
+            table.add_row(
+                "梯段间距",
+                f"≥ {regulation.between_flights.min_value} {regulation.between_flights.unit}",
+                regulation.between_flights.source,
+                regulation.between_flights.full_text
+            )
+
         console.print(table)
         console.print()
 
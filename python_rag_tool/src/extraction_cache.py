@@ -0,0 +1,209 @@
+"""
+提取缓存模块
+按内容寻址缓存提取结果，同一份PDF再次上传时直接返回上次的结果
+
+缓存分三层，键都是内容的SHA-256：
+  - 文档：PDF字节 + 提取器版本 → 规范数据（同一文件再次上传，不解析也不调用LLM）
+  - 文本：楼梯相关页的文本 + 提取器版本 → 规范数据（修订版只改了无关页面时不再调用LLM）
+  - 页面：页面内容指纹 + 解析方法 → 该页解析出的文本（修订版只重新解析改动的页）
+"""
+import hashlib
+import json
+import os
+import tempfile
+from pathlib import Path
+from typing import Callable, Dict, List, Optional, Tuple
+from rich.console import Console
+
+from regulation_extractor import PartialExtractionError, StairRegulation
+from config_generator import ConfigGenerator
+
+console = Console()
+
+# 缓存文件格式或键的组成改变时递增，旧缓存自动失效
+CACHE_FORMAT_VERSION = 2
+
+DEFAULT_CACHE_DIR = Path(__file__).resolve().parent.parent / "cache"
+
+
+def hash_file(path: str) -> str:
+    """分块计算文件的SHA-256"""
+    digest = hashlib.sha256()
+    with open(path, "rb") as f:
+        for chunk in iter(lambda: f.read(1 << 20), b""):
+            digest.update(chunk)
+    return digest.hexdigest()
+
+
+def hash_text(*parts: str) -> str:
+    """计算若干字符串的SHA-256（各部分之间加分隔符，避免拼接歧义）"""
+    digest = hashlib.sha256()
+    for part in parts:
+        digest.update(part.encode("utf-8"))
+        digest.update(b"\0")
+    return digest.hexdigest()
+
+
+class ExtractionCache:
+    """本地目录中的提取缓存"""
+
+    def __init__(self, cache_dir: Optional[str] = None):
+        """
+        Args:
+            cache_dir: 缓存目录（默认读取环境变量REGULATION_CACHE_DIR，未设置时为 python_rag_tool/cache）
+        """
+        self.cache_dir = Path(cache_dir or os.getenv("REGULATION_CACHE_DIR") or DEFAULT_CACHE_DIR)
+
+    def document_key(self, pdf_path: str, extractor_version: str) -> str:
+        """文档缓存键：文件内容和提取器版本"""
+        return hash_text("document", str(CACHE_FORMAT_VERSION), extractor_version, hash_file(pdf_path))
+
+    def text_key(self, pages_content: List[Dict], extractor_version: str) -> str:
+        """文本缓存键：提取器实际读取的页码和文本"""
+        pages = json.dumps([[page["page_number"], page["text"]] for page in pages_content], ensure_ascii=False)
+        return hash_text("text", str(CACHE_FORMAT_VERSION), extractor_version, pages)
+
+    def page_key(self, fingerprint: str, method: str) -> str:
+        """页面缓存键：页面指纹和解析方法"""
+        return hash_text("page", str(CACHE_FORMAT_VERSION), method, fingerprint)
+
+    def load_regulation(self, key: str) -> Optional[StairRegulation]:
+        """读取缓存的规范数据，不存在或已损坏时返回None"""
+        data = self._read(self.cache_dir / "regulations" / f"{key}.json")
+        if data is None:
+            return None
+        try:
+            return StairRegulation(**data)
+        except (TypeError, ValueError):
+            return None
+
+    def save_regulation(self, key: str, regulation: StairRegulation) -> None:
+        """缓存规范数据"""
+        self._write(self.cache_dir / "regulations" / f"{key}.json", ConfigGenerator.regulation_to_dict(regulation))
+
+    def load_page(self, key: str) -> Optional[Dict]:
+        """读取缓存的页面解析结果"""
+        data = self._read(self.cache_dir / "pages" / key[:2] / f"{key}.json")
+        return data if isinstance(data, dict) and "text" in data else None
+
+    def save_page(self, key: str, page_data: Dict) -> None:
+        """缓存页面解析结果"""
+        self._write(self.cache_dir / "pages" / key[:2] / f"{key}.json", page_data)
+
+    @staticmethod
+    def _read(path: Path):
+        try:
+            with open(path, "r", encoding="utf-8") as f:
+                return json.load(f)
+        except (OSError, ValueError):
+            return None
+
+    @staticmethod
+    def _write(path: Path, data) -> None:
+        """先写临时文件再替换，并发的进程不会读到写了一半的缓存；写入失败只影响缓存，不影响提取"""
+        try:
+            path.parent.mkdir(parents=True, exist_ok=True)
+            fd, temp_path = tempfile.mkstemp(dir=path.parent, suffix=".tmp")
+            with os.fdopen(fd, "w", encoding="utf-8") as f:
+                json.dump(data, f, ensure_ascii=False)
+            os.replace(temp_path, path)
+        except OSError as e:
+            console.print(f"[yellow]写入提取缓存失败: {e}[/yellow]")
+
+
+def load_pages(
+    path: str,
+    cache: Optional[ExtractionCache] = None,
+    progress: Optional[Callable[[str, str], None]] = None
+) -> List[Dict]:
+    """读取规范文本：PDF按页解析（使用页面缓存），.txt文件整体作为一页（便于测试）"""
+    if Path(path).suffix.lower() == ".txt":
+        text = Path(path).read_text(encoding="utf-8")
+        return [{"page_number": 1, "text": text, "method": "text"}]
+
+    from pdf_parser import PDFParser
+    return PDFParser(path).parse(cache=cache, progress=progress)
+
+
+def extract_regulation(
+    pdf_path: str,
+    extractor,
+    cache: Optional[ExtractionCache] = None,
+    progress: Optional[Callable[[str, str], None]] = None
+) -> Tuple[StairRegulation, Optional[str]]:
+    """
+    解析、提取并验证规范，依次查找文档缓存和文本缓存
+
+    Args:
+        pdf_path: PDF文件路径
+        extractor: 提取器（RegulationExtractor或LocalRegulationExtractor）
+        cache: 提取缓存，为None时不使用缓存
+        progress: 进度回调 (阶段, 说明)
+
+    Returns:
+        (规范数据, 命中的缓存："document" / "text" / None)
+
+    Raises:
+        PartialExtractionError: 部分批次提取失败，异常中带有验证后的不完整结果，该结果不写入缓存
+    """
+    def report(stage: str, message: str) -> None:
+        if progress:
+            progress(stage, message)
+
+    version = extractor.cache_version()
+
+    document_key = None
+    if cache is not None:
+        document_key = cache.document_key(pdf_path, version)
+        regulation = cache.load_regulation(document_key)
+        if regulation is not None:
+            report("cache", "使用缓存的提取结果（文件未改变）")
+            return regulation, "document"
+
+    report("parse", f"解析PDF文件: {Path(pdf_path).name}")
+    pages_content = load_pages(pdf_path, cache, progress)
+    if not pages_content:
+        raise ValueError("未找到楼梯相关内容")
+
+    if cache is not None:
+        text_key = cache.text_key(pages_content, version)
+        regulation = cache.load_regulation(text_key)
+        if regulation is not None:
+            report("cache", "使用缓存的提取结果（楼梯相关条文未改变）")
+            cache.save_regulation(document_key, regulation)
+            return regulation, "text"
+
+    report("extract", "提取规范数据")
+    try:
+        regulation = extractor.extract_with_llm(pages_content)
+    except PartialExtractionError as e:
+        # 不完整的结果不写入缓存，下次上传同一文件时重新提取
+        report("validate", f"验证提取的数据（{e}，结果不写入缓存）")
+        e.regulation = extractor.validate_and_fix(e.regulation)
+        raise
+
+    report("validate", "验证提取的数据")
+    regulation = extractor.validate_and_fix(regulation)
+
+    if cache is not None:
+        cache.save_regulation(text_key, regulation)
+        cache.save_regulation(document_key, regulation)
+    return regulation, None
+
+
+if __name__ == "__main__":
+    # 测试代码：同一文本提取两次，第二次应命中文档缓存
+    import sys
+    import time
+    from local_extractor import LocalRegulationExtractor
+
+    if len(sys.argv) > 1:
+        extractor = LocalRegulationExtractor()
+        cache = ExtractionCache(sys.argv[2] if len(sys.argv) > 2 else None)
+        for attempt in range(2):
+            started = time.perf_counter()
+            regulation, hit = extract_regulation(sys.argv[1], extractor, cache)
+            print(f"第{attempt + 1}次: 缓存={hit}, 用时 {time.perf_counter() - started:.3f} 秒")
+        print(regulation)
+    else:
+        print("用法: python extraction_cache.py <pdf或txt文件路径> [缓存目录]")
@@ -0,0 +1,173 @@
+"""
+本地规范提取模块
+不调用LLM，按常见条文句式从文本中提取楼梯规范数据，用于离线测试提取流程和常驻进程
+"""
+import re
+from typing import List, Dict, Optional, Tuple
+from rich.console import Console
+
+from regulation_extractor import RegulationExtractor, RegulationRule, StairRegulation, merge_rules
+
+console = Console()
+
+# 匹配规则改变时递增，之前缓存的提取结果随之失效
+LOCAL_EXTRACTOR_VERSION = 4
+
+
+# 限值句式："踏步高度不应大于0.175m"、"踏步宽度不宜小于260mm"
+LIMIT_PATTERN = r"{keyword}[^。；;\n]*?不[应宜得](大于|超过|小于|低于)\s*(\d+(?:\.\d+)?)\s*(mm|毫米|m|米)?"
+
+# 角度句式："楼梯的坡度不宜大于38°"，只有上限
+ANGLE_PATTERN = r"{keyword}[^。；;\n]*?不[应宜得](大于|超过)\s*(\d+(?:\.\d+)?)\s*(?:°|度)"
+
+# 范围句式："2R+G应在540~620mm之间"
+RANGE_PATTERN = re.compile(
+    r"2R\s*\+\s*G[^。；;\n]*?(\d+(?:\.\d+)?)\s*(mm|毫米|m|米)?\s*[~～至\-]\s*(\d+(?:\.\d+)?)\s*(mm|毫米|m|米)?"
+)
+
+# 条文编号，如 "6.3.2"
+CLAUSE_PATTERN = re.compile(r"(?<![\d.])(\d+\.\d+(?:\.\d+)*)\s")
+
+# 扇形踏步和螺旋楼梯的条文，普通踏步宽度不取其中的限值
+WINDER_PATTERN = r"扇形踏步|螺旋楼梯"
+
+# (规则名, 条文关键词, 排除的条文)
+LIMIT_RULES = [
+    ("riser_height", r"踏步高度(?!之?差)", None),
+    ("tread_depth", r"踏步宽度", WINDER_PATTERN),
+    ("landing_length", r"平台(?:宽度|长度|深度)", None),
+    ("narrow_tread_depth", r"(?:扇形踏步|螺旋楼梯)[^。；;\n]*?踏步宽度", None),
+    ("riser_variation", r"(?:踏步|踢面)高度之?差", None),
+    ("stair_width", r"(?:梯段|楼梯)的?(?:最小)?净宽", None),
+    ("handrail_height", r"扶手(?:的)?高度", None),
+    ("between_flights", r"梯段[^。；;\n]*?间的?水平净距", None),
+]
+
+# 坡度关键词（以度为单位，单独提取）
+SLOPE_KEYWORD = r"(?:坡度|倾斜角)"
+
+
+def to_meters(value: float, unit: Optional[str]) -> float:
+    """按单位换算为米；未写单位时大于10的数值按毫米处理"""
+    if unit in ("mm", "毫米") or (not unit and value > 10):
+        return round(value / 1000.0, 6)
+    return value
+
+
+def find_clause(text: str, position: int) -> str:
+    """查找位置之前最近的条文编号"""
+    window = text[max(0, position - 200):position]
+    matches = CLAUSE_PATTERN.findall(window)
+    return f"第{matches[-1]}条" if matches else ""
+
+
+def sentence_at(text: str, start: int, end: int) -> str:
+    """取出匹配所在的句子作为完整条文"""
+    begin = max(text.rfind("。", 0, start), text.rfind("\n", 0, start)) + 1
+    stop_candidates = [i for i in (text.find("。", end), text.find("\n", end)) if i >= 0]
+    stop = min(stop_candidates) + 1 if stop_candidates else len(text)
+    return text[begin:stop].strip()
+
+
+class LocalRegulationExtractor(RegulationExtractor):
+    """本地规则提取器（与LLM提取器接口相同）"""
+
+    def __init__(self):
+        """不创建LLM客户端，无需API密钥和网络"""
+        self.api_key = None
+        self.base_url = None
+        self.client = None
+
+    def cache_version(self) -> str:
+        """提取缓存使用的版本标识"""
+        return f"local-{LOCAL_EXTRACTOR_VERSION}"
+
+    def extract_limit(self, text: str, keyword: str, exclude: Optional[str] = None) -> Optional[RegulationRule]:
+        """提取单项上限或下限规则；多处条文给出限值时取最严格的（与分批提取的合并规则一致），
+        所在句子匹配exclude的条文不计入"""
+        rules = []
+        for match in re.finditer(LIMIT_PATTERN.format(keyword=keyword), text):
+            full_text = sentence_at(text, match.start(), match.end())
+            if exclude and re.search(exclude, full_text):
+                continue
+            value = to_meters(float(match.group(2)), match.group(3))
+            is_max = match.group(1) in ("大于", "超过")
+            rules.append(RegulationRule(
+                min_value=None if is_max else value,
+                max_value=value if is_max else None,
+                unit="m",
+                source=find_clause(text, match.start()),
+                full_text=full_text
+            ))
+        return merge_rules(rules)
+
+    def extract_angle(self, text: str) -> Optional[RegulationRule]:
+        """提取坡度上限（度），多处条文给出限值时取最严格的"""
+        rules = []
+        for match in re.finditer(ANGLE_PATTERN.format(keyword=SLOPE_KEYWORD), text):
+            rules.append(RegulationRule(
+                max_value=float(match.group(2)),
+                unit="deg",
+                source=find_clause(text, match.start()),
+                full_text=sentence_at(text, match.start(), match.end())
+            ))
+        return merge_rules(rules)
+
+    def extract_range(self, text: str) -> Optional[RegulationRule]:
+        """提取2R+G范围规则，只写了后一个单位时两个数值使用同一单位"""
+        match = RANGE_PATTERN.search(text)
+        if not match:
+            return None
+
+        unit = match.group(4) or match.group(2)
+        low = to_meters(float(match.group(1)), match.group(2) or unit)
+        high = to_meters(float(match.group(3)), unit)
+        return RegulationRule(
+            min_value=min(low, high),
+            max_value=max(low, high),
+            unit="m",
+            source=find_clause(text, match.start()) or "经验公式",
+            full_text=sentence_at(text, match.start(), match.end())
+        )
+
+    def extract_with_llm(self, pages_content: List[Dict]) -> StairRegulation:
+        """
+        按条文句式提取楼梯规范（保持与LLM提取器相同的方法名，便于替换）
+
+        Args:
+            pages_content: 页面内容列表
+
+        Returns:
+            StairRegulation: 提取的规范数据
+        """
+        combined_text = "\n".join(page["text"] for page in pages_content)
+        reg_info = self.extract_regulation_info(combined_text)
+
+        console.print("[cyan]正在使用本地规则提取规范数据...[/cyan]")
+
+        rules = {name: self.extract_limit(combined_text, keyword, exclude) for name, keyword, exclude in LIMIT_RULES}
+        rules["two_r_plus_g"] = self.extract_range(combined_text)
+        rules["slope_angle"] = self.extract_angle(combined_text)
+
+        found = sum(1 for rule in rules.values() if rule is not None)
+        console.print(f"[green][OK] 本地提取完成，找到 {found} 条规则[/green]")
+
+        return StairRegulation(
+            regulation_name=reg_info["regulation_name"] or "未知规范",
+            regulation_code=reg_info["regulation_code"],
+            **rules
+        )
+
+
+if __name__ == "__main__":
+    # 测试代码
+    test_text = """
+    住宅建筑规范 GB 50368-2005
+
+    6.3 楼梯
+    6.3.2 楼梯梯段净宽不应小于1.10m，踏步宽度不应小于0.26m，踏步高度不应大于0.175m。
+    6.3.3 中间平台宽度不应小于1.20m。
+    """
+
+    regulation = LocalRegulationExtractor().extract_with_llm([{"page_number": 1, "text": test_text}])
+    print(regulation)
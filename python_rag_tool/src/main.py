@@ -8,9 +8,9 @@ from rich.console import Console
 from rich.prompt import Prompt, Confirm
 from rich.panel import Panel
 
-from pdf_parser import PDFParser
-from regulation_extractor import RegulationExtractor
+from regulation_extractor import PartialExtractionError, RegulationExtractor
 from config_generator import ConfigGenerator
+from extraction_cache import ExtractionCache, extract_regulation
 
 console = Console()
 
@@ -29,7 +29,7 @@ def print_banner():
     console.print(banner, style="bold blue")
 
 
-def process_pdf(pdf_path: str, output_path: str = None, generate_cpp: bool = False):
+def process_pdf(pdf_path: str, output_path: str = None, generate_cpp: bool = False, use_cache: bool = True):
     """
     处理PDF文件并生成配置
 
@@ -37,25 +37,29 @@ def process_pdf(pdf_path: str, output_path: str = None, generate_cpp: bool = Fal
         pdf_path: PDF文件路径
         output_path: 输出JSON文件路径（可选）
         generate_cpp: 是否生成C++头文件
+        use_cache: 是否使用提取缓存（同一文件或楼梯条文未改变时不再调用LLM）
     """
-    try:
-        # 1. 解析PDF
-        console.print(f"\n[bold]步骤 1/4:[/bold] 解析PDF文件\n", style="cyan")
-        parser = PDFParser(pdf_path)
-        pages_content = parser.parse()
-
-        if not pages_content:
-            console.print("[red]错误: 未找到楼梯相关内容[/red]")
-            return False
+    # 1-3. 解析PDF、提取规范、验证数据（命中缓存时跳过）
+    steps = {
+        "cache": "[bold]步骤 1/4:[/bold] 使用缓存的提取结果",
+        "parse": "[bold]步骤 1/4:[/bold] 解析PDF文件",
+        "extract": "[bold]步骤 2/4:[/bold] 使用LLM提取规范数据",
+        "validate": "[bold]步骤 3/4:[/bold] 验证提取的数据"
+    }
+
+    def progress(stage: str, message: str) -> None:
+        console.print(f"\n{steps[stage]}\n", style="cyan")
+        if stage == "cache":
+            console.print(f"[green]{message}[/green]")
 
-        # 2. 提取规范
-        console.print(f"\n[bold]步骤 2/4:[/bold] 使用LLM提取规范数据\n", style="cyan")
+    try:
         extractor = RegulationExtractor()
-        regulation = extractor.extract_with_llm(pages_content)
-
-        # 3. 验证数据
-        console.print(f"\n[bold]步骤 3/4:[/bold] 验证提取的数据\n", style="cyan")
-        regulation = extractor.validate_and_fix(regulation)
+        cache = ExtractionCache() if use_cache else None
+        try:
+            regulation, _ = extract_regulation(pdf_path, extractor, cache, progress)
+        except PartialExtractionError as e:
+            console.print(f"[yellow][WARNING] {e}，以下结果不完整且未写入缓存，请稍后重新提取[/yellow]")
+            regulation = e.regulation
 
         # 4. 显示结果
         ConfigGenerator.display_summary(regulation)
@@ -166,12 +170,18 @@ def main():
         help="同时生成C++头文件"
     )
 
+    parser.add_argument(
+        "--no-cache",
+        action="store_true",
+        help="不使用提取缓存，重新解析和提取"
+    )
+
     args = parser.parse_args()
 
     # 命令行模式
     if args.pdf:
         print_banner()
-        process_pdf(args.pdf, args.output, args.cpp)
+        process_pdf(args.pdf, args.output, args.cpp, not args.no_cache)
     # 交互式模式
     else:
         interactive_mode()
@@ -0,0 +1,149 @@
+"""
+本地模拟LLM服务
+提供与OpenAI兼容的 /v1/chat/completions 接口，用本地规则（LocalRegulationExtractor）从提示词中的条文提取规范，
+用于离线测试分批并发请求和结果合并，无需API密钥和网络
+
+  python src/mock_llm_server.py --port 8765 --delay 2
+
+  # 另一个终端中
+  set OPENAI_BASE_URL=http://127.0.0.1:8765/v1
+  set OPENAI_API_KEY=mock
+  set LLM_BATCH_CHARS=1500
+  python src/main.py --pdf 规范.pdf --no-cache
+
+GET /stats 返回请求总数和最大同时请求数，用于确认并发数没有超过LLM_MAX_CONCURRENCY。
+"""
+import argparse
+import json
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from rich.console import Console
+
+from config_generator import ConfigGenerator
+from local_extractor import LocalRegulationExtractor
+
+console = Console()
+
+# 提示词中条文部分的起止标记（见RegulationExtractor.build_prompt）
+TEXT_BEGIN = "规范文本（按规则类型检索出的相关条文）："
+TEXT_END = "请提取以下信息"
+
+
+class MockState:
+    """请求计数（各请求线程共用）"""
+
+    def __init__(self, delay: float):
+        self.delay = delay
+        self.lock = threading.Lock()
+        self.requests = 0
+        self.active = 0
+        self.max_active = 0
+
+    def enter(self) -> None:
+        with self.lock:
+            self.requests += 1
+            self.active += 1
+            self.max_active = max(self.max_active, self.active)
+
+    def leave(self) -> None:
+        with self.lock:
+            self.active -= 1
+
+    def stats(self) -> dict:
+        with self.lock:
+            return {"requests": self.requests, "active": self.active, "max_concurrent": self.max_active}
+
+
+def answer(prompt: str) -> dict:
+    """按本地规则提取提示词中的条文，返回与LLM相同格式的JSON"""
+    text = prompt
+    if TEXT_BEGIN in text:
+        text = text.split(TEXT_BEGIN, 1)[1].split(TEXT_END, 1)[0]
+
+    regulation = LocalRegulationExtractor().extract_with_llm([{"page_number": 1, "text": text}])
+    result = ConfigGenerator.regulation_to_dict(regulation)
+
+    # 与LLM一样，找不到的信息返回null
+    if result["regulation_name"] == "未知规范":
+        result["regulation_name"] = None
+    return result
+
+
+def make_handler(state: MockState):
+    class Handler(BaseHTTPRequestHandler):
+        def send_json(self, status: int, body: dict) -> None:
+            data = json.dumps(body, ensure_ascii=False).encode("utf-8")
+            self.send_response(status)
+            self.send_header("Content-Type", "application/json; charset=utf-8")
+            self.send_header("Content-Length", str(len(data)))
+            self.end_headers()
+            self.wfile.write(data)
+
+        def do_GET(self):
+            if self.path.rstrip("/").endswith("/stats"):
+                self.send_json(200, state.stats())
+            else:
+                self.send_json(404, {"error": {"message": "not found"}})
+
+        def do_POST(self):
+            if not self.path.rstrip("/").endswith("/chat/completions"):
+                self.send_json(404, {"error": {"message": "not found"}})
+                return
+
+            state.enter()
+            try:
+                length = int(self.headers.get("Content-Length", 0))
+                request = json.loads(self.rfile.read(length).decode("utf-8"))
+                prompt = request["messages"][-1]["content"]
+
+                # 模拟LLM的响应时间，使并发请求在服务端重叠
+                time.sleep(state.delay)
+                content = json.dumps(answer(prompt), ensure_ascii=False)
+
+                self.send_json(200, {
+                    "id": f"mock-{state.requests}",
+                    "object": "chat.completion",
+                    "created": int(time.time()),
+                    "model": request.get("model", "mock"),
+                    "choices": [{
+                        "index": 0,
+                        "message": {"role": "assistant", "content": content},
+                        "finish_reason": "stop"
+                    }],
+                    "usage": {"prompt_tokens": len(prompt), "completion_tokens": len(content), "total_tokens": len(prompt) + len(content)}
+                })
+            except (ValueError, KeyError, IndexError) as e:
+                self.send_json(400, {"error": {"message": f"invalid request: {e}"}})
+            finally:
+                state.leave()
+
+        def log_message(self, format, *args):
+            console.print(f"[dim]{self.address_string()} {format % args}[/dim]")
+
+    return Handler
+
+
+def main():
+    """主函数"""
+    parser = argparse.ArgumentParser(description="本地模拟LLM服务（OpenAI兼容接口，用于离线测试）")
+    parser.add_argument("--host", default="127.0.0.1", help="监听地址（默认: 127.0.0.1）")
+    parser.add_argument("--port", type=int, default=8765, help="端口（默认: 8765）")
+    parser.add_argument("--delay", type=float, default=1.0, help="每个请求的模拟响应时间，秒（默认: 1）")
+    args = parser.parse_args()
+
+    state = MockState(args.delay)
+    server = ThreadingHTTPServer((args.host, args.port), make_handler(state))
+    console.print(f"[green]模拟LLM服务: http://{args.host}:{args.port}/v1 （响应时间 {args.delay} 秒）[/green]")
+
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+        console.print(f"[cyan]请求统计: {state.stats()}[/cyan]")
+
+
+if __name__ == "__main__":
+    main()
@@ -2,15 +2,111 @@
 PDF解析模块
 用于从PDF文件中提取文本内容
 """
+import hashlib
+import os
 import fitz  # PyMuPDF
 import pdfplumber
-from typing import List, Dict
+from concurrent.futures import ProcessPoolExecutor, FIRST_COMPLETED, wait
+from typing import Callable, Iterator, List, Dict, Optional
 from pathlib import Path
 from rich.console import Console
 from rich.progress import track
 
 console = Console()
 
+STAIR_KEYWORDS = [
+    "楼梯", "踏步", "平台", "栏杆", "扶手",
+    "梯段", "踢面", "踏面", "梯井",
+    "stair", "step", "riser", "tread", "landing"
+]
+
+# 页数少于此值时在当前进程中解析，启动工作进程的开销大于并行的收益
+PARALLEL_MIN_PAGES = 40
+
+# 每个预扫描任务处理的页数
+SCAN_CHUNK_PAGES = 50
+
+# 工作进程数：CPU核数减一（留给界面和主进程），最多8个
+PROCESS_POOL_WORKERS = min(8, max(1, (os.cpu_count() or 2) - 1))
+
+# 常驻提取进程中多次解析共用同一个进程池，工作进程只启动一次
+_process_pool: Optional[ProcessPoolExecutor] = None
+
+
+def is_stair_related(text: str) -> bool:
+    """页面文本是否包含楼梯相关关键词"""
+    text = text.lower()
+    return any(keyword in text for keyword in STAIR_KEYWORDS)
+
+
+def get_process_pool() -> ProcessPoolExecutor:
+    """取得共用的进程池"""
+    global _process_pool
+    if _process_pool is None:
+        _process_pool = ProcessPoolExecutor(max_workers=PROCESS_POOL_WORKERS)
+    return _process_pool
+
+
+def reset_process_pool() -> None:
+    """关闭进程池（工作进程异常退出后调用，下次解析时重新创建）"""
+    global _process_pool
+    if _process_pool is not None:
+        _process_pool.shutdown(wait=False, cancel_futures=True)
+        _process_pool = None
+
+
+def scan_pages(pdf_path: str, page_indices: List[int]) -> List[Dict]:
+    """
+    预扫描（可在工作进程中运行）：用PyMuPDF快速提取文本，标记包含楼梯关键词的候选页
+
+    Args:
+        pdf_path: PDF文件路径
+        page_indices: 页面序号（从0开始）
+
+    Returns:
+        List[Dict]: 每页的文本，candidate表示是否为候选页
+    """
+    pages_data = []
+    doc = fitz.open(pdf_path)
+
+    for page_num in page_indices:
+        text = doc[page_num].get_text()
+        pages_data.append({
+            "page_number": page_num + 1,
+            "text": text,
+            "method": "pymupdf",
+            "candidate": is_stair_related(text)
+        })
+
+    doc.close()
+    return pages_data
+
+
+def extract_tables(pdf_path: str, page_indices: List[int]) -> List[Dict]:
+    """
+    精细解析（可在工作进程中运行）：用pdfplumber提取候选页的文本和表格
+
+    Args:
+        pdf_path: PDF文件路径
+        page_indices: 页面序号（从0开始）
+
+    Returns:
+        List[Dict]: 每页的文本、表格内容
+    """
+    pages_data = []
+
+    with pdfplumber.open(pdf_path) as pdf:
+        for page_num in page_indices:
+            page = pdf.pages[page_num]
+            pages_data.append({
+                "page_number": page_num + 1,
+                "text": page.extract_text() or "",
+                "tables": page.extract_tables(),
+                "method": "pdfplumber"
+            })
+
+    return pages_data
+
 
 class PDFParser:
     """PDF文档解析器"""
@@ -20,10 +116,13 @@ class PDFParser:
         if not self.pdf_path.exists():
             raise FileNotFoundError(f"PDF文件不存在: {pdf_path}")
 
-    def extract_text_with_pymupdf(self) -> List[Dict]:
+    def extract_text_with_pymupdf(self, page_indices: Optional[List[int]] = None) -> List[Dict]:
         """
         使用PyMuPDF提取文本（速度快，适合纯文本PDF）
 
+        Args:
+            page_indices: 只解析这些页（从0开始），为None时解析全部页面
+
         Returns:
             List[Dict]: 每页的文本内容和元数据
         """
@@ -32,7 +131,10 @@ class PDFParser:
         pages_data = []
         doc = fitz.open(self.pdf_path)
 
-        for page_num in track(range(len(doc)), description="提取文本"):
+        if page_indices is None:
+            page_indices = range(len(doc))
+
+        for page_num in track(page_indices, description="提取文本"):
             page = doc[page_num]
             text = page.get_text()
 
@@ -46,10 +148,13 @@ class PDFParser:
         console.print(f"[green]成功提取 {len(pages_data)} 页[/green]")
         return pages_data
 
-    def extract_text_with_pdfplumber(self) -> List[Dict]:
+    def extract_text_with_pdfplumber(self, page_indices: Optional[List[int]] = None) -> List[Dict]:
         """
         使用pdfplumber提取文本（适合表格和复杂布局）
 
+        Args:
+            page_indices: 只解析这些页（从0开始），为None时解析全部页面
+
         Returns:
             List[Dict]: 每页的文本、表格内容
         """
@@ -58,7 +163,11 @@ class PDFParser:
         pages_data = []
 
         with pdfplumber.open(self.pdf_path) as pdf:
-            for page_num, page in enumerate(track(pdf.pages, description="提取文本和表格")):
+            if page_indices is None:
+                page_indices = range(len(pdf.pages))
+
+            for page_num in track(page_indices, description="提取文本和表格"):
+                page = pdf.pages[page_num]
                 text = page.extract_text() or ""
                 tables = page.extract_tables()
 
@@ -72,6 +181,180 @@ class PDFParser:
         console.print(f"[green]成功提取 {len(pages_data)} 页[/green]")
         return pages_data
 
+    def page_fingerprints(self) -> List[str]:
+        """
+        计算每页的内容指纹（页面尺寸、内容流和字体），修订版中未改动的页面指纹不变
+
+        Returns:
+            List[str]: 按页排列的SHA-256
+        """
+        fingerprints = []
+        doc = fitz.open(self.pdf_path)
+
+        for page in doc:
+            digest = hashlib.sha256()
+            digest.update(repr(tuple(page.rect)).encode("utf-8"))
+            digest.update(page.read_contents())
+            for font in page.get_fonts():
+                digest.update(f"{font[3]}/{font[5]}".encode("utf-8"))
+            fingerprints.append(digest.hexdigest())
+
+        doc.close()
+        return fingerprints
+
+    def iter_pages(self, page_indices: Optional[List[int]] = None) -> Iterator[Dict]:
+        """
+        流水线解析页面，按完成顺序逐页产出
+
+        先用PyMuPDF分批预扫描（多个工作进程并行），每批扫描完成后立即把其中的候选页交给pdfplumber
+        提取文本和表格，与其余批次的预扫描重叠执行。非候选页只有PyMuPDF文本，不再做表格提取。
+
+        Args:
+            page_indices: 只解析这些页（从0开始），为None时解析全部页面
+
+        Yields:
+            Dict: 单页的文本内容（候选页含tables）
+        """
+        if page_indices is None:
+            doc = fitz.open(self.pdf_path)
+            page_indices = range(len(doc))
+            doc.close()
+
+        page_indices = list(page_indices)
+        pdf_path = str(self.pdf_path)
+
+        if len(page_indices) < PARALLEL_MIN_PAGES:
+            pages_data = scan_pages(pdf_path, page_indices)
+            candidates = [page["page_number"] - 1 for page in pages_data if page.pop("candidate")]
+            tables = {page["page_number"]: page for page in self._extract_candidates(pdf_path, candidates, pages_data)}
+            for page in pages_data:
+                yield tables.get(page["page_number"], page)
+            return
+
+        pool = get_process_pool()
+        pending = {}
+        prescanned = {}
+        try:
+            for start in range(0, len(page_indices), SCAN_CHUNK_PAGES):
+                chunk = page_indices[start:start + SCAN_CHUNK_PAGES]
+                pending[pool.submit(scan_pages, pdf_path, chunk)] = ("scan", chunk)
+
+            while pending:
+                done, _ = wait(pending, return_when=FIRST_COMPLETED)
+                for future in done:
+                    kind, chunk = pending.pop(future)
+                    if kind == "scan":
+                        candidates = []
+                        for page in future.result():
+                            if page.pop("candidate"):
+                                prescanned[page["page_number"] - 1] = page
+                                candidates.append(page["page_number"] - 1)
+                            else:
+                                yield page
+                        if candidates:
+                            pending[pool.submit(extract_tables, pdf_path, candidates)] = ("tables", candidates)
+                    else:
+                        try:
+                            yield from future.result()
+                        except Exception as e:
+                            # 表格提取失败的页面保留预扫描的文本
+                            console.print(f"[yellow]pdfplumber失败，使用pymupdf的文本: {e}[/yellow]")
+                            yield from (prescanned[index] for index in chunk)
+        finally:
+            for future in pending:
+                future.cancel()
+
+    @staticmethod
+    def _extract_candidates(pdf_path: str, candidates: List[int], prescanned: List[Dict]) -> List[Dict]:
+        """在当前进程中提取候选页的表格，失败时返回预扫描的文本"""
+        if not candidates:
+            return []
+        try:
+            return extract_tables(pdf_path, candidates)
+        except Exception as e:
+            console.print(f"[yellow]pdfplumber失败，使用pymupdf的文本: {e}[/yellow]")
+            return [page for page in prescanned if page["page_number"] - 1 in candidates]
+
+    def extract_pages(
+        self,
+        method: str,
+        page_indices: Optional[List[int]] = None,
+        progress: Optional[Callable[[str, str], None]] = None
+    ) -> List[Dict]:
+        """
+        按指定方法解析页面
+
+        Args:
+            method: 解析方法 ("pymupdf", "pdfplumber", "auto")
+            page_indices: 只解析这些页（从0开始），为None时解析全部页面
+            progress: 进度回调 (阶段, 说明)，auto方法每完成一批页面调用一次
+
+        Returns:
+            List[Dict]: 每页的文本内容（按页码排列）
+        """
+        if method == "pymupdf":
+            return self.extract_text_with_pymupdf(page_indices)
+        if method == "pdfplumber":
+            return self.extract_text_with_pdfplumber(page_indices)
+
+        # auto: 并行预扫描 + 只对候选页用pdfplumber提取表格，流水线失败时用pymupdf顺序解析
+        console.print(f"[cyan]正在并行解析: {self.pdf_path.name}[/cyan]")
+        pages_data = []
+        try:
+            for page in self.iter_pages(page_indices):
+                pages_data.append(page)
+                if progress and len(pages_data) % SCAN_CHUNK_PAGES == 0:
+                    progress("parse", f"已解析 {len(pages_data)} 页")
+        except Exception as e:
+            console.print(f"[yellow]并行解析失败，切换到pymupdf: {e}[/yellow]")
+            reset_process_pool()
+            return self.extract_text_with_pymupdf(page_indices)
+
+        pages_data.sort(key=lambda page: page["page_number"])
+        tables_count = sum(1 for page in pages_data if page["method"] == "pdfplumber")
+        console.print(f"[green]成功提取 {len(pages_data)} 页（{tables_count} 页提取了表格）[/green]")
+        return pages_data
+
+    def extract_pages_with_cache(
+        self,
+        method: str,
+        cache,
+        progress: Optional[Callable[[str, str], None]] = None
+    ) -> List[Dict]:
+        """
+        解析全部页面，指纹未变的页面直接使用缓存，只解析新增或改动的页
+
+        Args:
+            method: 解析方法
+            cache: 提取缓存（ExtractionCache）
+            progress: 进度回调 (阶段, 说明)
+
+        Returns:
+            List[Dict]: 每页的文本内容
+        """
+        fingerprints = self.page_fingerprints()
+        keys = [cache.page_key(fingerprint, method) for fingerprint in fingerprints]
+
+        pages_data = []
+        missing = []
+        for index, key in enumerate(keys):
+            page_data = cache.load_page(key)
+            if page_data is None:
+                missing.append(index)
+            else:
+                page_data["page_number"] = index + 1
+            pages_data.append(page_data)
+
+        console.print(f"[cyan]页面缓存: {len(keys) - len(missing)}/{len(keys)} 页未改变，需解析 {len(missing)} 页[/cyan]")
+
+        if missing:
+            for page_data in self.extract_pages(method, missing, progress):
+                index = page_data["page_number"] - 1
+                pages_data[index] = page_data
+                cache.save_page(keys[index], page_data)
+
+        return pages_data
+
     def extract_stair_related_content(self, pages_data: List[Dict]) -> List[Dict]:
         """
         筛选出与楼梯相关的内容
@@ -82,45 +365,32 @@ class PDFParser:
         Returns:
             List[Dict]: 楼梯相关的页面内容
         """
-        keywords = [
-            "楼梯", "踏步", "平台", "栏杆", "扶手",
-            "梯段", "踢面", "踏面", "梯井",
-            "stair", "step", "riser", "tread", "landing"
-        ]
-
-        stair_pages = []
-
-        for page_data in pages_data:
-            text = page_data["text"].lower()
-
-            # 检查是否包含楼梯相关关键词
-            if any(keyword in text for keyword in keywords):
-                stair_pages.append(page_data)
+        stair_pages = [page_data for page_data in pages_data if is_stair_related(page_data["text"])]
 
         console.print(f"[yellow]找到 {len(stair_pages)} 页包含楼梯相关内容[/yellow]")
         return stair_pages
 
-    def parse(self, method: str = "auto") -> List[Dict]:
+    def parse(
+        self,
+        method: str = "auto",
+        cache=None,
+        progress: Optional[Callable[[str, str], None]] = None
+    ) -> List[Dict]:
         """
         解析PDF并返回楼梯相关内容
 
         Args:
             method: 解析方法 ("pymupdf", "pdfplumber", "auto")
+            cache: 提取缓存（ExtractionCache，可选），提供时只解析改动过的页面
+            progress: 进度回调 (阶段, 说明)
 
         Returns:
             List[Dict]: 楼梯相关的页面内容
         """
-        if method == "pymupdf":
-            pages_data = self.extract_text_with_pymupdf()
-        elif method == "pdfplumber":
-            pages_data = self.extract_text_with_pdfplumber()
-        else:  # auto
-            # 先尝试pdfplumber（更准确），失败则用pymupdf
-            try:
-                pages_data = self.extract_text_with_pdfplumber()
-            except Exception as e:
-                console.print(f"[yellow]pdfplumber失败，切换到pymupdf: {e}[/yellow]")
-                pages_data = self.extract_text_with_pymupdf()
+        if cache is not None:
+            pages_data = self.extract_pages_with_cache(method, cache, progress)
+        else:
+            pages_data = self.extract_pages(method, progress=progress)
 
         # 筛选楼梯相关内容
         stair_content = self.extract_stair_related_content(pages_data)
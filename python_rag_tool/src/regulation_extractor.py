@@ -5,15 +5,34 @@
 import os
 import json
 import re
+from concurrent.futures import ThreadPoolExecutor
 from typing import List, Dict, Optional
 from pydantic import BaseModel, Field
 from rich.console import Console
 from openai import OpenAI
 from dotenv import load_dotenv
 
+from clause_retriever import ClauseRetriever, batch_clauses, format_clauses
+
 load_dotenv()
 console = Console()
 
+# 提示词或结果处理方式改变时递增，之前缓存的提取结果随之失效
+EXTRACTOR_VERSION = 3
+
+# 每类规则检索的条文数（分批请求后可以比单次请求时多取）
+EXTRACTION_TOP_K = 8
+
+# 每批条文的最大字符数，加上提示词模板后仍远小于常见模型的上下文长度
+DEFAULT_BATCH_CHARS = 6000
+
+# 同时进行的LLM请求数
+DEFAULT_MAX_CONCURRENCY = 4
+
+# 规则字段（merge_regulations按此逐项合并）
+RULE_FIELDS = ["riser_height", "tread_depth", "two_r_plus_g", "landing_length", "narrow_tread_depth", "riser_variation",
+               "stair_width", "handrail_height", "slope_angle", "between_flights"]
+
 
 # 定义规范数据结构
 class RegulationRule(BaseModel):
@@ -33,21 +52,108 @@ class StairRegulation(BaseModel):
     tread_depth: Optional[RegulationRule] = Field(None, description="踏步宽度规则")
     two_r_plus_g: Optional[RegulationRule] = Field(None, description="2R+G公式规则")
     landing_length: Optional[RegulationRule] = Field(None, description="平台长度规则")
+    narrow_tread_depth: Optional[RegulationRule] = Field(None, description="扇形踏步窄端宽度规则")
+    riser_variation: Optional[RegulationRule] = Field(None, description="同一梯段踢面高度差规则")
+    stair_width: Optional[RegulationRule] = Field(None, description="梯段净宽规则")
+    handrail_height: Optional[RegulationRule] = Field(None, description="扶手高度规则")
+    slope_angle: Optional[RegulationRule] = Field(None, description="梯段坡度规则（单位为度）")
+    between_flights: Optional[RegulationRule] = Field(None, description="两梯段之间水平净距规则")
+
+
+def merge_rules(rules: List[Optional[RegulationRule]]) -> Optional[RegulationRule]:
+    """
+    合并同一规则在各批中的提取结果：下限取最大值、上限取最小值（最严格的限值），
+    并保留给出该限值的条文来源；数值相同时保留先出现（原文中靠前）的条文
+
+    Args:
+        rules: 各批的提取结果（未找到的为None）
+
+    Returns:
+        Optional[RegulationRule]: 合并后的规则
+    """
+    rules = [rule for rule in rules if rule is not None]
+    if not rules:
+        return None
+
+    lower = None
+    upper = None
+    for rule in rules:
+        if rule.min_value is not None and (lower is None or rule.min_value > lower.min_value):
+            lower = rule
+        if rule.max_value is not None and (upper is None or rule.max_value < upper.max_value):
+            upper = rule
+
+    if lower is None and upper is None:
+        return rules[0]
+
+    winners = [lower] if upper is None or upper is lower else [rule for rule in (lower, upper) if rule is not None]
+    if lower is not None and upper is not None and lower.min_value > upper.max_value:
+        console.print(f"[yellow][WARNING] 条文限值冲突: 下限 {lower.min_value} ({lower.source}) 大于上限 {upper.max_value} ({upper.source})[/yellow]")
+
+    def join_unique(values: List[str], separator: str) -> str:
+        return separator.join(dict.fromkeys(value for value in values if value))
+
+    return RegulationRule(
+        min_value=lower.min_value if lower else None,
+        max_value=upper.max_value if upper else None,
+        unit=winners[0].unit or "m",
+        source=join_unique([rule.source for rule in winners], "；"),
+        full_text=join_unique([rule.full_text for rule in winners], "\n")
+    )
+
+
+def merge_regulations(regulations: List[StairRegulation]) -> StairRegulation:
+    """
+    合并各批的提取结果：规范名称和编号取第一个有效值，各规则按merge_rules取最严格的限值
+
+    Args:
+        regulations: 各批的提取结果（按条文在原文中的顺序）
+
+    Returns:
+        StairRegulation: 合并后的规范
+    """
+    names = [r.regulation_name for r in regulations if r.regulation_name and r.regulation_name != "未知规范"]
+    codes = [r.regulation_code for r in regulations if r.regulation_code]
+
+    rules = {name: merge_rules([getattr(r, name) for r in regulations]) for name in RULE_FIELDS}
+    return StairRegulation(
+        regulation_name=names[0] if names else "未知规范",
+        regulation_code=codes[0] if codes else "",
+        **rules
+    )
+
+
+class PartialExtractionError(Exception):
+    """
+    部分批次提取失败：regulation为其余批次合并的结果。
+    失败批次中的条文可能给出更严格的限值，结果不完整，调用方可以使用但不应写入提取缓存
+    """
+
+    def __init__(self, regulation: StairRegulation, failed: int, total: int, first_error: Exception):
+        super().__init__(f"{failed}/{total} 批条文提取失败（{type(first_error).__name__}: {first_error}）")
+        self.regulation = regulation
+        self.failed = failed
+        self.total = total
 
 
 class RegulationExtractor:
     """规范提取器"""
 
-    def __init__(self, api_key: Optional[str] = None, base_url: Optional[str] = None):
+    def __init__(self, api_key: Optional[str] = None, base_url: Optional[str] = None, top_k: int = EXTRACTION_TOP_K):
         """
         初始化提取器
 
         Args:
             api_key: OpenAI API密钥（如果不提供，从环境变量读取）
             base_url: API基础URL（可用于国内API）
+            top_k: 每类规则检索后发送给LLM的条文数
         """
+        self.top_k = top_k
+        self.batch_chars = int(os.getenv("LLM_BATCH_CHARS", DEFAULT_BATCH_CHARS))
+        self.max_concurrency = int(os.getenv("LLM_MAX_CONCURRENCY", DEFAULT_MAX_CONCURRENCY))
         self.api_key = api_key or os.getenv("OPENAI_API_KEY")
         self.base_url = base_url or os.getenv("OPENAI_BASE_URL", "https://api.openai.com/v1")
+        self.model = os.getenv("LLM_MODEL", "openai/gpt-4o-mini")
 
         if not self.api_key:
             console.print("[red]警告: 未找到OPENAI_API_KEY，请在.env文件中配置[/red]")
@@ -60,6 +166,15 @@ class RegulationExtractor:
             max_retries=3   # 自动重试3次
         )
 
+    def cache_version(self) -> str:
+        """
+        提取缓存使用的版本标识，提取器版本或模型改变时不再使用旧的缓存结果
+
+        Returns:
+            str: 版本标识
+        """
+        return f"llm-{EXTRACTOR_VERSION}-{self.model}-top{self.top_k}-batch{self.batch_chars}"
+
     def extract_regulation_info(self, text: str) -> Dict:
         """
         从文本中提取规范名称和编号
@@ -102,35 +217,74 @@ class RegulationExtractor:
         """
         使用LLM提取楼梯规范
 
+        检索到的条文按长度分批，各批并发请求（并发数受max_concurrency限制），
+        再把各批的结果合并为一个规范（见merge_regulations）。
+
         Args:
             pages_content: PDF页面内容列表
 
         Returns:
             StairRegulation: 提取的规范数据
-        """
-        # 合并所有楼梯相关文本
-        combined_text = "\n\n".join([
-            f"=== 第{page['page_number']}页 ===\n{page['text']}"
-            for page in pages_content
-        ])
 
-        # 限制文本长度（避免超过token限制）
-        max_chars = 15000
-        if len(combined_text) > max_chars:
-            console.print(f"[yellow]文本过长，截取前{max_chars}字符[/yellow]")
-            combined_text = combined_text[:max_chars]
+        Raises:
+            PartialExtractionError: 部分批次失败，异常中带有其余批次合并的结果
+        """
+        # 按条文检索每类规则最相关的条文，只把这些条文发送给LLM（不再截断拼接后的全文）
+        retriever = ClauseRetriever(pages_content)
+        clauses = retriever.retrieve_for_rules(self.top_k)
+        batches = batch_clauses(clauses, self.batch_chars)
+
+        # 提取规范基本信息（规范名称通常在首页开头，不一定在检索到的条文中）
+        reg_info = self.extract_regulation_info(pages_content[0]["text"] + "\n" + format_clauses(clauses))
+
+        # OpenRouter支持的模型，按推荐顺序：
+        # 1. google/gemini-2.0-flash-exp:free (免费，速度快)
+        # 2. openai/gpt-4o-mini (性价比高)
+        # 3. anthropic/claude-3.5-sonnet (效果最好)
+        workers = max(1, min(self.max_concurrency, len(batches)))
+        console.print(f"[cyan]使用模型: {self.model}[/cyan]")
+        console.print(f"[cyan]正在调用LLM提取规范数据（{len(batches)} 批，{workers} 个并发请求）...[/cyan]")
+        console.print("[yellow]正在调用LLM API...（这可能需要1-2分钟，请耐心等待）[/yellow]")
+
+        if len(batches) == 1:
+            return self.extract_batch(batches[0], reg_info)
+
+        results = []
+        errors = []
+        with ThreadPoolExecutor(max_workers=workers) as pool:
+            futures = [pool.submit(self.extract_batch, text, reg_info) for text in batches]
+            for index, future in enumerate(futures):
+                try:
+                    results.append(future.result())
+                except Exception as e:
+                    errors.append(e)
+                    console.print(f"[yellow][WARNING] 第{index + 1}/{len(batches)}批提取失败，忽略该批: {e}[/yellow]")
+
+        # 全部失败时抛出第一个错误；部分失败时把其余批次的结果随异常一起交给调用方，不当作完整结果
+        if not results:
+            raise errors[0]
+
+        console.print(f"[green][OK] {len(results)}/{len(batches)} 批提取完成，正在合并结果[/green]")
+        regulation = merge_regulations(results)
+        if errors:
+            raise PartialExtractionError(regulation, len(errors), len(batches), errors[0])
+        return regulation
 
-        # 提取规范基本信息
-        reg_info = self.extract_regulation_info(combined_text)
+    def build_prompt(self, clause_text: str) -> str:
+        """
+        构造提示词
 
-        console.print("[cyan]正在调用LLM提取规范数据...[/cyan]")
+        Args:
+            clause_text: 一批条文
 
-        # 构造提示词
-        prompt = f"""
+        Returns:
+            str: 提示词
+        """
+        return f"""
 你是一个专业的建筑规范分析专家。请从以下建筑规范文本中提取楼梯相关的数值限制。
 
-规范文本：
-{combined_text}
+规范文本（按规则类型检索出的相关条文）：
+{clause_text}
 
 请提取以下信息，并以JSON格式返回：
 
@@ -143,17 +297,23 @@ class RegulationExtractor:
 2. **踏步宽度/深度 (tread_depth)**：最小值限制
 3. **2R+G公式 (two_r_plus_g)**：最小值和最大值范围
 4. **平台长度 (landing_length)**：最小值限制
+5. **扇形踏步窄端宽度 (narrow_tread_depth)**：螺旋楼梯和扇形踏步在距内侧扶手0.25m处的踏步宽度，最小值限制
+6. **踢面高度差 (riser_variation)**：同一梯段内踏步高度的最大差值，最大值限制
+7. **梯段净宽 (stair_width)**：楼梯梯段的最小净宽度，最小值限制
+8. **扶手高度 (handrail_height)**：楼梯扶手的高度（自踏步前缘量起），最小值限制
+9. **梯段坡度 (slope_angle)**：楼梯的最大坡度（倾斜角），最大值限制，单位为度 "deg"
+10. **梯段间距 (between_flights)**：两梯段及其扶手之间的水平净距（梯井宽度），最小值限制
 
 对于每个规则，请提供：
 - min_value: 最小值（如果有）
 - max_value: 最大值（如果有）
-- unit: 单位（统一转换为米 "m"）
+- unit: 单位（统一转换为米 "m"，坡度为度 "deg"）
 - source: 规范来源（章节号，如"第6.3.2条"）
 - full_text: 完整的规范条文
 
 **重要提示**：
 - regulation_name必须是规范文档的主标题，不要提取条文的一部分
-- 所有数值统一转换为米（m）为单位。例如：170mm = 0.17m, 260mm = 0.26m
+- 所有数值统一转换为米（m）为单位。例如：170mm = 0.17m, 260mm = 0.26m；只有坡度以度为单位，如38°写为38
 - 如果某个规则在文本中没有找到，设置为null
 - 确保提取的数值准确无误
 - source字段只写章节号，不要包含规范名称
@@ -186,28 +346,46 @@ class RegulationExtractor:
     "unit": "m",
     "source": "平台要求",
     "full_text": "中间平台宽度不应小于1.20m"
-  }}
+  }},
+  "narrow_tread_depth": {{
+    "min_value": 0.22,
+    "unit": "m",
+    "source": "第6.8.10条",
+    "full_text": "螺旋楼梯和扇形踏步离内侧扶手中心0.25m处的踏步宽度不应小于0.22m"
+  }},
+  "riser_variation": null,
+  "stair_width": {{
+    "min_value": 1.1,
+    "unit": "m",
+    "source": "第6.3.2条",
+    "full_text": "楼梯梯段净宽不应小于1.10m"
+  }},
+  "handrail_height": null,
+  "slope_angle": null,
+  "between_flights": null
 }}
 
 只返回JSON，不要添加其他说明文字。
 """
 
-        try:
-            # 调用LLM
-            # OpenRouter支持的模型，按推荐顺序：
-            # 1. google/gemini-2.0-flash-exp:free (免费，速度快)
-            # 2. openai/gpt-4o-mini (性价比高)
-            # 3. anthropic/claude-3.5-sonnet (效果最好)
-            model = os.getenv("LLM_MODEL", "openai/gpt-4o-mini")
+    def extract_batch(self, clause_text: str, reg_info: Dict) -> StairRegulation:
+        """
+        发送一次LLM请求，提取一批条文中的规范数据
 
-            console.print(f"[cyan]使用模型: {model}[/cyan]")
-            console.print("[yellow]正在调用LLM API...（这可能需要1-2分钟，请耐心等待）[/yellow]")
+        Args:
+            clause_text: 一批条文
+            reg_info: 正则提取的规范名称和编号（LLM未返回时使用）
 
+        Returns:
+            StairRegulation: 这批条文的提取结果
+        """
+        result_text = ""
+        try:
             response = self.client.chat.completions.create(
-                model=model,
+                model=self.model,
                 messages=[
                     {"role": "system", "content": "你是建筑规范分析专家，擅长从规范文本中提取结构化数据。"},
-                    {"role": "user", "content": prompt}
+                    {"role": "user", "content": self.build_prompt(clause_text)}
                 ],
                 temperature=0.1,  # 降低温度以提高准确性
                 response_format={"type": "json_object"}
@@ -240,7 +418,13 @@ class RegulationExtractor:
                 riser_height=RegulationRule(**clean_rule_data(extracted_data.get("riser_height"))) if extracted_data.get("riser_height") else None,
                 tread_depth=RegulationRule(**clean_rule_data(extracted_data.get("tread_depth"))) if extracted_data.get("tread_depth") else None,
                 two_r_plus_g=RegulationRule(**clean_rule_data(extracted_data.get("two_r_plus_g"))) if extracted_data.get("two_r_plus_g") else None,
-                landing_length=RegulationRule(**clean_rule_data(extracted_data.get("landing_length"))) if extracted_data.get("landing_length") else None
+                landing_length=RegulationRule(**clean_rule_data(extracted_data.get("landing_length"))) if extracted_data.get("landing_length") else None,
+                narrow_tread_depth=RegulationRule(**clean_rule_data(extracted_data.get("narrow_tread_depth"))) if extracted_data.get("narrow_tread_depth") else None,
+                riser_variation=RegulationRule(**clean_rule_data(extracted_data.get("riser_variation"))) if extracted_data.get("riser_variation") else None,
+                stair_width=RegulationRule(**clean_rule_data(extracted_data.get("stair_width"))) if extracted_data.get("stair_width") else None,
+                handrail_height=RegulationRule(**clean_rule_data(extracted_data.get("handrail_height"))) if extracted_data.get("handrail_height") else None,
+                slope_angle=RegulationRule(**clean_rule_data(extracted_data.get("slope_angle"))) if extracted_data.get("slope_angle") else None,
+                between_flights=RegulationRule(**clean_rule_data(extracted_data.get("between_flights"))) if extracted_data.get("between_flights") else None
             )
 
             return regulation
@@ -294,6 +478,42 @@ class RegulationExtractor:
                 if not (0.50 <= regulation.two_r_plus_g.max_value <= 0.70):
                     warnings.append(f"2R+G最大值异常: {regulation.two_r_plus_g.max_value}m")
 
+        # 检查扇形踏步窄端宽度
+        if regulation.narrow_tread_depth:
+            if regulation.narrow_tread_depth.min_value:
+                if not (0.10 <= regulation.narrow_tread_depth.min_value <= 0.30):
+                    warnings.append(f"扇形踏步窄端宽度异常: {regulation.narrow_tread_depth.min_value}m")
+
+        # 检查踢面高度差
+        if regulation.riser_variation:
+            if regulation.riser_variation.max_value:
+                if not (0.0 < regulation.riser_variation.max_value <= 0.03):
+                    warnings.append(f"踢面高度差异常: {regulation.riser_variation.max_value}m")
+
+        # 检查梯段净宽
+        if regulation.stair_width:
+            if regulation.stair_width.min_value:
+                if not (0.60 <= regulation.stair_width.min_value <= 3.00):
+                    warnings.append(f"梯段净宽异常: {regulation.stair_width.min_value}m")
+
+        # 检查扶手高度
+        if regulation.handrail_height:
+            if regulation.handrail_height.min_value:
+                if not (0.80 <= regulation.handrail_height.min_value <= 1.20):
+                    warnings.append(f"扶手高度异常: {regulation.handrail_height.min_value}m")
+
+        # 检查梯段坡度（度）
+        if regulation.slope_angle:
+            if regulation.slope_angle.max_value:
+                if not (20.0 <= regulation.slope_angle.max_value <= 60.0):
+                    warnings.append(f"梯段坡度异常: {regulation.slope_angle.max_value}°")
+
+        # 检查梯段间距
+        if regulation.between_flights:
+            if regulation.between_flights.min_value:
+                if not (0.0 < regulation.between_flights.min_value <= 0.50):
+                    warnings.append(f"梯段间距异常: {regulation.between_flights.min_value}m")
+
         if warnings:
             console.print("[yellow][WARNING] 发现异常数据:[/yellow]")
             for warning in warnings:
@@ -0,0 +1,234 @@
+"""
+规范提取常驻进程
+
+由ArchiCAD插件启动一次并保持运行，避免每次上传都重新启动解释器、导入PDF库和创建LLM客户端。
+插件通过标准输入发送请求，每行一个JSON对象；进程通过标准输出返回消息，同样每行一个JSON对象。
+标准输出只用于协议消息，其余输出（进度日志、异常堆栈）写入标准错误。
+
+请求:
+  {"type": "extract", "id": 1, "pdf": "规范.pdf", "output": "result.json"}
+  {"type": "cancel", "id": 1}            只能取消仍在排队的任务
+  {"type": "ping"}
+  {"type": "shutdown"}                   处理完当前任务后退出
+
+消息:
+  {"type": "ready", "backend": "llm", "startup_seconds": 2.1}
+  {"type": "accepted", "id": 1, "position": 0}
+  {"type": "progress", "id": 1, "stage": "parse", "message": "解析PDF文件"}
+  {"type": "result", "id": 1, "ok": true, "output": "result.json", "cached": null, "partial": null, "regulation": {...}, "seconds": 35.2}
+  {"type": "result", "id": 1, "ok": false, "error": "...", "seconds": 0.4}
+  {"type": "cancelled", "id": 1}
+  {"type": "pong", "queued": 0, "busy": false}
+  {"type": "error", "message": "..."}   无法识别的请求
+
+阶段(stage)为 cache / parse / extract / validate / save；cached 为 "document"（文件未改变）、
+"text"（楼梯相关条文未改变）或 null（重新提取），缓存说明见 extraction_cache.py。
+partial 为部分批次提取失败时的说明（结果不完整，未写入提取缓存），完整提取时为 null。
+"""
+import sys
+
+# 协议消息独占标准输出，其余模块的输出（rich等）都改写到标准错误
+protocol_out = sys.stdout
+sys.stdout = sys.stderr
+
+import argparse
+import json
+import threading
+import time
+import traceback
+from collections import deque
+from typing import Optional
+
+startup_time = time.perf_counter()
+
+from config_generator import ConfigGenerator
+from extraction_cache import ExtractionCache, extract_regulation
+from regulation_extractor import PartialExtractionError
+
+
+write_lock = threading.Lock()
+
+
+def send(message: dict) -> None:
+    """发送一条协议消息"""
+    line = json.dumps(message, ensure_ascii=False)
+    with write_lock:
+        protocol_out.write(line + "\n")
+        protocol_out.flush()
+
+
+def create_extractor(backend: str):
+    """创建提取器：llm 调用LLM服务，local 使用本地规则（无需网络，用于测试）"""
+    if backend == "local":
+        from local_extractor import LocalRegulationExtractor
+        return LocalRegulationExtractor()
+
+    from regulation_extractor import RegulationExtractor
+    return RegulationExtractor()
+
+
+class ExtractionWorker:
+    """按提交顺序逐个执行提取任务"""
+
+    def __init__(self, extractor, cache: Optional[ExtractionCache]):
+        self.extractor = extractor
+        self.cache = cache
+        self.queue = deque()
+        self.current_id = None
+        self.stopping = False
+        self.condition = threading.Condition()
+
+    def submit(self, job: dict) -> None:
+        with self.condition:
+            self.queue.append(job)
+            position = len(self.queue) - 1 + (1 if self.current_id is not None else 0)
+            self.condition.notify()
+        send({"type": "accepted", "id": job["id"], "position": position})
+
+    def cancel(self, job_id) -> None:
+        with self.condition:
+            for job in self.queue:
+                if job["id"] == job_id:
+                    self.queue.remove(job)
+                    break
+            else:
+                job = None
+        if job is not None:
+            send({"type": "cancelled", "id": job_id})
+
+    def status(self) -> dict:
+        with self.condition:
+            return {"type": "pong", "queued": len(self.queue), "busy": self.current_id is not None}
+
+    def stop(self) -> None:
+        with self.condition:
+            self.stopping = True
+            self.condition.notify()
+
+    def run(self) -> None:
+        while True:
+            with self.condition:
+                while not self.queue and not self.stopping:
+                    self.condition.wait()
+                if self.stopping:
+                    for job in self.queue:
+                        send({"type": "cancelled", "id": job["id"]})
+                    self.queue.clear()
+                    return
+                job = self.queue.popleft()
+                self.current_id = job["id"]
+
+            self.process(job)
+
+            with self.condition:
+                self.current_id = None
+
+    def process(self, job: dict) -> None:
+        job_id = job["id"]
+        started = time.perf_counter()
+
+        def progress(stage: str, message: str) -> None:
+            send({"type": "progress", "id": job_id, "stage": stage, "message": message})
+
+        try:
+            partial = None
+            try:
+                regulation, cached = extract_regulation(job["pdf"], self.extractor, self.cache, progress)
+            except PartialExtractionError as e:
+                regulation, cached, partial = e.regulation, None, str(e)
+
+            progress("save", "保存配置文件")
+            ConfigGenerator.save_json(regulation, job["output"])
+
+            send({
+                "type": "result",
+                "id": job_id,
+                "ok": True,
+                "output": job["output"],
+                "cached": cached,
+                "partial": partial,
+                "regulation": ConfigGenerator.regulation_to_dict(regulation),
+                "seconds": round(time.perf_counter() - started, 3)
+            })
+        except Exception as e:
+            traceback.print_exc()
+            send({
+                "type": "result",
+                "id": job_id,
+                "ok": False,
+                "error": f"{type(e).__name__}: {e}",
+                "seconds": round(time.perf_counter() - started, 3)
+            })
+
+
+def serve(worker: ExtractionWorker) -> None:
+    """读取标准输入中的请求，直到收到shutdown或输入关闭"""
+    while True:
+        line = sys.stdin.readline()
+        if not line:
+            break
+        line = line.strip()
+        if not line:
+            continue
+
+        try:
+            request = json.loads(line)
+            request_type = request["type"]
+        except (ValueError, KeyError, TypeError):
+            send({"type": "error", "message": f"无法识别的请求: {line[:200]}"})
+            continue
+
+        if request_type == "extract":
+            if "id" not in request or not request.get("pdf") or not request.get("output"):
+                send({"type": "error", "message": "extract请求需要id、pdf和output"})
+                continue
+            worker.submit(request)
+        elif request_type == "cancel":
+            worker.cancel(request.get("id"))
+        elif request_type == "ping":
+            send(worker.status())
+        elif request_type == "shutdown":
+            break
+        else:
+            send({"type": "error", "message": f"未知的请求类型: {request_type}"})
+
+    worker.stop()
+
+
+def main():
+    """主函数"""
+    parser = argparse.ArgumentParser(description="楼梯规范提取常驻进程（JSON Lines协议，经标准输入/输出通信）")
+    parser.add_argument(
+        "--backend",
+        choices=["llm", "local"],
+        default="llm",
+        help="提取后端：llm 调用LLM服务；local 使用本地规则，无需网络（默认: llm）"
+    )
+    parser.add_argument(
+        "--cache-dir",
+        help="提取缓存目录（默认: 环境变量REGULATION_CACHE_DIR或python_rag_tool/cache）"
+    )
+    parser.add_argument(
+        "--no-cache",
+        action="store_true",
+        help="不使用提取缓存，每次都重新解析和提取"
+    )
+    args = parser.parse_args()
+
+    cache = None if args.no_cache else ExtractionCache(args.cache_dir)
+    worker = ExtractionWorker(create_extractor(args.backend), cache)
+    thread = threading.Thread(target=worker.run, name="extraction")
+    thread.start()
+
+    send({
+        "type": "ready",
+        "backend": args.backend,
+        "startup_seconds": round(time.perf_counter() - startup_time, 3)
+    })
+
+    serve(worker)
+    thread.join()
+
+
+if __name__ == "__main__":
+    main()